@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+/// Residency state of the mesh geometry that is used to select the meshes to evict.
+struct HnGeometryResidencyItem
+{
+    /// The GPU memory size of the mesh geometry, in bytes.
+    Uint64 Size = 0;
+
+    /// The number of the frame in which the mesh was last requested for rendering.
+    Uint32 LastVisibleFrame = 0;
+};
+
+/// Selects the meshes whose geometry is evicted to fit the resident geometry into the budget.
+///
+/// \param [in] Items        - Meshes whose geometry is resident in GPU memory.
+/// \param [in] ResidentSize - The total size of the resident geometry, in bytes. It may include
+///                            geometry that can't be evicted and is not in the Items list.
+/// \param [in] LastFrame    - The number of the last rendered frame.
+/// \param [in] Budget       - Geometry memory budget, in bytes.
+///
+/// \return     Indices of the items to evict, least recently visible first.
+///
+/// \remarks    Meshes that were visible in the last frame or later (e.g. meshes whose geometry
+///             was uploaded in the current frame) are never evicted, so the resident size may
+///             still exceed the budget after the eviction.
+std::vector<size_t> SelectGeometryToEvict(const std::vector<HnGeometryResidencyItem>& Items,
+                                          Uint64                                      ResidentSize,
+                                          Uint32                                      LastFrame,
+                                          Uint64                                      Budget);
+
+} // namespace USD
+
+} // namespace Diligent
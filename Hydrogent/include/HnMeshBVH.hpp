@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+/// Bounding volume hierarchy of mesh triangles that is used for CPU ray casting.
+class HnMeshBVH
+{
+public:
+    /// Builds the hierarchy.
+    ///
+    /// \param [in] pPositions   - Vertex positions.
+    /// \param [in] NumVertices  - The number of vertices.
+    /// \param [in] pIndices     - Triangle list indices.
+    /// \param [in] NumTriangles - The number of triangles.
+    ///
+    /// \remarks    Vertex positions are copied, so the source data may be released after the call.
+    ///             Triangles that reference vertices out of range are skipped.
+    void Build(const float3* pPositions,
+               Uint32        NumVertices,
+               const Uint32* pIndices,
+               Uint32        NumTriangles);
+
+    void Clear();
+
+    bool IsEmpty() const { return m_Nodes.empty(); }
+
+    struct Hit
+    {
+        /// Ray parameter of the hit point, i.e. Origin + Direction * T.
+        float T = 0;
+
+        /// The index of the hit triangle in the triangle list passed to Build().
+        Uint32 Triangle = ~0u;
+
+        /// Geometric normal of the hit triangle. Not normalized.
+        float3 Normal;
+    };
+
+    /// Finds the closest intersection of the ray with the mesh triangles.
+    ///
+    /// \param [in]  Origin    - Ray origin.
+    /// \param [in]  Direction - Ray direction. Does not need to be normalized.
+    /// \param [in]  MaxT      - Maximum value of the ray parameter.
+    /// \param [out] Result    - Intersection data.
+    ///
+    /// \return     true if the ray hits a triangle with the ray parameter in [0, MaxT], and false otherwise.
+    ///
+    /// \remarks    Triangles are double-sided.
+    bool RayCast(const float3& Origin, const float3& Direction, float MaxT, Hit& Result) const;
+
+private:
+    struct Node
+    {
+        float3 BoundsMin;
+        float3 BoundsMax;
+
+        // For leaf nodes, the index of the first triangle in m_Triangles.
+        // For internal nodes, the index of the second child. The first child
+        // immediately follows the node.
+        Uint32 Offset = 0;
+
+        // The number of triangles in the leaf node, or zero for internal nodes.
+        Uint32 NumTriangles = 0;
+    };
+
+    struct Triangle
+    {
+        Uint32 Indices[3];
+
+        // The index of the triangle in the source triangle list
+        Uint32 SourceIndex;
+    };
+
+    Uint32 BuildNode(Uint32 FirstTriangle, Uint32 NumTriangles, std::vector<float3>& Centroids);
+
+private:
+    std::vector<float3>   m_Positions;
+    std::vector<Triangle> m_Triangles;
+    std::vector<Node>     m_Nodes;
+};
+
+} // namespace USD
+
+} // namespace Diligent
@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <array>
+
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+/// Simplifies triangle meshes using edge collapses ordered by the quadric error metric
+/// (M. Garland, P. Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997).
+///
+/// Edges are collapsed onto one of their existing vertices, so the simplified index
+/// lists reference the same vertex data as the original mesh. Border vertices, vertices of
+/// non-manifold edges and vertices that are explicitly locked by the caller are never removed.
+///
+/// The simplifier is progressive: each call to Simplify() continues from the result of
+/// the previous call, which makes it efficient to generate a chain of levels of detail.
+class HnMeshSimplifier
+{
+public:
+    /// \param [in] pPositions      - Vertex positions.
+    /// \param [in] NumVertices     - The number of vertices.
+    /// \param [in] pIndices        - Triangle list indices.
+    /// \param [in] NumIndices      - The number of indices. Must be a multiple of 3.
+    /// \param [in] LockedVertices  - Optional per-vertex flags. Vertices that are marked
+    ///                               as locked are never removed. If not empty, the
+    ///                               size must be equal to NumVertices.
+    HnMeshSimplifier(const float3*     pPositions,
+                     Uint32            NumVertices,
+                     const Uint32*     pIndices,
+                     Uint32            NumIndices,
+                     std::vector<bool> LockedVertices = {});
+
+    /// Collapses edges until the number of indices does not exceed TargetIndexCount
+    /// or no more edges can be collapsed.
+    ///
+    /// \return     The geometric error of the simplified mesh, see GetError().
+    float Simplify(Uint32 TargetIndexCount);
+
+    /// Returns the triangle list indices of the simplified mesh.
+    const std::vector<Uint32>& GetIndices() const { return m_Indices; }
+
+    /// Returns the geometric error of the simplified mesh, i.e. the maximum
+    /// approximate distance from the original surface, in mesh units.
+    float GetError() const { return m_Error; }
+
+private:
+    // Symmetric 4x4 quadric matrix weighted by the triangle area.
+    struct Quadric
+    {
+        // a00, a01, a02, a11, a12, a22, b0, b1, b2, c
+        std::array<double, 10> q = {};
+
+        // Total weight of the planes that contributed to the quadric
+        double w = 0;
+
+        Quadric& operator+=(const Quadric& rhs);
+
+        // Returns the area-weighted sum of squared distances from the point to the quadric planes.
+        double Evaluate(const float3& Pos) const;
+    };
+
+    // Returns the approximate squared distance from the point to the surface represented by the quadric.
+    static double GetCollapseError(const Quadric& Q, const float3& Pos);
+
+    // Returns true if replacing Vert with NewVert in the triangles adjacent to Vert
+    // does not flip any of them.
+    bool IsCollapseValid(Uint32 Vert, Uint32 NewVert) const;
+
+    void UpdateAdjacency();
+
+private:
+    const float3* const m_pPositions;
+    const Uint32        m_NumVertices;
+
+    std::vector<Uint32>  m_Indices;
+    std::vector<Quadric> m_Quadrics;
+    std::vector<bool>    m_LockedVertices;
+
+    // Vertex to triangle adjacency in the compressed row format
+    std::vector<Uint32> m_AdjacencyOffsets;
+    std::vector<Uint32> m_AdjacentTriangles;
+
+    // Maximum squared error of all collapses
+    double m_MaxCollapseError = 0;
+    float  m_Error            = 0;
+};
+
+} // namespace USD
+
+} // namespace Diligent
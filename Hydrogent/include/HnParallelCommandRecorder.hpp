@@ -0,0 +1,149 @@
+/*
+ *  Copyright 2023 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "DeviceContext.h"
+#include "CommandList.h"
+#include "ThreadPool.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+/// Records resource update commands in parallel using deferred contexts.
+///
+/// The items are split into contiguous chunks, one per deferred context. Each chunk is processed
+/// by a thread pool worker that records commands into its own deferred context. The resulting
+/// command lists are executed on the immediate context in the chunk order, so the commands are
+/// executed in the same order as if all items were processed serially.
+///
+/// If the recorder is not enabled or there is only one chunk, the items are processed serially
+/// on the immediate context.
+class HnParallelCommandRecorder
+{
+public:
+    HnParallelCommandRecorder() noexcept {}
+
+    HnParallelCommandRecorder(IThreadPool*           pThreadPool,
+                              IDeviceContext*        pImmediateContext,
+                              IDeviceContext* const* ppDeferredContexts,
+                              Uint32                 NumDeferredContexts) :
+        m_pThreadPool{pThreadPool},
+        m_pImmediateContext{pImmediateContext}
+    {
+        if (m_pThreadPool != nullptr && ppDeferredContexts != nullptr)
+        {
+            m_DeferredContexts.reserve(NumDeferredContexts);
+            for (Uint32 i = 0; i < NumDeferredContexts; ++i)
+            {
+                if (ppDeferredContexts[i] == nullptr)
+                {
+                    UNEXPECTED("Deferred context ", i, " is null");
+                    continue;
+                }
+                VERIFY(ppDeferredContexts[i]->GetDesc().IsDeferred, "Context ", i, " is not a deferred context");
+                m_DeferredContexts.emplace_back(ppDeferredContexts[i]);
+            }
+        }
+    }
+
+    /// Returns true if commands are recorded in parallel.
+    bool IsEnabled() const { return m_pThreadPool != nullptr && !m_DeferredContexts.empty(); }
+
+    /// Processes all items.
+    ///
+    /// \param [in] Items   - Items to process.
+    /// \param [in] Handler - Item handler: void(ItemType& Item, IDeviceContext* pCtx).
+    ///                       The handler must record all commands into pCtx.
+    ///
+    /// \remarks    When commands are recorded into deferred contexts, resource state transitions
+    ///             of resources shared between items are not thread-safe. The caller must transition
+    ///             such resources to the required states before calling this method and the handler
+    ///             must use RESOURCE_STATE_TRANSITION_MODE_NONE for them.
+    template <typename ItemType, typename HandlerType>
+    void Process(std::vector<ItemType>& Items, HandlerType&& Handler)
+    {
+        const size_t NumChunks = IsEnabled() ? std::min(m_DeferredContexts.size(), Items.size()) : 0;
+        if (NumChunks <= 1)
+        {
+            for (ItemType& Item : Items)
+                Handler(Item, m_pImmediateContext);
+            return;
+        }
+
+        const Uint32 ImmediateContextId = m_pImmediateContext->GetDesc().ContextId;
+
+        std::vector<RefCntAutoPtr<ICommandList>> CmdLists(NumChunks);
+        std::vector<RefCntAutoPtr<IAsyncTask>>   Tasks(NumChunks);
+        for (size_t chunk = 0; chunk < NumChunks; ++chunk)
+        {
+            const size_t FirstItem = Items.size() * chunk / NumChunks;
+            const size_t LastItem  = Items.size() * (chunk + 1) / NumChunks;
+
+            Tasks[chunk] = EnqueueAsyncWork(m_pThreadPool,
+                                            [&, chunk, FirstItem, LastItem](Uint32 ThreadId) {
+                                                IDeviceContext* pCtx = m_DeferredContexts[chunk];
+                                                pCtx->Begin(ImmediateContextId);
+                                                for (size_t i = FirstItem; i < LastItem; ++i)
+                                                    Handler(Items[i], pCtx);
+                                                pCtx->FinishCommandList(&CmdLists[chunk]);
+                                                return ASYNC_TASK_STATUS_COMPLETE;
+                                            });
+        }
+
+        std::vector<ICommandList*> pCmdLists;
+        pCmdLists.reserve(NumChunks);
+        for (size_t chunk = 0; chunk < NumChunks; ++chunk)
+        {
+            Tasks[chunk]->WaitForCompletion();
+            if (CmdLists[chunk])
+                pCmdLists.push_back(CmdLists[chunk]);
+            else
+                UNEXPECTED("Failed to record command list for chunk ", chunk);
+        }
+
+        m_pImmediateContext->ExecuteCommandLists(static_cast<Uint32>(pCmdLists.size()), pCmdLists.data());
+        for (size_t chunk = 0; chunk < NumChunks; ++chunk)
+            m_DeferredContexts[chunk]->FinishFrame();
+    }
+
+private:
+    RefCntAutoPtr<IThreadPool>                 m_pThreadPool;
+    IDeviceContext*                            m_pImmediateContext = nullptr;
+    std::vector<RefCntAutoPtr<IDeviceContext>> m_DeferredContexts;
+};
+
+} // namespace USD
+
+} // namespace Diligent
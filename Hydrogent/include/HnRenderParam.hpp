@@ -47,13 +47,19 @@ public:
     HnRenderParam(bool                              UseVertexPool,
                   bool                              UseIndexPool,
                   HN_MATERIAL_TEXTURES_BINDING_MODE TextureBindingMode,
-                  float                             MetersPerUnit) noexcept;
+                  float                             MetersPerUnit,
+                  Uint32                            MeshLodCount,
+                  bool                              EnableRayCastPicking,
+                  bool                              CompressVertexNormals) noexcept;
     ~HnRenderParam();
 
     bool                              GetUseVertexPool() const { return m_UseVertexPool; }
     bool                              GetUseIndexPool() const { return m_UseIndexPool; }
     HN_MATERIAL_TEXTURES_BINDING_MODE GetTextureBindingMode() const { return m_TextureBindingMode; }
     float                             GetMetersPerUnit() const { return m_MetersPerUnit; }
+    Uint32                            GetMeshLodCount() const { return m_MeshLodCount; }
+    bool                              GetEnableRayCastPicking() const { return m_EnableRayCastPicking; }
+    bool                              GetCompressVertexNormals() const { return m_CompressVertexNormals; }
 
     HN_RENDER_MODE GetRenderMode() const { return m_RenderMode; }
     void           SetRenderMode(HN_RENDER_MODE Mode) { m_RenderMode = Mode; }
@@ -64,6 +70,18 @@ public:
     void SetUseShadows(bool UseShadows) { m_UseShadows = UseShadows; }
     bool GetUseShadows() const { return m_UseShadows; }
 
+    void  SetMeshLodErrorThreshold(float Threshold) { m_MeshLodErrorThreshold = Threshold; }
+    float GetMeshLodErrorThreshold() const { return m_MeshLodErrorThreshold; }
+
+    void   SetShadowCascadeCount(Uint32 CascadeCount) { m_ShadowCascadeCount = CascadeCount; }
+    Uint32 GetShadowCascadeCount() const { return m_ShadowCascadeCount; }
+
+    void  SetShadowCascadePartitioning(float Partitioning) { m_ShadowCascadePartitioning = Partitioning; }
+    float GetShadowCascadePartitioning() const { return m_ShadowCascadePartitioning; }
+
+    void  SetShadowCascadeBlendRange(float BlendRange) { m_ShadowCascadeBlendRange = BlendRange; }
+    float GetShadowCascadeBlendRange() const { return m_ShadowCascadeBlendRange; }
+
     enum class GlobalAttrib
     {
         // Indicates changes to geometry subset draw items.
@@ -118,6 +136,10 @@ private:
 
     const float m_MetersPerUnit;
 
+    const Uint32 m_MeshLodCount;
+    const bool   m_EnableRayCastPicking;
+    const bool   m_CompressVertexNormals;
+
     HN_RENDER_MODE m_RenderMode = HN_RENDER_MODE_SOLID;
 
     pxr::SdfPath m_SelectedPrimId;
@@ -128,6 +150,12 @@ private:
 
     bool m_UseShadows = false;
 
+    float m_MeshLodErrorThreshold = 1;
+
+    Uint32 m_ShadowCascadeCount        = 1;
+    float  m_ShadowCascadePartitioning = 0.95f;
+    float  m_ShadowCascadeBlendRange   = 0.1f;
+
     double   m_FrameTime   = 0.0;
     float    m_ElapsedTime = 0.0;
     uint32_t m_FrameNumber = 0;
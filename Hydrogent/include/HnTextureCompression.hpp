@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "Texture.h"
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+/// Texture data compressed by CompressTextureBC().
+struct HnCompressedTextureData
+{
+    TextureDesc Desc;
+
+    /// Compressed data of all mip levels, tightly packed.
+    std::vector<Uint8> Data;
+
+    /// Offsets of the mip levels in Data.
+    std::vector<size_t> MipOffsets;
+
+    /// Peak signal-to-noise ratio of the most detailed mip level, in dB,
+    /// computed over the channels that are stored by the compressed format.
+    double PSNR = 0;
+};
+
+/// Compresses the 2D texture data into the block-compressed format on the CPU.
+///
+/// \param [in]  SrcDesc   - Source texture description.
+/// \param [in]  SrcData   - Source texture data, one subresource per mip level.
+/// \param [in]  DstFormat - Target format: TEX_FORMAT_BC1_UNORM, TEX_FORMAT_BC3_UNORM, or TEX_FORMAT_BC4_UNORM.
+///                          BC1 and BC3 require RGBA8 source data, BC4 requires R8 source data.
+///                          sRGB variants of BC1 and BC3 are selected automatically for sRGB sources.
+/// \param [out] Dst       - Compressed texture data.
+///
+/// \return     true if the data was compressed successfully, and false otherwise.
+///
+/// \remarks    If all texels are opaque, BC3 is replaced with BC1 that uses half the memory.
+///             The source dimensions must be multiples of the block size.
+bool CompressTextureBC(const TextureDesc&       SrcDesc,
+                       const TextureData&       SrcData,
+                       TEXTURE_FORMAT           DstFormat,
+                       HnCompressedTextureData& Dst);
+
+/// Serializes the compressed texture data as a DDS file with the DX10 header.
+std::vector<Uint8> WriteCompressedTextureDDS(const HnCompressedTextureData& Data);
+
+} // namespace USD
+
+} // namespace Diligent
@@ -26,6 +26,9 @@
 
 #pragma once
 
+#include <array>
+#include <string>
+
 #include "TextureLoader.h"
 #include "RefCntAutoPtr.hpp"
 
@@ -38,6 +41,38 @@ namespace USD
 RefCntAutoPtr<ITextureLoader> CreateTextureLoaderFromSdfPath(const char*            SdfPath,
                                                              const TextureLoadInfo& LoadInfo);
 
+/// Creates the texture loader for the asset at the specified path and compresses the
+/// texture data into the block-compressed format, see CompressTextureBC().
+///
+/// \param [in] SdfPath          - Resolved asset path.
+/// \param [in] LoadInfo         - Texture load info. LoadInfo.Format must be the uncompressed
+///                                format that is compatible with CompressedFormat.
+/// \param [in] CompressedFormat - Target compressed format.
+/// \param [in] CacheDir         - Optional cache directory. If not empty, the compressed data is
+///                                stored in the directory in the DDS format under the name derived from
+///                                the hash of the asset contents and the load parameters, and is loaded
+///                                from there next time without decoding and compressing the asset again.
+///
+/// \remarks   If the texture can't be compressed, the loader for the uncompressed data is returned.
+RefCntAutoPtr<ITextureLoader> CreateCompressedTextureLoaderFromSdfPath(const char*            SdfPath,
+                                                                       const TextureLoadInfo& LoadInfo,
+                                                                       TEXTURE_FORMAT         CompressedFormat,
+                                                                       const std::string&     CacheDir);
+
+/// Creates the loader for the RGBA8 texture that packs the first components of up to four textures.
+///
+/// \param [in] Name             - Name of the packed texture.
+/// \param [in] ChannelLoaders   - Loaders of the textures to pack into the R, G, B and A channels.
+///                                Only the most detailed mip level of each texture is used.
+///                                If a loader is null, the channel is filled with 255.
+/// \param [in] CompressedFormat - Optional block-compressed format of the packed texture, see CompressTextureBC().
+///
+/// \remarks   Textures with a resolution lower than that of the largest texture are bilinearly resampled.
+///            Only 2D textures with 8-bit components can be packed.
+RefCntAutoPtr<ITextureLoader> CreatePackedTextureLoader(const char*                                          Name,
+                                                        const std::array<RefCntAutoPtr<ITextureLoader>, 4>& ChannelLoaders,
+                                                        TEXTURE_FORMAT                                       CompressedFormat = TEX_FORMAT_UNKNOWN);
+
 } // namespace USD
 
 } // namespace Diligent
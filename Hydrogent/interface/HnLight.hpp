@@ -26,6 +26,9 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
+
 #include "pxr/imaging/hd/light.h"
 
 #include "../../../DiligentCore/Common/interface/BasicMath.hpp"
@@ -45,10 +48,24 @@ struct PBRShadowMapInfo;
 namespace USD
 {
 
+class HnCamera;
+class HnRenderParam;
+class HnShadowMapManager;
+
 /// Light implementation in Hydrogent.
 class HnLight final : public pxr::HdLight
 {
 public:
+    /// The maximum number of shadow map cascades of a directional light.
+    static constexpr Uint32 MaxShadowCascades = 4;
+
+    /// The maximum number of shadow maps of a light. Point lights
+    /// use one shadow map for every face of the cube around the light.
+    static constexpr Uint32 MaxShadowMaps = 6;
+
+    /// The minimum resolution of the local light shadow maps selected by importance.
+    static constexpr Uint32 MinLocalShadowMapResolution = 128;
+
     static HnLight* Create(const pxr::SdfPath& Id, const pxr::TfToken& TypeId);
 
     ~HnLight();
@@ -67,29 +84,98 @@ public:
     const GLTF::Light& GetParams() const { return m_Params; }
     bool               IsVisible() const { return m_IsVisible; }
     const float4x4&    GetViewMatrix() const { return m_ViewMatrix; }
-    const float4x4&    GetProjMatrix() const { return m_ProjMatrix; }
-    const float4x4&    GetViewProjMatrix() const { return m_ViewProjMatrix; }
-    bool               ShadowsEnabled() const { return m_ShadowMapSuballocation != nullptr && m_SceneBounds.IsValid(); }
+    const float4x4&    GetShadowViewMatrix(Uint32 Idx = 0) const { return m_ShadowMaps[Idx].ViewMatrix; }
+    const float4x4&    GetProjMatrix(Uint32 Idx = 0) const { return m_ShadowMaps[Idx].ProjMatrix; }
+    const float4x4&    GetViewProjMatrix(Uint32 Idx = 0) const { return m_ShadowMaps[Idx].ViewProjMatrix; }
+    bool               ShadowsEnabled() const { return m_NumShadowMaps > 0 && m_SceneBounds.IsValid(); }
+
+    /// Returns the number of shadow maps, or 0 if the light does not cast shadows.
+    ///
+    /// \remarks    Directional lights use one shadow map per cascade, spot lights use
+    ///             a single perspective shadow map, and point lights as well as spot lights
+    ///             with a wide cone use six shadow maps that cover the faces of a cube.
+    Uint32 GetNumShadowMaps() const { return m_NumShadowMaps; }
+
+    /// Returns the number of shadow maps the light needs.
+    ///
+    /// \remarks    This number differs from GetNumShadowMaps() when the shadow maps could not be
+    ///             allocated in the atlas. UpdateShadowMaps() then retries the allocation every frame.
+    Uint32 GetNumRequestedShadowMaps() const { return m_NumRequestedShadowMaps; }
 
     /// Sets the index of the light's frame attributes data in the frame attribs buffer.
     /// This index is passed to the HnRenderDelegate::GetShadowPassFrameAttribsSRB
     /// method to set the offset in the frame attribs buffer.
+    /// Shadow maps of the light use GetNumShadowMaps() consecutive indices starting with this one.
     void SetFrameAttribsIndex(Int32 Index) { m_FrameAttribsIndex = Index; }
 
     /// Returns the index of the light's frame attributes data in the frame attribs buffer.
     Int32 GetFrameAttribsIndex() const { return m_FrameAttribsIndex; }
 
-    ITextureAtlasSuballocation*   GetShadowMapSuballocation() const { return m_ShadowMapSuballocation; }
+    ITextureAtlasSuballocation* GetShadowMapSuballocation(Uint32 Idx = 0) const { return m_ShadowMaps[Idx].Suballocation; }
+
+    /// Returns the array of GetNumShadowMaps() shadow map infos, or null if the light does not cast shadows.
     const HLSL::PBRShadowMapInfo* GetShadowMapShaderInfo() const { return m_ShadowMapShaderInfo.get(); }
 
+    /// Returns the number of shadow casters rendered into the shadow map the last time it was updated.
+    Uint32 GetNumShadowCasters(Uint32 Idx = 0) const { return m_ShadowMaps[Idx].NumCasters; }
+    void   SetNumShadowCasters(Uint32 Idx, Uint32 NumCasters) { m_ShadowMaps[Idx].NumCasters = NumCasters; }
+
+    /// Tests if the mesh may cast a shadow into the shadow map frustum.
+    ///
+    /// \param [in] Frustum        - Shadow map frustum extracted from the light's view-projection matrix.
+    /// \param [in] BoundingSphere - Mesh bounding sphere in the mesh space, see HnMesh::GetBoundingSphere().
+    /// \param [in] Transform      - Mesh world transform.
+    ///
+    /// \remarks    The frustum is extruded toward the light by ignoring its near plane, so that
+    ///             casters between the light and the frustum are not culled.
+    static bool IsShadowCasterInFrustum(const ViewFrustum& Frustum, const float4& BoundingSphere, const float4x4& Transform);
+
+    /// Returns the importance of the local light shadow, which is the light intensity at the camera position.
+    float GetShadowImportance(const float3& CameraPos) const;
+
+    /// Returns the local light shadow map resolution level, see UpdateShadowMaps().
+    Uint32 GetShadowResolutionLevel() const { return m_ShadowResolutionLevel; }
+
+    /// Updates the shadow maps before rendering the frame.
+    ///
+    /// \param [in] Camera          - Camera that is used to render the frame.
+    /// \param [in] RenderParam     - Render param that defines the shadow settings.
+    /// \param [in] ShadowMapMgr    - Shadow map manager that allocates the shadow maps.
+    /// \param [in] IsGL            - Whether the device uses the OpenGL NDC depth range.
+    /// \param [in] ResolutionLevel - For local lights, the shadow map resolution is the resolution
+    ///                               requested by the light divided by 2^ResolutionLevel.
+    ///
+    /// \remarks    The method is called by HnBeginFrameTask every frame after the light is synced.
+    ///             It fits the cascades of a directional light to the camera view frustum and
+    ///             reallocates the shadow maps when the cascade count setting or the local light
+    ///             shadow map resolution changes. If the new shadow maps can't be allocated, the
+    ///             existing ones are kept when possible, and the allocation is retried in later frames.
+    void UpdateShadowMaps(const HnCamera& Camera, HnRenderParam& RenderParam, HnShadowMapManager& ShadowMapMgr, bool IsGL, Uint32 ResolutionLevel);
+
     bool IsShadowMapDirty() const { return m_IsShadowMapDirty; }
     void SetShadowMapDirty(bool IsDirty) { m_IsShadowMapDirty = IsDirty; }
 
+    /// Returns the hash of the shadow casters the shadow maps were last checked against,
+    /// see HnRenderDelegate::ComputeShadowCastersHash().
+    size_t GetShadowCastersHash() const { return m_ShadowCastersHash; }
+    void   SetShadowCastersHash(size_t Hash) { m_ShadowCastersHash = Hash; }
+
 private:
     HnLight(const pxr::SdfPath& Id, const pxr::TfToken& TypeId);
 
     bool ApproximateAreaLight(pxr::HdSceneDelegate& SceneDelegate, float MetersPerUnit);
+    void ComputeSceneBounds(pxr::HdSceneDelegate& SceneDelegate, BoundBox* pLightSpaceBounds);
     void ComputeDirectLightProjMatrix(pxr::HdSceneDelegate& SceneDelegate);
+    void ComputeLocalLightShadowMatrices(bool IsGL);
+
+    Uint32 GetRequiredShadowMapCount(const HnRenderParam* pRenderParam) const;
+    Uint32 GetShadowMapAllocationResolution() const;
+
+    bool AllocateShadowMaps(HnShadowMapManager& ShadowMapMgr, Uint32 NumShadowMaps);
+    bool ShadowMapsNeedReallocation() const;
+    void ReleaseShadowMaps();
+    void UpdateShadowMapShaderInfo(Uint32 Idx);
+    void FitShadowMapToScene();
 
 private:
     const pxr::TfToken m_TypeId;
@@ -101,14 +187,36 @@ private:
     bool        m_IsShadowMapDirty = true;
 
     float4x4 m_ViewMatrix;
+    // Projection that covers the entire scene
     float4x4 m_ProjMatrix;
-    float4x4 m_ViewProjMatrix;
     BoundBox m_SceneBounds;
 
-    Int32                                     m_FrameAttribsIndex   = 0;
-    Uint32                                    m_ShadowMapResolution = 1024;
-    RefCntAutoPtr<ITextureAtlasSuballocation> m_ShadowMapSuballocation;
-    std::unique_ptr<HLSL::PBRShadowMapInfo>   m_ShadowMapShaderInfo;
+    struct ShadowMapData
+    {
+        RefCntAutoPtr<ITextureAtlasSuballocation> Suballocation;
+
+        float4x4 ViewMatrix;
+        float4x4 ProjMatrix;
+        float4x4 ViewProjMatrix;
+
+        // Camera view-space depth where the cascade ends
+        float EndZ = 0;
+
+        Uint32 NumCasters = 0;
+    };
+    std::array<ShadowMapData, MaxShadowMaps> m_ShadowMaps;
+
+    Int32                                     m_FrameAttribsIndex         = 0;
+    Uint32                                    m_ShadowMapResolution       = 1024;
+    Uint32                                    m_ShadowResolutionLevel     = 0;
+    Uint32                                    m_NumShadowMaps             = 0;
+    Uint32                                    m_NumRequestedShadowMaps    = 0;
+    bool                                      m_ShadowMapAllocationFailed = false;
+    float                                     m_CascadeBlendRange         = 0;
+    float                                     m_ShadowNearZ               = 0.01f;
+    bool                                      m_CascadesDirty             = false;
+    size_t                                    m_ShadowCastersHash         = 0;
+    std::unique_ptr<HLSL::PBRShadowMapInfo[]> m_ShadowMapShaderInfo;
 };
 
 } // namespace USD
@@ -29,6 +29,7 @@
 #include <memory>
 #include <unordered_map>
 #include <vector>
+#include <atomic>
 
 #include "HnMaterialNetwork.hpp"
 #include "HnTextureRegistry.hpp"
@@ -103,6 +104,12 @@ public:
 
     const pxr::TfToken& GetTag() const { return m_Network.GetTag(); }
 
+    const HnMaterialNetwork& GetNetwork() const { return m_Network; }
+
+    /// Returns the hash of the material network, or zero if the material has no network.
+    /// Materials with equal networks are equivalent, see HnRenderDelegate::FindEquivalentMaterial().
+    size_t GetNetworkHash() const { return m_NetworkHash; }
+
     /// Static shader texture indexing identifier, for example:
     ///    0 -> {0, 0, 0, 1, 1, 2}
     ///    1 -> {0, 1, 0, 1, 2, 2}
@@ -119,6 +126,29 @@ public:
 
     Uint32 GetPBRPrimitiveAttribsBufferRange() const { return m_PBRPrimitiveAttribsBufferRange; }
 
+    /// Updates the material after the resources of its textures have been replaced by the
+    /// texture registry, e.g. when the textures that were loaded asynchronously have been
+    /// published (until then, the material uses the default textures) or when the resident
+    /// mip levels of the streamed textures have changed.
+    ///
+    /// \return    true if the material has been updated and its SRB must be recreated
+    ///            by UpdateSRB(), and false otherwise.
+    bool UpdateTextureResources(HnTextureRegistry& TexRegistry, const USD_Renderer& UsdRenderer);
+
+    /// Requests the resolution, in texels, of the material textures for texture streaming.
+    void RequestTextureResolution(Uint32 Resolution) const
+    {
+        for (const auto& tex_it : m_Textures)
+        {
+            std::atomic<Uint32>& RequestedResolution = tex_it.second->RequestedResolution;
+
+            Uint32 CurrResolution = RequestedResolution.load();
+            while (CurrResolution < Resolution && !RequestedResolution.compare_exchange_weak(CurrResolution, Resolution))
+            {
+            }
+        }
+    }
+
 private:
     HnMaterial(pxr::SdfPath const& id);
 
@@ -133,18 +163,38 @@ private:
     // The same index is set in m_ShaderTextureAttribs[].UVSelector for the corresponding texture.
     // The name of the primvar that contains the texture coordinates is given by m_TexCoords[index].PrimVarName (e.g. "st0").
     using TexNameToCoordSetMapType = std::unordered_map<pxr::TfToken, size_t, pxr::TfToken::HashFunctor>;
-    TexNameToCoordSetMapType AllocateTextures(HnTextureRegistry& TexRegistry);
+    //
+    // If PackTextures is true, the metallic, roughness and occlusion textures are packed into
+    // a single occlusionRoughnessMetallic texture (R - occlusion, G - roughness, B - metallic).
+    TexNameToCoordSetMapType AllocateTextures(HnTextureRegistry& TexRegistry, bool PackTextures);
 
     HnTextureRegistry::TextureHandleSharedPtr GetDefaultTexture(HnTextureRegistry& TexRegistry, const pxr::TfToken& Name);
 
     void ProcessMaterialNetwork();
+
+    // Copies the state derived from the network of an equivalent material.
+    void CopyNetworkState(const HnMaterial& Src);
     void InitTextureAttribs(HnTextureRegistry& TexRegistry, const USD_Renderer& UsdRenderer, const TexNameToCoordSetMapType& TexNameToCoordSetMap);
 
+    Uint32 GetTexturesVersion() const;
+
 private:
     HnMaterialNetwork m_Network;
 
+    // Hash of m_Network, or zero if the material has no network
+    size_t m_NetworkHash = 0;
+
     std::unordered_map<pxr::TfToken, HnTextureRegistry::TextureHandleSharedPtr, pxr::TfToken::HashFunctor> m_Textures;
 
+    TexNameToCoordSetMapType m_TexNameToCoordSetMap;
+
+    // The name of the texture whose texture coordinates and transform are used
+    // by the packed occlusionRoughnessMetallic texture (e.g. "metallic").
+    pxr::TfToken m_PackedTextureParamsName;
+
+    // The sum of the versions of the texture handles in m_Textures when the texture attributes were initialized
+    Uint32 m_TexturesVersion = 0;
+
     RefCntAutoPtr<IShaderResourceBinding> m_SRB;
     IShaderResourceVariable*              m_PrimitiveAttribsVar = nullptr; // cbPrimitiveAttribs
 
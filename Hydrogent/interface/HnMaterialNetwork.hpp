@@ -115,6 +115,8 @@ struct HnMaterialParameter final
         return IsTexture() && ArrayOfTexturesSize > 0;
     }
 
+    bool operator==(const HnMaterialParameter& rhs) const;
+
     ParamType               Type = ParamType::Unknown;
     pxr::TfToken            Name;
     pxr::VtValue            FallbackValue;
@@ -182,6 +184,8 @@ public:
 
         // This is used for draw targets and hashing.
         pxr::SdfPath TexturePrim;
+
+        bool operator==(const TextureDescriptor& rhs) const;
     };
 
     const pxr::TfToken&      GetTag() const { return m_Tag; }
@@ -194,6 +198,13 @@ public:
     float GetOpacity() const { return m_Opacity; }
     float GetOpacityThreshold() const { return m_OpacityThreshold; }
 
+    // Returns true if the networks have the same tag, metadata, parameters and textures,
+    // i.e. the materials that use them are equivalent.
+    bool operator==(const HnMaterialNetwork& rhs) const;
+
+    // Computes the hash of the network that is consistent with operator==.
+    size_t ComputeHash() const;
+
 private:
     void LoadParams(const pxr::HdMaterialNetwork2& Network,
                     const pxr::HdMaterialNode2&    Node);
@@ -30,9 +30,11 @@
 #include <unordered_map>
 #include <map>
 #include <vector>
+#include <atomic>
 
 #include "pxr/imaging/hd/types.h"
 #include "pxr/imaging/hd/mesh.h"
+#include "pxr/imaging/hd/changeTracker.h"
 #include "pxr/base/tf/token.h"
 
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
@@ -82,7 +84,17 @@ public:
     // are part of the core geometric schema for this prim.
     virtual const pxr::TfTokenVector& GetBuiltinPrimvarNames() const override final;
 
-    void CommitGPUResources(HnRenderDelegate& RenderDelegate);
+    /// Uploads pending vertex and index data to the GPU.
+    ///
+    /// \param [in] RenderDelegate - Render delegate.
+    /// \param [in] pCtx           - Device context to record upload commands into.
+    ///                              This may be a deferred context, in which case
+    ///                              the shared pool buffers must be in the copy
+    ///                              destination state.
+    void CommitGPUResources(HnRenderDelegate& RenderDelegate, IDeviceContext* pCtx);
+
+    /// Returns true if the mesh has vertex or index data that has not been uploaded to the GPU yet.
+    bool HasPendingGPUResources() const { return m_StagingIndexData || m_StagingVertexData; }
 
     /// Returns the vertex buffer for the given primvar name (e.g. "points", "normals", etc.).
     /// If the buffer doesn't exist, returns nullptr.
@@ -125,6 +137,124 @@ public:
     ///             for the points drawing commands.
     Uint32 GetPointsStartIndex() const { return m_IndexData.PointsStartIndex; }
 
+    /// Simplified level of detail of the mesh faces.
+    struct LodInfo
+    {
+        /// The index of the first triangle of the level of detail in the face index data.
+        ///
+        /// \remarks    Level of detail triangles are stored in the face index buffer after
+        ///             the full-resolution triangles and reference the same vertices.
+        Uint32 StartTriangle = 0;
+
+        /// The number of triangles in the level of detail.
+        Uint32 NumTriangles = 0;
+
+        /// The maximum approximate distance from the full-resolution surface, in mesh units.
+        float Error = 0;
+    };
+
+    /// Returns the simplified levels of detail of the mesh faces, from finest to coarsest.
+    ///
+    /// \remarks    The full-resolution mesh is not included in the list.
+    ///             Levels of detail are generated during the sync when the MeshLodCount
+    ///             member of the render delegate create info is not zero.
+    const std::vector<LodInfo>& GetLods() const { return m_IndexData.Lods; }
+
+    /// Returns the bounding sphere of the mesh in the mesh space:
+    /// (x, y, z) is the center, w is the radius.
+    ///
+    /// \remarks    The bounding sphere is computed when the mesh points are synced.
+    const float4& GetBoundingSphere() const { return m_BoundingSphere; }
+
+    struct RayCastHit
+    {
+        /// Ray parameter of the hit point, i.e. Origin + Direction * T.
+        float T = 0;
+
+        /// The index of the hit face in the mesh topology.
+        Uint32 FaceIndex = ~0u;
+
+        /// Geometric normal of the hit triangle in the mesh space. Not normalized.
+        float3 Normal;
+    };
+
+    /// Finds the closest intersection of the ray with the mesh faces.
+    ///
+    /// \param [in]  Origin    - Ray origin in the mesh space.
+    /// \param [in]  Direction - Ray direction in the mesh space. Does not need to be normalized.
+    /// \param [in]  MaxT      - Maximum value of the ray parameter.
+    /// \param [out] Hit       - Intersection data.
+    ///
+    /// \return     true if the ray hits the mesh, and false otherwise.
+    ///
+    /// \remarks    The ray is tested against a triangle hierarchy built on the CPU from the positions
+    ///             and indices of the full-resolution mesh when it is synced. The hierarchy is only
+    ///             built when the EnableRayCastPicking member of the render delegate create info is true.
+    ///             The method must not be called while the mesh is being synced.
+    bool RayCast(const float3& Origin, const float3& Direction, float MaxT, RayCastHit& Hit) const;
+
+    /// Returns the total size of the mesh data in the index pool, in bytes.
+    Uint64 GetPooledIndexDataSize() const;
+
+    /// Returns the total size of the mesh data in the vertex pool, in bytes.
+    Uint64 GetPooledVertexDataSize() const;
+
+    /// Returns the start vertex of the mesh data in the vertex pool.
+    Uint32 GetPooledStartVertex() const;
+
+    /// Moves the mesh index data closer to the beginning of the index pool, if possible.
+    ///
+    /// \param [in] RenderDelegate - Render delegate.
+    /// \param [in] pScratchBuffer - Scratch buffer that is used to copy the data.
+    ///                              Must be large enough to hold any index allocation of this mesh.
+    /// \return     The number of bytes moved.
+    ///
+    /// \remarks    The data is moved with GPU copy commands. Start indices of the draw items
+    ///             are updated and the mesh geometry version is incremented if any data was moved.
+    Uint64 CompactIndexData(HnRenderDelegate& RenderDelegate, IBuffer* pScratchBuffer);
+
+    /// Requests the mesh vertex data to be moved to a new vertex pool allocation
+    /// when the mesh is synced next time.
+    ///
+    /// \remarks    Pooled indices include the start vertex, so the vertex data can't be
+    ///             moved with a GPU copy. The caller must mark the mesh topology and primvars
+    ///             dirty in the change tracker so that the data is reuploaded. The new allocation
+    ///             is only used if it is closer to the beginning of the pool than the current one.
+    void RequestVertexDataRelocation() { m_RelocateVertexData = true; }
+
+    /// Dirty bits that make the mesh pull all its geometry data from the scene delegate again.
+    static constexpr pxr::HdDirtyBits GeometryResyncDirtyBits =
+        pxr::HdChangeTracker::DirtyTopology |
+        pxr::HdChangeTracker::DirtyPoints |
+        pxr::HdChangeTracker::DirtyNormals |
+        pxr::HdChangeTracker::DirtyWidths |
+        pxr::HdChangeTracker::DirtyPrimvar;
+
+    /// Returns the total size of the GPU memory used by the mesh geometry, in bytes.
+    ///
+    /// \remarks    This includes both pooled and standalone vertex and index buffers.
+    Uint64 GetGPUGeometrySize() const;
+
+    /// Releases all GPU geometry resources of the mesh.
+    ///
+    /// \return     The number of bytes released.
+    ///
+    /// \remarks    The mesh remains evicted until its geometry is synced again.
+    ///             To restore the mesh, the caller must mark it dirty with
+    ///             GeometryResyncDirtyBits in the change tracker.
+    Uint64 EvictGPUResources();
+
+    /// Returns true if the mesh GPU resources have been evicted.
+    bool IsEvicted() const { return m_IsEvicted; }
+
+    /// Records the frame in which the mesh was last requested for rendering
+    /// by a render pass. The mesh is marked even if it is evicted.
+    void MarkVisible(Uint32 FrameNumber) const { m_LastVisibleFrame.store(FrameNumber); }
+
+    /// Returns the number of the frame in which the mesh was last
+    /// requested for rendering or its geometry was uploaded to the GPU.
+    Uint32 GetLastVisibleFrame() const { return m_LastVisibleFrame.load(); }
+
     struct Components
     {
         struct Transform
@@ -162,8 +292,8 @@ protected:
     // is used.
     virtual void _InitRepr(const pxr::TfToken& reprToken, pxr::HdDirtyBits* dirtyBits) override final;
 
-    void UpdateVertexBuffers(HnRenderDelegate& RenderDelegate);
-    void UpdateIndexBuffer(HnRenderDelegate& RenderDelegate);
+    void UpdateVertexBuffers(HnRenderDelegate& RenderDelegate, IDeviceContext* pCtx);
+    void UpdateIndexBuffer(HnRenderDelegate& RenderDelegate, IDeviceContext* pCtx);
     void AllocatePooledResources(pxr::HdSceneDelegate& SceneDelegate,
                                  pxr::HdRenderParam*   RenderParam);
 
@@ -201,6 +331,17 @@ private:
 
     void GenerateSmoothNormals();
 
+    // Replaces the float3 normals in the staging data with octahedral-encoded normals.
+    void CompressNormals();
+
+    // Rebuilds the ray casting triangle hierarchy from the staging data.
+    void UpdatePickingData();
+    void UpdateBoundingSphere();
+
+    // Generates simplified levels of detail of the mesh faces and appends
+    // their triangles to the staging face indices.
+    void GenerateLods(Uint32 LodCount);
+
     // Converts vertex primvar sources into face-varying primvar sources.
     void ConvertVertexPrimvarSources(FaceSourcesMapType&& FaceSources);
 
@@ -234,6 +375,7 @@ private:
         pxr::VtVec3iArray         TrianglesFaceIndices;
         std::vector<pxr::GfVec2i> MeshEdgeIndices;
         std::vector<Uint32>       PointIndices;
+        pxr::VtIntArray           PrimitiveParams;
     };
     std::unique_ptr<StagingIndexData> m_StagingIndexData;
 
@@ -252,6 +394,11 @@ private:
         Uint32 EdgeStartIndex   = 0;
         Uint32 PointsStartIndex = 0;
 
+        // The total number of triangles in all levels of detail
+        Uint32 NumLodTriangles = 0;
+
+        std::vector<LodInfo> Lods;
+
         RefCntAutoPtr<IBuffer> Faces;
         RefCntAutoPtr<IBuffer> Edges;
         RefCntAutoPtr<IBuffer> Points;
@@ -266,6 +413,9 @@ private:
     {
         RefCntAutoPtr<IVertexPoolAllocation> PoolAllocation;
 
+        // The total size of all vertex elements in the pool allocation
+        Uint32 PoolVertexSize = 0;
+
         // Buffer name to vertex pool element index (e.g. "normals" -> 0, "points" -> 1, etc.)
         std::unordered_map<pxr::TfToken, Uint32, pxr::TfToken::HashFunctor> NameToPoolIndex;
 
@@ -274,7 +424,16 @@ private:
     };
     VertexData m_VertexData;
 
-    bool m_IsDoubleSided = false;
+    struct PickingData;
+    std::unique_ptr<PickingData> m_PickingData;
+
+    float4 m_BoundingSphere;
+
+    bool m_IsDoubleSided      = false;
+    bool m_RelocateVertexData = false;
+    bool m_IsEvicted          = false;
+
+    mutable std::atomic<Uint32> m_LastVisibleFrame{0};
 
     std::atomic<Uint32> m_GeometryVersion{0};
     std::atomic<Uint32> m_MaterialVersion{0};
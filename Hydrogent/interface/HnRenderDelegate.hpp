@@ -31,12 +31,15 @@
 #include <unordered_set>
 #include <string>
 #include <atomic>
+#include <cfloat>
 #include <mutex>
+#include <vector>
 
 #include "pxr/imaging/hd/renderDelegate.h"
 
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
 #include "../../../DiligentCore/Graphics/GraphicsTools/interface/RenderStateCache.h"
+#include "../../../DiligentCore/Common/interface/ThreadPool.h"
 #include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
 #include "../../PBR/interface/USD_Renderer.hpp"
 
@@ -57,10 +60,12 @@ namespace USD
 {
 
 class HnMaterial;
+class HnMaterialNetwork;
 class HnMesh;
 class HnLight;
 class HnRenderParam;
 class HnShadowMapManager;
+class HnParallelCommandRecorder;
 
 /// Memory usage statistics of the render delegate.
 struct HnRenderDelegateMemoryStats
@@ -76,6 +81,12 @@ struct HnRenderDelegateMemoryStats
 
         /// The number of allcations.
         Uint32 AllocationCount = 0;
+
+        /// The fraction of the committed memory that is not used by any allocation.
+        float FragmentationRatio = 0;
+
+        /// The total number of bytes moved by the pool compaction.
+        Uint64 CompactionMovedBytes = 0;
     };
     /// Index pool usage statistics.
     IndexPoolUsage IndexPool;
@@ -94,6 +105,12 @@ struct HnRenderDelegateMemoryStats
 
         /// The number of vertices allocated from the pool.
         Uint64 AllocatedVertexCount = 0;
+
+        /// The fraction of the committed memory that is not used by any allocation.
+        float FragmentationRatio = 0;
+
+        /// The total number of bytes moved by the pool compaction.
+        Uint64 CompactionMovedBytes = 0;
     };
     /// Vertex pool usage statistics.
     VertexPoolUsage VertexPool;
@@ -114,6 +131,97 @@ struct HnRenderDelegateMemoryStats
         Uint64 AllocatedTexels = 0;
     };
     TextureAtlasUsage Atlas;
+
+    /// Geometry residency statistics.
+    struct GeometryResidency
+    {
+        /// The geometry memory budget, in bytes. Zero if the budget is not set.
+        Uint64 Budget = 0;
+
+        /// The total GPU memory size used by the resident mesh geometry, in bytes.
+        Uint64 ResidentSize = 0;
+
+        /// The number of meshes whose geometry is currently evicted.
+        Uint32 EvictedMeshCount = 0;
+
+        /// The total number of bytes evicted since the render delegate was created.
+        Uint64 TotalEvictedBytes = 0;
+    };
+    GeometryResidency Geometry;
+
+    /// Texture streaming statistics.
+    struct TextureStreamingUsage
+    {
+        /// The texture streaming memory budget, in bytes. Zero if the budget is not set.
+        Uint64 Budget = 0;
+
+        /// The total GPU memory size of the resident mip levels of the streamed textures, in bytes.
+        Uint64 ResidentSize = 0;
+
+        /// The total GPU memory size of the mip levels requested by the draw items, in bytes.
+        Uint64 RequestedSize = 0;
+
+        /// The number of streamed textures.
+        Uint32 TextureCount = 0;
+    };
+    TextureStreamingUsage TextureStreaming;
+
+    /// Texture cache statistics.
+    struct TextureCacheUsage
+    {
+        /// The number of textures that share the resources of another texture
+        /// with the same decoded contents, e.g. the same image referenced by different paths.
+        Uint32 ContentHits = 0;
+
+        /// The number of unique sampler objects.
+        Uint32 SamplerCount = 0;
+
+        /// The number of textures that reuse an existing sampler object.
+        Uint32 SamplerHits = 0;
+    };
+    TextureCacheUsage TextureCache;
+
+    /// Texture atlas defragmentation statistics.
+    struct TextureAtlasDefragmentation
+    {
+        /// The fraction of the atlas area used by the allocations at the start of the last repack pass.
+        float UtilizationBefore = 0;
+
+        /// The fraction of the atlas area used by the allocations at the end of the last completed repack pass.
+        float UtilizationAfter = 0;
+
+        /// The number of repack passes started.
+        Uint32 PassCount = 0;
+
+        /// The total number of atlas regions moved.
+        Uint32 MovedRegionCount = 0;
+
+        /// The total number of bytes copied.
+        Uint64 MovedBytes = 0;
+
+        /// Whether a repack pass is in progress.
+        bool InProgress = false;
+    };
+    TextureAtlasDefragmentation AtlasDefragmentation;
+};
+
+/// The result of the ray cast against the scene meshes.
+struct HnRayCastHit
+{
+    /// The path of the hit mesh prim.
+    pxr::SdfPath PrimId;
+
+    /// The index of the hit face in the mesh topology.
+    Uint32 FaceIndex = ~0u;
+
+    /// The hit point in world space.
+    float3 Position;
+
+    /// The geometric normal of the hit face in world space.
+    float3 Normal;
+
+    /// The distance from the ray origin to the hit point.
+    float Distance = 0;
 };
 
 /// USD render delegate implementation in Hydrogent.
@@ -177,10 +285,167 @@ public:
         Uint32 MaxLightCount = 16;
 
         /// The maximum number of shadow-casting lights that can be used by the render delegate.
+        ///
+        /// \remarks    Every shadow map of a light counts as a separate shadow-casting light:
+        ///             directional lights use one shadow map per cascade (see ShadowCascadeCount),
+        ///             spot lights use one shadow map, and point lights use six.
         Uint32 MaxShadowCastingLightCount = 8;
 
+        /// The initial number of shadow map cascades of directional lights, see SetShadowCascadeCount().
+        Uint32 ShadowCascadeCount = 1;
+
+        /// The initial cascade partitioning factor, see SetShadowCascadePartitioning().
+        float ShadowCascadePartitioning = 0.95f;
+
+        /// The initial cascade blend range, see SetShadowCascadeBlendRange().
+        float ShadowCascadeBlendRange = 0.1f;
+
         /// Meters per logical unit.
         float MetersPerUnit = 1.0f;
+
+        /// The fragmentation ratio of the vertex or index pool above which
+        /// the render delegate starts compacting the pool.
+        ///
+        /// \remarks    The fragmentation ratio is the fraction of the committed pool
+        ///             memory that is not used by any allocation.
+        ///             If zero, pool compaction is disabled.
+        float PoolCompactionThreshold = 0;
+
+        /// The maximum number of bytes moved by the pool compaction in one frame.
+        ///
+        /// \remarks    Index data is moved with GPU copy commands. Since pooled indices
+        ///             include the start vertex, vertex data is moved by re-syncing the mesh
+        ///             and uploading its data to the new allocation.
+        Uint64 PoolCompactionBudget = Uint64{4} << Uint64{20};
+
+        /// The fraction of the texture atlas area not used by any allocation above which
+        /// the render delegate repacks the atlas when a texture fails to be allocated in it.
+        ///
+        /// \remarks    Live atlas regions are re-allocated from the largest to the smallest
+        ///             and their data is copied with GPU copy commands over several frames.
+        ///             Materials that use the moved textures update their atlas UV scale and bias.
+        ///             If zero, atlas defragmentation is disabled.
+        ///             Ignored if TextureAtlasDim is zero.
+        float AtlasDefragmentationThreshold = 0;
+
+        /// The maximum number of bytes copied by the atlas defragmentation in one frame.
+        Uint64 AtlasDefragmentationBudget = Uint64{16} << Uint64{20};
+
+        /// An optional thread pool that is used to record resource upload
+        /// commands in parallel in CommitResources().
+        ///
+        /// \remarks    Parallel recording requires deferred contexts (see ppDeferredContexts)
+        ///             and the MultithreadedResourceCreation device feature.
+        IThreadPool* pThreadPool = nullptr;
+
+        /// An array of NumDeferredContexts deferred contexts that are used to record
+        /// resource upload commands when pThreadPool is not null.
+        ///
+        /// \remarks    Pending work is split into one chunk per deferred context.
+        ///             Command lists are executed on pContext in the chunk order.
+        IDeviceContext* const* ppDeferredContexts = nullptr;
+
+        /// The number of deferred contexts in ppDeferredContexts.
+        Uint32 NumDeferredContexts = 0;
+
+        /// Whether to load texture files asynchronously using pThreadPool.
+        ///
+        /// \remarks    Texture files are decoded by the thread pool workers, and the textures
+        ///             are uploaded in CommitResources() once they are loaded. Until then,
+        ///             materials use the default textures.
+        ///             Ignored if pThreadPool is null.
+        bool AsyncTextureLoading = false;
+
+        /// Whether to stream the mip levels of the standalone textures.
+        ///
+        /// \remarks    Streamed textures are initially created with the low-resolution mip levels only.
+        ///             Render passes request the texture resolution based on the projected size of the
+        ///             meshes that use the textures, and the render delegate raises or lowers the resident
+        ///             mip levels accordingly in CommitResources().
+        ///             Textures allocated in the atlas are always loaded with the full mip chain.
+        bool EnableTextureStreaming = false;
+
+        /// GPU memory budget for the streamed textures, in bytes. If zero, the budget is unlimited.
+        ///
+        /// \remarks    When raising the resolution of a texture would exceed the budget, the render
+        ///             delegate lowers the resolution of the least recently requested textures first.
+        Uint64 TextureStreamingBudget = 0;
+
+        /// Whether to compress the material textures into BC formats on the CPU when loading them.
+        ///
+        /// \remarks    Base color textures are compressed to BC3, or to BC1 if they are opaque,
+        ///             emissive textures to BC1, and metallic, roughness and occlusion textures to BC4.
+        ///             The peak signal-to-noise ratio of every compressed texture is logged.
+        ///             Compression is performed by the loading threads if AsyncTextureLoading is enabled.
+        ///             Compressed textures are not allocated in the texture atlas.
+        ///             Ignored if the device does not support BC texture compression.
+        bool CompressTextures = false;
+
+        /// Optional directory where the compressed textures are cached.
+        ///
+        /// \remarks    Compressed textures are stored as DDS files named after the hash of the source
+        ///             file contents and the load parameters, so that subsequent loads skip decoding
+        ///             and compression. The directory is created if it does not exist.
+        const char* CompressedTextureCacheDir = nullptr;
+
+        /// Whether to pack the single-channel material textures into one texture.
+        ///
+        /// \remarks    Roughness and metallic textures of each material are packed into the green and blue
+        ///             channels of one RGBA8 texture when they are loaded. The occlusion texture is packed into
+        ///             the red channel if it uses the same texture coordinates, transform and sampler.
+        ///             Textures with different resolutions are resampled to the largest one.
+        ///             This reduces the number of texture fetches and the memory used by the textures.
+        ///             The packed textures are not compressed, as block compression formats available
+        ///             for them would leak the error between the uncorrelated channels.
+        ///             The renderer then uses the physical descriptor map instead of separate metallic and
+        ///             roughness textures for all materials.
+        ///
+        ///             Limitation: roughness and metallic textures that use different texture coordinates,
+        ///             transforms or samplers can't be packed, and since separate textures are not available
+        ///             in this mode, such materials ignore both textures and use the constant factors.
+        bool PackMaterialTextures = false;
+
+        /// GPU memory budget for the mesh geometry, in bytes. If zero, the budget is unlimited.
+        ///
+        /// \remarks    When the total size of the resident geometry exceeds the budget,
+        ///             the render delegate evicts the geometry of the meshes that have not
+        ///             been requested by any render pass for the longest time.
+        ///             Evicted geometry is restored by pulling it from the scene delegate
+        ///             again when a render pass requests the mesh.
+        ///
+        ///             Evicting pooled geometry releases space in the pools for other
+        ///             allocations, but does not reduce the size of the pool buffers.
+        Uint64 GeometryMemoryBudget = 0;
+
+        /// The number of simplified levels of detail generated for each mesh.
+        /// Allowed values are 0 to 4. If zero, levels of detail are not generated.
+        ///
+        /// \remarks    Levels of detail are generated when the mesh is synced.
+        ///             Every level targets a quarter of the triangles of the previous one.
+        ///             Their indices are stored in the mesh face index buffer and reference
+        ///             the same vertices as the full-resolution mesh.
+        ///             Meshes with geometry subsets are always rendered at full resolution.
+        ///
+        ///             The level of detail is selected by the render pass based on the
+        ///             projected error, see SetMeshLodErrorThreshold().
+        Uint32 MeshLodCount = 0;
+
+        /// The initial value of the mesh level of detail error threshold, see SetMeshLodErrorThreshold().
+        float MeshLodErrorThreshold = 1;
+
+        /// Whether to enable CPU ray cast picking, see RayCast().
+        ///
+        /// \remarks    When enabled, every mesh keeps a copy of its positions and indices
+        ///             and builds a triangle hierarchy on the CPU when it is synced.
+        bool EnableRayCastPicking = false;
+
+        /// Whether to store vertex normals as two octahedral-encoded 16-bit components
+        /// instead of three 32-bit floats.
+        ///
+        /// \remarks    This reduces the normal data from 12 to 4 bytes per vertex.
+        ///             The normals are encoded on the CPU when the mesh is synced,
+        ///             see EncodeOctahedralNormalRG16(), and decoded in the vertex shader.
+        bool CompressVertexNormals = false;
     };
     static std::unique_ptr<HnRenderDelegate> Create(const CreateInfo& CI);
 
@@ -337,9 +602,75 @@ public:
     void SetSelectedRPrimId(const pxr::SdfPath& RPrimID);
     void SetUseShadows(bool UseShadows);
 
+    /// Sets the maximum screen-space error, in pixels, of the mesh level of detail.
+    ///
+    /// \remarks    The render pass selects the coarsest level of detail whose geometric error
+    ///             projected at the distance of the mesh bounding sphere does not exceed the threshold.
+    ///             If the threshold is zero, meshes are always rendered at full resolution.
+    void SetMeshLodErrorThreshold(float Threshold);
+
+    /// Sets the number of shadow map cascades of directional lights.
+    /// Allowed values are 1 to HnLight::MaxShadowCascades.
+    ///
+    /// \remarks    With a single cascade, the shadow map of a directional light covers the entire scene.
+    ///             With multiple cascades, the camera view frustum is split along the view direction,
+    ///             and every part is covered by a separate shadow map of the light's resolution
+    ///             that is allocated in the shadow map atlas. Cascades follow the camera and are
+    ///             re-rendered when it moves.
+    void SetShadowCascadeCount(Uint32 CascadeCount);
+
+    /// Sets the cascade partitioning factor that defines the ratio between fully
+    /// linear (0.0) and fully logarithmic (1.0) split of the camera depth range.
+    void SetShadowCascadePartitioning(float Partitioning);
+
+    /// Sets the fraction of the cascade depth range, between 0 and 1, over which
+    /// the cascade is blended with the next one.
+    void SetShadowCascadeBlendRange(float BlendRange);
+
+    /// Finds the closest intersection of the ray with the visible scene meshes on the CPU.
+    ///
+    /// \param [in]  Origin      - Ray origin in world space.
+    /// \param [in]  Direction   - Ray direction in world space. Does not need to be normalized.
+    /// \param [out] Hit         - Intersection data.
+    /// \param [in]  MaxDistance - Maximum distance from the ray origin to the hit point.
+    ///
+    /// \return     true if the ray hits a mesh, and false otherwise.
+    ///
+    /// \remarks    Unlike the HnReadRprimIdTask, the method does not require rendering and returns
+    ///             the result immediately, which makes it suitable for hover highlighting and snapping.
+    ///
+    ///             Ray cast picking must be enabled by the EnableRayCastPicking member of the
+    ///             create info, otherwise the method always returns false.
+    ///             Meshes are tested against their full-resolution geometry as it was last synced.
+    ///             The method must not be called while the render index is being synced.
+    bool RayCast(const float3& Origin, const float3& Direction, HnRayCastHit& Hit, float MaxDistance = FLT_MAX) const;
+
+    /// Computes the hash of the shadow casters of the light.
+    ///
+    /// \remarks    The hash combines the geometry and material versions and the transforms of all
+    ///             visible meshes whose bounding spheres intersect any of the light's shadow map
+    ///             frustums, see HnLight::IsShadowCasterInFrustum(). The light's shadow maps only need
+    ///             to be re-rendered when the hash changes.
+    size_t ComputeShadowCastersHash(const HnLight& Light) const;
+
     IObject* GetMaterialSRBCache() const { return m_MaterialSRBCache; }
 
+    /// Returns a synced material whose network is equal to Network, or null if there is none.
+    const HnMaterial* FindEquivalentMaterial(const HnMaterialNetwork& Network, size_t NetworkHash);
+
+    /// Registers the material network so that materials with equal networks can find it,
+    /// see FindEquivalentMaterial(). The material must have a non-zero network hash.
+    void RegisterMaterialNetwork(HnMaterial& Material);
+
+    /// Unregisters the material network. Called when the material is synced or destroyed.
+    void UnregisterMaterialNetwork(HnMaterial& Material);
+
+    void AddPoolCompactionMovedBytes(Uint64 IndexBytes, Uint64 VertexBytes);
+
 private:
+    void CompactPools(pxr::HdChangeTracker& Tracker);
+    void UpdateGeometryResidency(pxr::HdChangeTracker& Tracker);
+
     static const pxr::TfTokenVector SupportedRPrimTypes;
     static const pxr::TfTokenVector SupportedSPrimTypes;
     static const pxr::TfTokenVector SupportedBPrimTypes;
@@ -378,22 +709,81 @@ private:
     std::unique_ptr<HnRenderParam>      m_RenderParam;
     std::unique_ptr<HnShadowMapManager> m_ShadowMapManager;
 
+    std::unique_ptr<HnParallelCommandRecorder> m_CommandRecorder;
+
     std::atomic<Uint32>                      m_RPrimNextUID{1};
     mutable std::mutex                       m_RPrimUIDToSdfPathMtx;
     std::unordered_map<Uint32, pxr::SdfPath> m_RPrimUIDToSdfPath;
 
-    std::mutex                  m_MeshesMtx;
+    mutable std::mutex          m_MeshesMtx;
     std::unordered_set<HnMesh*> m_Meshes;
 
     std::mutex                      m_MaterialsMtx;
     std::unordered_set<HnMaterial*> m_Materials;
 
+    // Materials grouped by the network hash, protected by m_MaterialsMtx.
+    // Each hash maps to the classes of materials with equal networks. The first
+    // material of each class is its representative.
+    std::unordered_map<size_t, std::vector<std::vector<HnMaterial*>>> m_MaterialsByNetworkHash;
+
+    // Material counts reported by the last deduplication log message
+    size_t m_LoggedMaterialCount       = 0;
+    size_t m_LoggedUniqueMaterialCount = 0;
+
     std::mutex                   m_LightsMtx;
     std::unordered_set<HnLight*> m_Lights;
 
+    struct PoolCompactionState
+    {
+        const float  Threshold;
+        const Uint64 Budget;
+
+        // Meshes to process in the current compaction sweep.
+        // Protected by m_MeshesMtx.
+        std::vector<HnMesh*> Queue;
+
+        // Pool usage at the end of the last sweep. A new sweep is not started
+        // until the usage changes.
+        Uint64 IndexPoolUsedSize         = ~Uint64{0};
+        Uint32 IndexPoolAllocationCount  = ~0u;
+        Uint64 VertexPoolUsedSize        = ~Uint64{0};
+        Uint32 VertexPoolAllocationCount = ~0u;
+
+        bool CompactIndices  = false;
+        bool CompactVertices = false;
+
+        RefCntAutoPtr<IBuffer> ScratchBuffer;
+
+        std::atomic<Uint64> IndexMovedBytes{0};
+        std::atomic<Uint64> VertexMovedBytes{0};
+
+        PoolCompactionState(float _Threshold, Uint64 _Budget) :
+            Threshold{_Threshold},
+            Budget{_Budget}
+        {}
+    };
+    PoolCompactionState m_PoolCompaction;
+
+    struct GeometryResidencyState
+    {
+        const Uint64 Budget;
+
+        std::atomic<Uint64> ResidentSize{0};
+        std::atomic<Uint32> EvictedMeshCount{0};
+        std::atomic<Uint64> TotalEvictedBytes{0};
+
+        bool BudgetExceededWarningShown = false;
+
+        explicit GeometryResidencyState(Uint64 _Budget) :
+            Budget{_Budget}
+        {}
+    };
+    GeometryResidencyState m_GeometryResidency;
+
     Uint32 m_MeshResourcesVersion     = ~0u;
     Uint32 m_MaterialResourcesVersion = ~0u;
     Uint32 m_ShadowAtlasVersion       = ~0u;
+    Uint32 m_TextureStorageVersion    = 0;
 };
 
 } // namespace USD
@@ -90,7 +90,7 @@ public:
 
     using SupportedVertexInputsSetType = std::unordered_set<pxr::TfToken, pxr::TfToken::HashFunctor>;
     static SupportedVertexInputsSetType GetSupportedVertexInputs(const HnMaterial* Material);
-    static PBR_Renderer::PSO_FLAGS      GetMaterialPSOFlags(const HnMaterial& Material);
+    static PBR_Renderer::PSO_FLAGS      GetMaterialPSOFlags(const HnMaterial& Material, const PBR_Renderer::CreateInfo& RendererSettings);
 
     enum DRAW_LIST_ITEM_DIRTY_FLAGS : Uint32
     {
@@ -103,6 +103,9 @@ public:
 
     void Execute(HnRenderPassState& RPState, const pxr::TfTokenVector& Tags);
 
+    /// Returns the number of draw list items rendered by the last call to Execute().
+    Uint32 GetNumRenderedItems() const { return m_NumRenderedItems; }
+
 protected:
     // Virtual API: Execute the buckets corresponding to renderTags;
     // renderTags.empty() implies execute everything.
@@ -139,6 +142,9 @@ private:
         Uint32 NumVertices = 0;
         Uint32 StartIndex  = 0;
 
+        // Mesh level of detail used to render the item, 0 is the full-resolution mesh.
+        Uint32 Lod = 0;
+
         PBR_Renderer::PSO_FLAGS PSOFlags = PBR_Renderer::PSO_FLAG_NONE;
 
         float4x4 PrevTransform = float4x4::Identity();
@@ -179,6 +185,8 @@ private:
     PBR_Renderer::DebugViewType m_DebugView  = PBR_Renderer::DebugViewType::None;
     bool                        m_UseShadows = false;
 
+    Uint32 m_NumRenderedItems = 0;
+
     // All draw items in the collection returned by pRenderIndex->GetDrawItems().
     pxr::HdRenderIndex::HdDrawItemPtrVector m_DrawItems;
 
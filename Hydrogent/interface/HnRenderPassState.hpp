@@ -44,6 +44,8 @@
 namespace Diligent
 {
 
+struct ViewFrustum;
+
 namespace USD
 {
 
@@ -79,6 +81,19 @@ public:
         return m_FrameAttribsSRB;
     }
 
+    /// Sets the frustum that is used to cull shadow casters, or null to disable culling.
+    ///
+    /// \remarks    The frustum is not copied and must remain valid until the render pass is executed.
+    ///             Meshes are tested with HnLight::IsShadowCasterInFrustum().
+    void SetShadowCasterCullingFrustum(const ViewFrustum* pFrustum)
+    {
+        m_ShadowCasterCullingFrustum = pFrustum;
+    }
+    const ViewFrustum* GetShadowCasterCullingFrustum() const
+    {
+        return m_ShadowCasterCullingFrustum;
+    }
+
     void SetFrontFaceCCW(bool FrontFaceCCW)
     {
         m_FrontFaceCCW = FrontFaceCCW;
@@ -115,6 +130,12 @@ public:
         return m_ClearDepth;
     }
 
+    /// Returns the height of the render targets set by the last call to Begin().
+    Uint32 GetFramebufferHeight() const
+    {
+        return m_FramebufferHeight;
+    }
+
     static constexpr Uint32 ClearDepthBit = 1u << 31u;
 
     void Begin(Uint32        NumRenderTargets,
@@ -131,6 +152,8 @@ private:
 
     IShaderResourceBinding* m_FrameAttribsSRB = nullptr;
 
+    const ViewFrustum* m_ShadowCasterCullingFrustum = nullptr;
+
     std::array<ITextureView*, MAX_RENDER_TARGETS> m_RTVs        = {};
     ITextureView*                                 m_DSV         = nullptr;
     std::array<float4, MAX_RENDER_TARGETS>        m_ClearColors = {};
@@ -138,6 +161,8 @@ private:
     Uint32                                        m_ClearMask   = 0;
     bool                                          m_IsCommited  = false;
 
+    Uint32 m_FramebufferHeight = 0;
+
     bool m_FrontFaceCCW = false;
 };
 
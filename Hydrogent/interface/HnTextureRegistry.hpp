@@ -26,10 +26,14 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <atomic>
+#include <vector>
+#include <functional>
+#include <string>
 
 #include "pxr/pxr.h"
 #include "pxr/base/tf/token.h"
@@ -39,6 +43,7 @@
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
 #include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
 #include "../../../DiligentCore/Common/interface/ObjectsRegistry.hpp"
+#include "../../../DiligentCore/Common/interface/ThreadPool.h"
 #include "../../../DiligentTools/TextureLoader/interface/TextureLoader.h"
 
 namespace Diligent
@@ -55,15 +60,48 @@ namespace USD
 {
 
 struct HnTextureIdentifier;
+class HnParallelCommandRecorder;
 
 class HnTextureRegistry final
 {
 public:
+    /// \param [in] pDevice          - Render device.
+    /// \param [in] pResourceManager - Optional resource manager. If not null, textures are
+    ///                                allocated in the texture atlas when possible.
+    /// \param [in] pLoadingPool     - Optional thread pool. If not null, texture files are
+    ///                                loaded asynchronously by the thread pool workers.
+    /// \param [in] EnableStreaming  - Whether to stream the mip levels of standalone textures,
+    ///                                see UpdateStreaming().
+    /// \param [in] StreamingBudget  - GPU memory budget for the streamed textures, in bytes.
+    ///                                If zero, the budget is unlimited.
+    /// \param [in] CompressTextures - Whether to compress the textures into BC formats on the CPU
+    ///                                when loading them, see Allocate(). Ignored if the device does not
+    ///                                support BC texture compression.
+    /// \param [in] CompressionCacheDir - Optional directory where the compressed textures are cached.
+    /// \param [in] AtlasDefragThreshold - The fraction of the atlas area not used by any allocation
+    ///                                    above which the atlas is repacked, see UpdateAtlasDefragmentation().
+    ///                                    If zero, atlas defragmentation is disabled.
+    /// \param [in] AtlasDefragBudget    - The maximum number of bytes copied by the atlas defragmentation in one update.
     HnTextureRegistry(IRenderDevice*         pDevice,
-                      GLTF::ResourceManager* pResourceManager);
+                      GLTF::ResourceManager* pResourceManager,
+                      IThreadPool*           pLoadingPool         = nullptr,
+                      bool                   EnableStreaming      = false,
+                      Uint64                 StreamingBudget      = 0,
+                      bool                   CompressTextures     = false,
+                      const std::string&     CompressionCacheDir  = {},
+                      float                  AtlasDefragThreshold = 0,
+                      Uint64                 AtlasDefragBudget    = 0);
     ~HnTextureRegistry();
 
-    void Commit(IDeviceContext* pContext);
+    /// Finishes initialization of the pending textures.
+    ///
+    /// \param [in] pContext  - Immediate device context.
+    /// \param [in] pRecorder - Optional parallel command recorder. If not null and enabled,
+    ///                         texture upload commands are recorded in parallel into deferred contexts.
+    ///
+    /// \remarks    Textures that have been loaded asynchronously since the last call
+    ///             are uploaded and published in their handles by this method.
+    void Commit(IDeviceContext* pContext, HnParallelCommandRecorder* pRecorder = nullptr);
 
     struct TextureHandle
     {
@@ -74,6 +112,20 @@ public:
 
         Uint32 TextureId = ~0u;
 
+        // Whether the texture is being loaded asynchronously.
+        // While the flag is set, the handle has no resources and the
+        // default texture should be used instead.
+        // The flag is reset by the Commit() method.
+        bool IsLoading = false;
+
+        // The version that is incremented every time the texture resources
+        // are replaced after the handle has been allocated.
+        Uint32 Version = 0;
+
+        // The maximum texture resolution, in texels, requested by the draw items that use
+        // the texture since the last streaming update, see UpdateStreaming().
+        std::atomic<Uint32> RequestedResolution{0};
+
         explicit operator bool() const noexcept
         {
             return pTexture != nullptr || pAtlasSuballocation != nullptr;
@@ -82,16 +134,34 @@ public:
 
     using TextureHandleSharedPtr = std::shared_ptr<TextureHandle>;
 
+    // Allocates texture handle for the specified texture identifier.
+    // If texture compression is enabled and CompressedFormat is not TEX_FORMAT_UNKNOWN,
+    // the texture data is loaded in the Format and compressed into the CompressedFormat.
+    // Compressed textures are never allocated in the atlas.
     TextureHandleSharedPtr Allocate(const HnTextureIdentifier&      TexId,
                                     TEXTURE_FORMAT                  Format,
-                                    const pxr::HdSamplerParameters& SamplerParams);
+                                    const pxr::HdSamplerParameters& SamplerParams,
+                                    TEXTURE_FORMAT                  CompressedFormat = TEX_FORMAT_UNKNOWN);
+
+    // Allocates texture handle for the RGBA8 texture that packs the first components of up to
+    // four single-channel textures into the R, G, B and A channels, see CreatePackedTextureLoader().
+    // Channels with null identifiers are filled with 255.
+    // If texture compression is enabled, the packed texture is compressed into the CompressedFormat.
+    TextureHandleSharedPtr AllocatePacked(const std::array<const HnTextureIdentifier*, 4>& Channels,
+                                          const pxr::HdSamplerParameters&                  SamplerParams,
+                                          TEXTURE_FORMAT                                   CompressedFormat = TEX_FORMAT_UNKNOWN);
 
     // Allocates texture handle for the specified texture file path.
     // If the texture is not loaded, calls CreateLoader() to create the texture loader.
+    // If AsyncLoad is true and asynchronous loading is enabled, CreateLoader() is called by
+    // a thread pool worker, and the returned handle remains in the loading state until the
+    // texture is committed. In this case, CreateLoader() must not reference the caller's stack.
+    // Requests for a texture that is being loaded return the same handle.
     TextureHandleSharedPtr Allocate(const pxr::TfToken&                            FilePath,
                                     const TextureComponentMapping&                 Swizzle,
                                     const pxr::HdSamplerParameters&                SamplerParams,
-                                    std::function<RefCntAutoPtr<ITextureLoader>()> CreateLoader);
+                                    std::function<RefCntAutoPtr<ITextureLoader>()> CreateLoader,
+                                    bool                                           AsyncLoad = false);
 
     TextureHandleSharedPtr Get(const pxr::TfToken& Path)
     {
@@ -100,6 +170,96 @@ public:
 
     Uint32 GetAtlasVersion() const;
 
+    /// Returns the version that is incremented every time the resources of any texture
+    /// handle are replaced, e.g. when asynchronously loaded textures are published by
+    /// the Commit() method or when resident mip levels are changed by UpdateStreaming().
+    Uint32 GetStorageVersion() const { return m_StorageVersion; }
+
+    /// Returns true if texture mip level streaming is enabled.
+    bool IsStreamingEnabled() const { return m_Streaming.Enabled; }
+
+    /// Updates the resident mip levels of the streamed textures.
+    ///
+    /// \param [in] pContext    - Immediate device context.
+    /// \param [in] FrameNumber - The number of the last rendered frame.
+    ///
+    /// \remarks    Streamed textures are initially created with the low-resolution mip levels only.
+    ///             The method raises the resident resolution of every texture to the maximum resolution
+    ///             requested by the draw items through the TextureHandle::RequestedResolution since the
+    ///             last update. If the budget does not allow this, it first lowers the resolution of the
+    ///             least recently requested textures to the requested one, or to the lowest one for the
+    ///             textures that were not requested.
+    ///
+    ///             Streaming applies to standalone 2D textures only. The texture loader is retained to
+    ///             re-create the texture with a different number of mip levels, so the full texture data
+    ///             is kept in the system memory.
+    void UpdateStreaming(IDeviceContext* pContext, Uint32 FrameNumber);
+
+    struct StreamingStats
+    {
+        Uint64 Budget        = 0;
+        Uint64 ResidentSize  = 0;
+        Uint64 RequestedSize = 0;
+        Uint32 TextureCount  = 0;
+    };
+    StreamingStats GetStreamingStats() const;
+
+    /// Incrementally repacks the texture atlas.
+    ///
+    /// \param [in] pContext - Immediate device context.
+    ///
+    /// \remarks    A repack pass starts when a texture that fits into the atlas fails to be allocated
+    ///             in it and the fraction of the atlas area not used by any allocation exceeds the threshold.
+    ///             The pass re-allocates the live atlas regions from the smallest to the largest. Small regions
+    ///             fill the holes between other regions, and the space they release merges into larger free
+    ///             blocks that the larger regions are moved to later in the pass.
+    ///             The texture data is copied to the new regions with GPU copy commands, and at most the budget
+    ///             is copied per update, so the pass may take several frames. Each moved texture handle gets
+    ///             the new atlas region and a new version, so the materials update their UV scale and bias.
+    void UpdateAtlasDefragmentation(IDeviceContext* pContext);
+
+    struct AtlasDefragStats
+    {
+        /// Atlas utilization, i.e. the fraction of the atlas area used by the allocations,
+        /// at the start of the last repack pass.
+        float UtilizationBefore = 0;
+
+        /// Atlas utilization at the end of the last completed repack pass.
+        float UtilizationAfter = 0;
+
+        /// The number of repack passes started.
+        Uint32 PassCount = 0;
+
+        /// The total number of atlas regions moved by all passes.
+        Uint32 MovedRegionCount = 0;
+
+        /// The total number of bytes copied by all passes.
+        Uint64 MovedBytes = 0;
+
+        /// Whether a repack pass is in progress.
+        bool InProgress = false;
+    };
+    AtlasDefragStats GetAtlasDefragStats() const;
+
+    struct CacheStats
+    {
+        /// The number of textures that share the resources of another texture with the same contents.
+        Uint32 ContentHits = 0;
+
+        /// The number of unique sampler objects.
+        Uint32 SamplerCount = 0;
+
+        /// The number of sampler requests that returned an existing sampler object.
+        Uint32 SamplerHits = 0;
+    };
+    CacheStats GetCacheStats() const;
+
+    /// Returns true if textures are compressed on the CPU when loading.
+    bool IsCompressionEnabled() const { return m_CompressTextures; }
+
+    /// Returns the number of textures that are being loaded asynchronously.
+    Uint32 GetNumLoadingTextures() const { return m_NumLoadingTextures.load(); }
+
     template <typename HandlerType>
     void ProcessTextures(HandlerType&& Handler)
     {
@@ -111,13 +271,32 @@ private:
                           IDeviceContext*    pContext,
                           ITextureLoader*    pLoader,
                           const SamplerDesc& SamDesc,
-                          TextureHandle&     Handle);
+                          TextureHandle&     Handle,
+                          Uint32             FirstMip = 0);
+
+    Uint32 GetStreamingMaxFirstMip(ITextureLoader* pLoader) const;
+
+    RefCntAutoPtr<ISampler> GetSampler(const SamplerDesc& SamDesc);
+
+    bool MoveAtlasRegion(IDeviceContext* pContext, const ITextureAtlasSuballocation* pRegion, Uint64& MovedBytes);
+
+    void AddPendingTexture(const pxr::TfToken&           Key,
+                           const pxr::TfToken&           FilePath,
+                           RefCntAutoPtr<ITextureLoader> pLoader,
+                           const SamplerDesc&            SamDesc,
+                           TextureHandleSharedPtr        Handle,
+                           TextureHandleSharedPtr        TargetHandle);
 
 private:
     RefCntAutoPtr<IRenderDevice> m_pDevice;
 
     GLTF::ResourceManager* const m_pResourceManager;
 
+    RefCntAutoPtr<IThreadPool> m_pLoadingPool;
+
+    const bool        m_CompressTextures;
+    const std::string m_CompressionCacheDir;
+
     ObjectsRegistry<pxr::TfToken, TextureHandleSharedPtr, pxr::TfToken::HashFunctor> m_Cache;
 
     struct PendingTextureInfo
@@ -125,12 +304,121 @@ private:
         RefCntAutoPtr<ITextureLoader> pLoader;
         SamplerDesc                   SamDesc;
         TextureHandleSharedPtr        Handle;
+
+        // For asynchronously loaded textures, the handle that is published
+        // by the Commit() method once the Handle is initialized.
+        TextureHandleSharedPtr TargetHandle;
+
+        // If true, the Handle is the public handle of another texture with the same contents,
+        // and the Commit() method shares its resources with the TargetHandle.
+        bool IsAlias = false;
+
+        // For streamed textures, the most detailed mip level of the source
+        // data that the texture is created with.
+        Uint32 FirstMip   = 0;
+        bool   IsStreamed = false;
     };
 
     std::mutex                                                                      m_PendingTexturesMtx;
     std::unordered_map<pxr::TfToken, PendingTextureInfo, pxr::TfToken::HashFunctor> m_PendingTextures;
 
+    // Asynchronous loading tasks. Protected by m_PendingTexturesMtx.
+    std::vector<RefCntAutoPtr<IAsyncTask>> m_LoadingTasks;
+
+    // The loader is used to compare the data on a hash match, so textures are only
+    // deduplicated while the source data of the first texture is alive.
+    struct ContentCacheEntry
+    {
+        std::weak_ptr<TextureHandle>  Handle;
+        RefCntWeakPtr<ITextureLoader> pLoader;
+    };
+    // Content hash of the decoded texture data to the public handle of the texture.
+    // Protected by m_PendingTexturesMtx.
+    std::unordered_map<size_t, ContentCacheEntry> m_ContentCache;
+    std::atomic<Uint32>                           m_ContentHits{0};
+
+    struct SamplerDescHasher
+    {
+        size_t operator()(const SamplerDesc& Desc) const;
+    };
+    mutable std::mutex                                                           m_SamplersMtx;
+    std::unordered_map<SamplerDesc, RefCntAutoPtr<ISampler>, SamplerDescHasher> m_Samplers;
+    std::atomic<Uint32>                                                          m_SamplerHits{0};
+
     std::atomic<Uint32> m_NextTextureId{0};
+    std::atomic<Uint32> m_NumLoadingTextures{0};
+    Uint32              m_StorageVersion = 0;
+
+    struct StreamingTextureInfo
+    {
+        // The handle of the texture followed by the handles of the
+        // textures with the same contents that share its resources.
+        std::vector<std::weak_ptr<TextureHandle>> Handles;
+
+        RefCntAutoPtr<ITextureLoader> pLoader;
+        SamplerDesc                   SamDesc;
+
+        // The most detailed resident mip level
+        Uint32 FirstMip = 0;
+
+        // The least detailed mip level that the texture is allowed to be reduced to
+        Uint32 MaxFirstMip = 0;
+
+        // The most detailed mip level requested by the draw items
+        Uint32 RequestedFirstMip = 0;
+
+        Uint32 LastRequestedFrame = 0;
+
+        Uint64 GetSize(Uint32 Mip) const;
+    };
+
+    struct StreamingState
+    {
+        const bool   Enabled;
+        const Uint64 Budget;
+
+        // Accessed by the render thread only
+        std::vector<StreamingTextureInfo> Textures;
+
+        std::atomic<Uint64> ResidentSize{0};
+        std::atomic<Uint64> RequestedSize{0};
+        std::atomic<Uint32> TextureCount{0};
+
+        StreamingState(bool _Enabled, Uint64 _Budget) :
+            Enabled{_Enabled},
+            Budget{_Budget}
+        {}
+    };
+    StreamingState m_Streaming;
+
+    struct AtlasDefragState
+    {
+        const float  Threshold;
+        const Uint64 Budget;
+
+        // Accessed by the render thread only
+        std::vector<std::weak_ptr<TextureHandle>> Textures;
+
+        // Regions to move in the current pass, processed from the back, i.e. from the smallest to the largest.
+        // The references keep the regions alive, so a region can't be released and its address reused
+        // by another allocation while the pass is in progress.
+        std::vector<RefCntAutoPtr<ITextureAtlasSuballocation>> Queue;
+
+        std::atomic<Uint32> AllocationFailures{0};
+
+        std::atomic<float>  UtilizationBefore{0};
+        std::atomic<float>  UtilizationAfter{0};
+        std::atomic<Uint32> PassCount{0};
+        std::atomic<Uint32> MovedRegionCount{0};
+        std::atomic<Uint64> MovedBytes{0};
+        std::atomic<bool>   InProgress{false};
+
+        AtlasDefragState(float _Threshold, Uint64 _Budget) :
+            Threshold{_Threshold},
+            Budget{_Budget}
+        {}
+    };
+    AtlasDefragState m_AtlasDefrag;
 };
 
 } // namespace USD
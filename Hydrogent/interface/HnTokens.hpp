@@ -72,6 +72,7 @@ namespace USD
     (emissiveColor)            \
     (clearcoat)                \
     (clearcoatRoughness)       \
+    (occlusionRoughnessMetallic) \
     (renderPassParams) 	       \
 	(renderPassName)
 
@@ -48,6 +48,7 @@ namespace USD
 {
 
 class HnCamera;
+class HnLight;
 
 struct HnBeginFrameTaskParams
 {
@@ -215,6 +216,9 @@ private:
 
     std::vector<Uint8> m_FrameAttribsData;
 
+    // Local shadow-casting lights sorted by importance, reused every frame
+    std::vector<std::pair<float, HnLight*>> m_ShadowLightsByImportance;
+
     Uint32 m_FrameBufferWidth  = 0;
     Uint32 m_FrameBufferHeight = 0;
 
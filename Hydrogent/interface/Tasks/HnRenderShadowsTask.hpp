@@ -90,7 +90,9 @@ struct HnRenderShadowsTaskParams
     }
 };
 
-/// Renders shadow maps for shadow-casting lights
+/// Renders shadow maps for shadow-casting lights.
+/// Shadow maps are cached and only re-rendered when the light
+/// or the shadow casters within its frustums change.
 class HnRenderShadowsTask final : public HnTask
 {
 public:
@@ -125,7 +127,13 @@ private:
     // Combined geometry version (transform, visibility, etc.) last time we rendered shadows
     Uint32 m_LastGeometryVersion = ~0u;
 
-    std::multimap<Uint32, HnLight*> m_LightsByShadowSlice;
+    struct ShadowMapRenderItem
+    {
+        HnLight* Light        = nullptr;
+        Uint32   ShadowMapIdx = 0;
+    };
+    // Dirty shadow maps of all lights sorted by the atlas slice
+    std::multimap<Uint32, ShadowMapRenderItem> m_LightsByShadowSlice;
 };
 
 } // namespace USD
@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "HnGeometryResidency.hpp"
+
+#include <algorithm>
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+std::vector<size_t> SelectGeometryToEvict(const std::vector<HnGeometryResidencyItem>& Items,
+                                          Uint64                                      ResidentSize,
+                                          Uint32                                      LastFrame,
+                                          Uint64                                      Budget)
+{
+    std::vector<size_t> Evicted;
+    if (ResidentSize <= Budget)
+        return Evicted;
+
+    std::vector<size_t> Candidates;
+    Candidates.reserve(Items.size());
+    for (size_t i = 0; i < Items.size(); ++i)
+    {
+        // Meshes committed in the current frame are stamped with a frame number after the
+        // last one and must not be evicted before they are rendered.
+        if (Items[i].LastVisibleFrame < LastFrame && Items[i].Size > 0)
+            Candidates.push_back(i);
+    }
+
+    // Evict least recently visible meshes first
+    std::stable_sort(Candidates.begin(), Candidates.end(), [&Items](size_t lhs, size_t rhs) {
+        return Items[lhs].LastVisibleFrame < Items[rhs].LastVisibleFrame;
+    });
+
+    for (size_t Idx : Candidates)
+    {
+        if (ResidentSize <= Budget)
+            break;
+
+        Evicted.push_back(Idx);
+        ResidentSize -= std::min(ResidentSize, Items[Idx].Size);
+    }
+
+    return Evicted;
+}
+
+} // namespace USD
+
+} // namespace Diligent
@@ -28,9 +28,13 @@
 #include "HnRenderParam.hpp"
 #include "HnRenderDelegate.hpp"
 #include "HnShadowMapManager.hpp"
+#include "HnCamera.hpp"
 #include "HnTokens.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cfloat>
+#include <cmath>
 
 #include "pxr/imaging/hd/sceneDelegate.h"
 
@@ -301,6 +305,21 @@ static float GetShapingConeAngle(pxr::HdSceneDelegate& SceneDelegate, const pxr:
     return ShapingConeAngle;
 }
 
+// Returns the radius of the volume enclosed by the light emitter in scene units,
+// or 0 if the emitter does not enclose a volume.
+static float GetLightEmitterRadius(pxr::HdSceneDelegate& SceneDelegate, const pxr::SdfPath& Id, const pxr::TfToken LightType)
+{
+    if (LightType == pxr::HdPrimTypeTokens->sphereLight ||
+        LightType == pxr::HdPrimTypeTokens->cylinderLight)
+    {
+        pxr::VtValue RadiusVal = SceneDelegate.GetLightParamValue(Id, pxr::HdLightTokens->radius);
+        if (RadiusVal.IsHolding<float>())
+            return std::max(RadiusVal.Get<float>(), 0.f);
+    }
+
+    return 0;
+}
+
 
 bool HnLight::ApproximateAreaLight(pxr::HdSceneDelegate& SceneDelegate, float MetersPerUnit)
 {
@@ -353,18 +372,15 @@ bool HnLight::ApproximateAreaLight(pxr::HdSceneDelegate& SceneDelegate, float Me
     return ParamsDirty;
 }
 
-void HnLight::ComputeDirectLightProjMatrix(pxr::HdSceneDelegate& SceneDelegate)
+void HnLight::ComputeSceneBounds(pxr::HdSceneDelegate& SceneDelegate, BoundBox* pLightSpaceBounds)
 {
-    pxr::HdRenderIndex& RenderIndex = SceneDelegate.GetRenderIndex();
-
-    BoundBox LightSpaceBounds{BoundBox::Invalid()};
     if (!m_SceneBounds.IsValid())
     {
         // First time compute accurate scene bounds in light space by projecting
         // each primitive's bounding box into light space.
         // Also, compute the scnene bounds in world space.
 
-        const pxr::SdfPathVector& RPrimIds = RenderIndex.GetRprimIds();
+        const pxr::SdfPathVector& RPrimIds = SceneDelegate.GetRenderIndex().GetRprimIds();
         for (const pxr::SdfPath& RPrimId : RPrimIds)
         {
             if (RPrimId.IsEmpty())
@@ -383,22 +399,33 @@ void HnLight::ComputeDirectLightProjMatrix(pxr::HdSceneDelegate& SceneDelegate)
                 Corner        = Corner * PrimTransform;
                 m_SceneBounds = m_SceneBounds.Enclose(Corner);
 
-                Corner           = Corner * m_ViewMatrix;
-                LightSpaceBounds = LightSpaceBounds.Enclose(Corner);
+                if (pLightSpaceBounds != nullptr)
+                {
+                    Corner             = Corner * m_ViewMatrix;
+                    *pLightSpaceBounds = pLightSpaceBounds->Enclose(Corner);
+                }
             }
         }
     }
-    else
+    else if (pLightSpaceBounds != nullptr)
     {
         // Use precomputed scene bounds in world space. This is less accurate, but
         // much faster.
         for (Uint32 i = 0; i < 8; ++i)
         {
-            float4 Corner    = {m_SceneBounds.GetCorner(i), 1.0};
-            Corner           = Corner * m_ViewMatrix;
-            LightSpaceBounds = LightSpaceBounds.Enclose(Corner);
+            float4 Corner      = {m_SceneBounds.GetCorner(i), 1.0};
+            Corner             = Corner * m_ViewMatrix;
+            *pLightSpaceBounds = pLightSpaceBounds->Enclose(Corner);
         }
     }
+}
+
+void HnLight::ComputeDirectLightProjMatrix(pxr::HdSceneDelegate& SceneDelegate)
+{
+    pxr::HdRenderIndex& RenderIndex = SceneDelegate.GetRenderIndex();
+
+    BoundBox LightSpaceBounds{BoundBox::Invalid()};
+    ComputeSceneBounds(SceneDelegate, &LightSpaceBounds);
 
     IRenderDevice*          pDevice    = static_cast<const HnRenderDelegate*>(RenderIndex.GetRenderDelegate())->GetDevice();
     const RenderDeviceInfo& DeviceInfo = pDevice->GetDeviceInfo();
@@ -409,6 +436,85 @@ void HnLight::ComputeDirectLightProjMatrix(pxr::HdSceneDelegate& SceneDelegate)
                                             DeviceInfo.NDC.MinZ == -1);
 }
 
+void HnLight::ComputeLocalLightShadowMatrices(bool IsGL)
+{
+    VERIFY_EXPR(m_Params.Type == GLTF::Light::TYPE::SPOT || m_Params.Type == GLTF::Light::TYPE::POINT);
+    VERIFY_EXPR(m_SceneBounds.IsValid());
+
+    // Shadow maps cover the scene up to its farthest corner
+    float FarZ = 0;
+    for (Uint32 i = 0; i < 8; ++i)
+    {
+        FarZ = std::max(FarZ, length(m_SceneBounds.GetCorner(i) - m_Position));
+    }
+    // The near plane does not depend on the scene size, so that casters close to the light
+    // are not clipped in large scenes (depth clamp is disabled in the shadow pass).
+    FarZ              = std::max(FarZ, m_ShadowNearZ * 2.f);
+    const float NearZ = m_ShadowNearZ;
+
+    const float4x4 LightTranslation = float4x4::Translation(-m_Position);
+    if (m_NumShadowMaps == 1)
+    {
+        // Spot light with a perspective shadow map that covers the outer cone
+        VERIFY_EXPR(m_Params.Type == GLTF::Light::TYPE::SPOT);
+
+        float3 LightSpaceX, LightSpaceY, LightSpaceZ;
+        BasisFromDirection(m_Direction, true, LightSpaceX, LightSpaceY, LightSpaceZ);
+
+        m_ShadowMaps[0].ViewMatrix = LightTranslation * float4x4::ViewFromBasis(LightSpaceX, LightSpaceY, LightSpaceZ);
+        m_ShadowMaps[0].ProjMatrix = float4x4::Projection(2.f * m_Params.OuterConeAngle, 1.f, NearZ, FarZ, IsGL);
+    }
+    else
+    {
+        // Every face of the cube around the light uses a separate perspective shadow map.
+        VERIFY_EXPR(m_NumShadowMaps == 6);
+
+        // Extend the face frustums slightly so that the PCF kernel does not sample outside of the
+        // face's atlas region at the face edges.
+        constexpr float PCFMargin  = 4;
+        const float     Resolution = static_cast<float>(m_ShadowMaps[0].Suballocation->GetSize().x);
+        const float     FaceFOV    = 2.f * std::atan(Resolution / std::max(Resolution - 2.f * PCFMargin, 1.f));
+
+        // Face order must match GetLightShadowing() in RenderPBR.psh
+        static const float3 FaceDirections[] = {
+            float3{+1, 0, 0},
+            float3{-1, 0, 0},
+            float3{0, +1, 0},
+            float3{0, -1, 0},
+            float3{0, 0, +1},
+            float3{0, 0, -1},
+        };
+        static_assert(_countof(FaceDirections) == MaxShadowMaps, "Unexpected number of cube faces");
+
+        // Face bases must be aligned with the world axes, so they can't be built by BasisFromDirection,
+        // but they must have the same handedness to keep the triangle winding.
+        float3 RefX, RefY, RefZ;
+        BasisFromDirection(float3{0, 0, 1}, true, RefX, RefY, RefZ);
+        const bool RefRightHanded = dot(cross(RefX, RefY), RefZ) > 0;
+
+        for (Uint32 Face = 0; Face < 6; ++Face)
+        {
+            const float3 LightSpaceZ = FaceDirections[Face];
+            const float3 Up          = std::abs(LightSpaceZ.y) > 0.5f ? float3{0, 0, 1} : float3{0, 1, 0};
+            float3       LightSpaceX = normalize(cross(Up, LightSpaceZ));
+            const float3 LightSpaceY = cross(LightSpaceZ, LightSpaceX);
+            if ((dot(cross(LightSpaceX, LightSpaceY), LightSpaceZ) > 0) != RefRightHanded)
+                LightSpaceX = -LightSpaceX;
+
+            m_ShadowMaps[Face].ViewMatrix = LightTranslation * float4x4::ViewFromBasis(LightSpaceX, LightSpaceY, LightSpaceZ);
+            m_ShadowMaps[Face].ProjMatrix = float4x4::Projection(FaceFOV, 1.f, NearZ, FarZ, IsGL);
+        }
+    }
+
+    for (Uint32 i = 0; i < m_NumShadowMaps; ++i)
+    {
+        ShadowMapData& ShadowMap = m_ShadowMaps[i];
+        ShadowMap.ViewProjMatrix = ShadowMap.ViewMatrix * ShadowMap.ProjMatrix;
+        ShadowMap.EndZ           = FLT_MAX;
+        UpdateShadowMapShaderInfo(i);
+    }
+}
+
 void HnLight::Sync(pxr::HdSceneDelegate* SceneDelegate,
                    pxr::HdRenderParam*   RenderParam,
                    pxr::HdDirtyBits*     DirtyBits)
@@ -499,6 +605,19 @@ void HnLight::Sync(pxr::HdSceneDelegate* SceneDelegate,
             if (ApproximateAreaLight(*SceneDelegate, MetersPerUnit))
             {
                 LightDirty = true;
+                // Cone angle defines the spot light shadow projection
+                ShadowTransformDirty = true;
+            }
+
+            // Nothing inside the emitter can cast a shadow, so the local light shadow near plane is placed
+            // at the emitter surface. Small emitters use a fixed minimum distance to limit the depth range.
+            constexpr float MinShadowNearZ = 0.01f; // meters
+
+            const float ShadowNearZ = std::max(GetLightEmitterRadius(*SceneDelegate, Id, m_TypeId), MinShadowNearZ / MetersPerUnit);
+            if (ShadowNearZ != m_ShadowNearZ)
+            {
+                m_ShadowNearZ        = ShadowNearZ;
+                ShadowTransformDirty = true;
             }
         }
         else
@@ -531,14 +650,6 @@ void HnLight::Sync(pxr::HdSceneDelegate* SceneDelegate,
                                     "  for light ", Id, " is too large for the shadow map atlas ", ShadowMapDesc.Width, "x", ShadowMapDesc.Height);
                 m_ShadowMapResolution = std::min(ShadowMapDesc.Width, ShadowMapDesc.Height);
             }
-
-            if (m_ShadowMapSuballocation &&
-                m_ShadowMapSuballocation->GetSize() != uint2{m_ShadowMapResolution, m_ShadowMapResolution})
-            {
-                m_ShadowMapSuballocation.Release();
-                m_ShadowMapShaderInfo.reset();
-                LightDirty = true;
-            }
         }
 
         *DirtyBits &= ~DirtyShadowParams;
@@ -546,49 +657,42 @@ void HnLight::Sync(pxr::HdSceneDelegate* SceneDelegate,
 
     if (ShadowMapMgr != nullptr)
     {
-        const bool ShadowsEnabled =
-            SceneDelegate->GetLightParamValue(Id, pxr::HdLightTokens->shadowEnable).GetWithDefault<bool>(false) &&
-            m_Params.Type == GLTF::Light::TYPE::DIRECTIONAL;
-        if (!ShadowsEnabled && m_ShadowMapSuballocation)
-        {
-            m_ShadowMapSuballocation.Release();
-            m_ShadowMapShaderInfo.reset();
-            LightDirty = true;
-        }
+        const bool ShadowsEnabled = SceneDelegate->GetLightParamValue(Id, pxr::HdLightTokens->shadowEnable).GetWithDefault<bool>(false);
 
-        if (ShadowsEnabled && !m_ShadowMapSuballocation)
+        m_NumRequestedShadowMaps = ShadowsEnabled ? GetRequiredShadowMapCount(static_cast<const HnRenderParam*>(RenderParam)) : 0;
+        if (ShadowMapsNeedReallocation())
         {
-            m_ShadowMapSuballocation = ShadowMapMgr->Allocate(m_ShadowMapResolution, m_ShadowMapResolution);
-            if (!m_ShadowMapSuballocation)
-            {
-                LOG_ERROR_MESSAGE("Failed to allocate shadow map for light ", Id);
-            }
-            m_ShadowMapShaderInfo = std::make_unique<HLSL::PBRShadowMapInfo>();
-
-            const float4& UVScaleBias      = m_ShadowMapSuballocation->GetUVScaleBias();
-            m_ShadowMapShaderInfo->UVScale = {UVScaleBias.x, UVScaleBias.y};
-            m_ShadowMapShaderInfo->UVBias  = {UVScaleBias.z, UVScaleBias.w};
-
-            m_ShadowMapShaderInfo->ShadowMapSlice = static_cast<float>(m_ShadowMapSuballocation->GetSlice());
+            AllocateShadowMaps(*ShadowMapMgr, m_NumRequestedShadowMaps);
 
             ShadowTransformDirty = true;
 
             LightDirty = true;
         }
 
-        if (m_ShadowMapShaderInfo && ShadowTransformDirty)
+        // The scene bounds and the light projection are computed even if the shadow maps
+        // could not be allocated, so that UpdateShadowMaps() can retry the allocation later.
+        if (m_NumRequestedShadowMaps > 0 && ShadowTransformDirty)
         {
-            if (m_TypeId == pxr::HdPrimTypeTokens->distantLight)
+            if (m_Params.Type == GLTF::Light::TYPE::DIRECTIONAL)
             {
                 ComputeDirectLightProjMatrix(*SceneDelegate);
+
+                if (m_NumShadowMaps == 1)
+                {
+                    FitShadowMapToScene();
+                }
+                else
+                {
+                    // Cascades are fit to the camera frustum by UpdateShadowMaps()
+                    m_CascadesDirty = true;
+                }
             }
             else
             {
-                UNEXPECTED("Only distant light is supported for shadow map");
+                ComputeSceneBounds(*SceneDelegate, nullptr);
+                if (m_NumShadowMaps > 0)
+                    ComputeLocalLightShadowMatrices(RenderDelegate->GetDevice()->GetDeviceInfo().NDC.MinZ == -1);
             }
-            m_ViewProjMatrix = m_ViewMatrix * m_ProjMatrix;
-
-            m_ShadowMapShaderInfo->WorldToLightProjSpace = m_ViewProjMatrix.Transpose();
 
             LightDirty         = true;
             m_IsShadowMapDirty = true;
@@ -603,6 +707,294 @@ void HnLight::Sync(pxr::HdSceneDelegate* SceneDelegate,
     *DirtyBits = HdLight::Clean;
 }
 
+Uint32 HnLight::GetRequiredShadowMapCount(const HnRenderParam* pRenderParam) const
+{
+    // Spot lights with a wider cone are shadowed like point lights
+    constexpr float MaxSpotShadowConeAngle = PI_F / 3.f;
+
+    switch (m_Params.Type)
+    {
+        case GLTF::Light::TYPE::DIRECTIONAL:
+            return pRenderParam != nullptr ? pRenderParam->GetShadowCascadeCount() : 1;
+
+        case GLTF::Light::TYPE::SPOT:
+            return m_Params.OuterConeAngle <= MaxSpotShadowConeAngle ? 1 : 6;
+
+        case GLTF::Light::TYPE::POINT:
+            return 6;
+
+        default:
+            return 0;
+    }
+}
+
+Uint32 HnLight::GetShadowMapAllocationResolution() const
+{
+    if (m_Params.Type == GLTF::Light::TYPE::DIRECTIONAL)
+        return m_ShadowMapResolution;
+
+    return std::max(m_ShadowMapResolution >> m_ShadowResolutionLevel, std::min(MinLocalShadowMapResolution, m_ShadowMapResolution));
+}
+
+bool HnLight::IsShadowCasterInFrustum(const ViewFrustum& Frustum, const float4& BoundingSphere, const float4x4& Transform)
+{
+    // Use the largest axis scale of the transform to scale the radius
+    const float3 Axes[] = {
+        float3::MakeVector(Transform[0]),
+        float3::MakeVector(Transform[1]),
+        float3::MakeVector(Transform[2]),
+    };
+    const float  Scale  = std::sqrt(std::max({dot(Axes[0], Axes[0]), dot(Axes[1], Axes[1]), dot(Axes[2], Axes[2])}));
+    const float4 Center = float4{BoundingSphere.x, BoundingSphere.y, BoundingSphere.z, 1} * Transform;
+    const float  Radius = BoundingSphere.w * Scale;
+
+    for (Uint32 i = 0; i < ViewFrustum::NUM_PLANES; ++i)
+    {
+        // Ignore the near plane to extrude the frustum toward the light
+        if (i == ViewFrustum::NEAR_PLANE_IDX)
+            continue;
+
+        // Frustum planes are not normalized
+        const Plane3D& Plane = Frustum.GetPlane(static_cast<ViewFrustum::PLANE_IDX>(i));
+        if (dot(Plane.Normal, float3{Center.x, Center.y, Center.z}) + Plane.Distance < -Radius * length(Plane.Normal))
+            return false;
+    }
+
+    return true;
+}
+
+float HnLight::GetShadowImportance(const float3& CameraPos) const
+{
+    const float3 Offset    = m_Position - CameraPos;
+    const float  Intensity = std::max(std::max(m_Params.Color.r, m_Params.Color.g), m_Params.Color.b) * m_Params.Intensity;
+    return Intensity / std::max(dot(Offset, Offset), 1e-6f);
+}
+
+bool HnLight::AllocateShadowMaps(HnShadowMapManager& ShadowMapMgr, Uint32 NumShadowMaps)
+{
+    if (NumShadowMaps == 0)
+    {
+        ReleaseShadowMaps();
+        return true;
+    }
+
+    // Allocate the new shadow maps before releasing the current ones, so that
+    // the light keeps its shadows if the atlas has no space for the new ones.
+    VERIFY_EXPR(NumShadowMaps <= MaxShadowMaps);
+    const Uint32 Resolution = GetShadowMapAllocationResolution();
+
+    std::array<RefCntAutoPtr<ITextureAtlasSuballocation>, MaxShadowMaps> Suballocations;
+    for (Uint32 i = 0; i < NumShadowMaps; ++i)
+    {
+        Suballocations[i] = ShadowMapMgr.Allocate(Resolution, Resolution);
+        if (!Suballocations[i])
+        {
+            // The allocation is retried every frame, so only report the first failure.
+            if (!m_ShadowMapAllocationFailed)
+            {
+                LOG_WARNING_MESSAGE("Failed to allocate shadow map ", i, " of light ", GetId(), ". ",
+                                    (m_NumShadowMaps == NumShadowMaps ? "The existing shadow maps will be used." : "The light will not cast shadows."),
+                                    " The allocation will be retried in later frames.");
+                m_ShadowMapAllocationFailed = true;
+            }
+
+            // Shadow maps with a different count can't be used by the light
+            if (m_NumShadowMaps != NumShadowMaps)
+                ReleaseShadowMaps();
+            return false;
+        }
+    }
+    m_ShadowMapAllocationFailed = false;
+
+    ReleaseShadowMaps();
+    for (Uint32 i = 0; i < NumShadowMaps; ++i)
+        m_ShadowMaps[i].Suballocation = std::move(Suballocations[i]);
+
+    m_NumShadowMaps       = NumShadowMaps;
+    m_ShadowMapShaderInfo = std::make_unique<HLSL::PBRShadowMapInfo[]>(NumShadowMaps);
+    for (Uint32 i = 0; i < NumShadowMaps; ++i)
+    {
+        const ITextureAtlasSuballocation* pSuballocation = m_ShadowMaps[i].Suballocation;
+        HLSL::PBRShadowMapInfo&           ShadowMapInfo  = m_ShadowMapShaderInfo[i];
+
+        const float4& UVScaleBias = pSuballocation->GetUVScaleBias();
+        ShadowMapInfo.UVScale     = {UVScaleBias.x, UVScaleBias.y};
+        ShadowMapInfo.UVBias      = {UVScaleBias.z, UVScaleBias.w};
+
+        ShadowMapInfo.ShadowMapSlice = static_cast<float>(pSuballocation->GetSlice());
+        ShadowMapInfo.NumCascades    = static_cast<int>(NumShadowMaps);
+    }
+
+    return true;
+}
+
+bool HnLight::ShadowMapsNeedReallocation() const
+{
+    if (m_NumShadowMaps != m_NumRequestedShadowMaps)
+        return true;
+
+    const Uint32 Resolution = GetShadowMapAllocationResolution();
+    return m_NumShadowMaps > 0 && m_ShadowMaps[0].Suballocation->GetSize() != uint2{Resolution, Resolution};
+}
+
+void HnLight::ReleaseShadowMaps()
+{
+    for (ShadowMapData& ShadowMap : m_ShadowMaps)
+        ShadowMap = {};
+    m_NumShadowMaps = 0;
+    m_ShadowMapShaderInfo.reset();
+}
+
+void HnLight::UpdateShadowMapShaderInfo(Uint32 Idx)
+{
+    VERIFY_EXPR(Idx < m_NumShadowMaps);
+
+    HLSL::PBRShadowMapInfo& ShadowMapInfo = m_ShadowMapShaderInfo[Idx];
+    ShadowMapInfo.WorldToLightProjSpace   = m_ShadowMaps[Idx].ViewProjMatrix.Transpose();
+    ShadowMapInfo.CascadeEndZ             = m_ShadowMaps[Idx].EndZ;
+    ShadowMapInfo.CascadeBlendRange       = m_CascadeBlendRange;
+}
+
+void HnLight::FitShadowMapToScene()
+{
+    VERIFY_EXPR(m_NumShadowMaps == 1);
+
+    ShadowMapData& Cascade = m_ShadowMaps[0];
+    Cascade.ViewMatrix     = m_ViewMatrix;
+    Cascade.ProjMatrix     = m_ProjMatrix;
+    Cascade.ViewProjMatrix = m_ViewMatrix * m_ProjMatrix;
+    Cascade.EndZ           = FLT_MAX;
+    UpdateShadowMapShaderInfo(0);
+}
+
+void HnLight::UpdateShadowMaps(const HnCamera& Camera, HnRenderParam& RenderParam, HnShadowMapManager& ShadowMapMgr, bool IsGL, Uint32 ResolutionLevel)
+{
+    if (m_NumRequestedShadowMaps == 0 || !m_SceneBounds.IsValid())
+        return;
+
+    if (m_Params.Type != GLTF::Light::TYPE::DIRECTIONAL)
+    {
+        const Uint32 PrevResolutionLevel = m_ShadowResolutionLevel;
+        m_ShadowResolutionLevel          = ResolutionLevel;
+        // This also retries the allocation if it failed before
+        if (ShadowMapsNeedReallocation())
+        {
+            if (AllocateShadowMaps(ShadowMapMgr, m_NumRequestedShadowMaps))
+            {
+                ComputeLocalLightShadowMatrices(IsGL);
+                m_IsShadowMapDirty = true;
+                RenderParam.MakeAttribDirty(HnRenderParam::GlobalAttrib::Light);
+            }
+            else if (m_NumShadowMaps > 0)
+            {
+                // The existing shadow maps are kept, so keep their resolution level
+                m_ShadowResolutionLevel = PrevResolutionLevel;
+            }
+        }
+        return;
+    }
+
+    m_NumRequestedShadowMaps = RenderParam.GetShadowCascadeCount();
+    if (ShadowMapsNeedReallocation() && AllocateShadowMaps(ShadowMapMgr, m_NumRequestedShadowMaps))
+    {
+        if (m_NumShadowMaps == 1)
+            FitShadowMapToScene();
+
+        m_CascadesDirty    = true;
+        m_IsShadowMapDirty = true;
+        RenderParam.MakeAttribDirty(HnRenderParam::GlobalAttrib::Light);
+    }
+
+    // A single shadow map is fit to the scene rather than to the camera frustum
+    if (m_NumShadowMaps <= 1)
+        return;
+
+    const float4x4& CameraProj  = Camera.GetProjectionMatrix();
+    const float4x4& CameraView  = Camera.GetViewMatrix();
+    const float4x4& CameraWorld = Camera.GetWorldMatrix();
+
+    float CameraNearZ = 0;
+    float CameraFarZ  = 0;
+    CameraProj.GetNearFarClipPlanes(CameraNearZ, CameraFarZ, IsGL);
+
+    // Limit the camera depth range by the scene bounds so that cascades are not wasted on
+    // empty space, and use the scene depth range in light space for every cascade so that
+    // shadow casters outside of the view frustum are not clipped.
+    float SceneMaxZ      = 0;
+    float LightSpaceMinZ = +FLT_MAX;
+    float LightSpaceMaxZ = -FLT_MAX;
+    for (Uint32 i = 0; i < 8; ++i)
+    {
+        const float3 Corner = m_SceneBounds.GetCorner(i);
+        SceneMaxZ           = std::max(SceneMaxZ, (Corner * CameraView).z);
+
+        const float LightSpaceZ = (Corner * m_ViewMatrix).z;
+        LightSpaceMinZ          = std::min(LightSpaceMinZ, LightSpaceZ);
+        LightSpaceMaxZ          = std::max(LightSpaceMaxZ, LightSpaceZ);
+    }
+    // If the scene is behind the camera, any non-empty range will do
+    CameraFarZ = std::max(std::min(CameraFarZ, SceneMaxZ), CameraNearZ * 2.f);
+
+    const float Partitioning = RenderParam.GetShadowCascadePartitioning();
+    const float BlendRange   = RenderParam.GetShadowCascadeBlendRange();
+
+    bool CascadesChanged = m_CascadesDirty || m_CascadeBlendRange != BlendRange;
+    m_CascadeBlendRange  = BlendRange;
+
+    // Cascade start depth as it is computed by the shader
+    float StartZ = 0;
+    // Cascade start depth extended to cover the blend range of the previous cascade
+    float FitStartZ = CameraNearZ;
+    for (Uint32 i = 0; i < m_NumShadowMaps; ++i)
+    {
+        float EndZ = CameraFarZ;
+        if (i + 1 < m_NumShadowMaps)
+        {
+            const float Power    = static_cast<float>(i + 1) / static_cast<float>(m_NumShadowMaps);
+            const float LogZ     = CameraNearZ * std::pow(CameraFarZ / CameraNearZ, Power);
+            const float UniformZ = CameraNearZ + (CameraFarZ - CameraNearZ) * Power;
+            EndZ                 = Partitioning * (LogZ - UniformZ) + UniformZ;
+        }
+
+        // The minimal bounding sphere of the cascade frustum does not depend on the
+        // camera orientation, so the cascade extents do not change when the camera rotates.
+        float3 SphereCenter;
+        float  SphereRadius = 0;
+        GetFrustumMinimumBoundingSphere(CameraProj._11, CameraProj._22, FitStartZ, EndZ, SphereCenter, SphereRadius);
+        float3 Center = SphereCenter * CameraWorld * m_ViewMatrix;
+
+        // Snap the cascade center to the shadow map texels to avoid shimmering when the camera moves
+        const float TexelSize = 2.f * SphereRadius / static_cast<float>(m_ShadowMapResolution);
+        Center.x              = std::floor(Center.x / TexelSize) * TexelSize;
+        Center.y              = std::floor(Center.y / TexelSize) * TexelSize;
+
+        const float4x4 ProjMatrix = float4x4::OrthoOffCenter(Center.x - SphereRadius, Center.x + SphereRadius,
+                                                             Center.y - SphereRadius, Center.y + SphereRadius,
+                                                             LightSpaceMinZ, LightSpaceMaxZ, IsGL);
+
+        ShadowMapData& Cascade = m_ShadowMaps[i];
+        if (CascadesChanged || Cascade.ProjMatrix != ProjMatrix || Cascade.EndZ != EndZ)
+        {
+            Cascade.ViewMatrix     = m_ViewMatrix;
+            Cascade.ProjMatrix     = ProjMatrix;
+            Cascade.ViewProjMatrix = m_ViewMatrix * ProjMatrix;
+            Cascade.EndZ           = EndZ;
+            UpdateShadowMapShaderInfo(i);
+
+            CascadesChanged = true;
+        }
+
+        FitStartZ = std::max(EndZ - (EndZ - StartZ) * BlendRange, CameraNearZ);
+        StartZ    = EndZ;
+    }
+
+    if (CascadesChanged)
+    {
+        m_IsShadowMapDirty = true;
+    }
+    m_CascadesDirty = false;
+}
+
 } // namespace USD
 
 } // namespace Diligent
@@ -26,6 +26,7 @@
 
 #include "HnMaterial.hpp"
 
+#include <array>
 #include <vector>
 #include <set>
 
@@ -109,8 +110,11 @@ void HnMaterial::Sync(pxr::HdSceneDelegate* SceneDelegate,
     HnTextureRegistry&  TexRegistry    = RenderDelegate->GetTextureRegistry();
     const USD_Renderer& UsdRenderer    = *RenderDelegate->GetUSDRenderer();
 
-    // A mapping from the texture name to the texture coordinate set index (e.g. "diffuseColor" -> 0)
-    TexNameToCoordSetMapType TexNameToCoordSetMap;
+    m_TexNameToCoordSetMap.clear();
+    m_PackedTextureParamsName = {};
+
+    RenderDelegate->UnregisterMaterialNetwork(*this);
+    m_NetworkHash = 0;
 
     pxr::VtValue vtMat = SceneDelegate->GetMaterialResource(GetId());
     if (vtMat.IsHolding<pxr::HdMaterialNetworkMap>())
@@ -122,8 +126,26 @@ void HnMaterial::Sync(pxr::HdSceneDelegate* SceneDelegate,
             {
                 m_Network = HnMaterialNetwork{GetId(), hdNetworkMap}; // May throw
 
-                TexNameToCoordSetMap = AllocateTextures(TexRegistry);
-                ProcessMaterialNetwork();
+                const size_t NetworkHash = m_Network.ComputeHash();
+                if (const HnMaterial* pEquivalentMat = RenderDelegate->FindEquivalentMaterial(m_Network, NetworkHash))
+                {
+                    // DCC exports often contain many copies of the same material. Reuse the textures,
+                    // texture coordinate sets and shader attributes of the equivalent material, so that
+                    // both materials resolve to the same SRB and draw items that use them can be batched.
+                    CopyNetworkState(*pEquivalentMat);
+                }
+                else
+                {
+                    // When the renderer uses the physical descriptor map instead of separate metallic and
+                    // roughness textures, pack the single-channel textures into one.
+                    const bool PackTextures = !UsdRenderer.GetSettings().UseSeparateMetallicRoughnessTextures;
+
+                    m_TexNameToCoordSetMap = AllocateTextures(TexRegistry, PackTextures);
+                    ProcessMaterialNetwork();
+                }
+
+                m_NetworkHash = NetworkHash;
+                RenderDelegate->RegisterMaterialNetwork(*this);
             }
             catch (const std::runtime_error& err)
             {
@@ -139,7 +161,7 @@ void HnMaterial::Sync(pxr::HdSceneDelegate* SceneDelegate,
     }
 
     // It is important to initialize texture attributes with default values even if there is no material network.
-    InitTextureAttribs(TexRegistry, UsdRenderer, TexNameToCoordSetMap);
+    InitTextureAttribs(TexRegistry, UsdRenderer, m_TexNameToCoordSetMap);
 
     if (RenderParam)
     {
@@ -227,6 +249,17 @@ void HnMaterial::ProcessMaterialNetwork()
     m_MaterialData.Attribs.BaseColorFactor.a = m_Network.GetOpacity();
 }
 
+void HnMaterial::CopyNetworkState(const HnMaterial& Src)
+{
+    VERIFY_EXPR(m_Network == Src.m_Network);
+
+    m_Textures                = Src.m_Textures;
+    m_TexNameToCoordSetMap    = Src.m_TexNameToCoordSetMap;
+    m_PackedTextureParamsName = Src.m_PackedTextureParamsName;
+    m_TexCoords               = Src.m_TexCoords;
+    m_MaterialData            = Src.m_MaterialData;
+}
+
 void HnMaterial::InitTextureAttribs(HnTextureRegistry& TexRegistry, const USD_Renderer& UsdRenderer, const TexNameToCoordSetMapType& TexNameToCoordSetMap)
 {
     GLTF::MaterialBuilder MatBuilder{m_MaterialData};
@@ -234,7 +267,12 @@ void HnMaterial::InitTextureAttribs(HnTextureRegistry& TexRegistry, const USD_Re
     auto SetTextureParams = [&](const pxr::TfToken& Name, Uint32 Idx) {
         GLTF::Material::TextureShaderAttribs& TexAttribs = MatBuilder.GetTextureAttrib(Idx);
 
-        auto coord_it         = TexNameToCoordSetMap.find(Name);
+        // The packed texture uses the texture coordinates and the transform of one of its sources
+        const pxr::TfToken& ParamName = (Name == HnTokens->occlusionRoughnessMetallic && !m_PackedTextureParamsName.IsEmpty()) ?
+            m_PackedTextureParamsName :
+            Name;
+
+        auto coord_it         = TexNameToCoordSetMap.find(ParamName);
         TexAttribs.UVSelector = coord_it != TexNameToCoordSetMap.end() ?
             static_cast<float>(coord_it->second) :
             0;
@@ -246,7 +284,7 @@ void HnMaterial::InitTextureAttribs(HnTextureRegistry& TexRegistry, const USD_Re
         auto tex_it = m_Textures.find(Name);
         if (tex_it != m_Textures.end())
         {
-            if (const HnMaterialParameter* Param = m_Network.GetParameter(HnMaterialParameter::ParamType::Transform2d, Name))
+            if (const HnMaterialParameter* Param = m_Network.GetParameter(HnMaterialParameter::ParamType::Transform2d, ParamName))
             {
                 float2x2 UVScaleAndRotation = float2x2::Scale(Param->Transform2d.Scale[0], Param->Transform2d.Scale[1]);
                 float    Rotation           = Param->Transform2d.Rotation;
@@ -266,29 +304,68 @@ void HnMaterial::InitTextureAttribs(HnTextureRegistry& TexRegistry, const USD_Re
             tex_it = m_Textures.emplace(Name, GetDefaultTexture(TexRegistry, Name)).first;
         }
 
-        if (ITextureAtlasSuballocation* pAtlasSuballocation = tex_it->second->pAtlasSuballocation)
+        // Use the default texture until the texture is loaded
+        const HnTextureRegistry::TextureHandleSharedPtr pTexHandle = tex_it->second->IsLoading ?
+            GetDefaultTexture(TexRegistry, Name) :
+            tex_it->second;
+        if (ITextureAtlasSuballocation* pAtlasSuballocation = pTexHandle->pAtlasSuballocation)
         {
             TexAttribs.TextureSlice        = static_cast<float>(pAtlasSuballocation->GetSlice());
             TexAttribs.AtlasUVScaleAndBias = pAtlasSuballocation->GetUVScaleBias();
         }
         else
         {
-            TexAttribs.TextureSlice        = static_cast<float>(tex_it->second->TextureId);
+            TexAttribs.TextureSlice        = static_cast<float>(pTexHandle->TextureId);
             TexAttribs.AtlasUVScaleAndBias = float4{1, 1, 0, 0};
         }
     };
 
-    const auto& TexAttribIndices = UsdRenderer.GetSettings().TextureAttribIndices;
+    const PBR_Renderer::CreateInfo& RendererSettings = UsdRenderer.GetSettings();
+    const auto&                     TexAttribIndices = RendererSettings.TextureAttribIndices;
     // clang-format off
     SetTextureParams(HnTokens->diffuseColor,  TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_BASE_COLOR]);
     SetTextureParams(HnTokens->normal,        TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_NORMAL]);
-    SetTextureParams(HnTokens->metallic,      TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_METALLIC]);
-    SetTextureParams(HnTokens->roughness,     TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_ROUGHNESS]);
+    if (RendererSettings.UseSeparateMetallicRoughnessTextures)
+    {
+        SetTextureParams(HnTokens->metallic,  TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_METALLIC]);
+        SetTextureParams(HnTokens->roughness, TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_ROUGHNESS]);
+    }
+    else
+    {
+        SetTextureParams(HnTokens->occlusionRoughnessMetallic, TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_PHYS_DESC]);
+    }
     SetTextureParams(HnTokens->occlusion,     TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_OCCLUSION]);
     SetTextureParams(HnTokens->emissiveColor, TexAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_EMISSIVE]);
     // clang-format on
 
     MatBuilder.Finalize();
+
+    m_TexturesVersion = GetTexturesVersion();
+}
+
+Uint32 HnMaterial::GetTexturesVersion() const
+{
+    // Handle versions only grow, so the sum changes whenever any of them does
+    Uint32 Version = 0;
+    for (const auto& tex_it : m_Textures)
+        Version += tex_it.second->Version;
+    return Version;
+}
+
+bool HnMaterial::UpdateTextureResources(HnTextureRegistry& TexRegistry, const USD_Renderer& UsdRenderer)
+{
+    if (GetTexturesVersion() == m_TexturesVersion)
+        return false;
+
+    // Replace the default textures with the loaded ones and update the atlas regions
+    InitTextureAttribs(TexRegistry, UsdRenderer, m_TexNameToCoordSetMap);
+
+    // Release the SRB so that it is recreated by UpdateSRB()
+    m_SRB.Release();
+    m_PrimitiveAttribsVar            = nullptr;
+    m_PBRPrimitiveAttribsBufferRange = 0;
+
+    return true;
 }
 
 static RefCntAutoPtr<Image> CreateDefaultImage(const pxr::TfToken& Name, Uint32 Dimension = 64)
@@ -355,7 +432,8 @@ HnTextureRegistry::TextureHandleSharedPtr HnMaterial::GetDefaultTexture(HnTextur
 {
     pxr::TfToken DefaultTexName;
     if (Name == HnTokens->diffuseColor ||
-        Name == HnTokens->emissiveColor)
+        Name == HnTokens->emissiveColor ||
+        Name == HnTokens->occlusionRoughnessMetallic)
     {
         DefaultTexName = HnMaterialPrivateTokens->whiteRgba8;
     }
@@ -415,13 +493,95 @@ static TEXTURE_FORMAT GetMaterialTextureFormat(const pxr::TfToken& Name)
     }
 }
 
-HnMaterial::TexNameToCoordSetMapType HnMaterial::AllocateTextures(HnTextureRegistry& TexRegistry)
+// Returns the block-compressed format for the material texture, based on the channels that the shader reads
+static TEXTURE_FORMAT GetMaterialTextureCompressedFormat(const pxr::TfToken& Name)
+{
+    if (Name == HnTokens->diffuseColor)
+    {
+        // Replaced with BC1 if the texture is opaque
+        return TEX_FORMAT_BC3_UNORM;
+    }
+    else if (Name == HnTokens->emissiveColor)
+    {
+        return TEX_FORMAT_BC1_UNORM;
+    }
+    else if (Name == HnTokens->metallic ||
+             Name == HnTokens->roughness ||
+             Name == HnTokens->occlusion)
+    {
+        return TEX_FORMAT_BC4_UNORM;
+    }
+    else
+    {
+        // Normal maps are not compressed: the shader reads all three components
+        // of the normal, and BC1 artifacts are clearly visible in the lighting.
+        return TEX_FORMAT_UNKNOWN;
+    }
+}
+
+static bool TextureTransformsMatch(const HnMaterialNetwork& Network, const pxr::TfToken& Name0, const pxr::TfToken& Name1)
+{
+    const HnMaterialParameter* Param0 = Network.GetParameter(HnMaterialParameter::ParamType::Transform2d, Name0);
+    const HnMaterialParameter* Param1 = Network.GetParameter(HnMaterialParameter::ParamType::Transform2d, Name1);
+    if (Param0 == nullptr || Param1 == nullptr)
+        return Param0 == Param1;
+
+    // clang-format off
+    return Param0->Transform2d.Scale       == Param1->Transform2d.Scale &&
+           Param0->Transform2d.Translation == Param1->Transform2d.Translation &&
+           Param0->Transform2d.Rotation    == Param1->Transform2d.Rotation;
+    // clang-format on
+}
+
+HnMaterial::TexNameToCoordSetMapType HnMaterial::AllocateTextures(HnTextureRegistry& TexRegistry, bool PackTextures)
 {
     // Texture name to texture coordinate set index (e.g. "diffuseColor" -> 0)
     TexNameToCoordSetMapType TexNameToCoordSetMap;
 
     // Texture coordinate primvar name to texture coordinate set index (e.g. "st" -> 0)
     std::unordered_map<pxr::TfToken, size_t, pxr::TfToken::HashFunctor> TexCoordPrimvarMapping;
+
+    auto AllocateTexCoords = [&](const pxr::TfToken& Name) {
+        // Find texture coordinate
+        size_t TexCoordIdx = ~size_t{0};
+        if (const HnMaterialParameter* Param = m_Network.GetParameter(HnMaterialParameter::ParamType::Texture, Name))
+        {
+            if (!Param->SamplerCoords.empty())
+            {
+                if (Param->SamplerCoords.size() > 1)
+                    LOG_WARNING_MESSAGE("Texture '", Name, "' has ", Param->SamplerCoords.size(), " texture coordinates. Only the first set will be used");
+                const pxr::TfToken& TexCoordName = Param->SamplerCoords[0];
+
+                // Check if the texture coordinate set primvar (e.g. "st0") has already been allocated
+                auto it_inserted = TexCoordPrimvarMapping.emplace(TexCoordName, m_TexCoords.size());
+                TexCoordIdx      = it_inserted.first->second;
+                if (it_inserted.second)
+                {
+                    // Add new texture coordinate set
+                    VERIFY_EXPR(TexCoordIdx == m_TexCoords.size());
+                    m_TexCoords.resize(TexCoordIdx + 1);
+                    m_TexCoords[TexCoordIdx] = {TexCoordName};
+                }
+
+                TexNameToCoordSetMap[Name] = TexCoordIdx;
+            }
+            else
+            {
+                LOG_ERROR_MESSAGE("Texture '", Name, "' in material '", GetId(), "' has no texture coordinates");
+            }
+        }
+
+        if (TexCoordIdx == ~size_t{0})
+        {
+            LOG_ERROR_MESSAGE("Failed to find texture coordinates for texture '", Name, "' in material '", GetId(), "'");
+        }
+    };
+
+    // Single-channel textures to pack into the occlusionRoughnessMetallic texture
+    const HnMaterialNetwork::TextureDescriptor* pOcclusionDesc = nullptr;
+    const HnMaterialNetwork::TextureDescriptor* pRoughnessDesc = nullptr;
+    const HnMaterialNetwork::TextureDescriptor* pMetallicDesc  = nullptr;
+
     for (const HnMaterialNetwork::TextureDescriptor& TexDescriptor : m_Network.GetTextures())
     {
         TEXTURE_FORMAT Format = GetMaterialTextureFormat(TexDescriptor.Name);
@@ -437,42 +597,97 @@ HnMaterial::TexNameToCoordSetMapType HnMaterial::AllocateTextures(HnTextureRegis
             continue;
         }
 
-        if (auto pTex = TexRegistry.Allocate(TexDescriptor.TextureId, Format, TexDescriptor.SamplerParams))
+        if (PackTextures)
         {
-            m_Textures[TexDescriptor.Name] = pTex;
-            // Find texture coordinate
-            size_t TexCoordIdx = ~size_t{0};
-            if (const HnMaterialParameter* Param = m_Network.GetParameter(HnMaterialParameter::ParamType::Texture, TexDescriptor.Name))
+            const HnMaterialNetwork::TextureDescriptor** ppPackedDesc =
+                TexDescriptor.Name == HnTokens->occlusion ? &pOcclusionDesc :
+                TexDescriptor.Name == HnTokens->roughness ? &pRoughnessDesc :
+                TexDescriptor.Name == HnTokens->metallic  ? &pMetallicDesc :
+                                                            nullptr;
+            if (ppPackedDesc != nullptr)
             {
-                if (!Param->SamplerCoords.empty())
-                {
-                    if (Param->SamplerCoords.size() > 1)
-                        LOG_WARNING_MESSAGE("Texture '", TexDescriptor.Name, "' has ", Param->SamplerCoords.size(), " texture coordinates. Only the first set will be used");
-                    const pxr::TfToken& TexCoordName = Param->SamplerCoords[0];
-
-                    // Check if the texture coordinate set primvar (e.g. "st0") has already been allocated
-                    auto it_inserted = TexCoordPrimvarMapping.emplace(TexCoordName, m_TexCoords.size());
-                    TexCoordIdx      = it_inserted.first->second;
-                    if (it_inserted.second)
-                    {
-                        // Add new texture coordinate set
-                        VERIFY_EXPR(TexCoordIdx == m_TexCoords.size());
-                        m_TexCoords.resize(TexCoordIdx + 1);
-                        m_TexCoords[TexCoordIdx] = {TexCoordName};
-                    }
-
-                    TexNameToCoordSetMap[TexDescriptor.Name] = TexCoordIdx;
-                }
-                else
-                {
-                    LOG_ERROR_MESSAGE("Texture '", TexDescriptor.Name, "' in material '", GetId(), "' has no texture coordinates");
-                }
+                // The texture is allocated below
+                *ppPackedDesc = &TexDescriptor;
+                AllocateTexCoords(TexDescriptor.Name);
+                continue;
             }
+        }
 
-            if (TexCoordIdx == ~size_t{0})
+        const TEXTURE_FORMAT CompressedFormat = GetMaterialTextureCompressedFormat(TexDescriptor.Name);
+        if (auto pTex = TexRegistry.Allocate(TexDescriptor.TextureId, Format, TexDescriptor.SamplerParams, CompressedFormat))
+        {
+            m_Textures[TexDescriptor.Name] = pTex;
+            AllocateTexCoords(TexDescriptor.Name);
+        }
+    }
+
+    // Textures can only be packed if they are sampled the same way
+    auto IsPackingCompatible = [&](const HnMaterialNetwork::TextureDescriptor& TexDesc, const HnMaterialNetwork::TextureDescriptor& RefDesc) {
+        auto coord_it     = TexNameToCoordSetMap.find(TexDesc.Name);
+        auto ref_coord_it = TexNameToCoordSetMap.find(RefDesc.Name);
+        // clang-format off
+        return (coord_it == TexNameToCoordSetMap.end() ? ~size_t{0} : coord_it->second) ==
+               (ref_coord_it == TexNameToCoordSetMap.end() ? ~size_t{0} : ref_coord_it->second) &&
+               TextureTransformsMatch(m_Network, TexDesc.Name, RefDesc.Name) &&
+               TexDesc.SamplerParams == RefDesc.SamplerParams;
+        // clang-format on
+    };
+
+    if (pRoughnessDesc != nullptr && pMetallicDesc != nullptr && !IsPackingCompatible(*pRoughnessDesc, *pMetallicDesc))
+    {
+        // The renderer reads metallic and roughness from the same packed texture for all materials,
+        // so textures that are sampled differently can't be used. Sampling one of them with the parameters
+        // of the other one would render the material incorrectly.
+        LOG_WARNING_MESSAGE("Roughness and metallic textures in material '", GetId(),
+                            "' use different texture coordinates, transforms or samplers and can't be packed. "
+                            "The textures are ignored. Disable PackMaterialTextures to render the material correctly.");
+        pRoughnessDesc = nullptr;
+        pMetallicDesc  = nullptr;
+    }
+
+    if (pMetallicDesc != nullptr || pRoughnessDesc != nullptr)
+    {
+        // The packed texture uses the texture coordinates, transform and sampler of the metallic texture,
+        // or of the roughness texture if there is no metallic one.
+        const HnMaterialNetwork::TextureDescriptor& RefDesc = pMetallicDesc != nullptr ? *pMetallicDesc : *pRoughnessDesc;
+
+        // Occlusion is read from the packed texture only if it is sampled the same way.
+        // Otherwise, it remains a separate texture.
+        if (pOcclusionDesc != nullptr && !IsPackingCompatible(*pOcclusionDesc, RefDesc))
+        {
+            if (auto pTex = TexRegistry.Allocate(pOcclusionDesc->TextureId, TEX_FORMAT_R8_UNORM, pOcclusionDesc->SamplerParams,
+                                                 GetMaterialTextureCompressedFormat(HnTokens->occlusion)))
             {
-                LOG_ERROR_MESSAGE("Failed to find texture coordinates for texture '", TexDescriptor.Name, "' in material '", GetId(), "'");
+                m_Textures[HnTokens->occlusion] = pTex;
             }
+            pOcclusionDesc = nullptr;
+        }
+
+        // R - occlusion, G - roughness, B - metallic, which matches the glTF layout expected by the shader
+        const std::array<const HnTextureIdentifier*, 4> Channels = {
+            pOcclusionDesc != nullptr ? &pOcclusionDesc->TextureId : nullptr,
+            pRoughnessDesc != nullptr ? &pRoughnessDesc->TextureId : nullptr,
+            pMetallicDesc != nullptr ? &pMetallicDesc->TextureId : nullptr,
+            nullptr,
+        };
+        // The packed texture is not compressed: BC1 shares the color endpoints between the channels
+        // of a block, so the edges in one channel would bleed into the other uncorrelated channels.
+        if (auto pTex = TexRegistry.AllocatePacked(Channels, RefDesc.SamplerParams))
+        {
+            m_Textures[HnTokens->occlusionRoughnessMetallic] = pTex;
+            if (pOcclusionDesc != nullptr)
+                m_Textures[HnTokens->occlusion] = pTex;
+
+            m_PackedTextureParamsName = RefDesc.Name;
+        }
+    }
+    else if (pOcclusionDesc != nullptr)
+    {
+        // There is nothing to pack occlusion with
+        if (auto pTex = TexRegistry.Allocate(pOcclusionDesc->TextureId, TEX_FORMAT_R8_UNORM, pOcclusionDesc->SamplerParams,
+                                             GetMaterialTextureCompressedFormat(HnTokens->occlusion)))
+        {
+            m_Textures[HnTokens->occlusion] = pTex;
         }
     }
 
@@ -613,6 +828,14 @@ RefCntAutoPtr<IObject> HnMaterial::CreateSRBCache()
     return HnMaterialSRBCache::Create();
 }
 
+// Returns the mask of the texture attribs that are not used by the renderer
+static Uint32 GetDisabledTextureAttribsMask(const PBR_Renderer::CreateInfo& RendererSettings)
+{
+    return RendererSettings.UseSeparateMetallicRoughnessTextures ?
+        (1u << PBR_Renderer::TEXTURE_ATTRIB_ID_PHYS_DESC) :
+        (1u << PBR_Renderer::TEXTURE_ATTRIB_ID_METALLIC) | (1u << PBR_Renderer::TEXTURE_ATTRIB_ID_ROUGHNESS);
+}
+
 // If possible, applies standard texture indexing to reduce the number of shader permutations, e.g.:
 //
 //  StdTexIds     TexIds0      TexArray     StdTexArray0
@@ -633,8 +856,7 @@ RefCntAutoPtr<IObject> HnMaterial::CreateSRBCache()
 // \note    HnRenderPass always enables the following textures (see HnRenderPass::GetMaterialPSOFlags):
 //            - COLOR_MAP
 //            - NORMAL_MAP
-//            - METALLIC_MAP
-//		      - ROUGHNESS_MAP
+//            - METALLIC_MAP and ROUGHNESS_MAP, or PHYS_DESC_MAP if UseSeparateMetallicRoughnessTextures is false
 //            - AO_MAP
 //		      - EMISSIVE_MAP
 //          For pipelines that only use these textures (which is the most common case), we can use
@@ -657,9 +879,7 @@ static bool ApplyStandardStaticTextureIndexing(const PBR_Renderer::CreateInfo&
     VERIFY_EXPR(StdTexArray.size() == TexturesArraySize);
 
     // Skip texture attribs not used by the renderer.
-    const Uint32 DisabledAttribsMask = RendererSettings.UseSeparateMetallicRoughnessTextures ?
-        (1u << PBR_Renderer::TEXTURE_ATTRIB_ID_PHYS_DESC) :
-        (1u << PBR_Renderer::TEXTURE_ATTRIB_ID_METALLIC) | (1u << PBR_Renderer::TEXTURE_ATTRIB_ID_ROUGHNESS);
+    const Uint32 DisabledAttribsMask = GetDisabledTextureAttribsMask(RendererSettings);
 
     Uint16 Slot = 0;
     for (Uint32 TexAttribId = 0; TexAttribId < StaticShaderTexIds.size(); ++TexAttribId)
@@ -761,9 +981,12 @@ void HnMaterial::UpdateSRB(HnRenderDelegate& RendererDelegate)
         PBR_Renderer::StaticShaderTextureIdsArrayType StaticShaderTexIds;
         StaticShaderTexIds.fill(decltype(PBR_Renderer::InvalidMaterialTextureId){PBR_Renderer::InvalidMaterialTextureId});
 
+        const Uint32 DisabledAttribsMask = GetDisabledTextureAttribsMask(RendererSettings);
         for (Uint32 id = 0; id < PBR_Renderer::TEXTURE_ATTRIB_ID_COUNT; ++id)
         {
             const PBR_Renderer::TEXTURE_ATTRIB_ID ID = static_cast<PBR_Renderer::TEXTURE_ATTRIB_ID>(id);
+            if ((DisabledAttribsMask & (1u << id)) != 0)
+                continue;
 
             const pxr::TfToken& TexName = PBRTextureAttribIdToPxrName(ID);
             if (TexName.IsEmpty())
@@ -778,7 +1001,10 @@ void HnMaterial::UpdateSRB(HnRenderDelegate& RendererDelegate)
 
             ITexture* pTexture = nullptr;
 
-            const HnTextureRegistry::TextureHandleSharedPtr& pTexHandle = tex_it->second;
+            // Use the default texture until the texture is loaded
+            const HnTextureRegistry::TextureHandleSharedPtr pTexHandle = tex_it->second->IsLoading ?
+                GetDefaultTexture(RendererDelegate.GetTextureRegistry(), TexName) :
+                tex_it->second;
             if (pTexHandle->pTexture)
             {
                 const auto& TexDesc = pTexHandle->pTexture->GetDesc();
@@ -891,6 +1117,12 @@ void HnMaterial::UpdateSRB(HnRenderDelegate& RendererDelegate)
             m_ShaderTextureIndexingId = SRBCache->AddShaderTextureIndexing(StaticShaderTexIds);
         }
     }
+    else
+    {
+        // With dynamic texture binding, the SRB references all textures in the registry,
+        // so a new one is required when asynchronously loaded textures are published.
+        SRBKey.UniqueIDs.push_back(RendererDelegate.GetTextureRegistry().GetStorageVersion());
+    }
 
     m_SRB = SRBCache->GetSRB(SRBKey, [&]() {
         RefCntAutoPtr<IShaderResourceBinding> pSRB;
@@ -920,6 +1152,9 @@ void HnMaterial::UpdateSRB(HnRenderDelegate& RendererDelegate)
                     HnTextureRegistry& TexRegistry = RendererDelegate.GetTextureRegistry();
                     TexRegistry.ProcessTextures(
                         [&TexArray](const pxr::TfToken& Name, const HnTextureRegistry::TextureHandle& Handle) {
+                            if (Handle.IsLoading)
+                                return; // The slot is set to the default texture below
+
                             if (!Handle.pTexture)
                             {
                                 UNEXPECTED("Texture '", Name, "' is not initialized.");
@@ -969,13 +1204,16 @@ void HnMaterial::UpdateSRB(HnRenderDelegate& RendererDelegate)
         else
         {
             VERIFY_EXPR(BindingMode == HN_MATERIAL_TEXTURES_BINDING_MODE_LEGACY);
+            const Uint32 DisabledAttribsMask = GetDisabledTextureAttribsMask(RendererSettings);
             for (Uint32 id = 0; id < PBR_Renderer::TEXTURE_ATTRIB_ID_COUNT; ++id)
             {
                 const PBR_Renderer::TEXTURE_ATTRIB_ID ID = static_cast<PBR_Renderer::TEXTURE_ATTRIB_ID>(id);
+                if ((DisabledAttribsMask & (1u << id)) != 0)
+                    continue; // Skip attributes not used by the renderer, e.g. TEXTURE_ATTRIB_ID_PHYS_DESC
 
                 const pxr::TfToken& TexName = PBRTextureAttribIdToPxrName(ID);
                 if (TexName.IsEmpty())
-                    continue; // Skip unrecognized attributes such as TEXTURE_ATTRIB_ID_PHYS_DESC
+                    continue; // Skip unrecognized attributes
 
                 auto tex_it = StandaloneTextures.find(ID);
                 if (tex_it == StandaloneTextures.end())
@@ -993,7 +1231,7 @@ void HnMaterial::UpdateSRB(HnRenderDelegate& RendererDelegate)
 
     if (m_SRB)
     {
-        const auto   PSOFlags                = HnRenderPass::GetMaterialPSOFlags(*this);
+        const auto   PSOFlags                = HnRenderPass::GetMaterialPSOFlags(*this, RendererSettings);
         const Uint32 PBRPrimitiveAttribsSize = UsdRenderer.GetPBRPrimitiveAttribsSize(PSOFlags);
         const Uint32 PrimitiveArraySize      = std::max(UsdRenderer.GetSettings().PrimitiveArraySize, 1u);
         SRBCache->UpdatePrimitiveAttribsBufferRange(m_SRB, PBRPrimitiveAttribsSize * PrimitiveArraySize);
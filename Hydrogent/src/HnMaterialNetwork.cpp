@@ -30,6 +30,7 @@
 #include "DebugUtilities.hpp"
 #include "StringTools.hpp"
 #include "GraphicsAccessories.hpp"
+#include "HashUtils.hpp"
 
 #include "pxr/base/gf/vec3f.h"
 #include "pxr/base/gf/vec4f.h"
@@ -73,6 +74,44 @@ HnMaterialParameter::HnMaterialParameter(
     ArrayOfTexturesSize{_ArrayOfTexturesSize}
 {}
 
+bool HnMaterialParameter::operator==(const HnMaterialParameter& rhs) const
+{
+    // clang-format off
+    return Type                    == rhs.Type &&
+           Name                    == rhs.Name &&
+           FallbackValue           == rhs.FallbackValue &&
+           SamplerCoords           == rhs.SamplerCoords &&
+           TextureType             == rhs.TextureType &&
+           Swizzle                 == rhs.Swizzle &&
+           IsPremultiplied         == rhs.IsPremultiplied &&
+           InputScale              == rhs.InputScale &&
+           InputBias               == rhs.InputBias &&
+           Transform2d.Scale       == rhs.Transform2d.Scale &&
+           Transform2d.Translation == rhs.Transform2d.Translation &&
+           Transform2d.Rotation    == rhs.Transform2d.Rotation &&
+           ArrayOfTexturesSize     == rhs.ArrayOfTexturesSize;
+    // clang-format on
+}
+
+bool HnMaterialNetwork::TextureDescriptor::operator==(const TextureDescriptor& rhs) const
+{
+    const HnSubTextureIdentifier& SubTexId    = TextureId.SubtextureId;
+    const HnSubTextureIdentifier& RhsSubTexId = rhs.TextureId.SubtextureId;
+    // clang-format off
+    return Name                        == rhs.Name &&
+           TextureId.FilePath          == rhs.TextureId.FilePath &&
+           SubTexId.Type               == RhsSubTexId.Type &&
+           SubTexId.IsSRGB             == RhsSubTexId.IsSRGB &&
+           SubTexId.FlipVertically     == RhsSubTexId.FlipVertically &&
+           SubTexId.PremultiplyAlpha   == RhsSubTexId.PremultiplyAlpha &&
+           SubTexId.Swizzle            == RhsSubTexId.Swizzle &&
+           SamplerParams               == rhs.SamplerParams &&
+           MemoryRequest               == rhs.MemoryRequest &&
+           UseTexturePrimToFindTexture == rhs.UseTexturePrimToFindTexture &&
+           TexturePrim                 == rhs.TexturePrim;
+    // clang-format on
+}
+
 // clang-format off
 TF_DEFINE_PRIVATE_TOKENS(
     HnMaterialPrivateTokens,
@@ -1248,6 +1287,60 @@ void HnMaterialNetwork::AddTransform2dParam(const pxr::HdMaterialNetwork2& Netwo
     m_Parameters.emplace_back(GetTransform2dParam(Network, Node, NodePath, pxr::TfToken{ParamName.GetString()}));
 }
 
+bool HnMaterialNetwork::operator==(const HnMaterialNetwork& rhs) const
+{
+    // clang-format off
+    return m_Tag              == rhs.m_Tag &&
+           m_OpacityThreshold == rhs.m_OpacityThreshold &&
+           m_Opacity          == rhs.m_Opacity &&
+           m_Parameters       == rhs.m_Parameters &&
+           m_Textures         == rhs.m_Textures &&
+           m_Metadata         == rhs.m_Metadata;
+    // clang-format on
+}
+
+size_t HnMaterialNetwork::ComputeHash() const
+{
+    // Metadata is not hashed: networks that only differ in metadata are rare,
+    // and operator== resolves the collisions.
+    size_t Hash = Diligent::ComputeHash(m_Tag.Hash(), m_OpacityThreshold, m_Opacity, m_Parameters.size(), m_Textures.size());
+    for (const HnMaterialParameter& Param : m_Parameters)
+    {
+        HashCombine(Hash,
+                    static_cast<int>(Param.Type),
+                    Param.Name.Hash(),
+                    Param.FallbackValue.GetHash(),
+                    static_cast<int>(Param.TextureType),
+                    Param.Swizzle.R, Param.Swizzle.G, Param.Swizzle.B, Param.Swizzle.A,
+                    Param.IsPremultiplied,
+                    Param.InputScale[0], Param.InputScale[1], Param.InputScale[2], Param.InputScale[3],
+                    Param.InputBias[0], Param.InputBias[1], Param.InputBias[2], Param.InputBias[3],
+                    Param.Transform2d.Scale[0], Param.Transform2d.Scale[1],
+                    Param.Transform2d.Translation[0], Param.Transform2d.Translation[1],
+                    Param.Transform2d.Rotation,
+                    Param.ArrayOfTexturesSize);
+        for (const pxr::TfToken& Coord : Param.SamplerCoords)
+            HashCombine(Hash, Coord.Hash());
+    }
+
+    for (const TextureDescriptor& Tex : m_Textures)
+    {
+        const HnSubTextureIdentifier&   SubTexId = Tex.TextureId.SubtextureId;
+        const pxr::HdSamplerParameters& Sampler  = Tex.SamplerParams;
+        HashCombine(Hash,
+                    Tex.Name.Hash(),
+                    Tex.TextureId.FilePath.Hash(),
+                    static_cast<int>(SubTexId.Type),
+                    SubTexId.IsSRGB, SubTexId.FlipVertically, SubTexId.PremultiplyAlpha,
+                    SubTexId.Swizzle.R, SubTexId.Swizzle.G, SubTexId.Swizzle.B, SubTexId.Swizzle.A,
+                    static_cast<int>(Sampler.wrapS), static_cast<int>(Sampler.wrapT), static_cast<int>(Sampler.wrapR),
+                    static_cast<int>(Sampler.minFilter), static_cast<int>(Sampler.magFilter),
+                    Tex.TexturePrim.GetHash());
+    }
+
+    return Hash;
+}
+
 const HnMaterialParameter* HnMaterialNetwork::GetParameter(HnMaterialParameter::ParamType Type, const pxr::TfToken& Name) const
 {
     for (const auto& Param : m_Parameters)
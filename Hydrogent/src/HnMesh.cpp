@@ -33,13 +33,18 @@
 #include "HnRenderPass.hpp"
 #include "HnDrawItem.hpp"
 #include "GfTypeConversions.hpp"
+#include "HnMeshSimplifier.hpp"
+#include "HnMeshBVH.hpp"
+#include "VertexCompression.hpp"
 
 #include "DebugUtilities.hpp"
 #include "GraphicsTypesX.hpp"
 #include "GLTFResourceManager.hpp"
 #include "EngineMemory.h"
+#include "HashUtils.hpp"
 
 #include "pxr/base/gf/vec2f.h"
+#include "pxr/base/vt/types.h"
 #include "pxr/imaging/hd/meshUtil.h"
 #include "pxr/imaging/hd/vtBufferSource.h"
 #include "pxr/imaging/hd/vertexAdjacency.h"
@@ -75,6 +80,18 @@ HnMesh::HnMesh(pxr::TfToken const& typeId,
     Regisgtry.emplace<Components::Visibility>(m_Entity, _sharedData.visible);
 }
 
+struct HnMesh::PickingData
+{
+    // Triangle list indices of the full-resolution mesh. The indices are kept
+    // to rebuild the hierarchy when only the positions change.
+    std::vector<Uint32> Indices;
+
+    // Topology face index of every triangle
+    std::vector<Uint32> FaceIndices;
+
+    HnMeshBVH BVH;
+};
+
 HnMesh::~HnMesh()
 {
 }
@@ -261,6 +278,7 @@ void HnMesh::Invalidate()
 {
     m_StagingVertexData.reset();
     m_StagingIndexData.reset();
+    m_PickingData.reset();
     m_Topology   = {};
     m_VertexData = {};
     m_IndexData  = {};
@@ -311,6 +329,30 @@ void HnMesh::UpdateRepr(pxr::HdSceneDelegate& SceneDelegate,
 
             UpdateConstantPrimvars(SceneDelegate, RenderParam, DirtyBits, ReprToken);
 
+            UpdateBoundingSphere();
+
+            if (RenderParam != nullptr && static_cast<const HnRenderParam*>(RenderParam)->GetEnableRayCastPicking())
+            {
+                // Note that the picking data must be updated before the levels of detail are
+                // generated and the indices are adjusted by the start vertex.
+                UpdatePickingData();
+            }
+
+            if (m_StagingIndexData && RenderParam != nullptr)
+            {
+                // Note that the levels of detail must be generated before the indices are adjusted
+                // by the start vertex in AllocatePooledResources().
+                if (const Uint32 LodCount = static_cast<const HnRenderParam*>(RenderParam)->GetMeshLodCount())
+                    GenerateLods(LodCount);
+            }
+
+            if (RenderParam != nullptr && static_cast<const HnRenderParam*>(RenderParam)->GetCompressVertexNormals())
+            {
+                // Note that the normals must be compressed before the vertex pool allocation
+                // is created as it uses the size of the staging vertex data elements.
+                CompressNormals();
+            }
+
             // Allocate space for vertex and index buffers.
             // Note that this only reserves space, but does not create any buffers.
             AllocatePooledResources(SceneDelegate, RenderParam);
@@ -325,6 +367,12 @@ void HnMesh::UpdateRepr(pxr::HdSceneDelegate& SceneDelegate,
         DirtyBits &= ~pxr::HdChangeTracker::DirtyPrimvar;
     }
 
+    if (TopologyDirty && AnyPrimvarDirty)
+    {
+        // All geometry data has been synced again
+        m_IsEvicted = false;
+    }
+
     if ((TopologyDirty || AnyPrimvarDirty) && RenderParam != nullptr)
     {
         static_cast<HnRenderParam*>(RenderParam)->MakeAttribDirty(HnRenderParam::GlobalAttrib::MeshGeometry);
@@ -412,11 +460,12 @@ void HnMesh::UpdateTopology(pxr::HdSceneDelegate& SceneDelegate,
     m_StagingIndexData = std::make_unique<StagingIndexData>();
 
     pxr::HdMeshUtil MeshUtil{&m_Topology, Id};
-    pxr::VtIntArray PrimitiveParams;
-    MeshUtil.ComputeTriangleIndices(&m_StagingIndexData->TrianglesFaceIndices, &PrimitiveParams, nullptr);
+    MeshUtil.ComputeTriangleIndices(&m_StagingIndexData->TrianglesFaceIndices, &m_StagingIndexData->PrimitiveParams, nullptr);
     MeshUtil.EnumerateEdges(&m_StagingIndexData->MeshEdgeIndices);
     m_IndexData.NumFaceTriangles = static_cast<Uint32>(m_StagingIndexData->TrianglesFaceIndices.size());
     m_IndexData.NumEdges         = static_cast<Uint32>(m_StagingIndexData->MeshEdgeIndices.size());
+    m_IndexData.NumLodTriangles  = 0;
+    m_IndexData.Lods.clear();
 
     DirtyBits &= ~pxr::HdChangeTracker::DirtyTopology;
 }
@@ -668,6 +717,37 @@ void HnMesh::GenerateSmoothNormals()
     }
 }
 
+void HnMesh::CompressNormals()
+{
+    VERIFY_EXPR(m_StagingVertexData);
+
+    auto normals_it = m_StagingVertexData->Sources.find(pxr::HdTokens->normals);
+    if (normals_it == m_StagingVertexData->Sources.end() || !normals_it->second)
+        return;
+
+    const pxr::HdBufferSource& NormalsSource = *normals_it->second;
+    if (NormalsSource.GetTupleType() != pxr::HdTupleType{pxr::HdTypeFloatVec3, 1})
+    {
+        // The input layout expects compressed normals, so the mesh is rendered without normals
+        LOG_WARNING_MESSAGE("Skipping normals of ", GetId(), " because they are not float3 and can't be compressed.");
+        m_StagingVertexData->Sources.erase(normals_it);
+        return;
+    }
+
+    const float3* pNormals   = static_cast<const float3*>(NormalsSource.GetData());
+    const size_t  NumNormals = NormalsSource.GetNumElements();
+
+    // Two octahedral-encoded RG16_SNORM components packed into one 32-bit value
+    pxr::VtIntArray Encoded(NumNormals);
+    for (size_t i = 0; i < NumNormals; ++i)
+        Encoded[i] = static_cast<int>(EncodeOctahedralNormalRG16(pNormals[i]));
+
+    if (auto BufferSource = CreateBufferSource(pxr::HdTokens->normals, pxr::VtValue{Encoded}, NumNormals, GetId()))
+        normals_it->second = std::move(BufferSource);
+    else
+        m_StagingVertexData->Sources.erase(normals_it);
+}
+
 namespace
 {
 
@@ -844,6 +924,236 @@ void HnMesh::ConvertVertexPrimvarSources(FaceSourcesMapType&& FaceSources)
     }
 }
 
+void HnMesh::GenerateLods(Uint32 LodCount)
+{
+    VERIFY_EXPR(m_StagingIndexData && m_StagingVertexData);
+
+    m_IndexData.NumLodTriangles = 0;
+    m_IndexData.Lods.clear();
+
+    // Geometry subsets reference ranges of the full-resolution triangles
+    if (!m_Topology.GetGeomSubsets().empty())
+        return;
+
+    auto points_it = m_StagingVertexData->Sources.find(pxr::HdTokens->points);
+    if (points_it == m_StagingVertexData->Sources.end() || !points_it->second)
+        return;
+
+    const pxr::HdBufferSource& Points = *points_it->second;
+    if (Points.GetTupleType() != pxr::HdTupleType{pxr::HdTypeFloatVec3, 1})
+    {
+        LOG_WARNING_MESSAGE("Skipping LOD generation for ", GetId(), " because its points are not float3 vectors.");
+        return;
+    }
+
+    const float3* pPositions  = static_cast<const float3*>(Points.GetData());
+    const Uint32  NumVertices = static_cast<Uint32>(Points.GetNumElements());
+
+    pxr::VtVec3iArray& Triangles        = m_StagingIndexData->TrianglesFaceIndices;
+    const Uint32       NumFaceTriangles = GetNumFaceTriangles();
+    VERIFY_EXPR(Triangles.size() == NumFaceTriangles);
+
+    // Meshes with few triangles are not worth simplifying
+    constexpr Uint32 MinLodTriangleCount = 64;
+    if (NumFaceTriangles / 4 < MinLodTriangleCount)
+        return;
+
+    // Face-varying primvars unfold the vertices, so every triangle has its own vertices.
+    // Weld vertices whose attributes are all identical to recover the mesh connectivity.
+    auto GetVertexData = [&](const pxr::HdBufferSource& Source, Uint32 v) {
+        const size_t ElementSize = HdDataSizeOfTupleType(Source.GetTupleType());
+        return std::make_pair(static_cast<const Uint8*>(Source.GetData()) + v * ElementSize, ElementSize);
+    };
+
+    std::vector<Uint32> WeldRemap(NumVertices);
+    {
+        std::unordered_map<size_t, Uint32> HashToVertex;
+        HashToVertex.reserve(NumVertices);
+        for (Uint32 v = 0; v < NumVertices; ++v)
+        {
+            size_t Hash = 0;
+            for (const auto& source_it : m_StagingVertexData->Sources)
+            {
+                const auto Data = GetVertexData(*source_it.second, v);
+                HashCombine(Hash, ComputeHashRaw(Data.first, Data.second));
+            }
+
+            const Uint32 FirstVertex = HashToVertex.emplace(Hash, v).first->second;
+
+            bool IsEqual = true;
+            for (const auto& source_it : m_StagingVertexData->Sources)
+            {
+                const auto Data0 = GetVertexData(*source_it.second, FirstVertex);
+                const auto Data1 = GetVertexData(*source_it.second, v);
+                IsEqual          = IsEqual && memcmp(Data0.first, Data1.first, Data0.second) == 0;
+            }
+            WeldRemap[v] = IsEqual ? FirstVertex : v;
+        }
+    }
+
+    // Welded vertices that share the position with other vertices lie on attribute seams
+    // (e.g. texture coordinate or hard normal discontinuities). Lock them to preserve the seams.
+    std::vector<bool> LockedVertices(NumVertices, false);
+    {
+        std::unordered_map<size_t, Uint32> PosHashToVertex;
+        PosHashToVertex.reserve(NumVertices);
+        for (Uint32 v = 0; v < NumVertices; ++v)
+        {
+            if (WeldRemap[v] != v)
+                continue;
+
+            const auto   it_inserted = PosHashToVertex.emplace(ComputeHashRaw(&pPositions[v], sizeof(float3)), v);
+            const Uint32 OtherVertex = it_inserted.first->second;
+            if (!it_inserted.second && pPositions[OtherVertex] == pPositions[v])
+            {
+                LockedVertices[OtherVertex] = true;
+                LockedVertices[v]           = true;
+            }
+        }
+    }
+
+    std::vector<Uint32> Indices(size_t{NumFaceTriangles} * 3);
+    for (size_t i = 0; i < NumFaceTriangles; ++i)
+    {
+        for (size_t v = 0; v < 3; ++v)
+            Indices[i * 3 + v] = WeldRemap[Triangles[i][v]];
+    }
+
+    HnMeshSimplifier Simplifier{pPositions, NumVertices, Indices.data(), static_cast<Uint32>(Indices.size()), std::move(LockedVertices)};
+
+    Uint32 PrevNumTriangles = NumFaceTriangles;
+    for (Uint32 lod = 0; lod < LodCount; ++lod)
+    {
+        // Every level of detail targets a quarter of the triangles of the previous one
+        const Uint32 TargetNumTriangles = PrevNumTriangles / 4;
+        if (TargetNumTriangles < MinLodTriangleCount)
+            break;
+
+        const float                Error        = Simplifier.Simplify(TargetNumTriangles * 3);
+        const std::vector<Uint32>& LodIndices   = Simplifier.GetIndices();
+        const Uint32               NumTriangles = static_cast<Uint32>(LodIndices.size() / 3);
+        if (NumTriangles * 4 > PrevNumTriangles * 3)
+        {
+            // The mesh can't be simplified much further, e.g. because most of its vertices are locked
+            break;
+        }
+
+        LodInfo Lod;
+        Lod.StartTriangle = NumFaceTriangles + m_IndexData.NumLodTriangles;
+        Lod.NumTriangles  = NumTriangles;
+        Lod.Error         = Error;
+        m_IndexData.Lods.push_back(Lod);
+        m_IndexData.NumLodTriangles += NumTriangles;
+
+        for (size_t i = 0; i < LodIndices.size(); i += 3)
+        {
+            Triangles.push_back(pxr::GfVec3i{
+                static_cast<int>(LodIndices[i + 0]),
+                static_cast<int>(LodIndices[i + 1]),
+                static_cast<int>(LodIndices[i + 2]),
+            });
+        }
+
+        PrevNumTriangles = NumTriangles;
+    }
+}
+
+void HnMesh::UpdateBoundingSphere()
+{
+    VERIFY_EXPR(m_StagingVertexData);
+
+    m_BoundingSphere = float4{0, 0, 0, 0};
+
+    auto points_it = m_StagingVertexData->Sources.find(pxr::HdTokens->points);
+    if (points_it == m_StagingVertexData->Sources.end() ||
+        !points_it->second ||
+        points_it->second->GetTupleType() != pxr::HdTupleType{pxr::HdTypeFloatVec3, 1} ||
+        points_it->second->GetNumElements() == 0)
+    {
+        return;
+    }
+
+    const pxr::HdBufferSource& Points      = *points_it->second;
+    const float3*              pPositions  = static_cast<const float3*>(Points.GetData());
+    const size_t               NumVertices = Points.GetNumElements();
+
+    float3 MinPos = pPositions[0];
+    float3 MaxPos = pPositions[0];
+    for (size_t v = 1; v < NumVertices; ++v)
+    {
+        MinPos = std::min(MinPos, pPositions[v]);
+        MaxPos = std::max(MaxPos, pPositions[v]);
+    }
+
+    const float3 Center = (MinPos + MaxPos) * 0.5f;
+    float        Radius = 0;
+    for (size_t v = 0; v < NumVertices; ++v)
+        Radius = std::max(Radius, length(pPositions[v] - Center));
+
+    m_BoundingSphere = float4{Center, Radius};
+}
+
+void HnMesh::UpdatePickingData()
+{
+    VERIFY_EXPR(m_StagingVertexData);
+
+    if (m_StagingIndexData)
+    {
+        if (!m_PickingData)
+            m_PickingData = std::make_unique<PickingData>();
+
+        const pxr::VtVec3iArray& Triangles       = m_StagingIndexData->TrianglesFaceIndices;
+        const pxr::VtIntArray&   PrimitiveParams = m_StagingIndexData->PrimitiveParams;
+
+        const Uint32 NumTriangles = std::min(GetNumFaceTriangles(), static_cast<Uint32>(Triangles.size()));
+        m_PickingData->Indices.resize(size_t{NumTriangles} * 3);
+        m_PickingData->FaceIndices.resize(NumTriangles);
+        for (Uint32 t = 0; t < NumTriangles; ++t)
+        {
+            for (size_t v = 0; v < 3; ++v)
+                m_PickingData->Indices[t * 3 + v] = static_cast<Uint32>(Triangles[t][v]);
+
+            m_PickingData->FaceIndices[t] = t < PrimitiveParams.size() ?
+                static_cast<Uint32>(pxr::HdMeshUtil::DecodeFaceIndexFromCoarseFaceParam(PrimitiveParams[t])) :
+                t;
+        }
+    }
+
+    if (!m_PickingData)
+        return;
+
+    auto points_it = m_StagingVertexData->Sources.find(pxr::HdTokens->points);
+    if (points_it == m_StagingVertexData->Sources.end() ||
+        !points_it->second ||
+        points_it->second->GetTupleType() != pxr::HdTupleType{pxr::HdTypeFloatVec3, 1})
+    {
+        m_PickingData->BVH.Clear();
+        return;
+    }
+
+    const pxr::HdBufferSource& Points = *points_it->second;
+    m_PickingData->BVH.Build(static_cast<const float3*>(Points.GetData()),
+                             static_cast<Uint32>(Points.GetNumElements()),
+                             m_PickingData->Indices.data(),
+                             static_cast<Uint32>(m_PickingData->Indices.size() / 3));
+}
+
+bool HnMesh::RayCast(const float3& Origin, const float3& Direction, float MaxT, RayCastHit& Hit) const
+{
+    if (!m_PickingData)
+        return false;
+
+    HnMeshBVH::Hit BVHHit;
+    if (!m_PickingData->BVH.RayCast(Origin, Direction, MaxT, BVHHit))
+        return false;
+
+    VERIFY_EXPR(BVHHit.Triangle < m_PickingData->FaceIndices.size());
+    Hit.T         = BVHHit.T;
+    Hit.FaceIndex = m_PickingData->FaceIndices[BVHHit.Triangle];
+    Hit.Normal    = BVHHit.Normal;
+    return true;
+}
+
 void HnMesh::AllocatePooledResources(pxr::HdSceneDelegate& SceneDelegate,
                                      pxr::HdRenderParam*   RenderParam)
 {
@@ -852,10 +1162,16 @@ void HnMesh::AllocatePooledResources(pxr::HdSceneDelegate& SceneDelegate,
 
     if (m_StagingVertexData && !m_StagingVertexData->Sources.empty() && static_cast<const HnRenderParam*>(RenderParam)->GetUseVertexPool())
     {
+        // When the vertex data is relocated by the pool compaction, keep the existing
+        // allocation alive until the new one is made so that they don't overlap.
+        RefCntAutoPtr<IVertexPoolAllocation> PrevPoolAllocation;
         if (m_StagingIndexData)
         {
             // The topology has changed: release the existing allocation
-            m_VertexData.PoolAllocation.Release();
+            if (m_RelocateVertexData)
+                PrevPoolAllocation = std::move(m_VertexData.PoolAllocation);
+            else
+                m_VertexData.PoolAllocation.Release();
             m_VertexData.NameToPoolIndex.clear();
         }
 
@@ -865,6 +1181,7 @@ void HnMesh::AllocatePooledResources(pxr::HdSceneDelegate& SceneDelegate,
         {
             GLTF::ResourceManager::VertexLayoutKey VtxKey;
             VtxKey.Elements.reserve(m_StagingVertexData->Sources.size());
+            m_VertexData.PoolVertexSize = 0;
             for (const auto& source_it : m_StagingVertexData->Sources)
             {
                 const pxr::TfToken&                         Name   = source_it.first;
@@ -875,10 +1192,27 @@ void HnMesh::AllocatePooledResources(pxr::HdSceneDelegate& SceneDelegate,
 
                 m_VertexData.NameToPoolIndex[Name] = static_cast<Uint32>(VtxKey.Elements.size());
                 VtxKey.Elements.emplace_back(static_cast<Uint32>(ElementSize), BIND_VERTEX_BUFFER);
+                m_VertexData.PoolVertexSize += static_cast<Uint32>(ElementSize);
             }
 
             m_VertexData.PoolAllocation = ResMgr.AllocateVertices(VtxKey, static_cast<Uint32>(NumVerts));
             VERIFY_EXPR(m_VertexData.PoolAllocation);
+
+            if (PrevPoolAllocation &&
+                m_VertexData.PoolAllocation &&
+                m_VertexData.PoolAllocation->GetPool() == PrevPoolAllocation->GetPool() &&
+                PrevPoolAllocation->GetVertexCount() == NumVerts)
+            {
+                if (m_VertexData.PoolAllocation->GetStartVertex() < PrevPoolAllocation->GetStartVertex())
+                {
+                    RenderDelegate->AddPoolCompactionMovedBytes(0, Uint64{m_VertexData.PoolVertexSize} * NumVerts);
+                }
+                else
+                {
+                    // The new allocation is not closer to the beginning of the pool, so keep the existing one.
+                    m_VertexData.PoolAllocation = std::move(PrevPoolAllocation);
+                }
+            }
         }
         else
         {
@@ -894,6 +1228,7 @@ void HnMesh::AllocatePooledResources(pxr::HdSceneDelegate& SceneDelegate,
             }
 #endif
         }
+        m_RelocateVertexData = false;
 
         // WebGL/GLES do not support base vertex, so we need to adjust indices.
         const Uint32 StartVertex = m_VertexData.PoolAllocation->GetStartVertex();
@@ -941,7 +1276,7 @@ void HnMesh::AllocatePooledResources(pxr::HdSceneDelegate& SceneDelegate,
     {
         if (!m_StagingIndexData->TrianglesFaceIndices.empty())
         {
-            m_IndexData.FaceAllocation = ResMgr.AllocateIndices(sizeof(Uint32) * GetNumFaceTriangles() * 3);
+            m_IndexData.FaceAllocation = ResMgr.AllocateIndices(sizeof(Uint32) * (GetNumFaceTriangles() + m_IndexData.NumLodTriangles) * 3);
             m_IndexData.FaceStartIndex = m_IndexData.FaceAllocation->GetOffset() / sizeof(Uint32);
         }
 
@@ -959,7 +1294,15 @@ void HnMesh::AllocatePooledResources(pxr::HdSceneDelegate& SceneDelegate,
     }
 }
 
-void HnMesh::UpdateVertexBuffers(HnRenderDelegate& RenderDelegate)
+// Pool buffers are shared between all meshes. When commands are recorded into
+// a deferred context, state transitions of shared resources are not thread-safe,
+// so the render delegate transitions the pools to the copy destination state beforehand.
+static RESOURCE_STATE_TRANSITION_MODE GetPoolTransitionMode(IDeviceContext* pCtx)
+{
+    return pCtx->GetDesc().IsDeferred ? RESOURCE_STATE_TRANSITION_MODE_VERIFY : RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+}
+
+void HnMesh::UpdateVertexBuffers(HnRenderDelegate& RenderDelegate, IDeviceContext* pCtx)
 {
     const RenderDeviceX_N& Device{RenderDelegate.GetDevice()};
 
@@ -982,7 +1325,7 @@ void HnMesh::UpdateVertexBuffers(HnRenderDelegate& RenderDelegate)
         if (PrimName == pxr::HdTokens->points)
             VERIFY(ElementType == pxr::HdTypeFloatVec3, "Unexpected vertex size");
         else if (PrimName == pxr::HdTokens->normals)
-            VERIFY(ElementType == pxr::HdTypeFloatVec3, "Unexpected normal size");
+            VERIFY(ElementType == pxr::HdTypeFloatVec3 || ElementType == pxr::HdTypeInt32, "Unexpected normal size");
 
         RefCntAutoPtr<IBuffer> pBuffer;
         if (!m_VertexData.PoolAllocation)
@@ -999,7 +1342,7 @@ void HnMesh::UpdateVertexBuffers(HnRenderDelegate& RenderDelegate)
             pBuffer = Device.CreateBuffer(Desc, &InitData);
 
             StateTransitionDesc Barrier{pBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE};
-            RenderDelegate.GetDeviceContext()->TransitionResourceStates(1, &Barrier);
+            pCtx->TransitionResourceStates(1, &Barrier);
         }
         else
         {
@@ -1008,9 +1351,8 @@ void HnMesh::UpdateVertexBuffers(HnRenderDelegate& RenderDelegate)
             {
                 pBuffer = m_VertexData.PoolAllocation->GetBuffer(idx_it->second);
 
-                IDeviceContext* pCtx = RenderDelegate.GetDeviceContext();
                 VERIFY_EXPR(m_VertexData.PoolAllocation->GetVertexCount() == NumElements);
-                pCtx->UpdateBuffer(pBuffer, m_VertexData.PoolAllocation->GetStartVertex() * ElementSize, NumElements * ElementSize, pSource->GetData(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                pCtx->UpdateBuffer(pBuffer, m_VertexData.PoolAllocation->GetStartVertex() * ElementSize, NumElements * ElementSize, pSource->GetData(), GetPoolTransitionMode(pCtx));
             }
             else
             {
@@ -1024,7 +1366,7 @@ void HnMesh::UpdateVertexBuffers(HnRenderDelegate& RenderDelegate)
     m_StagingVertexData.reset();
 }
 
-void HnMesh::UpdateIndexBuffer(HnRenderDelegate& RenderDelegate)
+void HnMesh::UpdateIndexBuffer(HnRenderDelegate& RenderDelegate, IDeviceContext* pCtx)
 {
     VERIFY_EXPR(m_StagingIndexData);
 
@@ -1034,7 +1376,6 @@ void HnMesh::UpdateIndexBuffer(HnRenderDelegate& RenderDelegate)
                                   IBufferSuballocation* pSuballocation) {
         const std::string Name = GetId().GetString() + " - " + BufferName;
 
-        IDeviceContext* pCtx = RenderDelegate.GetDeviceContext();
         if (pSuballocation == nullptr)
         {
             BufferDesc Desc{
@@ -1057,18 +1398,20 @@ void HnMesh::UpdateIndexBuffer(HnRenderDelegate& RenderDelegate)
         {
             RefCntAutoPtr<IBuffer> pBuffer{pSuballocation->GetBuffer()};
             VERIFY_EXPR(pSuballocation->GetSize() == DataSize);
-            pCtx->UpdateBuffer(pBuffer, pSuballocation->GetOffset(), DataSize, pData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            pCtx->UpdateBuffer(pBuffer, pSuballocation->GetOffset(), DataSize, pData, GetPoolTransitionMode(pCtx));
             return pBuffer;
         }
     };
 
     if (!m_StagingIndexData->TrianglesFaceIndices.empty())
     {
-        VERIFY_EXPR(GetNumFaceTriangles() == static_cast<size_t>(m_StagingIndexData->TrianglesFaceIndices.size()));
+        // Level of detail triangles are stored after the full-resolution triangles
+        const Uint32 NumTriangles = GetNumFaceTriangles() + m_IndexData.NumLodTriangles;
+        VERIFY_EXPR(NumTriangles == static_cast<size_t>(m_StagingIndexData->TrianglesFaceIndices.size()));
         static_assert(sizeof(m_StagingIndexData->TrianglesFaceIndices[0]) == sizeof(Uint32) * 3, "Unexpected triangle data size");
         m_IndexData.Faces = PrepareIndexBuffer("Triangle Index Buffer",
                                                m_StagingIndexData->TrianglesFaceIndices.data(),
-                                               GetNumFaceTriangles() * sizeof(Uint32) * 3,
+                                               NumTriangles * sizeof(Uint32) * 3,
                                                m_IndexData.FaceAllocation);
     }
 
@@ -1173,17 +1516,155 @@ void HnMesh::UpdateDrawItemGpuTopology()
         });
 }
 
-void HnMesh::CommitGPUResources(HnRenderDelegate& RenderDelegate)
+Uint64 HnMesh::GetPooledIndexDataSize() const
+{
+    Uint64 Size = 0;
+    for (IBufferSuballocation* pAllocation : {m_IndexData.FaceAllocation.RawPtr(),
+                                              m_IndexData.EdgeAllocation.RawPtr(),
+                                              m_IndexData.PointsAllocation.RawPtr()})
+    {
+        if (pAllocation != nullptr)
+            Size += pAllocation->GetSize();
+    }
+    return Size;
+}
+
+Uint64 HnMesh::GetPooledVertexDataSize() const
+{
+    return m_VertexData.PoolAllocation ?
+        Uint64{m_VertexData.PoolVertexSize} * m_VertexData.PoolAllocation->GetVertexCount() :
+        0;
+}
+
+Uint32 HnMesh::GetPooledStartVertex() const
+{
+    return m_VertexData.PoolAllocation ? m_VertexData.PoolAllocation->GetStartVertex() : 0;
+}
+
+Uint64 HnMesh::GetGPUGeometrySize() const
+{
+    Uint64 Size = GetPooledIndexDataSize() + GetPooledVertexDataSize();
+
+    if (!m_VertexData.PoolAllocation)
+    {
+        for (const auto& buffer_it : m_VertexData.Buffers)
+        {
+            if (buffer_it.second)
+                Size += buffer_it.second->GetDesc().Size;
+        }
+    }
+
+    auto AddIndexBufferSize = [&Size](IBuffer* pBuffer, IBufferSuballocation* pAllocation) {
+        // Pooled allocations are accounted for by GetPooledIndexDataSize()
+        if (pBuffer != nullptr && pAllocation == nullptr)
+            Size += pBuffer->GetDesc().Size;
+    };
+    AddIndexBufferSize(m_IndexData.Faces, m_IndexData.FaceAllocation);
+    AddIndexBufferSize(m_IndexData.Edges, m_IndexData.EdgeAllocation);
+    AddIndexBufferSize(m_IndexData.Points, m_IndexData.PointsAllocation);
+
+    return Size;
+}
+
+Uint64 HnMesh::EvictGPUResources()
+{
+    if (m_IsEvicted || HasPendingGPUResources())
+        return 0;
+
+    const Uint64 Size = GetGPUGeometrySize();
+
+    // Keep the topology so that the mesh can be restored when it is synced again
+    m_VertexData = {};
+    m_IndexData  = {};
+    m_IsEvicted  = true;
+
+    // Draw items with no topology are skipped by the render pass
+    UpdateDrawItemGpuTopology();
+    ProcessDrawItems(
+        [](HnDrawItem& DrawItem) {
+            DrawItem.SetGeometryData({});
+        },
+        [](const pxr::HdGeomSubset& Subset, HnDrawItem& DrawItem) {
+            DrawItem.SetGeometryData({});
+        });
+    ++m_GeometryVersion;
+
+    return Size;
+}
+
+Uint64 HnMesh::CompactIndexData(HnRenderDelegate& RenderDelegate, IBuffer* pScratchBuffer)
 {
     if (m_StagingIndexData)
     {
-        UpdateIndexBuffer(RenderDelegate);
+        // Index data has not been uploaded yet
+        return 0;
+    }
+
+    GLTF::ResourceManager& ResMgr = RenderDelegate.GetResourceManager();
+    IDeviceContext*        pCtx   = RenderDelegate.GetDeviceContext();
+
+    Uint64 MovedBytes = 0;
+
+    auto MoveAllocation = [&](RefCntAutoPtr<IBufferSuballocation>& Allocation, Uint32& StartIndex) {
+        if (!Allocation)
+            return;
+
+        const Uint32 Size = Allocation->GetSize();
+        VERIFY_EXPR(pScratchBuffer != nullptr && pScratchBuffer->GetDesc().Size >= Size);
+
+        RefCntAutoPtr<IBufferSuballocation> NewAllocation = ResMgr.AllocateIndices(Size);
+        // Only move the data if the new region is closer to the beginning of the pool.
+        // Note that in this case the new region is guaranteed to be within the existing buffer,
+        // so the buffer does not need to be resized.
+        if (!NewAllocation || NewAllocation->GetOffset() >= Allocation->GetOffset())
+            return;
+
+        // Source and destination regions are in the same buffer that can't be in
+        // copy source and copy destination states at the same time, so copy through
+        // the scratch buffer.
+        IBuffer* pIndexBuffer = Allocation->GetBuffer();
+        VERIFY_EXPR(pIndexBuffer == NewAllocation->GetBuffer());
+        pCtx->CopyBuffer(pIndexBuffer, Allocation->GetOffset(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                         pScratchBuffer, 0, Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        pCtx->CopyBuffer(pScratchBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                         pIndexBuffer, NewAllocation->GetOffset(), Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        // The old region is released here, but it will not be overwritten before
+        // the copy is executed as all commands are recorded into the same context.
+        Allocation = std::move(NewAllocation);
+        StartIndex = static_cast<Uint32>(Allocation->GetOffset() / sizeof(Uint32));
+        MovedBytes += Size;
+    };
+
+    MoveAllocation(m_IndexData.FaceAllocation, m_IndexData.FaceStartIndex);
+    MoveAllocation(m_IndexData.EdgeAllocation, m_IndexData.EdgeStartIndex);
+    MoveAllocation(m_IndexData.PointsAllocation, m_IndexData.PointsStartIndex);
+
+    if (MovedBytes > 0)
+    {
+        UpdateDrawItemGpuTopology();
+        ++m_GeometryVersion;
+    }
+
+    return MovedBytes;
+}
+
+void HnMesh::CommitGPUResources(HnRenderDelegate& RenderDelegate, IDeviceContext* pCtx)
+{
+    VERIFY_EXPR(pCtx != nullptr);
+
+    // Prevent the mesh from being evicted before it is rendered for the first time
+    m_LastVisibleFrame.store(static_cast<const HnRenderParam*>(RenderDelegate.GetRenderParam())->GetFrameNumber());
+
+    if (m_StagingIndexData)
+    {
+        UpdateIndexBuffer(RenderDelegate, pCtx);
         UpdateDrawItemGpuTopology();
     }
 
     if (m_StagingVertexData)
     {
-        UpdateVertexBuffers(RenderDelegate);
+        UpdateVertexBuffers(RenderDelegate, pCtx);
         UpdateDrawItemGpuGeometry(RenderDelegate);
     }
 }
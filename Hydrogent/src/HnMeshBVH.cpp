@@ -0,0 +1,250 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include "HnMeshBVH.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+static constexpr Uint32 MaxLeafTriangles = 4;
+
+void HnMeshBVH::Clear()
+{
+    m_Positions.clear();
+    m_Triangles.clear();
+    m_Nodes.clear();
+}
+
+void HnMeshBVH::Build(const float3* pPositions,
+                      Uint32        NumVertices,
+                      const Uint32* pIndices,
+                      Uint32        NumTriangles)
+{
+    Clear();
+
+    m_Positions.assign(pPositions, pPositions + NumVertices);
+
+    std::vector<Triangle> Triangles;
+    Triangles.reserve(NumTriangles);
+    for (Uint32 t = 0; t < NumTriangles; ++t)
+    {
+        const Uint32* Idx = pIndices + size_t{t} * 3;
+        if (Idx[0] >= NumVertices || Idx[1] >= NumVertices || Idx[2] >= NumVertices)
+            continue;
+
+        Triangles.push_back({{Idx[0], Idx[1], Idx[2]}, t});
+    }
+    if (Triangles.empty())
+    {
+        m_Positions.clear();
+        return;
+    }
+
+    std::vector<float3> Centroids(Triangles.size());
+    for (size_t t = 0; t < Triangles.size(); ++t)
+    {
+        const Uint32* Idx = Triangles[t].Indices;
+        Centroids[t]      = (m_Positions[Idx[0]] + m_Positions[Idx[1]] + m_Positions[Idx[2]]) / 3.f;
+    }
+
+    m_Triangles = std::move(Triangles);
+    m_Nodes.reserve(m_Triangles.size() / MaxLeafTriangles * 2 + 1);
+    BuildNode(0, static_cast<Uint32>(m_Triangles.size()), Centroids);
+}
+
+Uint32 HnMeshBVH::BuildNode(Uint32 FirstTriangle, Uint32 NumTriangles, std::vector<float3>& Centroids)
+{
+    VERIFY_EXPR(NumTriangles > 0);
+
+    const Uint32 NodeIdx = static_cast<Uint32>(m_Nodes.size());
+    m_Nodes.emplace_back();
+
+    float3 BoundsMin{+FLT_MAX, +FLT_MAX, +FLT_MAX};
+    float3 BoundsMax{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    float3 CentroidMin = BoundsMin;
+    float3 CentroidMax = BoundsMax;
+    for (Uint32 t = FirstTriangle; t < FirstTriangle + NumTriangles; ++t)
+    {
+        for (Uint32 Idx : m_Triangles[t].Indices)
+        {
+            BoundsMin = std::min(BoundsMin, m_Positions[Idx]);
+            BoundsMax = std::max(BoundsMax, m_Positions[Idx]);
+        }
+        CentroidMin = std::min(CentroidMin, Centroids[t]);
+        CentroidMax = std::max(CentroidMax, Centroids[t]);
+    }
+    m_Nodes[NodeIdx].BoundsMin = BoundsMin;
+    m_Nodes[NodeIdx].BoundsMax = BoundsMax;
+
+    const float3 Extent = CentroidMax - CentroidMin;
+    const int    Axis   = (Extent.x >= Extent.y && Extent.x >= Extent.z) ? 0 : (Extent.y >= Extent.z ? 1 : 2);
+    if (NumTriangles <= MaxLeafTriangles || Extent[Axis] <= 0)
+    {
+        m_Nodes[NodeIdx].Offset       = FirstTriangle;
+        m_Nodes[NodeIdx].NumTriangles = NumTriangles;
+        return NodeIdx;
+    }
+
+    // Split the triangles at the median centroid along the longest axis.
+    // Triangles and their centroids are reordered together.
+    std::vector<Uint32> Order(NumTriangles);
+    for (Uint32 i = 0; i < NumTriangles; ++i)
+        Order[i] = FirstTriangle + i;
+
+    const Uint32 NumLeft = NumTriangles / 2;
+    std::nth_element(Order.begin(), Order.begin() + NumLeft, Order.end(),
+                     [&Centroids, Axis](Uint32 t0, Uint32 t1) {
+                         return Centroids[t0][Axis] < Centroids[t1][Axis];
+                     });
+    {
+        std::vector<Triangle> Triangles(NumTriangles);
+        std::vector<float3>   TriCentroids(NumTriangles);
+        for (Uint32 i = 0; i < NumTriangles; ++i)
+        {
+            Triangles[i]    = m_Triangles[Order[i]];
+            TriCentroids[i] = Centroids[Order[i]];
+        }
+        std::copy(Triangles.begin(), Triangles.end(), m_Triangles.begin() + FirstTriangle);
+        std::copy(TriCentroids.begin(), TriCentroids.end(), Centroids.begin() + FirstTriangle);
+    }
+
+    // The first child immediately follows the node
+    BuildNode(FirstTriangle, NumLeft, Centroids);
+    const Uint32 SecondChild = BuildNode(FirstTriangle + NumLeft, NumTriangles - NumLeft, Centroids);
+
+    m_Nodes[NodeIdx].Offset       = SecondChild;
+    m_Nodes[NodeIdx].NumTriangles = 0;
+    return NodeIdx;
+}
+
+static bool IntersectBounds(const float3& BoundsMin,
+                            const float3& BoundsMax,
+                            const float3& Origin,
+                            const float3& InvDirection,
+                            float         MaxT)
+{
+    float TMin = 0;
+    float TMax = MaxT;
+    for (int i = 0; i < 3; ++i)
+    {
+        float t0 = (BoundsMin[i] - Origin[i]) * InvDirection[i];
+        float t1 = (BoundsMax[i] - Origin[i]) * InvDirection[i];
+        if (t0 > t1)
+            std::swap(t0, t1);
+
+        // Comparisons with NaN (0 * inf when the origin lies on the slab plane)
+        // are false, so such slabs do not restrict the interval.
+        TMin = t0 > TMin ? t0 : TMin;
+        TMax = t1 < TMax ? t1 : TMax;
+        if (TMin > TMax)
+            return false;
+    }
+    return true;
+}
+
+bool HnMeshBVH::RayCast(const float3& Origin, const float3& Direction, float MaxT, Hit& Result) const
+{
+    if (m_Nodes.empty())
+        return false;
+
+    const float3 InvDirection{1.f / Direction.x, 1.f / Direction.y, 1.f / Direction.z};
+
+    // Median splits produce a balanced tree, so the depth never exceeds log2 of the triangle count
+    std::array<Uint32, 64> Stack;
+
+    Uint32 StackSize   = 0;
+    Stack[StackSize++] = 0;
+
+    bool IntersectionFound = false;
+    while (StackSize > 0)
+    {
+        const Uint32 NodeIdx = Stack[--StackSize];
+        const Node&  N       = m_Nodes[NodeIdx];
+        if (!IntersectBounds(N.BoundsMin, N.BoundsMax, Origin, InvDirection, MaxT))
+            continue;
+
+        if (N.NumTriangles == 0)
+        {
+            VERIFY_EXPR(StackSize + 2 <= Stack.size());
+            Stack[StackSize++] = N.Offset;
+            Stack[StackSize++] = NodeIdx + 1;
+            continue;
+        }
+
+        for (Uint32 t = N.Offset; t < N.Offset + N.NumTriangles; ++t)
+        {
+            const Triangle& Tri = m_Triangles[t];
+            const float3&   p0  = m_Positions[Tri.Indices[0]];
+            const float3&   p1  = m_Positions[Tri.Indices[1]];
+            const float3&   p2  = m_Positions[Tri.Indices[2]];
+
+            // Moller-Trumbore ray-triangle intersection
+            const float3 E1  = p1 - p0;
+            const float3 E2  = p2 - p0;
+            const float3 P   = cross(Direction, E2);
+            const float  Det = dot(E1, P);
+            if (Det == 0)
+                continue;
+
+            const float  InvDet = 1.f / Det;
+            const float3 T      = Origin - p0;
+            const float  u      = dot(T, P) * InvDet;
+            if (u < 0 || u > 1)
+                continue;
+
+            const float3 Q = cross(T, E1);
+            const float  v = dot(Direction, Q) * InvDet;
+            if (v < 0 || u + v > 1)
+                continue;
+
+            const float HitT = dot(E2, Q) * InvDet;
+            if (HitT < 0 || HitT > MaxT)
+                continue;
+
+            MaxT              = HitT;
+            Result.T          = HitT;
+            Result.Triangle   = Tri.SourceIndex;
+            Result.Normal     = cross(E1, E2);
+            IntersectionFound = true;
+        }
+    }
+
+    return IntersectionFound;
+}
+
+} // namespace USD
+
+} // namespace Diligent
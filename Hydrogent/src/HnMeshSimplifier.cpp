@@ -0,0 +1,315 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include "HnMeshSimplifier.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <limits>
+#include <cmath>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+static Uint64 MakeEdgeKey(Uint32 v0, Uint32 v1)
+{
+    return v0 < v1 ?
+        (Uint64{v0} << Uint64{32}) | Uint64{v1} :
+        (Uint64{v1} << Uint64{32}) | Uint64{v0};
+}
+
+HnMeshSimplifier::Quadric& HnMeshSimplifier::Quadric::operator+=(const Quadric& rhs)
+{
+    for (size_t i = 0; i < q.size(); ++i)
+        q[i] += rhs.q[i];
+    w += rhs.w;
+    return *this;
+}
+
+double HnMeshSimplifier::Quadric::Evaluate(const float3& Pos) const
+{
+    const double x = Pos.x;
+    const double y = Pos.y;
+    const double z = Pos.z;
+
+    // clang-format off
+    return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z +
+                              q[3] * y * y + 2 * q[4] * y * z +
+                                                 q[5] * z * z +
+           2 * (q[6] * x + q[7] * y + q[8] * z) +
+           q[9];
+    // clang-format on
+}
+
+double HnMeshSimplifier::GetCollapseError(const Quadric& Q, const float3& Pos)
+{
+    // Normalize the error by the total area of the planes so that it
+    // approximates the squared distance to the surface.
+    return Q.w > 0 ? std::max(Q.Evaluate(Pos), 0.0) / Q.w : 0.0;
+}
+
+HnMeshSimplifier::HnMeshSimplifier(const float3*     pPositions,
+                                   Uint32            NumVertices,
+                                   const Uint32*     pIndices,
+                                   Uint32            NumIndices,
+                                   std::vector<bool> LockedVertices) :
+    m_pPositions{pPositions},
+    m_NumVertices{NumVertices},
+    m_Quadrics(NumVertices),
+    m_LockedVertices{std::move(LockedVertices)}
+{
+    VERIFY(NumIndices % 3 == 0, "The number of indices (", NumIndices, ") must be a multiple of 3");
+    VERIFY(m_LockedVertices.empty() || m_LockedVertices.size() == NumVertices, "The number of locked vertex flags must be equal to the number of vertices");
+
+    m_LockedVertices.resize(NumVertices, false);
+
+    m_Indices.reserve(NumIndices);
+    for (Uint32 i = 0; i + 2 < NumIndices; i += 3)
+    {
+        const Uint32 Tri[] = {pIndices[i + 0], pIndices[i + 1], pIndices[i + 2]};
+        if (Tri[0] >= NumVertices || Tri[1] >= NumVertices || Tri[2] >= NumVertices)
+        {
+            UNEXPECTED("Vertex index is out of range");
+            continue;
+        }
+        // Skip degenerate triangles
+        if (Tri[0] == Tri[1] || Tri[1] == Tri[2] || Tri[2] == Tri[0])
+            continue;
+
+        m_Indices.insert(m_Indices.end(), std::begin(Tri), std::end(Tri));
+
+        const float3& p0 = pPositions[Tri[0]];
+        const float3& p1 = pPositions[Tri[1]];
+        const float3& p2 = pPositions[Tri[2]];
+
+        float3      Normal = cross(p1 - p0, p2 - p0);
+        const float Area2  = length(Normal);
+        if (Area2 == 0)
+            continue;
+        Normal /= Area2;
+
+        const double a = Normal.x;
+        const double b = Normal.y;
+        const double c = Normal.z;
+        const double d = -dot(Normal, p0);
+        const double w = Area2 * 0.5;
+
+        Quadric Q;
+        Q.q = {a * a * w, a * b * w, a * c * w, b * b * w, b * c * w, c * c * w, a * d * w, b * d * w, c * d * w, d * d * w};
+        Q.w = w;
+        for (Uint32 v : Tri)
+            m_Quadrics[v] += Q;
+    }
+}
+
+void HnMeshSimplifier::UpdateAdjacency()
+{
+    m_AdjacencyOffsets.assign(size_t{m_NumVertices} + 1, 0);
+    for (Uint32 Idx : m_Indices)
+        ++m_AdjacencyOffsets[Idx + 1];
+    for (Uint32 v = 0; v < m_NumVertices; ++v)
+        m_AdjacencyOffsets[v + 1] += m_AdjacencyOffsets[v];
+
+    std::vector<Uint32> WritePos{m_AdjacencyOffsets.begin(), m_AdjacencyOffsets.end() - 1};
+    m_AdjacentTriangles.resize(m_Indices.size());
+    for (size_t i = 0; i < m_Indices.size(); ++i)
+        m_AdjacentTriangles[WritePos[m_Indices[i]]++] = static_cast<Uint32>(i / 3);
+}
+
+bool HnMeshSimplifier::IsCollapseValid(Uint32 Vert, Uint32 NewVert) const
+{
+    const float3& NewPos = m_pPositions[NewVert];
+    for (Uint32 t = m_AdjacencyOffsets[Vert]; t < m_AdjacencyOffsets[Vert + 1]; ++t)
+    {
+        const Uint32* Tri = &m_Indices[size_t{m_AdjacentTriangles[t]} * 3];
+        if (Tri[0] == NewVert || Tri[1] == NewVert || Tri[2] == NewVert)
+        {
+            // The triangle is removed by the collapse
+            continue;
+        }
+
+        float3 Pos[] = {m_pPositions[Tri[0]], m_pPositions[Tri[1]], m_pPositions[Tri[2]]};
+
+        const float3 OldNormal = cross(Pos[1] - Pos[0], Pos[2] - Pos[0]);
+        for (Uint32 v = 0; v < 3; ++v)
+        {
+            if (Tri[v] == Vert)
+                Pos[v] = NewPos;
+        }
+        const float3 NewNormal = cross(Pos[1] - Pos[0], Pos[2] - Pos[0]);
+
+        // Reject collapses that flip or degenerate the triangle
+        if (dot(OldNormal, NewNormal) <= 0)
+            return false;
+    }
+
+    return true;
+}
+
+float HnMeshSimplifier::Simplify(Uint32 TargetIndexCount)
+{
+    struct Collapse
+    {
+        Uint32 From;
+        Uint32 To;
+        double Error;
+
+        bool operator<(const Collapse& rhs) const
+        {
+            // Edge iteration order is not deterministic, so use vertex indices to break ties
+            if (Error != rhs.Error)
+                return Error < rhs.Error;
+            return From != rhs.From ? From < rhs.From : To < rhs.To;
+        }
+    };
+    std::vector<Collapse> Collapses;
+
+    std::unordered_map<Uint64, Uint32> EdgeUseCounts;
+
+    std::vector<bool>   LockedVertices;
+    std::vector<bool>   TouchedVertices;
+    std::vector<Uint32> Remap(m_NumVertices);
+
+    // Every pass collapses a set of independent edges, i.e. edges whose
+    // neighborhoods do not overlap, in the order of increasing error.
+    while (m_Indices.size() > TargetIndexCount)
+    {
+        UpdateAdjacency();
+
+        EdgeUseCounts.clear();
+        EdgeUseCounts.reserve(m_Indices.size());
+        for (size_t i = 0; i < m_Indices.size(); i += 3)
+        {
+            for (size_t e = 0; e < 3; ++e)
+                ++EdgeUseCounts[MakeEdgeKey(m_Indices[i + e], m_Indices[i + (e + 1) % 3])];
+        }
+
+        // Lock vertices of border and non-manifold edges
+        LockedVertices = m_LockedVertices;
+        for (const auto& it : EdgeUseCounts)
+        {
+            if (it.second != 2)
+            {
+                LockedVertices[static_cast<Uint32>(it.first >> Uint64{32})] = true;
+                LockedVertices[static_cast<Uint32>(it.first & Uint64{0xFFFFFFFFu})] = true;
+            }
+        }
+
+        Collapses.clear();
+        for (const auto& it : EdgeUseCounts)
+        {
+            const Uint32 v0 = static_cast<Uint32>(it.first >> Uint64{32});
+            const Uint32 v1 = static_cast<Uint32>(it.first & Uint64{0xFFFFFFFFu});
+            if (LockedVertices[v0] && LockedVertices[v1])
+                continue;
+
+            Quadric Q = m_Quadrics[v0];
+            Q += m_Quadrics[v1];
+
+            constexpr double MaxError = std::numeric_limits<double>::max();
+
+            const double Error01 = !LockedVertices[v0] ? GetCollapseError(Q, m_pPositions[v1]) : MaxError;
+            const double Error10 = !LockedVertices[v1] ? GetCollapseError(Q, m_pPositions[v0]) : MaxError;
+            if (Error01 <= Error10)
+                Collapses.push_back({v0, v1, Error01});
+            else
+                Collapses.push_back({v1, v0, Error10});
+        }
+        if (Collapses.empty())
+            break;
+
+        std::sort(Collapses.begin(), Collapses.end());
+
+        for (Uint32 v = 0; v < m_NumVertices; ++v)
+            Remap[v] = v;
+        TouchedVertices.assign(m_NumVertices, false);
+
+        const size_t TrianglesToRemove = m_Indices.size() / 3 - TargetIndexCount / 3;
+
+        size_t RemovedTriangles = 0;
+        for (const Collapse& C : Collapses)
+        {
+            if (RemovedTriangles >= TrianglesToRemove)
+                break;
+
+            if (TouchedVertices[C.From] || TouchedVertices[C.To])
+                continue;
+
+            if (!IsCollapseValid(C.From, C.To))
+                continue;
+
+            Remap[C.From] = C.To;
+            m_Quadrics[C.To] += m_Quadrics[C.From];
+            m_MaxCollapseError = std::max(m_MaxCollapseError, C.Error);
+
+            // Lock the neighborhood of the collapsed vertex for the rest of the pass
+            for (Uint32 t = m_AdjacencyOffsets[C.From]; t < m_AdjacencyOffsets[C.From + 1]; ++t)
+            {
+                const Uint32* Tri = &m_Indices[size_t{m_AdjacentTriangles[t]} * 3];
+
+                bool IsRemoved = false;
+                for (Uint32 v = 0; v < 3; ++v)
+                {
+                    TouchedVertices[Tri[v]] = true;
+                    IsRemoved               = IsRemoved || Tri[v] == C.To;
+                }
+                if (IsRemoved)
+                    ++RemovedTriangles;
+            }
+        }
+        if (RemovedTriangles == 0)
+            break;
+
+        // Apply the collapses and remove degenerate triangles
+        size_t NumIndices = 0;
+        for (size_t i = 0; i < m_Indices.size(); i += 3)
+        {
+            const Uint32 v0 = Remap[m_Indices[i + 0]];
+            const Uint32 v1 = Remap[m_Indices[i + 1]];
+            const Uint32 v2 = Remap[m_Indices[i + 2]];
+            if (v0 == v1 || v1 == v2 || v2 == v0)
+                continue;
+
+            m_Indices[NumIndices++] = v0;
+            m_Indices[NumIndices++] = v1;
+            m_Indices[NumIndices++] = v2;
+        }
+        m_Indices.resize(NumIndices);
+    }
+
+    m_Error = static_cast<float>(std::sqrt(m_MaxCollapseError));
+    return m_Error;
+}
+
+} // namespace USD
+
+} // namespace Diligent
@@ -33,6 +33,11 @@
 #include "HnRenderParam.hpp"
 #include "HnFrameRenderTargets.hpp"
 #include "HnShadowMapManager.hpp"
+#include "HnParallelCommandRecorder.hpp"
+#include "HnGeometryResidency.hpp"
+
+#include <algorithm>
+#include <array>
 
 #include "DebugUtilities.hpp"
 #include "GraphicsUtilities.h"
@@ -40,6 +45,8 @@
 #include "Align.hpp"
 #include "PlatformMisc.hpp"
 #include "GLTFResourceManager.hpp"
+#include "HashUtils.hpp"
+#include "AdvancedMath.hpp"
 
 #include "pxr/imaging/hd/material.h"
 
@@ -109,8 +116,9 @@ static std::shared_ptr<USD_Renderer> CreateUSDRenderer(const HnRenderDelegate::C
 
     // Disable animation
     USDRendererCI.MaxJointCount = 0;
-    // Use separate textures for metallic and roughness
-    USDRendererCI.UseSeparateMetallicRoughnessTextures = true;
+    // Use separate textures for metallic and roughness, unless HnMaterial packs them
+    // into the physical descriptor map.
+    USDRendererCI.UseSeparateMetallicRoughnessTextures = !RenderDelegateCI.PackMaterialTextures;
     // Default textures will be provided by the texture registry
     USDRendererCI.CreateDefaultTextures = false;
     // Enable clear coat support
@@ -185,12 +193,29 @@ static std::shared_ptr<USD_Renderer> CreateUSDRenderer(const HnRenderDelegate::C
             {3, 3, 2, VT_FLOAT32}, //float2 UV1     : ATTRIB3;
         };
 
+    // Normals are encoded by HnMesh::CompressNormals()
+    static constexpr LayoutElement CompressedNormalInputs[] =
+        {
+            {0, 0, 3, VT_FLOAT32},       //float3 Pos     : ATTRIB0;
+            {1, 1, 2, VT_INT16, True},   //float2 Normal  : ATTRIB1; Octahedral, RG16_SNORM
+            {2, 2, 2, VT_FLOAT32},       //float2 UV0     : ATTRIB2;
+            {3, 3, 2, VT_FLOAT32},       //float2 UV1     : ATTRIB3;
+        };
+
     const auto& DeviceInfo = RenderDelegateCI.pDevice->GetDeviceInfo();
     if (DeviceInfo.Features.NativeMultiDraw && (DeviceInfo.IsVulkanDevice() || DeviceInfo.IsGLDevice()))
         USDRendererCI.PrimitiveArraySize = RenderDelegateCI.MultiDrawBatchSize;
 
-    USDRendererCI.InputLayout.LayoutElements = Inputs;
-    USDRendererCI.InputLayout.NumElements    = _countof(Inputs);
+    if (RenderDelegateCI.CompressVertexNormals)
+    {
+        USDRendererCI.InputLayout.LayoutElements = CompressedNormalInputs;
+        USDRendererCI.InputLayout.NumElements    = _countof(CompressedNormalInputs);
+    }
+    else
+    {
+        USDRendererCI.InputLayout.LayoutElements = Inputs;
+        USDRendererCI.InputLayout.NumElements    = _countof(Inputs);
+    }
 
     USDRendererCI.pPrimitiveAttribsCB = pPrimitiveAttribsCB;
 
@@ -260,6 +285,26 @@ static RefCntAutoPtr<GLTF::ResourceManager> CreateResourceManager(const HnRender
     return GLTF::ResourceManager::Create(CI.pDevice, ResMgrCI);
 }
 
+static std::unique_ptr<HnParallelCommandRecorder> CreateCommandRecorder(const HnRenderDelegate::CreateInfo& CI)
+{
+    if (CI.pThreadPool == nullptr || CI.NumDeferredContexts == 0)
+        return std::make_unique<HnParallelCommandRecorder>();
+
+    if (CI.ppDeferredContexts == nullptr)
+    {
+        LOG_ERROR_MESSAGE("ppDeferredContexts must not be null when NumDeferredContexts (", CI.NumDeferredContexts, ") is not zero");
+        return std::make_unique<HnParallelCommandRecorder>();
+    }
+
+    if (!CI.pDevice->GetDeviceInfo().Features.MultithreadedResourceCreation)
+    {
+        LOG_WARNING_MESSAGE("This device does not support multithreaded resource creation. Resource upload commands will be recorded serially.");
+        return std::make_unique<HnParallelCommandRecorder>();
+    }
+
+    return std::make_unique<HnParallelCommandRecorder>(CI.pThreadPool, CI.pContext, CI.ppDeferredContexts, CI.NumDeferredContexts);
+}
+
 static std::unique_ptr<HnShadowMapManager> CreateShadowMapManager(const HnRenderDelegate::CreateInfo& CI)
 {
     if (!CI.EnableShadows)
@@ -277,9 +322,14 @@ HnRenderDelegate::HnRenderDelegate(const CreateInfo& CI) :
     m_PrimitiveAttribsCB{CreatePrimitiveAttribsCB(CI.pDevice)},
     m_MaterialSRBCache{HnMaterial::CreateSRBCache()},
     m_USDRenderer{CreateUSDRenderer(CI, m_PrimitiveAttribsCB, m_MaterialSRBCache)},
-    m_TextureRegistry{CI.pDevice, CI.TextureAtlasDim != 0 ? m_ResourceMgr : RefCntAutoPtr<GLTF::ResourceManager>{}},
-    m_RenderParam{std::make_unique<HnRenderParam>(CI.UseVertexPool, CI.UseIndexPool, CI.TextureBindingMode, CI.MetersPerUnit)},
-    m_ShadowMapManager{CreateShadowMapManager(CI)}
+    m_TextureRegistry{CI.pDevice, CI.TextureAtlasDim != 0 ? m_ResourceMgr : RefCntAutoPtr<GLTF::ResourceManager>{}, CI.AsyncTextureLoading ? CI.pThreadPool : nullptr, CI.EnableTextureStreaming, CI.TextureStreamingBudget,
+                      CI.CompressTextures, CI.CompressedTextureCacheDir != nullptr ? CI.CompressedTextureCacheDir : "",
+                      CI.AtlasDefragmentationThreshold, CI.AtlasDefragmentationBudget},
+    m_RenderParam{std::make_unique<HnRenderParam>(CI.UseVertexPool, CI.UseIndexPool, CI.TextureBindingMode, CI.MetersPerUnit, std::min(CI.MeshLodCount, 4u), CI.EnableRayCastPicking, CI.CompressVertexNormals)},
+    m_ShadowMapManager{CreateShadowMapManager(CI)},
+    m_CommandRecorder{CreateCommandRecorder(CI)},
+    m_PoolCompaction{CI.PoolCompactionThreshold, CI.PoolCompactionBudget},
+    m_GeometryResidency{CI.GeometryMemoryBudget}
 {
     const Uint32 ConstantBufferOffsetAlignment = m_pDevice->GetAdapterInfo().Buffer.ConstantBufferOffsetAlignment;
 
@@ -295,6 +345,10 @@ HnRenderDelegate::HnRenderDelegate(const CreateInfo& CI) :
         USAGE_DEFAULT);
 
     m_RenderParam->SetUseShadows(CI.EnableShadows);
+    m_RenderParam->SetMeshLodErrorThreshold(CI.MeshLodErrorThreshold);
+    SetShadowCascadeCount(CI.ShadowCascadeCount);
+    SetShadowCascadePartitioning(CI.ShadowCascadePartitioning);
+    SetShadowCascadeBlendRange(CI.ShadowCascadeBlendRange);
 }
 
 HnRenderDelegate::~HnRenderDelegate()
@@ -377,6 +431,9 @@ void HnRenderDelegate::DestroyRprim(pxr::HdRprim* rPrim)
         std::lock_guard<std::mutex> Guard{m_MeshesMtx};
         m_EcsRegistry.destroy(pMesh->GetEntity());
         m_Meshes.erase(pMesh);
+
+        auto& Queue = m_PoolCompaction.Queue;
+        Queue.erase(std::remove(Queue.begin(), Queue.end(), pMesh), Queue.end());
     }
     delete rPrim;
 }
@@ -452,6 +509,8 @@ void HnRenderDelegate::DestroySprim(pxr::HdSprim* SPrim)
 {
     if (dynamic_cast<HnMaterial*>(SPrim) != nullptr)
     {
+        UnregisterMaterialNetwork(*static_cast<HnMaterial*>(SPrim));
+
         std::lock_guard<std::mutex> Guard{m_MaterialsMtx};
         m_Materials.erase(static_cast<HnMaterial*>(SPrim));
     }
@@ -484,17 +543,107 @@ pxr::HdBprim* HnRenderDelegate::CreateFallbackBprim(pxr::TfToken const& typeId)
     return nullptr;
 }
 
+const HnMaterial* HnRenderDelegate::FindEquivalentMaterial(const HnMaterialNetwork& Network, size_t NetworkHash)
+{
+    std::lock_guard<std::mutex> Guard{m_MaterialsMtx};
+
+    auto it = m_MaterialsByNetworkHash.find(NetworkHash);
+    if (it == m_MaterialsByNetworkHash.end())
+        return nullptr;
+
+    for (const std::vector<HnMaterial*>& Class : it->second)
+    {
+        if (Class.front()->GetNetwork() == Network)
+            return Class.front();
+    }
+
+    return nullptr;
+}
+
+void HnRenderDelegate::RegisterMaterialNetwork(HnMaterial& Material)
+{
+    VERIFY_EXPR(Material.GetNetworkHash() != 0);
+
+    std::lock_guard<std::mutex> Guard{m_MaterialsMtx};
+
+    // Networks with the same hash are almost always equal, but check for collisions
+    std::vector<std::vector<HnMaterial*>>& Classes = m_MaterialsByNetworkHash[Material.GetNetworkHash()];
+    for (std::vector<HnMaterial*>& Class : Classes)
+    {
+        if (Class.front()->GetNetwork() == Material.GetNetwork())
+        {
+            Class.push_back(&Material);
+            return;
+        }
+    }
+    Classes.push_back({&Material});
+}
+
+void HnRenderDelegate::UnregisterMaterialNetwork(HnMaterial& Material)
+{
+    if (Material.GetNetworkHash() == 0)
+        return;
+
+    std::lock_guard<std::mutex> Guard{m_MaterialsMtx};
+
+    auto it = m_MaterialsByNetworkHash.find(Material.GetNetworkHash());
+    if (it == m_MaterialsByNetworkHash.end())
+        return;
+
+    std::vector<std::vector<HnMaterial*>>& Classes = it->second;
+    for (auto class_it = Classes.begin(); class_it != Classes.end(); ++class_it)
+    {
+        std::vector<HnMaterial*>& Class = *class_it;
+
+        auto mat_it = std::find(Class.begin(), Class.end(), &Material);
+        if (mat_it == Class.end())
+            continue;
+
+        // The next material in the class becomes the representative
+        Class.erase(mat_it);
+        if (Class.empty())
+            Classes.erase(class_it);
+        break;
+    }
+    if (Classes.empty())
+        m_MaterialsByNetworkHash.erase(it);
+}
+
 void HnRenderDelegate::DestroyBprim(pxr::HdBprim* BPrim)
 {
     delete BPrim;
 }
 
-void HnRenderDelegate::CommitResources(pxr::HdChangeTracker* tracker)
+void HnRenderDelegate::CommitResources(pxr::HdChangeTracker* Tracker)
 {
     m_ResourceMgr->UpdateVertexBuffers(m_pDevice, m_pContext);
     m_ResourceMgr->UpdateIndexBuffer(m_pDevice, m_pContext);
 
-    m_TextureRegistry.Commit(m_pContext);
+    m_TextureRegistry.Commit(m_pContext, m_CommandRecorder.get());
+    m_TextureRegistry.UpdateStreaming(m_pContext, m_RenderParam->GetFrameNumber());
+    m_TextureRegistry.UpdateAtlasDefragmentation(m_pContext);
+    {
+        const Uint32 TextureStorageVersion = m_TextureRegistry.GetStorageVersion();
+        if (m_TextureStorageVersion != TextureStorageVersion)
+        {
+            // Texture resources have been replaced, e.g. asynchronously loaded textures have been
+            // published, resident mip levels have changed, or atlas regions have been moved:
+            // update the materials that use them.
+            bool MaterialsUpdated = false;
+            {
+                std::lock_guard<std::mutex> Guard{m_MaterialsMtx};
+                for (auto* pMat : m_Materials)
+                {
+                    MaterialsUpdated |= pMat->UpdateTextureResources(m_TextureRegistry, *m_USDRenderer);
+                }
+            }
+            if (MaterialsUpdated)
+            {
+                m_RenderParam->MakeAttribDirty(HnRenderParam::GlobalAttrib::Material);
+            }
+            m_TextureStorageVersion = TextureStorageVersion;
+        }
+    }
     if (m_ShadowMapManager)
     {
         m_ShadowMapManager->Commit(m_pDevice, m_pContext);
@@ -568,6 +717,22 @@ void HnRenderDelegate::CommitResources(pxr::HdChangeTracker* tracker)
                 pMat->BindPrimitiveAttribsBuffer(*this);
             }
 
+            // Materials with equal networks share their textures and SRBs
+            size_t MaterialCount       = 0;
+            size_t UniqueMaterialCount = 0;
+            for (const auto& it : m_MaterialsByNetworkHash)
+            {
+                for (const std::vector<HnMaterial*>& Class : it.second)
+                    MaterialCount += Class.size();
+                UniqueMaterialCount += it.second.size();
+            }
+            if (MaterialCount != m_LoggedMaterialCount || UniqueMaterialCount != m_LoggedUniqueMaterialCount)
+            {
+                LOG_INFO_MESSAGE("Material deduplication: ", MaterialCount, " materials, ", UniqueMaterialCount, " unique");
+                m_LoggedMaterialCount       = MaterialCount;
+                m_LoggedUniqueMaterialCount = UniqueMaterialCount;
+            }
+
             m_MaterialResourcesVersion = MaterialVersion;
         }
     }
@@ -577,14 +742,42 @@ void HnRenderDelegate::CommitResources(pxr::HdChangeTracker* tracker)
         if (m_MeshResourcesVersion != MeshVersion)
         {
             std::lock_guard<std::mutex> Guard{m_MeshesMtx};
+
+            std::vector<HnMesh*> PendingMeshes;
             for (auto* pMesh : m_Meshes)
             {
-                pMesh->CommitGPUResources(*this);
+                if (pMesh->HasPendingGPUResources())
+                    PendingMeshes.push_back(pMesh);
+            }
+
+            if (!PendingMeshes.empty() && m_CommandRecorder->IsEnabled())
+            {
+                // Pool buffers are shared by all meshes. State transitions are not thread-safe,
+                // so transition the pools to the copy destination state before recording the commands.
+                GLTF::ResourceManager::TransitionResourceStatesInfo TRSInfo;
+                TRSInfo.VertexBuffers.NewState = RESOURCE_STATE_COPY_DEST;
+                TRSInfo.IndexBuffer.NewState   = RESOURCE_STATE_COPY_DEST;
+                m_ResourceMgr->TransitionResourceStates(m_pDevice, m_pContext, TRSInfo);
             }
+
+            m_CommandRecorder->Process(PendingMeshes,
+                                       [this](HnMesh* pMesh, IDeviceContext* pCtx) {
+                                           pMesh->CommitGPUResources(*this, pCtx);
+                                       });
             m_MeshResourcesVersion = MeshVersion;
         }
     }
 
+    if (m_GeometryResidency.Budget > 0 && Tracker != nullptr)
+    {
+        UpdateGeometryResidency(*Tracker);
+    }
+
+    if (m_PoolCompaction.Threshold > 0 && Tracker != nullptr)
+    {
+        CompactPools(*Tracker);
+    }
+
     {
         GLTF::ResourceManager::TransitionResourceStatesInfo TRSInfo;
         TRSInfo.VertexBuffers.NewState  = RESOURCE_STATE_VERTEX_BUFFER;
@@ -594,6 +787,291 @@ void HnRenderDelegate::CommitResources(pxr::HdChangeTracker* tracker)
     }
 }
 
+void HnRenderDelegate::CompactPools(pxr::HdChangeTracker& Tracker)
+{
+    std::lock_guard<std::mutex> Guard{m_MeshesMtx};
+
+    auto& Queue = m_PoolCompaction.Queue;
+    if (Queue.empty())
+    {
+        const HnRenderDelegateMemoryStats MemoryStats = GetMemoryStats();
+
+        // Do not start a new sweep until the pool usage changes since the last one, which
+        // indicates that allocations have been added or released. Relocations made by the
+        // compaction itself do not change the usage.
+        m_PoolCompaction.CompactIndices =
+            m_RenderParam->GetUseIndexPool() &&
+            MemoryStats.IndexPool.FragmentationRatio > m_PoolCompaction.Threshold &&
+            (MemoryStats.IndexPool.UsedSize != m_PoolCompaction.IndexPoolUsedSize ||
+             MemoryStats.IndexPool.AllocationCount != m_PoolCompaction.IndexPoolAllocationCount);
+        m_PoolCompaction.CompactVertices =
+            m_RenderParam->GetUseVertexPool() &&
+            MemoryStats.VertexPool.FragmentationRatio > m_PoolCompaction.Threshold &&
+            (MemoryStats.VertexPool.UsedSize != m_PoolCompaction.VertexPoolUsedSize ||
+             MemoryStats.VertexPool.AllocationCount != m_PoolCompaction.VertexPoolAllocationCount);
+        if (!m_PoolCompaction.CompactIndices && !m_PoolCompaction.CompactVertices)
+            return;
+
+        m_PoolCompaction.IndexPoolUsedSize         = MemoryStats.IndexPool.UsedSize;
+        m_PoolCompaction.IndexPoolAllocationCount  = MemoryStats.IndexPool.AllocationCount;
+        m_PoolCompaction.VertexPoolUsedSize        = MemoryStats.VertexPool.UsedSize;
+        m_PoolCompaction.VertexPoolAllocationCount = MemoryStats.VertexPool.AllocationCount;
+
+        Queue.reserve(m_Meshes.size());
+        for (HnMesh* pMesh : m_Meshes)
+        {
+            if (pMesh->GetPooledIndexDataSize() > 0 || pMesh->GetPooledVertexDataSize() > 0)
+                Queue.push_back(pMesh);
+        }
+
+        // Process meshes at the end of the pools first as they are the ones that
+        // may be moved to the free space at the beginning.
+        const bool SortByVertices = m_PoolCompaction.CompactVertices;
+        std::sort(Queue.begin(), Queue.end(), [SortByVertices](const HnMesh* pMesh0, const HnMesh* pMesh1) {
+            return SortByVertices ?
+                pMesh0->GetPooledStartVertex() < pMesh1->GetPooledStartVertex() :
+                pMesh0->GetFaceStartIndex() < pMesh1->GetFaceStartIndex();
+        });
+    }
+
+    bool   IndexDataMoved  = false;
+    Uint64 RemainingBudget = m_PoolCompaction.Budget;
+    while (!Queue.empty() && RemainingBudget > 0)
+    {
+        HnMesh* pMesh = Queue.back();
+        Queue.pop_back();
+
+        Uint64 ProcessedSize = 0;
+        if (m_PoolCompaction.CompactVertices && pMesh->GetPooledVertexDataSize() > 0)
+        {
+            // Pooled indices include the start vertex, so vertex data can't be copied on the GPU.
+            // Re-sync the mesh to upload its data to a new allocation. Index data will be
+            // reallocated as well.
+            pMesh->RequestVertexDataRelocation();
+            Tracker.MarkRprimDirty(pMesh->GetId(), HnMesh::GeometryResyncDirtyBits);
+            ProcessedSize = pMesh->GetPooledVertexDataSize() + pMesh->GetPooledIndexDataSize();
+        }
+        else if (m_PoolCompaction.CompactIndices)
+        {
+            ProcessedSize = pMesh->GetPooledIndexDataSize();
+            if (ProcessedSize == 0)
+                continue;
+
+            if (!m_PoolCompaction.ScratchBuffer || m_PoolCompaction.ScratchBuffer->GetDesc().Size < ProcessedSize)
+            {
+                m_PoolCompaction.ScratchBuffer.Release();
+
+                BufferDesc Desc{
+                    "Hydrogent pool compaction scratch buffer",
+                    std::max(ProcessedSize, m_PoolCompaction.Budget),
+                    BIND_INDEX_BUFFER,
+                    USAGE_DEFAULT,
+                };
+                m_pDevice->CreateBuffer(Desc, nullptr, &m_PoolCompaction.ScratchBuffer);
+                if (!m_PoolCompaction.ScratchBuffer)
+                {
+                    UNEXPECTED("Failed to create pool compaction scratch buffer");
+                    Queue.clear();
+                    break;
+                }
+            }
+
+            const Uint64 MovedBytes = pMesh->CompactIndexData(*this, m_PoolCompaction.ScratchBuffer);
+            if (MovedBytes > 0)
+            {
+                m_PoolCompaction.IndexMovedBytes.fetch_add(MovedBytes);
+                IndexDataMoved = true;
+            }
+        }
+
+        RemainingBudget -= std::min(RemainingBudget, ProcessedSize);
+    }
+
+    if (IndexDataMoved)
+    {
+        m_RenderParam->MakeAttribDirty(HnRenderParam::GlobalAttrib::MeshGeometry);
+    }
+}
+
+void HnRenderDelegate::UpdateGeometryResidency(pxr::HdChangeTracker& Tracker)
+{
+    // The begin frame task increments the frame number in its Prepare() method, which runs
+    // before CommitResources(), while render passes mark meshes visible after it. The last
+    // rendered frame is therefore the previous one.
+    const Uint32 FrameNumber = m_RenderParam->GetFrameNumber();
+    const Uint32 LastFrame   = FrameNumber > 0 ? FrameNumber - 1 : 0;
+
+    std::lock_guard<std::mutex> Guard{m_MeshesMtx};
+
+    std::vector<HnMesh*>                 Candidates;
+    std::vector<HnGeometryResidencyItem> CandidateItems;
+
+    Uint64 ResidentSize     = 0;
+    Uint32 EvictedMeshCount = 0;
+    for (HnMesh* pMesh : m_Meshes)
+    {
+        const Uint32 LastVisibleFrame = pMesh->GetLastVisibleFrame();
+        if (pMesh->IsEvicted())
+        {
+            if (LastVisibleFrame >= LastFrame)
+            {
+                // The mesh was requested by a render pass in the last frame: pull
+                // the geometry from the scene delegate again.
+                Tracker.MarkRprimDirty(pMesh->GetId(), HnMesh::GeometryResyncDirtyBits);
+            }
+            ++EvictedMeshCount;
+            continue;
+        }
+
+        const Uint64 Size = pMesh->GetGPUGeometrySize();
+        ResidentSize += Size;
+
+        // Meshes with pending uploads can't be evicted
+        if (!pMesh->HasPendingGPUResources())
+        {
+            Candidates.push_back(pMesh);
+            CandidateItems.push_back({Size, LastVisibleFrame});
+        }
+    }
+
+    if (ResidentSize > m_GeometryResidency.Budget)
+    {
+        bool GeometryEvicted = false;
+        for (size_t Idx : SelectGeometryToEvict(CandidateItems, ResidentSize, LastFrame, m_GeometryResidency.Budget))
+        {
+            const Uint64 EvictedSize = Candidates[Idx]->EvictGPUResources();
+            if (EvictedSize == 0)
+                continue;
+
+            ResidentSize -= std::min(ResidentSize, EvictedSize);
+            m_GeometryResidency.TotalEvictedBytes.fetch_add(EvictedSize);
+            ++EvictedMeshCount;
+            GeometryEvicted = true;
+        }
+
+        if (GeometryEvicted)
+        {
+            m_RenderParam->MakeAttribDirty(HnRenderParam::GlobalAttrib::MeshGeometry);
+        }
+
+        if (ResidentSize > m_GeometryResidency.Budget && !m_GeometryResidency.BudgetExceededWarningShown)
+        {
+            LOG_WARNING_MESSAGE("The size of the visible geometry (", ResidentSize, " bytes) exceeds the geometry memory budget (",
+                                m_GeometryResidency.Budget, " bytes)");
+            m_GeometryResidency.BudgetExceededWarningShown = true;
+        }
+    }
+    else
+    {
+        m_GeometryResidency.BudgetExceededWarningShown = false;
+    }
+
+    m_GeometryResidency.ResidentSize.store(ResidentSize);
+    m_GeometryResidency.EvictedMeshCount.store(EvictedMeshCount);
+}
+
+void HnRenderDelegate::AddPoolCompactionMovedBytes(Uint64 IndexBytes, Uint64 VertexBytes)
+{
+    m_PoolCompaction.IndexMovedBytes.fetch_add(IndexBytes);
+    m_PoolCompaction.VertexMovedBytes.fetch_add(VertexBytes);
+}
+
+bool HnRenderDelegate::RayCast(const float3& Origin, const float3& Direction, HnRayCastHit& Hit, float MaxDistance) const
+{
+    if (!m_RenderParam->GetEnableRayCastPicking())
+        return false;
+
+    const float DirectionLength = length(Direction);
+    if (DirectionLength == 0)
+        return false;
+
+    // With the normalized direction, the ray parameter is the distance in world space.
+    // It is preserved by the transformation to the mesh space, so the hits of different
+    // meshes can be compared directly.
+    const float3 WorldDirection = Direction / DirectionLength;
+
+    const HnMesh* pHitMesh = nullptr;
+    float4x4      HitMeshInvTransform;
+
+    HnMesh::RayCastHit MeshHit;
+    MeshHit.T = MaxDistance;
+
+    std::lock_guard<std::mutex> Guard{m_MeshesMtx};
+    for (const HnMesh* pMesh : m_Meshes)
+    {
+        const entt::entity MeshEntity = pMesh->GetEntity();
+        if (!m_EcsRegistry.get<HnMesh::Components::Visibility>(MeshEntity).Val)
+            continue;
+
+        const float4x4 InvTransform = m_EcsRegistry.get<HnMesh::Components::Transform>(MeshEntity).Val.Inverse();
+
+        const float4 MeshOrigin    = float4{Origin, 1} * InvTransform;
+        const float4 MeshDirection = float4{WorldDirection, 0} * InvTransform;
+        if (pMesh->RayCast(float3{MeshOrigin.x, MeshOrigin.y, MeshOrigin.z},
+                           float3{MeshDirection.x, MeshDirection.y, MeshDirection.z},
+                           MeshHit.T, MeshHit))
+        {
+            pHitMesh            = pMesh;
+            HitMeshInvTransform = InvTransform;
+        }
+    }
+
+    if (pHitMesh == nullptr)
+        return false;
+
+    // Normals are transformed by the inverse transpose matrix
+    const float4 Normal = float4{MeshHit.Normal, 0} * HitMeshInvTransform.Transpose();
+
+    Hit.PrimId    = pHitMesh->GetId();
+    Hit.FaceIndex = MeshHit.FaceIndex;
+    Hit.Distance  = MeshHit.T;
+    Hit.Position  = Origin + WorldDirection * MeshHit.T;
+    Hit.Normal    = normalize(float3{Normal.x, Normal.y, Normal.z});
+
+    return true;
+}
+
+size_t HnRenderDelegate::ComputeShadowCastersHash(const HnLight& Light) const
+{
+    const bool IsGL = m_pDevice->GetDeviceInfo().NDC.MinZ == -1;
+
+    std::array<ViewFrustum, HnLight::MaxShadowMaps> Frustums;
+
+    const Uint32 NumShadowMaps = std::min(Light.GetNumShadowMaps(), HnLight::MaxShadowMaps);
+    for (Uint32 i = 0; i < NumShadowMaps; ++i)
+    {
+        ExtractViewFrustumPlanesFromMatrix(Light.GetViewProjMatrix(i), Frustums[i], IsGL);
+    }
+
+    size_t Hash = ComputeHash(NumShadowMaps);
+
+    std::lock_guard<std::mutex> Guard{m_MeshesMtx};
+    for (const HnMesh* pMesh : m_Meshes)
+    {
+        const entt::entity MeshEntity = pMesh->GetEntity();
+        if (!m_EcsRegistry.get<HnMesh::Components::Visibility>(MeshEntity).Val)
+            continue;
+
+        const float4x4& Transform = m_EcsRegistry.get<HnMesh::Components::Transform>(MeshEntity).Val;
+
+        bool IsCaster = false;
+        for (Uint32 i = 0; i < NumShadowMaps && !IsCaster; ++i)
+        {
+            IsCaster = HnLight::IsShadowCasterInFrustum(Frustums[i], pMesh->GetBoundingSphere(), Transform);
+        }
+        if (!IsCaster)
+            continue;
+
+        // The order of the meshes in the set is not defined, so combine the
+        // hashes of individual meshes with an order-independent operation.
+        size_t MeshHash = ComputeHash(pMesh->GetUID(), pMesh->GetGeometryVersion(), pMesh->GetMaterialVersion(), pMesh->IsEvicted());
+        HashCombine(MeshHash, ComputeHashRaw(&Transform, sizeof(Transform)));
+        Hash += MeshHash;
+    }
+
+    return Hash;
+}
+
 const pxr::SdfPath* HnRenderDelegate::GetRPrimId(Uint32 UID) const
 {
     std::lock_guard<std::mutex> Guard{m_RPrimUIDToSdfPathMtx};
@@ -619,6 +1097,43 @@ HnRenderDelegateMemoryStats HnRenderDelegate::GetMemoryStats() const
     MemoryStats.VertexPool.AllocationCount      = VertexUsage.AllocationCount;
     MemoryStats.VertexPool.AllocatedVertexCount = VertexUsage.AllocatedVertexCount;
 
+    if (MemoryStats.IndexPool.CommittedSize > 0)
+    {
+        MemoryStats.IndexPool.FragmentationRatio =
+            1.f - static_cast<float>(static_cast<double>(MemoryStats.IndexPool.UsedSize) / static_cast<double>(MemoryStats.IndexPool.CommittedSize));
+    }
+    if (MemoryStats.VertexPool.CommittedSize > 0)
+    {
+        MemoryStats.VertexPool.FragmentationRatio =
+            1.f - static_cast<float>(static_cast<double>(MemoryStats.VertexPool.UsedSize) / static_cast<double>(MemoryStats.VertexPool.CommittedSize));
+    }
+    MemoryStats.IndexPool.CompactionMovedBytes  = m_PoolCompaction.IndexMovedBytes.load();
+    MemoryStats.VertexPool.CompactionMovedBytes = m_PoolCompaction.VertexMovedBytes.load();
+
+    MemoryStats.Geometry.Budget            = m_GeometryResidency.Budget;
+    MemoryStats.Geometry.ResidentSize      = m_GeometryResidency.ResidentSize.load();
+    MemoryStats.Geometry.EvictedMeshCount  = m_GeometryResidency.EvictedMeshCount.load();
+    MemoryStats.Geometry.TotalEvictedBytes = m_GeometryResidency.TotalEvictedBytes.load();
+
+    const HnTextureRegistry::StreamingStats StreamingStats = m_TextureRegistry.GetStreamingStats();
+    MemoryStats.TextureStreaming.Budget        = StreamingStats.Budget;
+    MemoryStats.TextureStreaming.ResidentSize  = StreamingStats.ResidentSize;
+    MemoryStats.TextureStreaming.RequestedSize = StreamingStats.RequestedSize;
+    MemoryStats.TextureStreaming.TextureCount  = StreamingStats.TextureCount;
+
+    const HnTextureRegistry::CacheStats TexCacheStats = m_TextureRegistry.GetCacheStats();
+    MemoryStats.TextureCache.ContentHits  = TexCacheStats.ContentHits;
+    MemoryStats.TextureCache.SamplerCount = TexCacheStats.SamplerCount;
+    MemoryStats.TextureCache.SamplerHits  = TexCacheStats.SamplerHits;
+
+    const HnTextureRegistry::AtlasDefragStats AtlasDefragStats = m_TextureRegistry.GetAtlasDefragStats();
+    MemoryStats.AtlasDefragmentation.UtilizationBefore = AtlasDefragStats.UtilizationBefore;
+    MemoryStats.AtlasDefragmentation.UtilizationAfter  = AtlasDefragStats.UtilizationAfter;
+    MemoryStats.AtlasDefragmentation.PassCount         = AtlasDefragStats.PassCount;
+    MemoryStats.AtlasDefragmentation.MovedRegionCount  = AtlasDefragStats.MovedRegionCount;
+    MemoryStats.AtlasDefragmentation.MovedBytes        = AtlasDefragStats.MovedBytes;
+    MemoryStats.AtlasDefragmentation.InProgress        = AtlasDefragStats.InProgress;
+
     MemoryStats.Atlas.CommittedSize   = AtlasUsage.CommittedSize;
     MemoryStats.Atlas.AllocationCount = AtlasUsage.AllocationCount;
     MemoryStats.Atlas.TotalTexels     = AtlasUsage.TotalArea;
@@ -652,6 +1167,31 @@ void HnRenderDelegate::SetUseShadows(bool UseShadows)
     m_RenderParam->SetUseShadows(UseShadows);
 }
 
+void HnRenderDelegate::SetMeshLodErrorThreshold(float Threshold)
+{
+    m_RenderParam->SetMeshLodErrorThreshold(std::max(Threshold, 0.f));
+}
+
+void HnRenderDelegate::SetShadowCascadeCount(Uint32 CascadeCount)
+{
+    if (CascadeCount < 1 || CascadeCount > HnLight::MaxShadowCascades)
+    {
+        LOG_WARNING_MESSAGE("Shadow cascade count (", CascadeCount, ") must be between 1 and ", HnLight::MaxShadowCascades);
+        CascadeCount = clamp(CascadeCount, 1u, HnLight::MaxShadowCascades);
+    }
+    m_RenderParam->SetShadowCascadeCount(CascadeCount);
+}
+
+void HnRenderDelegate::SetShadowCascadePartitioning(float Partitioning)
+{
+    m_RenderParam->SetShadowCascadePartitioning(clamp(Partitioning, 0.f, 1.f));
+}
+
+void HnRenderDelegate::SetShadowCascadeBlendRange(float BlendRange)
+{
+    m_RenderParam->SetShadowCascadeBlendRange(clamp(BlendRange, 0.f, 1.f));
+}
+
 Uint32 HnRenderDelegate::GetShadowPassFrameAttribsOffset(Uint32 LightId) const
 {
     return m_MainPassFrameAttribsAlignedSize + m_ShadowPassFrameAttribsAlignedSize * LightId;
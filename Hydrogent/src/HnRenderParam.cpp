@@ -35,11 +35,17 @@ namespace USD
 HnRenderParam::HnRenderParam(bool                              UseVertexPool,
                              bool                              UseIndexPool,
                              HN_MATERIAL_TEXTURES_BINDING_MODE TextureBindingMode,
-                             float                             MetersPerUnit) noexcept :
+                             float                             MetersPerUnit,
+                             Uint32                            MeshLodCount,
+                             bool                              EnableRayCastPicking,
+                             bool                              CompressVertexNormals) noexcept :
     m_UseVertexPool{UseVertexPool},
     m_UseIndexPool{UseIndexPool},
     m_TextureBindingMode{TextureBindingMode},
-    m_MetersPerUnit{MetersPerUnit}
+    m_MetersPerUnit{MetersPerUnit},
+    m_MeshLodCount{MeshLodCount},
+    m_EnableRayCastPicking{EnableRayCastPicking},
+    m_CompressVertexNormals{CompressVertexNormals}
 {
     for (auto& Version : m_GlobalAttribVersions)
         Version.store(0);
@@ -32,9 +32,13 @@
 #include "HnDrawItem.hpp"
 #include "HnTypeConversions.hpp"
 #include "HnRenderParam.hpp"
+#include "HnCamera.hpp"
+#include "HnLight.hpp"
 
 #include <array>
 #include <unordered_map>
+#include <algorithm>
+#include <cmath>
 
 #include "pxr/imaging/hd/renderIndex.h"
 
@@ -260,8 +264,98 @@ void HnRenderPass::_Execute(const pxr::HdRenderPassStateSharedPtr& RPState,
     Execute(*static_cast<HnRenderPassState*>(RPState.get()), Tags);
 }
 
+namespace
+{
+
+struct MeshLodSelectionAttribs
+{
+    float3 CameraPosition;
+
+    // Scale that converts the error at unit distance from the camera to pixels
+    float ErrorToPixelScale = 0;
+
+    bool IsPerspective = true;
+
+    float ErrorThreshold = 0;
+};
+
+// Switching to a coarser level of detail requires the projected error to be
+// below the threshold by this fraction to prevent flickering between levels.
+constexpr float MeshLodHysteresis = 0.25f;
+
+// Returns the factor that converts the size in the mesh space to pixels,
+// or zero if the camera is inside the mesh bounding sphere.
+float ComputeMeshToPixelScale(const HnMesh& Mesh, const float4x4& Transform, const MeshLodSelectionAttribs& Attribs)
+{
+    const float4& Sphere = Mesh.GetBoundingSphere();
+
+    // Use the largest axis scale of the transform to scale the size and the radius
+    const float3 Axes[] = {
+        float3::MakeVector(Transform[0]),
+        float3::MakeVector(Transform[1]),
+        float3::MakeVector(Transform[2]),
+    };
+    const float Scale = std::sqrt(std::max({dot(Axes[0], Axes[0]), dot(Axes[1], Axes[1]), dot(Axes[2], Axes[2])}));
+
+    float MeshToPixels = Attribs.ErrorToPixelScale * Scale;
+    if (Attribs.IsPerspective)
+    {
+        const float4 Center   = float4{Sphere.x, Sphere.y, Sphere.z, 1} * Transform;
+        const float  Distance = length(float3{Center.x, Center.y, Center.z} - Attribs.CameraPosition) - Sphere.w * Scale;
+        if (Distance <= 0)
+        {
+            // The camera is inside the bounding sphere
+            return 0;
+        }
+        MeshToPixels /= Distance;
+    }
+
+    return MeshToPixels;
+}
+
+Uint32 SelectMeshLod(const HnMesh& Mesh, Uint32 CurrLod, const float4x4& Transform, const MeshLodSelectionAttribs& Attribs)
+{
+    const std::vector<HnMesh::LodInfo>& Lods = Mesh.GetLods();
+    if (Lods.empty())
+        return 0;
+
+    const float ErrorToPixels = ComputeMeshToPixelScale(Mesh, Transform, Attribs);
+    if (ErrorToPixels == 0)
+        return 0;
+
+    // Find the coarsest level of detail whose projected error does not exceed the threshold
+    for (Uint32 Lod = static_cast<Uint32>(Lods.size()); Lod > 0; --Lod)
+    {
+        const float MaxError = Lod > CurrLod ?
+            Attribs.ErrorThreshold * (1.f - MeshLodHysteresis) :
+            Attribs.ErrorThreshold;
+        if (Lods[Lod - 1].Error * ErrorToPixels <= MaxError)
+            return Lod;
+    }
+
+    return 0;
+}
+
+// Estimates the texture resolution, in texels, that is required to render the mesh
+// without magnification, assuming that the texture is mapped once over the mesh.
+Uint32 ComputeRequiredTextureResolution(const HnMesh& Mesh, const float4x4& Transform, const MeshLodSelectionAttribs& Attribs)
+{
+    constexpr Uint32 MaxResolution = 16384;
+
+    const float MeshToPixels = ComputeMeshToPixelScale(Mesh, Transform, Attribs);
+    if (MeshToPixels == 0)
+        return MaxResolution;
+
+    const float Diameter = 2.f * Mesh.GetBoundingSphere().w * MeshToPixels;
+    return std::min(static_cast<Uint32>(std::ceil(Diameter)), MaxResolution);
+}
+
+} // namespace
+
 void HnRenderPass::Execute(HnRenderPassState& RPState, const pxr::TfTokenVector& Tags)
 {
+    m_NumRenderedItems = 0;
+
     UpdateDrawList(Tags);
     if (m_DrawList.empty())
         return;
@@ -370,12 +464,35 @@ void HnRenderPass::Execute(HnRenderPassState& RPState, const pxr::TfTokenVector&
                                          const HnMesh::Components::DisplayColor,
                                          const HnMesh::Components::Visibility>();
 
+    const Uint32 FrameNumber = State.RenderParam.GetFrameNumber();
+
+    // Levels of detail are only used for faces. Render passes that don't have a camera
+    // (e.g. shadow passes) always use full-resolution meshes.
+    MeshLodSelectionAttribs LodSelection;
+    LodSelection.ErrorThreshold = State.RenderParam.GetMeshLodErrorThreshold();
+
+    const HnCamera* pCamera       = static_cast<const HnCamera*>(RPState.GetCamera());
+    const bool      HasProjection = (m_RenderMode == HN_RENDER_MODE_SOLID &&
+                                pCamera != nullptr &&
+                                RPState.GetFramebufferHeight() > 0);
+    const bool      SelectLods    = HasProjection && LodSelection.ErrorThreshold > 0;
+
+    // Texture streaming feedback: request the texture resolution from the projected mesh size
+    const bool RequestTextureResolution = HasProjection && State.RenderDelegate.GetTextureRegistry().IsStreamingEnabled();
+    if (HasProjection)
+    {
+        const float4x4& ProjMatrix     = pCamera->GetProjectionMatrix();
+        LodSelection.CameraPosition    = float3::MakeVector(pCamera->GetWorldMatrix()[3]);
+        LodSelection.ErrorToPixelScale = ProjMatrix[1][1] * 0.5f * static_cast<float>(RPState.GetFramebufferHeight());
+        LodSelection.IsPerspective     = ProjMatrix[2][3] != 0;
+    }
+
+    // Shadow passes only render the casters that intersect the light's shadow frustum
+    const ViewFrustum* pCullingFrustum = RPState.GetShadowCasterCullingFrustum();
+
     Uint32 MultiDrawCount = 0;
     for (DrawListItem& ListItem : m_DrawList)
     {
-        if (!ListItem)
-            continue;
-
         const auto& MeshAttribs = MeshAttribsView.get<const HnMesh::Components::Transform,
                                                       const HnMesh::Components::DisplayColor,
                                                       const HnMesh::Components::Visibility>(ListItem.MeshEntity);
@@ -387,6 +504,41 @@ void HnRenderPass::Execute(HnRenderPassState& RPState, const pxr::TfTokenVector&
         if (!MeshVisibile)
             continue;
 
+        if (pCullingFrustum != nullptr && !HnLight::IsShadowCasterInFrustum(*pCullingFrustum, ListItem.Mesh.GetBoundingSphere(), Transform))
+            continue;
+
+        // Let the render delegate know that the mesh is needed even if its
+        // GPU resources have been evicted, so that they can be restored.
+        ListItem.Mesh.MarkVisible(FrameNumber);
+
+        if (!ListItem)
+            continue;
+
+        {
+            const Uint32 Lod = SelectLods ? SelectMeshLod(ListItem.Mesh, ListItem.Lod, Transform, LodSelection) : 0;
+            if (ListItem.Lod != Lod)
+            {
+                const HnDrawItem::TopologyData& Faces = ListItem.DrawItem.GetFaces();
+                if (Lod > 0)
+                {
+                    const HnMesh::LodInfo& LodInfo = ListItem.Mesh.GetLods()[Lod - 1];
+                    ListItem.StartIndex            = Faces.StartIndex + LodInfo.StartTriangle * 3;
+                    ListItem.NumVertices           = LodInfo.NumTriangles * 3;
+                }
+                else
+                {
+                    ListItem.StartIndex  = Faces.StartIndex;
+                    ListItem.NumVertices = Faces.NumVertices;
+                }
+                ListItem.Lod = Lod;
+            }
+        }
+
+        if (RequestTextureResolution)
+        {
+            ListItem.Material.RequestTextureResolution(ComputeRequiredTextureResolution(ListItem.Mesh, Transform, LodSelection));
+        }
+
         if (MultiDrawCount == PrimitiveArraySize)
             MultiDrawCount = 0;
 
@@ -479,6 +631,7 @@ void HnRenderPass::Execute(HnRenderPassState& RPState, const pxr::TfTokenVector&
         ListItem.PrevTransform = Transform;
 
         m_PendingDrawItems.push_back(PendingDrawItem{ListItem, CurrOffset});
+        ++m_NumRenderedItems;
 
         CurrOffset += ListItem.ShaderAttribsDataSize;
         ++MultiDrawCount;
@@ -734,18 +887,22 @@ HnRenderPass::SupportedVertexInputsSetType HnRenderPass::GetSupportedVertexInput
     return SupportedInputs;
 }
 
-PBR_Renderer::PSO_FLAGS HnRenderPass::GetMaterialPSOFlags(const HnMaterial& Material)
+PBR_Renderer::PSO_FLAGS HnRenderPass::GetMaterialPSOFlags(const HnMaterial& Material, const PBR_Renderer::CreateInfo& RendererSettings)
 {
     const GLTF::Material& MaterialData = Material.GetMaterialData();
 
     PBR_Renderer::PSO_FLAGS PSOFlags =
         PBR_Renderer::PSO_FLAG_USE_COLOR_MAP |
         PBR_Renderer::PSO_FLAG_USE_NORMAL_MAP |
-        PBR_Renderer::PSO_FLAG_USE_METALLIC_MAP |
-        PBR_Renderer::PSO_FLAG_USE_ROUGHNESS_MAP |
         PBR_Renderer::PSO_FLAG_USE_AO_MAP |
         PBR_Renderer::PSO_FLAG_USE_EMISSIVE_MAP;
 
+    // Metallic and roughness are packed into the physical descriptor map by HnMaterial
+    // when the renderer does not use separate textures.
+    PSOFlags |= RendererSettings.UseSeparateMetallicRoughnessTextures ?
+        PBR_Renderer::PSO_FLAG_USE_METALLIC_MAP | PBR_Renderer::PSO_FLAG_USE_ROUGHNESS_MAP :
+        PBR_Renderer::PSO_FLAG_USE_PHYS_DESC_MAP;
+
     PSOFlags |= PBR_Renderer::PSO_FLAG_COMPUTE_MOTION_VECTORS;
 
     MaterialData.ProcessActiveTextureAttibs(
@@ -803,7 +960,7 @@ void HnRenderPass::UpdateDrawListItemGPUResources(DrawListItem& ListItem, Render
 
             if (pMaterial != nullptr)
             {
-                const PBR_Renderer::PSO_FLAGS MaterialPSOFlags = GetMaterialPSOFlags(*pMaterial);
+                const PBR_Renderer::PSO_FLAGS MaterialPSOFlags = GetMaterialPSOFlags(*pMaterial, State.USDRenderer.GetSettings());
                 if (m_Params.UsdPsoFlags & USD_Renderer::USD_PSO_FLAG_ENABLE_COLOR_OUTPUT)
                 {
                     PSOFlags |= MaterialPSOFlags | PBR_Renderer::PSO_FLAG_USE_IBL | PBR_Renderer::PSO_FLAG_USE_LIGHTS;
@@ -889,6 +1046,7 @@ void HnRenderPass::UpdateDrawListItemGPUResources(DrawListItem& ListItem, Render
             ListItem.StartIndex  = 0;
             ListItem.NumVertices = 0;
         }
+        ListItem.Lod = 0;
     }
 }
 
@@ -26,6 +26,8 @@
 
 #include "HnRenderPassState.hpp"
 
+#include <algorithm>
+
 #include "HnTypeConversions.hpp"
 #include "DebugUtilities.hpp"
 
@@ -193,6 +195,13 @@ void HnRenderPassState::Begin(Uint32        NumRenderTargets,
     VERIFY((m_DSV != nullptr ? m_DSV->GetDesc().Format : TEX_FORMAT_UNKNOWN) == m_DepthFormat, "Invalid depth-stencil view format");
     m_ClearDepth = ClearDepth;
 
+    m_FramebufferHeight = 0;
+    if (ITextureView* pView = m_DSV != nullptr ? m_DSV : (NumRenderTargets > 0 ? m_RTVs[0] : nullptr))
+    {
+        const TextureViewDesc& ViewDesc = pView->GetDesc();
+        m_FramebufferHeight             = std::max(pView->GetTexture()->GetDesc().Height >> ViewDesc.MostDetailedMip, 1u);
+    }
+
     m_IsCommited = false;
 }
 
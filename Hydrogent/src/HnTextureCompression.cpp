@@ -0,0 +1,519 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include "HnTextureCompression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace USD
+{
+
+namespace
+{
+
+constexpr Uint32 BCBlockDim = 4;
+
+using BlockTexels = Uint8[16][4];
+
+Uint16 PackRGB565(const int RGB[3])
+{
+    const int R = (std::clamp(RGB[0], 0, 255) * 31 + 127) / 255;
+    const int G = (std::clamp(RGB[1], 0, 255) * 63 + 127) / 255;
+    const int B = (std::clamp(RGB[2], 0, 255) * 31 + 127) / 255;
+    return static_cast<Uint16>((R << 11) | (G << 5) | B);
+}
+
+void UnpackRGB565(Uint16 Color, int RGB[3])
+{
+    const int R = (Color >> 11) & 31;
+    const int G = (Color >> 5) & 63;
+    const int B = Color & 31;
+
+    RGB[0] = (R << 3) | (R >> 2);
+    RGB[1] = (G << 2) | (G >> 4);
+    RGB[2] = (B << 3) | (B >> 2);
+}
+
+// Computes the palette of the color block. Three-color mode with the transparent black
+// is only used by BC1 blocks with C0 <= C1, which the encoder never produces.
+void GetColorPalette(Uint16 C0, Uint16 C1, bool FourColorMode, int Palette[4][3])
+{
+    UnpackRGB565(C0, Palette[0]);
+    UnpackRGB565(C1, Palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        if (FourColorMode)
+        {
+            Palette[2][c] = (2 * Palette[0][c] + Palette[1][c] + 1) / 3;
+            Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c] + 1) / 3;
+        }
+        else
+        {
+            Palette[2][c] = (Palette[0][c] + Palette[1][c] + 1) / 2;
+            Palette[3][c] = 0;
+        }
+    }
+}
+
+void GetAlphaPalette(int A0, int A1, int Palette[8])
+{
+    Palette[0] = A0;
+    Palette[1] = A1;
+    if (A0 > A1)
+    {
+        for (int i = 1; i <= 6; ++i)
+            Palette[i + 1] = ((7 - i) * A0 + i * A1 + 3) / 7;
+    }
+    else
+    {
+        for (int i = 1; i <= 4; ++i)
+            Palette[i + 1] = ((5 - i) * A0 + i * A1 + 2) / 5;
+        Palette[6] = 0;
+        Palette[7] = 255;
+    }
+}
+
+struct ColorBlock
+{
+    Uint16 C0      = 0;
+    Uint16 C1      = 0;
+    Uint32 Indices = 0;
+    Uint32 Error   = 0;
+};
+
+// Selects the palette indices for the given endpoints in four-color mode
+ColorBlock FitColorBlock(const BlockTexels& Texels, Uint16 C0, Uint16 C1)
+{
+    // C0 > C1 selects the four-color mode in BC1 blocks
+    if (C0 < C1)
+        std::swap(C0, C1);
+
+    ColorBlock Block;
+    Block.C0 = C0;
+    Block.C1 = C1;
+
+    int Palette[4][3];
+    GetColorPalette(C0, C1, /*FourColorMode = */ true, Palette);
+    // If the endpoints are equal, all indices are zero and only the first color is used
+    const int NumColors = C0 != C1 ? 4 : 1;
+    for (int i = 0; i < 16; ++i)
+    {
+        int BestIdx = 0;
+        int BestErr = std::numeric_limits<int>::max();
+        for (int p = 0; p < NumColors; ++p)
+        {
+            const int dR  = Texels[i][0] - Palette[p][0];
+            const int dG  = Texels[i][1] - Palette[p][1];
+            const int dB  = Texels[i][2] - Palette[p][2];
+            const int Err = dR * dR + dG * dG + dB * dB;
+            if (Err < BestErr)
+            {
+                BestErr = Err;
+                BestIdx = p;
+            }
+        }
+        Block.Indices |= static_cast<Uint32>(BestIdx) << (2 * i);
+        Block.Error += static_cast<Uint32>(BestErr);
+    }
+
+    return Block;
+}
+
+// Refines the endpoints by solving the least squares problem for the current indices
+bool RefineColorEndpoints(const BlockTexels& Texels, const ColorBlock& Block, Uint16& C0, Uint16& C1)
+{
+    // Weights of C0 for indices 0..3
+    static constexpr float Weights[] = {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+
+    float Alpha2 = 0, Beta2 = 0, AlphaBeta = 0;
+    float AlphaX[3] = {}, BetaX[3] = {};
+    for (int i = 0; i < 16; ++i)
+    {
+        const float A = Weights[(Block.Indices >> (2 * i)) & 3];
+        const float B = 1.f - A;
+        Alpha2 += A * A;
+        Beta2 += B * B;
+        AlphaBeta += A * B;
+        for (int c = 0; c < 3; ++c)
+        {
+            AlphaX[c] += A * Texels[i][c];
+            BetaX[c] += B * Texels[i][c];
+        }
+    }
+
+    const float Det = Alpha2 * Beta2 - AlphaBeta * AlphaBeta;
+    if (std::abs(Det) < 1e-6f)
+        return false;
+
+    int RGB0[3], RGB1[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        RGB0[c] = static_cast<int>(std::round((AlphaX[c] * Beta2 - BetaX[c] * AlphaBeta) / Det));
+        RGB1[c] = static_cast<int>(std::round((BetaX[c] * Alpha2 - AlphaX[c] * AlphaBeta) / Det));
+    }
+    C0 = PackRGB565(RGB0);
+    C1 = PackRGB565(RGB1);
+    return true;
+}
+
+void EncodeColorBlock(const BlockTexels& Texels, Uint8* pDst)
+{
+    int Min[3] = {255, 255, 255};
+    int Max[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            Min[c] = std::min<int>(Min[c], Texels[i][c]);
+            Max[c] = std::max<int>(Max[c], Texels[i][c]);
+        }
+    }
+
+    // Select the diagonal of the bounding box that follows the color distribution.
+    // Green has the largest weight, so use it as the reference axis.
+    int CovRG = 0, CovBG = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        const int dR = 2 * Texels[i][0] - (Min[0] + Max[0]);
+        const int dG = 2 * Texels[i][1] - (Min[1] + Max[1]);
+        const int dB = 2 * Texels[i][2] - (Min[2] + Max[2]);
+        CovRG += dR * dG;
+        CovBG += dB * dG;
+    }
+    if (CovRG < 0)
+        std::swap(Min[0], Max[0]);
+    if (CovBG < 0)
+        std::swap(Min[2], Max[2]);
+
+    // Inset the endpoints to reduce the error of the interpolated colors
+    for (int c = 0; c < 3; ++c)
+    {
+        const int Inset = (Max[c] - Min[c]) / 16;
+        Max[c] -= Inset;
+        Min[c] += Inset;
+    }
+
+    ColorBlock Block = FitColorBlock(Texels, PackRGB565(Max), PackRGB565(Min));
+
+    Uint16 C0 = 0, C1 = 0;
+    if (Block.Error > 0 && RefineColorEndpoints(Texels, Block, C0, C1))
+    {
+        const ColorBlock RefinedBlock = FitColorBlock(Texels, C0, C1);
+        if (RefinedBlock.Error < Block.Error)
+            Block = RefinedBlock;
+    }
+
+    std::memcpy(pDst + 0, &Block.C0, sizeof(Block.C0));
+    std::memcpy(pDst + 2, &Block.C1, sizeof(Block.C1));
+    std::memcpy(pDst + 4, &Block.Indices, sizeof(Block.Indices));
+}
+
+void DecodeColorBlock(const Uint8* pSrc, bool IsBC1, BlockTexels& Texels)
+{
+    Uint16 C0 = 0, C1 = 0;
+    Uint32 Indices = 0;
+    std::memcpy(&C0, pSrc + 0, sizeof(C0));
+    std::memcpy(&C1, pSrc + 2, sizeof(C1));
+    std::memcpy(&Indices, pSrc + 4, sizeof(Indices));
+
+    int Palette[4][3];
+    GetColorPalette(C0, C1, !IsBC1 || C0 > C1, Palette);
+    for (int i = 0; i < 16; ++i)
+    {
+        const int Idx = (Indices >> (2 * i)) & 3;
+        for (int c = 0; c < 3; ++c)
+            Texels[i][c] = static_cast<Uint8>(Palette[Idx][c]);
+    }
+}
+
+// Encodes one channel of the block as a BC4 block. The same block is used for the BC3 alpha.
+void EncodeBC4Block(const BlockTexels& Texels, int Channel, Uint8* pDst)
+{
+    int Min = 255;
+    int Max = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        Min = std::min<int>(Min, Texels[i][Channel]);
+        Max = std::max<int>(Max, Texels[i][Channel]);
+    }
+
+    // Max > Min selects the eight-value mode. If the values are equal,
+    // all indices are zero and only the first value is used.
+    Uint64 Indices = 0;
+    if (Max > Min)
+    {
+        int Palette[8];
+        GetAlphaPalette(Max, Min, Palette);
+        for (int i = 0; i < 16; ++i)
+        {
+            int BestIdx = 0;
+            int BestErr = std::numeric_limits<int>::max();
+            for (int p = 0; p < 8; ++p)
+            {
+                const int Err = std::abs(Texels[i][Channel] - Palette[p]);
+                if (Err < BestErr)
+                {
+                    BestErr = Err;
+                    BestIdx = p;
+                }
+            }
+            Indices |= static_cast<Uint64>(BestIdx) << (3 * i);
+        }
+    }
+
+    pDst[0] = static_cast<Uint8>(Max);
+    pDst[1] = static_cast<Uint8>(Min);
+    for (int b = 0; b < 6; ++b)
+        pDst[2 + b] = static_cast<Uint8>(Indices >> (8 * b));
+}
+
+void DecodeBC4Block(const Uint8* pSrc, int Channel, BlockTexels& Texels)
+{
+    int Palette[8];
+    GetAlphaPalette(pSrc[0], pSrc[1], Palette);
+
+    Uint64 Indices = 0;
+    for (int b = 0; b < 6; ++b)
+        Indices |= static_cast<Uint64>(pSrc[2 + b]) << (8 * b);
+
+    for (int i = 0; i < 16; ++i)
+        Texels[i][Channel] = static_cast<Uint8>(Palette[(Indices >> (3 * i)) & 7]);
+}
+
+} // namespace
+
+bool CompressTextureBC(const TextureDesc&       SrcDesc,
+                       const TextureData&       SrcData,
+                       TEXTURE_FORMAT           DstFormat,
+                       HnCompressedTextureData& Dst)
+{
+    if (SrcDesc.Type != RESOURCE_DIM_TEX_2D)
+        return false;
+
+    if (SrcData.pSubResources == nullptr || SrcData.NumSubresources == 0)
+    {
+        UNEXPECTED("Texture data must not be empty");
+        return false;
+    }
+
+    bool IsSRGB = false;
+    switch (DstFormat)
+    {
+        case TEX_FORMAT_BC1_UNORM:
+        case TEX_FORMAT_BC3_UNORM:
+            if (SrcDesc.Format != TEX_FORMAT_RGBA8_UNORM && SrcDesc.Format != TEX_FORMAT_RGBA8_UNORM_SRGB)
+                return false;
+            IsSRGB = SrcDesc.Format == TEX_FORMAT_RGBA8_UNORM_SRGB;
+            break;
+
+        case TEX_FORMAT_BC4_UNORM:
+            if (SrcDesc.Format != TEX_FORMAT_R8_UNORM)
+                return false;
+            break;
+
+        default:
+            UNEXPECTED("Unsupported compressed format");
+            return false;
+    }
+
+    // The most detailed level must consist of whole blocks
+    if ((SrcDesc.Width % BCBlockDim) != 0 || (SrcDesc.Height % BCBlockDim) != 0)
+        return false;
+
+    const Uint32 NumComponents = DstFormat == TEX_FORMAT_BC4_UNORM ? 1 : 4;
+
+    if (DstFormat == TEX_FORMAT_BC3_UNORM)
+    {
+        // Use BC1 for opaque textures
+        bool HasAlpha = false;
+
+        const TextureSubResData& TopLevel = SrcData.pSubResources[0];
+        for (Uint32 y = 0; y < SrcDesc.Height && !HasAlpha; ++y)
+        {
+            const Uint8* pRow = static_cast<const Uint8*>(TopLevel.pData) + y * TopLevel.Stride;
+            for (Uint32 x = 0; x < SrcDesc.Width && !HasAlpha; ++x)
+                HasAlpha = pRow[x * 4 + 3] != 255;
+        }
+        if (!HasAlpha)
+            DstFormat = TEX_FORMAT_BC1_UNORM;
+    }
+
+    const bool   IsBC1         = DstFormat == TEX_FORMAT_BC1_UNORM;
+    const bool   IsBC3         = DstFormat == TEX_FORMAT_BC3_UNORM;
+    const Uint32 BytesPerBlock = IsBC3 ? 16 : 8;
+    // Channels stored by the compressed format that are used to compute the PSNR
+    const Uint32 ErrorChannels = IsBC3 ? 4 : (IsBC1 ? 3 : 1);
+
+    Dst.Desc        = SrcDesc;
+    Dst.Desc.Format = DstFormat;
+    if (IsSRGB)
+        Dst.Desc.Format = IsBC1 ? TEX_FORMAT_BC1_UNORM_SRGB : TEX_FORMAT_BC3_UNORM_SRGB;
+    Dst.Desc.MipLevels = SrcData.NumSubresources;
+    Dst.Data.clear();
+    Dst.MipOffsets.clear();
+
+    double SquaredError = 0;
+    for (Uint32 mip = 0; mip < SrcData.NumSubresources; ++mip)
+    {
+        const TextureSubResData& SrcLevel = SrcData.pSubResources[mip];
+        if (SrcLevel.pData == nullptr)
+        {
+            UNEXPECTED("Mip level ", mip, " has no data");
+            return false;
+        }
+
+        const Uint32 MipWidth  = std::max(SrcDesc.Width >> mip, 1u);
+        const Uint32 MipHeight = std::max(SrcDesc.Height >> mip, 1u);
+        const Uint32 BlocksX   = (MipWidth + BCBlockDim - 1) / BCBlockDim;
+        const Uint32 BlocksY   = (MipHeight + BCBlockDim - 1) / BCBlockDim;
+
+        const size_t MipOffset = Dst.Data.size();
+        Dst.MipOffsets.push_back(MipOffset);
+        Dst.Data.resize(MipOffset + size_t{BlocksX} * BlocksY * BytesPerBlock);
+
+        const Uint8* pSrc = static_cast<const Uint8*>(SrcLevel.pData);
+        for (Uint32 by = 0; by < BlocksY; ++by)
+        {
+            for (Uint32 bx = 0; bx < BlocksX; ++bx)
+            {
+                // Replicate the edge texels for blocks that cross the boundary of small mip levels
+                BlockTexels Texels = {};
+                for (Uint32 y = 0; y < BCBlockDim; ++y)
+                {
+                    const Uint32 SrcY = std::min(by * BCBlockDim + y, MipHeight - 1);
+                    for (Uint32 x = 0; x < BCBlockDim; ++x)
+                    {
+                        const Uint32 SrcX   = std::min(bx * BCBlockDim + x, MipWidth - 1);
+                        const Uint8* pTexel = pSrc + SrcY * SrcLevel.Stride + SrcX * NumComponents;
+                        std::memcpy(Texels[y * BCBlockDim + x], pTexel, NumComponents);
+                    }
+                }
+
+                Uint8* pBlock = &Dst.Data[MipOffset + (size_t{by} * BlocksX + bx) * BytesPerBlock];
+                if (IsBC3)
+                {
+                    EncodeBC4Block(Texels, 3, pBlock);
+                    EncodeColorBlock(Texels, pBlock + 8);
+                }
+                else if (IsBC1)
+                {
+                    EncodeColorBlock(Texels, pBlock);
+                }
+                else
+                {
+                    EncodeBC4Block(Texels, 0, pBlock);
+                }
+
+                if (mip == 0)
+                {
+                    BlockTexels Decoded = {};
+                    if (IsBC3)
+                    {
+                        DecodeBC4Block(pBlock, 3, Decoded);
+                        DecodeColorBlock(pBlock + 8, false, Decoded);
+                    }
+                    else if (IsBC1)
+                    {
+                        DecodeColorBlock(pBlock, true, Decoded);
+                    }
+                    else
+                    {
+                        DecodeBC4Block(pBlock, 0, Decoded);
+                    }
+
+                    for (Uint32 i = 0; i < 16; ++i)
+                    {
+                        // BC1 does not store the alpha channel
+                        for (Uint32 c = 0; c < ErrorChannels; ++c)
+                        {
+                            const int Diff = static_cast<int>(Texels[i][c]) - static_cast<int>(Decoded[i][c]);
+                            SquaredError += Diff * Diff;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const double MSE = SquaredError / (static_cast<double>(SrcDesc.Width) * SrcDesc.Height * ErrorChannels);
+    Dst.PSNR         = MSE > 0 ? 10.0 * std::log10(255.0 * 255.0 / MSE) : std::numeric_limits<double>::infinity();
+
+    return true;
+}
+
+std::vector<Uint8> WriteCompressedTextureDDS(const HnCompressedTextureData& Data)
+{
+    Uint32 DXGIFormat = 0;
+    switch (Data.Desc.Format)
+    {
+        // clang-format off
+        case TEX_FORMAT_BC1_UNORM:      DXGIFormat = 71; break;
+        case TEX_FORMAT_BC1_UNORM_SRGB: DXGIFormat = 72; break;
+        case TEX_FORMAT_BC3_UNORM:      DXGIFormat = 77; break;
+        case TEX_FORMAT_BC3_UNORM_SRGB: DXGIFormat = 78; break;
+        case TEX_FORMAT_BC4_UNORM:      DXGIFormat = 80; break;
+        // clang-format on
+        default:
+            UNEXPECTED("Unexpected compressed format");
+            return {};
+    }
+
+    // Magic number, DDS_HEADER, and DDS_HEADER_DXT10
+    Uint32 Header[1 + 31 + 5] = {};
+
+    Header[0]  = 0x20534444; // "DDS "
+    Header[1]  = 124;        // dwSize
+    Header[2]  = 0xA1007;    // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE
+    Header[3]  = Data.Desc.Height;
+    Header[4]  = Data.Desc.Width;
+    Header[5]  = static_cast<Uint32>(Data.MipOffsets.size() > 1 ? Data.MipOffsets[1] : Data.Data.size());
+    Header[7]  = Data.Desc.MipLevels;
+    Header[19] = 32;         // ddspf.dwSize
+    Header[20] = 0x4;        // DDPF_FOURCC
+    Header[21] = 0x30315844; // "DX10"
+    Header[27] = 0x401008;   // DDSCAPS_COMPLEX | DDSCAPS_TEXTURE | DDSCAPS_MIPMAP
+    Header[32] = DXGIFormat;
+    Header[33] = 3; // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+    Header[35] = 1; // arraySize
+
+    std::vector<Uint8> DDSData(sizeof(Header) + Data.Data.size());
+    std::memcpy(DDSData.data(), Header, sizeof(Header));
+    std::memcpy(DDSData.data() + sizeof(Header), Data.Data.data(), Data.Data.size());
+    return DDSData;
+}
+
+} // namespace USD
+
+} // namespace Diligent
@@ -31,8 +31,15 @@
 #include "USD_Renderer.hpp"
 #include "HnTextureIdentifier.hpp"
 #include "GraphicsAccessories.hpp"
+#include "HnParallelCommandRecorder.hpp"
+#include "FileSystem.hpp"
+#include "HashUtils.hpp"
 
 #include <mutex>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include <algorithm>
 
 namespace Diligent
 {
@@ -40,22 +47,132 @@ namespace Diligent
 namespace USD
 {
 
+namespace
+{
+
+// Computes the hash of the decoded data of a 2D texture. Returns zero for other texture types.
+size_t ComputeTextureContentHash(ITextureLoader* pLoader)
+{
+    const TextureDesc& Desc = pLoader->GetTextureDesc();
+    if (Desc.Type != RESOURCE_DIM_TEX_2D)
+        return 0;
+
+    const TextureData           Data       = pLoader->GetTextureData();
+    const TextureFormatAttribs& FmtAttribs = GetTextureFormatAttribs(Desc.Format);
+
+    size_t Hash = ComputeHash(Desc.Format, Desc.Width, Desc.Height, Data.NumSubresources);
+    for (Uint32 mip = 0; mip < Data.NumSubresources; ++mip)
+    {
+        const TextureSubResData& Level    = Data.pSubResources[mip];
+        const MipLevelProperties MipProps = GetMipLevelProperties(Desc, mip);
+        const Uint32             NumRows  = MipProps.StorageHeight / FmtAttribs.BlockHeight;
+        // Hash the rows separately as the stride may include padding
+        for (Uint32 row = 0; row < NumRows; ++row)
+        {
+            const Uint8* pRow = static_cast<const Uint8*>(Level.pData) + row * Level.Stride;
+            HashCombine(Hash, ComputeHashRaw(pRow, static_cast<size_t>(MipProps.RowSize)));
+        }
+    }
+    return Hash;
+}
+
+// Returns true if the decoded data of two 2D textures is identical.
+bool TextureContentsEqual(ITextureLoader* pLoader0, ITextureLoader* pLoader1)
+{
+    const TextureDesc& Desc0 = pLoader0->GetTextureDesc();
+    const TextureDesc& Desc1 = pLoader1->GetTextureDesc();
+    if (Desc0.Type != RESOURCE_DIM_TEX_2D || Desc1.Type != RESOURCE_DIM_TEX_2D)
+        return false;
+    if (Desc0.Format != Desc1.Format || Desc0.Width != Desc1.Width || Desc0.Height != Desc1.Height)
+        return false;
+
+    const TextureData Data0 = pLoader0->GetTextureData();
+    const TextureData Data1 = pLoader1->GetTextureData();
+    if (Data0.NumSubresources != Data1.NumSubresources)
+        return false;
+
+    const TextureFormatAttribs& FmtAttribs = GetTextureFormatAttribs(Desc0.Format);
+    for (Uint32 mip = 0; mip < Data0.NumSubresources; ++mip)
+    {
+        const TextureSubResData& Level0   = Data0.pSubResources[mip];
+        const TextureSubResData& Level1   = Data1.pSubResources[mip];
+        const MipLevelProperties MipProps = GetMipLevelProperties(Desc0, mip);
+        const Uint32             NumRows  = MipProps.StorageHeight / FmtAttribs.BlockHeight;
+        // Compare the rows separately as the strides may include different padding
+        for (Uint32 row = 0; row < NumRows; ++row)
+        {
+            const Uint8* pRow0 = static_cast<const Uint8*>(Level0.pData) + row * Level0.Stride;
+            const Uint8* pRow1 = static_cast<const Uint8*>(Level1.pData) + row * Level1.Stride;
+            if (memcmp(pRow0, pRow1, static_cast<size_t>(MipProps.RowSize)) != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+size_t HnTextureRegistry::SamplerDescHasher::operator()(const SamplerDesc& Desc) const
+{
+    // Name is ignored by the SamplerDesc comparison operator
+    return ComputeHash(Desc.MinFilter, Desc.MagFilter, Desc.MipFilter,
+                       Desc.AddressU, Desc.AddressV, Desc.AddressW,
+                       Desc.Flags, Desc.UnnormalizedCoords, Desc.MipLODBias,
+                       Desc.MaxAnisotropy, Desc.ComparisonFunc,
+                       Desc.BorderColor[0], Desc.BorderColor[1], Desc.BorderColor[2], Desc.BorderColor[3],
+                       Desc.MinLOD, Desc.MaxLOD);
+}
+
 HnTextureRegistry::HnTextureRegistry(IRenderDevice*         pDevice,
-                                     GLTF::ResourceManager* pResourceManager) :
+                                     GLTF::ResourceManager* pResourceManager,
+                                     IThreadPool*           pLoadingPool,
+                                     bool                   EnableStreaming,
+                                     Uint64                 StreamingBudget,
+                                     bool                   CompressTextures,
+                                     const std::string&     CompressionCacheDir,
+                                     float                  AtlasDefragThreshold,
+                                     Uint64                 AtlasDefragBudget) :
     m_pDevice{pDevice},
-    m_pResourceManager{pResourceManager}
+    m_pResourceManager{pResourceManager},
+    m_pLoadingPool{pLoadingPool},
+    m_CompressTextures{CompressTextures && pDevice->GetDeviceInfo().Features.TextureCompressionBC},
+    m_CompressionCacheDir{m_CompressTextures ? CompressionCacheDir : std::string{}},
+    m_Streaming{EnableStreaming, StreamingBudget},
+    m_AtlasDefrag{pResourceManager != nullptr ? AtlasDefragThreshold : 0.f, AtlasDefragBudget}
 {
+    if (CompressTextures && !m_CompressTextures)
+    {
+        LOG_WARNING_MESSAGE("Texture compression is disabled as the device does not support BC texture formats");
+    }
+
+    if (!m_CompressionCacheDir.empty() && !FileSystem::PathExists(m_CompressionCacheDir.c_str()))
+    {
+        if (!FileSystem::CreateDirectory(m_CompressionCacheDir.c_str()))
+        {
+            LOG_ERROR_MESSAGE("Failed to create compressed texture cache directory ", m_CompressionCacheDir);
+        }
+    }
 }
 
 HnTextureRegistry::~HnTextureRegistry()
 {
+    // Loading tasks reference the registry, so wait for them to finish.
+    // Do not hold the mutex as the tasks need it to add pending textures.
+    std::vector<RefCntAutoPtr<IAsyncTask>> LoadingTasks;
+    {
+        std::lock_guard<std::mutex> Lock{m_PendingTexturesMtx};
+        LoadingTasks.swap(m_LoadingTasks);
+    }
+    for (IAsyncTask* pTask : LoadingTasks)
+        pTask->WaitForCompletion();
 }
 
 void HnTextureRegistry::InitializeHandle(IRenderDevice*     pDevice,
                                          IDeviceContext*    pContext,
                                          ITextureLoader*    pLoader,
                                          const SamplerDesc& SamDesc,
-                                         TextureHandle&     Handle)
+                                         TextureHandle&     Handle,
+                                         Uint32             FirstMip)
 {
     if (Handle.pAtlasSuballocation != nullptr)
     {
@@ -80,7 +197,10 @@ void HnTextureRegistry::InitializeHandle(IRenderDevice*     pDevice,
             UpdateBox.MaxX = UpdateBox.MinX + MipProps.LogicalWidth;
             UpdateBox.MinY = Origin.y >> mip;
             UpdateBox.MaxY = UpdateBox.MinY + MipProps.LogicalHeight;
-            pContext->UpdateTexture(pDstTex, mip, Slice, UpdateBox, LevelData, RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            // Atlas texture is shared by all textures. When recording into a deferred context,
+            // it is transitioned to the copy destination state by the Commit() method.
+            pContext->UpdateTexture(pDstTex, mip, Slice, UpdateBox, LevelData, RESOURCE_STATE_TRANSITION_MODE_NONE,
+                                    pContext->GetDesc().IsDeferred ? RESOURCE_STATE_TRANSITION_MODE_VERIFY : RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
         }
     }
     else
@@ -95,10 +215,21 @@ void HnTextureRegistry::InitializeHandle(IRenderDevice*     pDevice,
                 TexDesc.ArraySize = 1;
 
                 TextureData InitData = pLoader->GetTextureData();
+                if (FirstMip > 0)
+                {
+                    // Skip the most detailed mip levels of the streamed texture
+                    VERIFY_EXPR(FirstMip < InitData.NumSubresources);
+                    TexDesc.Width     = std::max(TexDesc.Width >> FirstMip, 1u);
+                    TexDesc.Height    = std::max(TexDesc.Height >> FirstMip, 1u);
+                    TexDesc.MipLevels = InitData.NumSubresources - FirstMip;
+                    InitData.pSubResources += FirstMip;
+                    InitData.NumSubresources -= FirstMip;
+                }
                 pDevice->CreateTexture(TexDesc, &InitData, &Handle.pTexture);
             }
             else
             {
+                VERIFY(FirstMip == 0, "Only 2D textures can be streamed");
                 pLoader->CreateTexture(pDevice, &Handle.pTexture);
             }
             if (!Handle.pTexture)
@@ -107,7 +238,7 @@ void HnTextureRegistry::InitializeHandle(IRenderDevice*     pDevice,
                 return;
             }
 
-            pDevice->CreateSampler(SamDesc, &Handle.pSampler);
+            Handle.pSampler = GetSampler(SamDesc);
             VERIFY_EXPR(Handle.pSampler);
             Handle.pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)->SetSampler(Handle.pSampler);
         }
@@ -120,84 +251,688 @@ void HnTextureRegistry::InitializeHandle(IRenderDevice*     pDevice,
     }
 }
 
-void HnTextureRegistry::Commit(IDeviceContext* pContext)
+void HnTextureRegistry::Commit(IDeviceContext* pContext, HnParallelCommandRecorder* pRecorder)
 {
     if (m_pResourceManager)
     {
         m_pResourceManager->UpdateTextures(m_pDevice, pContext);
     }
     std::lock_guard<std::mutex> Lock{m_PendingTexturesMtx};
-    for (auto tex_it : m_PendingTextures)
+
+    m_LoadingTasks.erase(std::remove_if(m_LoadingTasks.begin(), m_LoadingTasks.end(),
+                                        [](IAsyncTask* pTask) { return pTask->IsFinished(); }),
+                         m_LoadingTasks.end());
+
+    if (m_PendingTextures.empty())
+        return;
+
+    if (pRecorder == nullptr || !pRecorder->IsEnabled())
+    {
+        for (auto& tex_it : m_PendingTextures)
+        {
+            if (tex_it.second.IsAlias)
+                continue;
+            InitializeHandle(m_pDevice, pContext, tex_it.second.pLoader, tex_it.second.SamDesc, *tex_it.second.Handle, tex_it.second.FirstMip);
+        }
+    }
+    else
+    {
+        if (m_pResourceManager)
+        {
+            // Atlases are shared by all textures. State transitions are not thread-safe,
+            // so transition the atlases to the copy destination state before recording the commands.
+            GLTF::ResourceManager::TransitionResourceStatesInfo TRSInfo;
+            TRSInfo.TextureAtlases.NewState = RESOURCE_STATE_COPY_DEST;
+            m_pResourceManager->TransitionResourceStates(m_pDevice, pContext, TRSInfo);
+        }
+
+        std::vector<PendingTextureInfo*> PendingTextures;
+        PendingTextures.reserve(m_PendingTextures.size());
+        for (auto& tex_it : m_PendingTextures)
+        {
+            if (!tex_it.second.IsAlias)
+                PendingTextures.push_back(&tex_it.second);
+        }
+
+        pRecorder->Process(PendingTextures,
+                           [this](PendingTextureInfo* pTexInfo, IDeviceContext* pCtx) {
+                               InitializeHandle(m_pDevice, pCtx, pTexInfo->pLoader, pTexInfo->SamDesc, *pTexInfo->Handle, pTexInfo->FirstMip);
+                           });
+    }
+
+    // Publish asynchronously loaded textures. Their handles may be accessed by other threads
+    // during the sync, so they are only modified here, after the textures are fully initialized.
+    bool TexturesPublished = false;
+    auto PublishTexture    = [&TexturesPublished](const PendingTextureInfo& TexInfo) {
+        TextureHandle& Target      = *TexInfo.TargetHandle;
+        Target.pTexture            = TexInfo.Handle->pTexture;
+        Target.pSampler            = TexInfo.Handle->pSampler;
+        Target.pAtlasSuballocation = TexInfo.Handle->pAtlasSuballocation;
+        Target.IsLoading           = TexInfo.Handle->IsLoading;
+        ++Target.Version;
+        TexturesPublished = true;
+    };
+
+    for (auto& tex_it : m_PendingTextures)
     {
-        InitializeHandle(m_pDevice, pContext, tex_it.second.pLoader, tex_it.second.SamDesc, *tex_it.second.Handle);
+        const PendingTextureInfo& TexInfo = tex_it.second;
+        if (TexInfo.IsAlias)
+            continue;
+
+        if (TexInfo.TargetHandle)
+            PublishTexture(TexInfo);
+
+        if (m_AtlasDefrag.Threshold > 0 && TexInfo.Handle->pAtlasSuballocation)
+            m_AtlasDefrag.Textures.emplace_back(TexInfo.TargetHandle ? TexInfo.TargetHandle : TexInfo.Handle);
+
+        if (TexInfo.IsStreamed && TexInfo.Handle->pTexture)
+        {
+            StreamingTextureInfo StreamingTex;
+            StreamingTex.Handles.emplace_back(TexInfo.TargetHandle ? TexInfo.TargetHandle : TexInfo.Handle);
+            StreamingTex.pLoader           = TexInfo.pLoader;
+            StreamingTex.SamDesc           = TexInfo.SamDesc;
+            StreamingTex.FirstMip          = TexInfo.FirstMip;
+            StreamingTex.MaxFirstMip       = TexInfo.FirstMip;
+            StreamingTex.RequestedFirstMip = TexInfo.FirstMip;
+            m_Streaming.Textures.emplace_back(std::move(StreamingTex));
+        }
+    }
+
+    // Textures that share the resources of other textures are published last
+    // as the source textures may have been published by the loop above.
+    for (auto& tex_it : m_PendingTextures)
+    {
+        const PendingTextureInfo& TexInfo = tex_it.second;
+        if (!TexInfo.IsAlias)
+            continue;
+
+        PublishTexture(TexInfo);
+
+        if (m_AtlasDefrag.Threshold > 0 && TexInfo.Handle->pAtlasSuballocation)
+            m_AtlasDefrag.Textures.emplace_back(TexInfo.TargetHandle);
+
+        // Make the streaming update the resources of the alias together with the source texture
+        for (StreamingTextureInfo& StreamingTex : m_Streaming.Textures)
+        {
+            if (StreamingTex.Handles.front().lock() == TexInfo.Handle)
+            {
+                StreamingTex.Handles.emplace_back(TexInfo.TargetHandle);
+                break;
+            }
+        }
     }
+    if (TexturesPublished)
+        ++m_StorageVersion;
+
     m_PendingTextures.clear();
+
+    for (auto it = m_ContentCache.begin(); it != m_ContentCache.end();)
+    {
+        if (it->second.Handle.expired() || !it->second.pLoader.IsValid())
+            it = m_ContentCache.erase(it);
+        else
+            ++it;
+    }
+}
+
+void HnTextureRegistry::AddPendingTexture(const pxr::TfToken&           Key,
+                                          const pxr::TfToken&           FilePath,
+                                          RefCntAutoPtr<ITextureLoader> pLoader,
+                                          const SamplerDesc&            SamDesc,
+                                          TextureHandleSharedPtr        Handle,
+                                          TextureHandleSharedPtr        TargetHandle)
+{
+    // Textures with the same contents and sampler share the resources. The sampler is
+    // part of the key as it is set in the default view of the shared texture.
+    size_t ContentHash = ComputeTextureContentHash(pLoader);
+    if (ContentHash != 0)
+    {
+        HashCombine(ContentHash, SamplerDescHasher{}(SamDesc));
+
+        std::lock_guard<std::mutex> Lock{m_PendingTexturesMtx};
+
+        auto it = m_ContentCache.find(ContentHash);
+        if (it != m_ContentCache.end())
+        {
+            TextureHandleSharedPtr        SrcHandle  = it->second.Handle.lock();
+            RefCntAutoPtr<ITextureLoader> pSrcLoader = it->second.pLoader.Lock();
+            // Compare the data to make sure this is not a hash collision
+            if (SrcHandle && pSrcLoader && TextureContentsEqual(pSrcLoader, pLoader))
+            {
+                PendingTextureInfo TexInfo;
+                TexInfo.SamDesc      = SamDesc;
+                TexInfo.Handle       = std::move(SrcHandle);
+                TexInfo.TargetHandle = TargetHandle ? std::move(TargetHandle) : std::move(Handle);
+                TexInfo.IsAlias      = true;
+                m_PendingTextures.emplace(Key, std::move(TexInfo));
+                m_ContentHits.fetch_add(1);
+                return;
+            }
+        }
+    }
+
+    // Try to allocate texture in the atlas first.
+    // Compressed textures are always created as standalone textures.
+    const bool IsCompressed = GetTextureFormatAttribs(pLoader->GetTextureDesc().Format).ComponentType == COMPONENT_TYPE_COMPRESSED;
+    if (m_pResourceManager != nullptr && !IsCompressed)
+    {
+        const auto& TexDesc   = pLoader->GetTextureDesc();
+        const auto& AtlasDesc = m_pResourceManager->GetAtlasDesc(TexDesc.Format);
+        if (TexDesc.Width <= AtlasDesc.Width && TexDesc.Height <= AtlasDesc.Height)
+        {
+            Handle->pAtlasSuballocation = m_pResourceManager->AllocateTextureSpace(TexDesc.Format, TexDesc.Width, TexDesc.Height);
+            if (!Handle->pAtlasSuballocation)
+            {
+                LOG_ERROR_MESSAGE("Failed to allocate atlas region for texture ", FilePath);
+                // The atlas may be fragmented
+                m_AtlasDefrag.AllocationFailures.fetch_add(1);
+            }
+        }
+        else
+        {
+            LOG_WARNING_MESSAGE("Texture ", FilePath, " is too large to fit into atlas (", TexDesc.Width, "x", TexDesc.Height, " vs ", AtlasDesc.Width, "x", AtlasDesc.Height, ")");
+        }
+    }
+
+    PendingTextureInfo TexInfo{std::move(pLoader), SamDesc, std::move(Handle), std::move(TargetHandle)};
+
+    // If the texture was not allocated in the atlas (because the atlas is disabled or because it does not fit),
+    // try to create it as a standalone texture.
+    if (!TexInfo.Handle->pAtlasSuballocation)
+    {
+        // Streamed textures start with the low-resolution mip levels only
+        TexInfo.FirstMip   = GetStreamingMaxFirstMip(TexInfo.pLoader);
+        TexInfo.IsStreamed = TexInfo.FirstMip > 0;
+
+        if (m_pDevice->GetDeviceInfo().Features.MultithreadedResourceCreation)
+        {
+            InitializeHandle(m_pDevice, nullptr, TexInfo.pLoader, SamDesc, *TexInfo.Handle, TexInfo.FirstMip);
+        }
+    }
+
+    // Finish initialization in the main thread: we either need to upload the texture data to the atlas or
+    // create the texture in the main thread if the device does not support multithreaded resource creation
+    // and transition it to the shader resource state.
+    {
+        std::lock_guard<std::mutex> Lock{m_PendingTexturesMtx};
+        if (ContentHash != 0)
+        {
+            ContentCacheEntry& Entry = m_ContentCache[ContentHash];
+            Entry.Handle             = TexInfo.TargetHandle ? TexInfo.TargetHandle : TexInfo.Handle;
+            Entry.pLoader            = RefCntWeakPtr<ITextureLoader>{TexInfo.pLoader.RawPtr()};
+        }
+        m_PendingTextures.emplace(Key, std::move(TexInfo));
+    }
+}
+
+RefCntAutoPtr<ISampler> HnTextureRegistry::GetSampler(const SamplerDesc& SamDesc)
+{
+    std::lock_guard<std::mutex> Lock{m_SamplersMtx};
+
+    auto it = m_Samplers.find(SamDesc);
+    if (it != m_Samplers.end())
+    {
+        m_SamplerHits.fetch_add(1);
+        return it->second;
+    }
+
+    RefCntAutoPtr<ISampler> pSampler;
+    m_pDevice->CreateSampler(SamDesc, &pSampler);
+    if (pSampler)
+        m_Samplers.emplace(SamDesc, pSampler);
+    return pSampler;
+}
+
+static float GetAtlasUtilization(const DynamicTextureAtlasUsageStats& Stats)
+{
+    return Stats.TotalArea > 0 ?
+        static_cast<float>(static_cast<double>(Stats.AllocatedArea) / static_cast<double>(Stats.TotalArea)) :
+        0.f;
+}
+
+bool HnTextureRegistry::MoveAtlasRegion(IDeviceContext* pContext, const ITextureAtlasSuballocation* pRegion, Uint64& MovedBytes)
+{
+    // Find all handles that reference the region, e.g. textures with the same contents
+    std::vector<TextureHandleSharedPtr> Handles;
+    for (const std::weak_ptr<TextureHandle>& wpHandle : m_AtlasDefrag.Textures)
+    {
+        TextureHandleSharedPtr Handle = wpHandle.lock();
+        if (Handle && Handle->pAtlasSuballocation == pRegion)
+            Handles.emplace_back(std::move(Handle));
+    }
+    if (Handles.empty())
+        return false; // The region has been released
+
+    RefCntAutoPtr<ITextureAtlasSuballocation> pSrcRegion = Handles[0]->pAtlasSuballocation;
+
+    const TEXTURE_FORMAT Format = pSrcRegion->GetAtlas()->GetAtlasDesc().Format;
+    const uint2          Size   = pSrcRegion->GetSize();
+
+    RefCntAutoPtr<ITextureAtlasSuballocation> pDstRegion = m_pResourceManager->AllocateTextureSpace(Format, Size.x, Size.y);
+    if (!pDstRegion)
+        return false;
+
+    // The allocation may have expanded the atlas
+    m_pResourceManager->UpdateTextures(m_pDevice, pContext);
+
+    IDynamicTextureAtlas* pAtlas    = pDstRegion->GetAtlas();
+    ITexture*             pAtlasTex = pAtlas->GetTexture();
+
+    TextureDesc ScratchDesc;
+    ScratchDesc.Name      = "Atlas defragmentation scratch texture";
+    ScratchDesc.Type      = RESOURCE_DIM_TEX_2D;
+    ScratchDesc.Width     = Size.x;
+    ScratchDesc.Height    = Size.y;
+    ScratchDesc.Format    = Format;
+    ScratchDesc.Usage     = USAGE_DEFAULT;
+    ScratchDesc.BindFlags = BIND_SHADER_RESOURCE;
+    ScratchDesc.MipLevels = 1;
+    while (ScratchDesc.MipLevels < pAtlas->GetAtlasDesc().MipLevels && (std::min(Size.x, Size.y) >> ScratchDesc.MipLevels) > 0)
+        ++ScratchDesc.MipLevels;
+
+    // The source and destination regions are in the same texture that can't be in the
+    // copy source and destination states at the same time, so copy through a scratch texture.
+    RefCntAutoPtr<ITexture> pScratchTex;
+    m_pDevice->CreateTexture(ScratchDesc, nullptr, &pScratchTex);
+    if (!pScratchTex)
+    {
+        UNEXPECTED("Failed to create atlas defragmentation scratch texture");
+        return false;
+    }
+
+    const uint2& SrcOrigin = pSrcRegion->GetOrigin();
+    const uint2& DstOrigin = pDstRegion->GetOrigin();
+    for (Uint32 mip = 0; mip < ScratchDesc.MipLevels; ++mip)
+    {
+        const MipLevelProperties MipProps = GetMipLevelProperties(ScratchDesc, mip);
+
+        Box SrcBox;
+        SrcBox.MinX = SrcOrigin.x >> mip;
+        SrcBox.MaxX = SrcBox.MinX + MipProps.LogicalWidth;
+        SrcBox.MinY = SrcOrigin.y >> mip;
+        SrcBox.MaxY = SrcBox.MinY + MipProps.LogicalHeight;
+
+        CopyTextureAttribs CopyAttribs;
+        CopyAttribs.pSrcTexture              = pAtlasTex;
+        CopyAttribs.SrcMipLevel              = mip;
+        CopyAttribs.SrcSlice                 = pSrcRegion->GetSlice();
+        CopyAttribs.pSrcBox                  = &SrcBox;
+        CopyAttribs.SrcTextureTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+        CopyAttribs.pDstTexture              = pScratchTex;
+        CopyAttribs.DstMipLevel              = mip;
+        CopyAttribs.DstTextureTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+        pContext->CopyTexture(CopyAttribs);
+
+        CopyAttribs.pSrcTexture = pScratchTex;
+        CopyAttribs.SrcSlice    = 0;
+        CopyAttribs.pSrcBox     = nullptr;
+        CopyAttribs.pDstTexture = pAtlasTex;
+        CopyAttribs.DstSlice    = pDstRegion->GetSlice();
+        CopyAttribs.DstX        = DstOrigin.x >> mip;
+        CopyAttribs.DstY        = DstOrigin.y >> mip;
+        pContext->CopyTexture(CopyAttribs);
+
+        MovedBytes += MipProps.MipSize;
+    }
+
+    // The source region is released when the last handle that references it is updated
+    for (const TextureHandleSharedPtr& Handle : Handles)
+    {
+        Handle->pAtlasSuballocation = pDstRegion;
+        ++Handle->Version;
+    }
+
+    return true;
+}
+
+void HnTextureRegistry::UpdateAtlasDefragmentation(IDeviceContext* pContext)
+{
+    if (m_AtlasDefrag.Threshold <= 0)
+        return;
+
+    std::vector<std::weak_ptr<TextureHandle>>&               Textures = m_AtlasDefrag.Textures;
+    std::vector<RefCntAutoPtr<ITextureAtlasSuballocation>>& Queue    = m_AtlasDefrag.Queue;
+
+    if (Queue.empty())
+    {
+        // Remove the textures that are no longer used
+        Textures.erase(std::remove_if(Textures.begin(), Textures.end(),
+                                      [](const std::weak_ptr<TextureHandle>& wpHandle) { return wpHandle.expired(); }),
+                       Textures.end());
+
+        // Only repack the atlas when a texture did not fit into it
+        if (m_AtlasDefrag.AllocationFailures.exchange(0) == 0)
+            return;
+
+        const float Utilization = GetAtlasUtilization(m_pResourceManager->GetAtlasUsageStats());
+        if (1.f - Utilization < m_AtlasDefrag.Threshold)
+            return;
+
+        // Collect unique regions, the same region may be referenced by several handles
+        std::vector<RefCntAutoPtr<ITextureAtlasSuballocation>> Regions;
+        for (const std::weak_ptr<TextureHandle>& wpHandle : Textures)
+        {
+            if (TextureHandleSharedPtr Handle = wpHandle.lock())
+            {
+                if (Handle->pAtlasSuballocation)
+                    Regions.push_back(Handle->pAtlasSuballocation);
+            }
+        }
+        std::sort(Regions.begin(), Regions.end(), [](const auto& pRegion0, const auto& pRegion1) { return pRegion0.RawPtr() < pRegion1.RawPtr(); });
+        Regions.erase(std::unique(Regions.begin(), Regions.end()), Regions.end());
+
+        // A region is moved while its source space is still allocated, so the new allocation can't reuse it.
+        // Small regions are moved first: they fit into the holes between other regions, and the space they
+        // release merges with the neighboring free space into larger blocks that the larger regions can use later.
+        // Moving the large regions first would most likely fail or expand the atlas when it is fragmented.
+        std::sort(Regions.begin(), Regions.end(), [](const auto& pRegion0, const auto& pRegion1) {
+            const uint2& Size0 = pRegion0->GetSize();
+            const uint2& Size1 = pRegion1->GetSize();
+            const Uint64 Area0 = Uint64{Size0.x} * Size0.y;
+            const Uint64 Area1 = Uint64{Size1.x} * Size1.y;
+            return Area0 != Area1 ? Area0 < Area1 : Size0.y < Size1.y;
+        });
+        if (Regions.empty())
+            return;
+
+        // Process the queue from the back
+        Queue.assign(std::make_move_iterator(Regions.rbegin()), std::make_move_iterator(Regions.rend()));
+
+        m_AtlasDefrag.UtilizationBefore.store(Utilization);
+        m_AtlasDefrag.PassCount.fetch_add(1);
+        m_AtlasDefrag.InProgress.store(true);
+    }
+
+    Uint64 MovedBytes = 0;
+    while (!Queue.empty() && MovedBytes < m_AtlasDefrag.Budget)
+    {
+        // The source region is released when the last handle that references it gets
+        // the new region and this reference goes out of scope.
+        const RefCntAutoPtr<ITextureAtlasSuballocation> pRegion = std::move(Queue.back());
+        Queue.pop_back();
+        if (MoveAtlasRegion(pContext, pRegion.RawPtr(), MovedBytes))
+            m_AtlasDefrag.MovedRegionCount.fetch_add(1);
+    }
+
+    if (MovedBytes > 0)
+    {
+        m_AtlasDefrag.MovedBytes.fetch_add(MovedBytes);
+        ++m_StorageVersion;
+    }
+
+    if (Queue.empty())
+    {
+        m_AtlasDefrag.UtilizationAfter.store(GetAtlasUtilization(m_pResourceManager->GetAtlasUsageStats()));
+        m_AtlasDefrag.InProgress.store(false);
+    }
+}
+
+HnTextureRegistry::AtlasDefragStats HnTextureRegistry::GetAtlasDefragStats() const
+{
+    AtlasDefragStats Stats;
+    Stats.UtilizationBefore = m_AtlasDefrag.UtilizationBefore.load();
+    Stats.UtilizationAfter  = m_AtlasDefrag.UtilizationAfter.load();
+    Stats.PassCount         = m_AtlasDefrag.PassCount.load();
+    Stats.MovedRegionCount  = m_AtlasDefrag.MovedRegionCount.load();
+    Stats.MovedBytes        = m_AtlasDefrag.MovedBytes.load();
+    Stats.InProgress        = m_AtlasDefrag.InProgress.load();
+    return Stats;
+}
+
+HnTextureRegistry::CacheStats HnTextureRegistry::GetCacheStats() const
+{
+    CacheStats Stats;
+    Stats.ContentHits = m_ContentHits.load();
+    Stats.SamplerHits = m_SamplerHits.load();
+    {
+        std::lock_guard<std::mutex> Lock{m_SamplersMtx};
+        Stats.SamplerCount = static_cast<Uint32>(m_Samplers.size());
+    }
+    return Stats;
+}
+
+Uint32 HnTextureRegistry::GetStreamingMaxFirstMip(ITextureLoader* pLoader) const
+{
+    // Streamed textures are never reduced below this resolution
+    constexpr Uint32 MinStreamingResolution = 64;
+
+    const TextureDesc& Desc = pLoader->GetTextureDesc();
+    if (!m_Streaming.Enabled || Desc.Type != RESOURCE_DIM_TEX_2D)
+        return 0;
+
+    const TextureFormatAttribs& FmtAttribs   = GetTextureFormatAttribs(Desc.Format);
+    const bool                  IsCompressed = FmtAttribs.ComponentType == COMPONENT_TYPE_COMPRESSED;
+
+    const Uint32 NumMips  = pLoader->GetTextureData().NumSubresources;
+    Uint32       FirstMip = 0;
+    while (FirstMip + 1 < NumMips)
+    {
+        const Uint32 Width  = Desc.Width >> (FirstMip + 1);
+        const Uint32 Height = Desc.Height >> (FirstMip + 1);
+        if (std::max(Width, Height) < MinStreamingResolution)
+            break;
+        // The dimensions of the most detailed level of a compressed texture must be multiples of the block size
+        if (IsCompressed && (Width % FmtAttribs.BlockWidth != 0 || Height % FmtAttribs.BlockHeight != 0))
+            break;
+        ++FirstMip;
+    }
+
+    return FirstMip;
+}
+
+Uint64 HnTextureRegistry::StreamingTextureInfo::GetSize(Uint32 Mip) const
+{
+    const TextureDesc& Desc    = pLoader->GetTextureDesc();
+    const Uint32       NumMips = pLoader->GetTextureData().NumSubresources;
+
+    Uint64 Size = 0;
+    for (Uint32 mip = Mip; mip < NumMips; ++mip)
+        Size += GetMipLevelProperties(Desc, mip).MipSize;
+    return Size;
+}
+
+void HnTextureRegistry::UpdateStreaming(IDeviceContext* pContext, Uint32 FrameNumber)
+{
+    if (!m_Streaming.Enabled)
+        return;
+
+    // The maximum size of the texture data uploaded to raise the resolution in one update
+    constexpr Uint64 MaxUploadSize = Uint64{64} << Uint64{20};
+
+    std::vector<StreamingTextureInfo>& Textures = m_Streaming.Textures;
+
+    // Remove the textures that are no longer used
+    Textures.erase(std::remove_if(Textures.begin(), Textures.end(),
+                                  [](const StreamingTextureInfo& Tex) {
+                                      return std::all_of(Tex.Handles.begin(), Tex.Handles.end(),
+                                                         [](const std::weak_ptr<TextureHandle>& wpHandle) { return wpHandle.expired(); });
+                                  }),
+                   Textures.end());
+
+    Uint64 ResidentSize  = 0;
+    Uint64 RequestedSize = 0;
+
+    std::vector<StreamingTextureInfo*> Upgrades;
+    std::vector<StreamingTextureInfo*> EvictionCandidates;
+    for (StreamingTextureInfo& Tex : Textures)
+    {
+        Uint32 Resolution = 0;
+        for (const std::weak_ptr<TextureHandle>& wpHandle : Tex.Handles)
+        {
+            if (TextureHandleSharedPtr Handle = wpHandle.lock())
+                Resolution = std::max(Resolution, Handle->RequestedResolution.exchange(0));
+        }
+        if (Resolution > 0)
+        {
+            // Find the least detailed mip level that provides the requested resolution
+            const TextureDesc& Desc    = Tex.pLoader->GetTextureDesc();
+            const Uint32       FullRes = std::max(Desc.Width, Desc.Height);
+
+            Tex.RequestedFirstMip = 0;
+            while (Tex.RequestedFirstMip < Tex.MaxFirstMip && (FullRes >> (Tex.RequestedFirstMip + 1)) >= Resolution)
+                ++Tex.RequestedFirstMip;
+            Tex.LastRequestedFrame = FrameNumber;
+        }
+        else
+        {
+            // The texture was not used by any draw item and can be reduced to the lowest resolution
+            Tex.RequestedFirstMip = Tex.MaxFirstMip;
+        }
+
+        ResidentSize += Tex.GetSize(Tex.FirstMip);
+        RequestedSize += Tex.GetSize(Tex.RequestedFirstMip);
+
+        if (Tex.RequestedFirstMip < Tex.FirstMip)
+            Upgrades.push_back(&Tex);
+        else if (Tex.RequestedFirstMip > Tex.FirstMip)
+            EvictionCandidates.push_back(&Tex);
+    }
+
+    Uint64 UploadSize = 0;
+    bool   Updated    = false;
+
+    auto SetFirstMip = [&](StreamingTextureInfo& Tex, Uint32 FirstMip) {
+        TextureHandle NewHandle;
+        InitializeHandle(m_pDevice, pContext, Tex.pLoader, Tex.SamDesc, NewHandle, FirstMip);
+        if (!NewHandle.pTexture)
+            return false;
+
+        // Materials that use the texture re-create their SRBs when they detect the new version
+        for (const std::weak_ptr<TextureHandle>& wpHandle : Tex.Handles)
+        {
+            if (TextureHandleSharedPtr Handle = wpHandle.lock())
+            {
+                Handle->pTexture = NewHandle.pTexture;
+                Handle->pSampler = NewHandle.pSampler;
+                ++Handle->Version;
+            }
+        }
+
+        const Uint64 NewSize = Tex.GetSize(FirstMip);
+        ResidentSize         = ResidentSize - Tex.GetSize(Tex.FirstMip) + NewSize;
+        UploadSize += NewSize;
+        Tex.FirstMip = FirstMip;
+        Updated      = true;
+        return true;
+    };
+
+    // Reduce the least recently requested textures to the requested resolution first
+    std::sort(EvictionCandidates.begin(), EvictionCandidates.end(), [](const StreamingTextureInfo* pTex0, const StreamingTextureInfo* pTex1) {
+        return pTex0->LastRequestedFrame < pTex1->LastRequestedFrame;
+    });
+    size_t NextEvictionCandidate = 0;
+
+    const Uint64 Budget     = m_Streaming.Budget;
+    auto         FreeMemory = [&](Uint64 RequiredSize) {
+        while (ResidentSize + RequiredSize > Budget && NextEvictionCandidate < EvictionCandidates.size())
+        {
+            StreamingTextureInfo& Tex = *EvictionCandidates[NextEvictionCandidate++];
+            SetFirstMip(Tex, Tex.RequestedFirstMip);
+        }
+        return ResidentSize + RequiredSize <= Budget;
+    };
+
+    if (Budget > 0 && ResidentSize > Budget)
+        FreeMemory(0);
+
+    // Raise the resolution of the textures with the largest deficit first
+    std::sort(Upgrades.begin(), Upgrades.end(), [](const StreamingTextureInfo* pTex0, const StreamingTextureInfo* pTex1) {
+        return pTex0->FirstMip - pTex0->RequestedFirstMip > pTex1->FirstMip - pTex1->RequestedFirstMip;
+    });
+    for (StreamingTextureInfo* pTex : Upgrades)
+    {
+        if (UploadSize >= MaxUploadSize)
+            break;
+
+        const Uint64 RequiredSize = pTex->GetSize(pTex->RequestedFirstMip) - pTex->GetSize(pTex->FirstMip);
+        if (Budget > 0 && !FreeMemory(RequiredSize))
+            break;
+
+        SetFirstMip(*pTex, pTex->RequestedFirstMip);
+    }
+
+    if (Updated)
+        ++m_StorageVersion;
+
+    m_Streaming.ResidentSize.store(ResidentSize);
+    m_Streaming.RequestedSize.store(RequestedSize);
+    m_Streaming.TextureCount.store(static_cast<Uint32>(Textures.size()));
+}
+
+HnTextureRegistry::StreamingStats HnTextureRegistry::GetStreamingStats() const
+{
+    StreamingStats Stats;
+    Stats.Budget        = m_Streaming.Budget;
+    Stats.ResidentSize  = m_Streaming.ResidentSize.load();
+    Stats.RequestedSize = m_Streaming.RequestedSize.load();
+    Stats.TextureCount  = m_Streaming.TextureCount.load();
+    return Stats;
 }
 
 HnTextureRegistry::TextureHandleSharedPtr HnTextureRegistry::Allocate(const pxr::TfToken&                            FilePath,
                                                                       const TextureComponentMapping&                 Swizzle,
                                                                       const pxr::HdSamplerParameters&                SamplerParams,
-                                                                      std::function<RefCntAutoPtr<ITextureLoader>()> CreateLoader)
+                                                                      std::function<RefCntAutoPtr<ITextureLoader>()> CreateLoader,
+                                                                      bool                                           AsyncLoad)
 {
     const pxr::TfToken Key{FilePath.GetString() + '.' + GetTextureComponentMappingString(Swizzle)};
     return m_Cache.Get(
         Key,
         [&]() {
-            RefCntAutoPtr<ITextureLoader> pLoader = CreateLoader();
-            if (!pLoader)
-            {
-                LOG_ERROR_MESSAGE("Failed to create texture loader for texture ", FilePath);
-                return TextureHandleSharedPtr{};
-            }
+            const SamplerDesc SamDesc = HdSamplerParametersToSamplerDesc(SamplerParams);
 
             auto TexHandle       = std::make_shared<TextureHandle>();
             TexHandle->TextureId = m_NextTextureId.fetch_add(1);
 
-            auto SamDesc = HdSamplerParametersToSamplerDesc(SamplerParams);
-            // Try to allocate texture in the atlas first
-            if (m_pResourceManager != nullptr)
+            if (AsyncLoad && m_pLoadingPool)
             {
-                const auto& TexDesc   = pLoader->GetTextureDesc();
-                const auto& AtlasDesc = m_pResourceManager->GetAtlasDesc(TexDesc.Format);
-                if (TexDesc.Width <= AtlasDesc.Width && TexDesc.Height <= AtlasDesc.Height)
-                {
-                    TexHandle->pAtlasSuballocation = m_pResourceManager->AllocateTextureSpace(TexDesc.Format, TexDesc.Width, TexDesc.Height);
-                    if (!TexHandle->pAtlasSuballocation)
-                    {
-                        LOG_ERROR_MESSAGE("Failed to allocate atlas region for texture ", FilePath);
-                    }
-                }
-                else
-                {
-                    LOG_WARNING_MESSAGE("Texture ", FilePath, " is too large to fit into atlas (", TexDesc.Width, "x", TexDesc.Height, " vs ", AtlasDesc.Width, "x", AtlasDesc.Height, ")");
-                }
-            }
+                // Decode the texture in a worker thread. The resources are created in a separate handle
+                // that is published by Commit(). Until then, the returned handle remains in the loading
+                // state. Since the handle is added to the cache, other requests for the same texture
+                // return it and do not start another load.
+                TexHandle->IsLoading = true;
+                m_NumLoadingTextures.fetch_add(1);
 
-            // If the texture was not allocated in the atlas (because the atlas is disabled or because it does not fit),
-            // try to create it as a standalone texture.
-            if (!TexHandle->pAtlasSuballocation)
-            {
-                if (m_pDevice->GetDeviceInfo().Features.MultithreadedResourceCreation)
-                {
-                    InitializeHandle(m_pDevice, nullptr, pLoader, SamDesc, *TexHandle);
-                }
+                RefCntAutoPtr<IAsyncTask> pTask = EnqueueAsyncWork(
+                    m_pLoadingPool,
+                    [this, Key, FilePath, SamDesc, TexHandle, CreateLoader = std::move(CreateLoader)](Uint32 ThreadId) {
+                        if (RefCntAutoPtr<ITextureLoader> pLoader = CreateLoader())
+                        {
+                            auto LoadedHandle       = std::make_shared<TextureHandle>();
+                            LoadedHandle->TextureId = TexHandle->TextureId;
+                            AddPendingTexture(Key, FilePath, std::move(pLoader), SamDesc, std::move(LoadedHandle), TexHandle);
+                        }
+                        else
+                        {
+                            // The handle remains in the loading state, and the default texture is used instead.
+                            LOG_ERROR_MESSAGE("Failed to create texture loader for texture ", FilePath);
+                        }
+                        m_NumLoadingTextures.fetch_sub(1);
+                        return ASYNC_TASK_STATUS_COMPLETE;
+                    });
+
+                std::lock_guard<std::mutex> Lock{m_PendingTexturesMtx};
+                m_LoadingTasks.emplace_back(std::move(pTask));
+                return TexHandle;
             }
 
-            // Finish initialization in the main thread: we either need to upload the texture data to the atlas or
-            // create the texture in the main thread if the device does not support multithreaded resource creation
-            // and transition it to the shader resource state.
+            RefCntAutoPtr<ITextureLoader> pLoader = CreateLoader();
+            if (!pLoader)
             {
-                std::lock_guard<std::mutex> Lock{m_PendingTexturesMtx};
-                m_PendingTextures.emplace(Key, PendingTextureInfo{std::move(pLoader), SamDesc, TexHandle});
+                LOG_ERROR_MESSAGE("Failed to create texture loader for texture ", FilePath);
+                return TextureHandleSharedPtr{};
             }
 
+            AddPendingTexture(Key, FilePath, std::move(pLoader), SamDesc, TexHandle, nullptr);
+
             return TexHandle;
         });
 }
 
 HnTextureRegistry::TextureHandleSharedPtr HnTextureRegistry::Allocate(const HnTextureIdentifier&      TexId,
                                                                       TEXTURE_FORMAT                  Format,
-                                                                      const pxr::HdSamplerParameters& SamplerParams)
+                                                                      const pxr::HdSamplerParameters& SamplerParams,
+                                                                      TEXTURE_FORMAT                  CompressedFormat)
 {
     if (TexId.FilePath.IsEmpty())
     {
@@ -205,8 +940,14 @@ HnTextureRegistry::TextureHandleSharedPtr HnTextureRegistry::Allocate(const HnTe
         return {};
     }
 
+    if (!m_CompressTextures)
+        CompressedFormat = TEX_FORMAT_UNKNOWN;
+
+    // The loader may be created by a worker thread, so capture the identifier by value.
+    // Texture compression is performed by the worker as well.
+    constexpr bool AsyncLoad = true;
     return Allocate(TexId.FilePath, TexId.SubtextureId.Swizzle, SamplerParams,
-                    [&TexId, Format]() {
+                    [TexId, Format, CompressedFormat, CacheDir = m_CompressionCacheDir]() {
                         TextureLoadInfo LoadInfo;
                         LoadInfo.Name   = TexId.FilePath.GetText();
                         LoadInfo.Format = Format;
@@ -217,8 +958,71 @@ HnTextureRegistry::TextureHandleSharedPtr HnTextureRegistry::Allocate(const HnTe
                         LoadInfo.PermultiplyAlpha = TexId.SubtextureId.PremultiplyAlpha;
                         LoadInfo.Swizzle          = TexId.SubtextureId.Swizzle;
 
+                        if (CompressedFormat != TEX_FORMAT_UNKNOWN)
+                            return CreateCompressedTextureLoaderFromSdfPath(TexId.FilePath.GetText(), LoadInfo, CompressedFormat, CacheDir);
+
                         return CreateTextureLoaderFromSdfPath(TexId.FilePath.GetText(), LoadInfo);
-                    });
+                    },
+                    AsyncLoad);
+}
+
+HnTextureRegistry::TextureHandleSharedPtr HnTextureRegistry::AllocatePacked(const std::array<const HnTextureIdentifier*, 4>& Channels,
+                                                                            const pxr::HdSamplerParameters&                  SamplerParams,
+                                                                            TEXTURE_FORMAT                                   CompressedFormat)
+{
+    // The packed texture is identified by the paths and swizzles of its channels, e.g.
+    //     $Packed(ao.png.rrrr|roughness.png.rrrr|metallic.png.rrrr|-)
+    std::array<HnTextureIdentifier, 4> ChannelIds;
+
+    std::string PackedPath = "$Packed(";
+    for (size_t c = 0; c < Channels.size(); ++c)
+    {
+        if (c > 0)
+            PackedPath += '|';
+        if (Channels[c] != nullptr && !Channels[c]->FilePath.IsEmpty())
+        {
+            ChannelIds[c] = *Channels[c];
+            PackedPath += ChannelIds[c].FilePath.GetString() + '.' + GetTextureComponentMappingString(ChannelIds[c].SubtextureId.Swizzle);
+        }
+        else
+        {
+            PackedPath += '-';
+        }
+    }
+    PackedPath += ')';
+
+    if (!m_CompressTextures)
+        CompressedFormat = TEX_FORMAT_UNKNOWN;
+
+    constexpr bool AsyncLoad = true;
+    return Allocate(pxr::TfToken{PackedPath}, TextureComponentMapping::Identity(), SamplerParams,
+                    [ChannelIds, PackedPath, CompressedFormat]() {
+                        std::array<RefCntAutoPtr<ITextureLoader>, 4> ChannelLoaders;
+                        for (size_t c = 0; c < ChannelIds.size(); ++c)
+                        {
+                            const HnTextureIdentifier& TexId = ChannelIds[c];
+                            if (TexId.FilePath.IsEmpty())
+                                continue;
+
+                            TextureLoadInfo LoadInfo;
+                            LoadInfo.Name   = TexId.FilePath.GetText();
+                            LoadInfo.Format = TEX_FORMAT_R8_UNORM;
+                            // Mip levels are generated for the packed texture
+                            LoadInfo.GenerateMips = false;
+
+                            LoadInfo.FlipVertically   = !TexId.SubtextureId.FlipVertically;
+                            LoadInfo.IsSRGB           = TexId.SubtextureId.IsSRGB;
+                            LoadInfo.PermultiplyAlpha = TexId.SubtextureId.PremultiplyAlpha;
+                            LoadInfo.Swizzle          = TexId.SubtextureId.Swizzle;
+
+                            ChannelLoaders[c] = CreateTextureLoaderFromSdfPath(TexId.FilePath.GetText(), LoadInfo);
+                            if (!ChannelLoaders[c])
+                                LOG_ERROR_MESSAGE("Failed to create texture loader for texture ", TexId.FilePath, ". The channel will be filled with 255.");
+                        }
+
+                        return CreatePackedTextureLoader(PackedPath.c_str(), ChannelLoaders, CompressedFormat);
+                    },
+                    AsyncLoad);
 }
 
 Uint32 HnTextureRegistry::GetAtlasVersion() const
@@ -25,32 +25,305 @@
  */
 
 #include "HnTextureUtils.hpp"
+#include "HnTextureCompression.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "pxr/usd/ar/asset.h"
 #include "pxr/usd/ar/resolver.h"
 
+#include "Image.h"
+#include "DataBlobImpl.hpp"
+#include "HashUtils.hpp"
+#include "GraphicsAccessories.hpp"
+#include "DebugUtilities.hpp"
+
 namespace Diligent
 {
 
 namespace USD
 {
 
-RefCntAutoPtr<ITextureLoader> CreateTextureLoaderFromSdfPath(const char*            SdfPath,
-                                                             const TextureLoadInfo& LoadInfo)
+namespace
 {
 
+std::shared_ptr<const char> ReadAsset(const char* SdfPath, size_t& Size)
+{
     pxr::ArResolvedPath           ResolvedPath{SdfPath};
     std::shared_ptr<pxr::ArAsset> Asset = pxr::ArGetResolver().OpenAsset(ResolvedPath);
     if (!Asset)
         return {};
 
+    Size = Asset->GetSize();
+    return Asset->GetBuffer();
+}
+
+// Increment when the compressed data changes to invalidate the existing cache files
+constexpr Uint32 CompressedTextureCacheVersion = 1;
+
+std::string GetCompressedTextureCachePath(const std::string&     CacheDir,
+                                          const char*            pData,
+                                          size_t                 Size,
+                                          const TextureLoadInfo& LoadInfo,
+                                          TEXTURE_FORMAT         CompressedFormat)
+{
+    size_t Hash = ComputeHashRaw(pData, Size);
+    HashCombine(Hash,
+                CompressedTextureCacheVersion,
+                CompressedFormat,
+                LoadInfo.Format,
+                LoadInfo.IsSRGB,
+                LoadInfo.GenerateMips,
+                LoadInfo.FlipVertically,
+                LoadInfo.PermultiplyAlpha,
+                LoadInfo.Swizzle.R,
+                LoadInfo.Swizzle.G,
+                LoadInfo.Swizzle.B,
+                LoadInfo.Swizzle.A);
+
+    std::stringstream PathSS;
+    PathSS << CacheDir;
+    if (CacheDir.back() != '/' && CacheDir.back() != '\\')
+        PathSS << '/';
+    PathSS << std::hex << std::setw(sizeof(Hash) * 2) << std::setfill('0') << Hash << ".dds";
+    return PathSS.str();
+}
+
+RefCntAutoPtr<ITextureLoader> LoadCompressedTextureCache(const std::string& CachePath, const char* Name)
+{
+    std::ifstream CacheFile{CachePath, std::ios::binary | std::ios::ate};
+    if (!CacheFile)
+        return {};
+
+    std::vector<char> Data(static_cast<size_t>(CacheFile.tellg()));
+    CacheFile.seekg(0);
+    if (!CacheFile.read(Data.data(), Data.size()))
+        return {};
+
+    // The cached data is already processed according to the original load info
+    TextureLoadInfo LoadInfo;
+    LoadInfo.Name = Name;
+
+    RefCntAutoPtr<ITextureLoader> pLoader;
+    CreateTextureLoaderFromMemory(Data.data(), Data.size(), true, LoadInfo, &pLoader);
+    return pLoader;
+}
+
+void WriteCompressedTextureCache(const std::string& CachePath, const std::vector<Uint8>& Data)
+{
+    // Different assets with the same contents may be compressed by several threads at the same time.
+    // Write to a temporary file first and then rename it so that readers never see a partial file.
+    const std::string TmpPath = CachePath + '.' + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream TmpFile{TmpPath, std::ios::binary | std::ios::trunc};
+        if (!TmpFile.write(reinterpret_cast<const char*>(Data.data()), Data.size()))
+        {
+            LOG_WARNING_MESSAGE("Failed to write compressed texture cache file ", TmpPath);
+            TmpFile.close();
+            std::remove(TmpPath.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(TmpPath.c_str(), CachePath.c_str()) != 0)
+    {
+        // The file may have been written by another thread
+        std::remove(TmpPath.c_str());
+    }
+}
+
+RefCntAutoPtr<ITextureLoader> CompressLoadedTexture(ITextureLoader*    pLoader,
+                                                    const char*        Name,
+                                                    TEXTURE_FORMAT     CompressedFormat,
+                                                    const std::string& CachePath)
+{
+    const TextureDesc&      SrcDesc = pLoader->GetTextureDesc();
+    HnCompressedTextureData CompressedData;
+    if (!CompressTextureBC(SrcDesc, pLoader->GetTextureData(), CompressedFormat, CompressedData))
+    {
+        // E.g. the texture dimensions are not multiples of the block size
+        return {};
+    }
+
+    LOG_INFO_MESSAGE("Compressed texture ", Name, " (", SrcDesc.Width, "x", SrcDesc.Height, ") to ",
+                     GetTextureFormatAttribs(CompressedData.Desc.Format).Name, ". PSNR: ", CompressedData.PSNR, " dB");
 
-    std::shared_ptr<const char> Buffer = Asset->GetBuffer();
+    const std::vector<Uint8> DDSData = WriteCompressedTextureDDS(CompressedData);
+    if (DDSData.empty())
+        return {};
+
+    if (!CachePath.empty())
+        WriteCompressedTextureCache(CachePath, DDSData);
+
+    TextureLoadInfo CompressedLoadInfo;
+    CompressedLoadInfo.Name = Name;
+
+    RefCntAutoPtr<ITextureLoader> pCompressedLoader;
+    CreateTextureLoaderFromMemory(DDSData.data(), DDSData.size(), true, CompressedLoadInfo, &pCompressedLoader);
+    if (!pCompressedLoader)
+        LOG_ERROR_MESSAGE("Failed to create texture loader for the compressed texture ", Name);
+
+    return pCompressedLoader;
+}
+
+} // namespace
+
+RefCntAutoPtr<ITextureLoader> CreateTextureLoaderFromSdfPath(const char*            SdfPath,
+                                                             const TextureLoadInfo& LoadInfo)
+{
+    size_t                      Size   = 0;
+    std::shared_ptr<const char> Buffer = ReadAsset(SdfPath, Size);
     if (!Buffer)
         return {};
 
     RefCntAutoPtr<ITextureLoader> pLoader;
-    CreateTextureLoaderFromMemory(Buffer.get(), Asset->GetSize(), true, LoadInfo, &pLoader);
+    CreateTextureLoaderFromMemory(Buffer.get(), Size, true, LoadInfo, &pLoader);
+
+    return pLoader;
+}
+
+RefCntAutoPtr<ITextureLoader> CreateCompressedTextureLoaderFromSdfPath(const char*            SdfPath,
+                                                                       const TextureLoadInfo& LoadInfo,
+                                                                       TEXTURE_FORMAT         CompressedFormat,
+                                                                       const std::string&     CacheDir)
+{
+    size_t                      Size   = 0;
+    std::shared_ptr<const char> Buffer = ReadAsset(SdfPath, Size);
+    if (!Buffer)
+        return {};
+
+    std::string CachePath;
+    if (!CacheDir.empty())
+    {
+        CachePath = GetCompressedTextureCachePath(CacheDir, Buffer.get(), Size, LoadInfo, CompressedFormat);
+        if (RefCntAutoPtr<ITextureLoader> pCachedLoader = LoadCompressedTextureCache(CachePath, LoadInfo.Name))
+            return pCachedLoader;
+    }
+
+    RefCntAutoPtr<ITextureLoader> pLoader;
+    CreateTextureLoaderFromMemory(Buffer.get(), Size, true, LoadInfo, &pLoader);
+    if (!pLoader)
+        return {};
+
+    if (RefCntAutoPtr<ITextureLoader> pCompressedLoader = CompressLoadedTexture(pLoader, SdfPath, CompressedFormat, CachePath))
+        return pCompressedLoader;
+
+    return pLoader;
+}
+
+RefCntAutoPtr<ITextureLoader> CreatePackedTextureLoader(const char*                                          Name,
+                                                        const std::array<RefCntAutoPtr<ITextureLoader>, 4>& ChannelLoaders,
+                                                        TEXTURE_FORMAT                                       CompressedFormat)
+{
+    // The packed texture has the resolution of the largest source texture
+    Uint32 Width  = 0;
+    Uint32 Height = 0;
+    for (const RefCntAutoPtr<ITextureLoader>& pLoader : ChannelLoaders)
+    {
+        if (!pLoader)
+            continue;
+
+        const TextureDesc&          Desc       = pLoader->GetTextureDesc();
+        const TextureFormatAttribs& FmtAttribs = GetTextureFormatAttribs(Desc.Format);
+        if (Desc.Type != RESOURCE_DIM_TEX_2D || FmtAttribs.ComponentSize != 1 || FmtAttribs.ComponentType == COMPONENT_TYPE_COMPRESSED)
+        {
+            LOG_ERROR_MESSAGE("Unable to pack texture ", Desc.Name, " of format ", FmtAttribs.Name, " into texture ", Name,
+                              ": only 2D textures with 8-bit components are supported");
+            return {};
+        }
+
+        Width  = std::max(Width, Desc.Width);
+        Height = std::max(Height, Desc.Height);
+    }
+    if (Width == 0 || Height == 0)
+        Width = Height = 1;
+
+    ImageDesc ImgDesc;
+    ImgDesc.Width         = Width;
+    ImgDesc.Height        = Height;
+    ImgDesc.ComponentType = VT_UINT8;
+    ImgDesc.NumComponents = 4;
+    ImgDesc.RowStride     = Width * ImgDesc.NumComponents;
+
+    RefCntAutoPtr<IDataBlob> pData = DataBlobImpl::Create(size_t{ImgDesc.RowStride} * size_t{Height});
+    // Channels without a source texture are white, so that the values are controlled by the material factors
+    memset(pData->GetDataPtr(), 255, pData->GetSize());
+
+    Uint8* const pDst = reinterpret_cast<Uint8*>(pData->GetDataPtr());
+    for (Uint32 c = 0; c < ChannelLoaders.size(); ++c)
+    {
+        const RefCntAutoPtr<ITextureLoader>& pLoader = ChannelLoaders[c];
+        if (!pLoader)
+            continue;
+
+        const TextureDesc&       SrcDesc   = pLoader->GetTextureDesc();
+        const TextureSubResData& SrcLevel  = pLoader->GetTextureData().pSubResources[0];
+        const Uint32             SrcStride = static_cast<Uint32>(SrcLevel.Stride);
+        const Uint32             TexelSize = GetTextureFormatAttribs(SrcDesc.Format).NumComponents;
+        const Uint8* const       pSrc      = static_cast<const Uint8*>(SrcLevel.pData);
+
+        if (SrcDesc.Width == Width && SrcDesc.Height == Height)
+        {
+            for (Uint32 y = 0; y < Height; ++y)
+            {
+                for (Uint32 x = 0; x < Width; ++x)
+                    pDst[y * ImgDesc.RowStride + x * 4 + c] = pSrc[y * SrcStride + x * TexelSize];
+            }
+            continue;
+        }
+
+        // Bilinearly resample the smaller texture to the packed resolution
+        for (Uint32 y = 0; y < Height; ++y)
+        {
+            const float  v  = std::max((static_cast<float>(y) + 0.5f) * static_cast<float>(SrcDesc.Height) / static_cast<float>(Height) - 0.5f, 0.f);
+            const Uint32 y0 = std::min(static_cast<Uint32>(v), SrcDesc.Height - 1);
+            const Uint32 y1 = std::min(y0 + 1, SrcDesc.Height - 1);
+            const float  fy = v - static_cast<float>(y0);
+            for (Uint32 x = 0; x < Width; ++x)
+            {
+                const float  u  = std::max((static_cast<float>(x) + 0.5f) * static_cast<float>(SrcDesc.Width) / static_cast<float>(Width) - 0.5f, 0.f);
+                const Uint32 x0 = std::min(static_cast<Uint32>(u), SrcDesc.Width - 1);
+                const Uint32 x1 = std::min(x0 + 1, SrcDesc.Width - 1);
+                const float  fx = u - static_cast<float>(x0);
+
+                const float t00 = pSrc[y0 * SrcStride + x0 * TexelSize];
+                const float t10 = pSrc[y0 * SrcStride + x1 * TexelSize];
+                const float t01 = pSrc[y1 * SrcStride + x0 * TexelSize];
+                const float t11 = pSrc[y1 * SrcStride + x1 * TexelSize];
+
+                const float Val = (t00 * (1 - fx) + t10 * fx) * (1 - fy) + (t01 * (1 - fx) + t11 * fx) * fy;
+
+                pDst[y * ImgDesc.RowStride + x * 4 + c] = static_cast<Uint8>(std::min(Val + 0.5f, 255.f));
+            }
+        }
+    }
+
+    RefCntAutoPtr<Image> pImage;
+    Image::CreateFromMemory(ImgDesc, pData, &pImage);
+    if (!pImage)
+        return {};
+
+    TextureLoadInfo LoadInfo;
+    LoadInfo.Name   = Name;
+    LoadInfo.Format = TEX_FORMAT_RGBA8_UNORM;
+
+    RefCntAutoPtr<ITextureLoader> pLoader;
+    CreateTextureLoaderFromImage(pImage, LoadInfo, &pLoader);
+    if (!pLoader)
+        return {};
+
+    if (CompressedFormat != TEX_FORMAT_UNKNOWN)
+    {
+        if (RefCntAutoPtr<ITextureLoader> pCompressedLoader = CompressLoadedTexture(pLoader, Name, CompressedFormat, {}))
+            return pCompressedLoader;
+    }
 
     return pLoader;
 }
@@ -333,6 +333,7 @@ const pxr::TfToken& PBRTextureAttribIdToPxrName(PBR_Renderer::TEXTURE_ATTRIB_ID
 
         PxrNames[PBR_Renderer::TEXTURE_ATTRIB_ID_BASE_COLOR] = HnTokens->diffuseColor;
         PxrNames[PBR_Renderer::TEXTURE_ATTRIB_ID_NORMAL]     = HnTokens->normal;
+        PxrNames[PBR_Renderer::TEXTURE_ATTRIB_ID_PHYS_DESC]  = HnTokens->occlusionRoughnessMetallic;
         PxrNames[PBR_Renderer::TEXTURE_ATTRIB_ID_METALLIC]   = HnTokens->metallic;
         PxrNames[PBR_Renderer::TEXTURE_ATTRIB_ID_ROUGHNESS]  = HnTokens->roughness;
         PxrNames[PBR_Renderer::TEXTURE_ATTRIB_ID_OCCLUSION]  = HnTokens->occlusion;
@@ -35,6 +35,9 @@
 #include "HnRenderParam.hpp"
 #include "HnShadowMapManager.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 #include "DebugUtilities.hpp"
 #include "GraphicsAccessories.hpp"
 #include "MapHelper.hpp"
@@ -357,23 +360,87 @@ void HnBeginFrameTask::Prepare(pxr::HdTaskContext* TaskCtx,
         UNEXPECTED("Unable to get final color target from Bprim ", m_Params.FinalColorTargetId);
     }
 
-    if (const HnShadowMapManager* ShadowMapMgr = RenderDelegate->GetShadowMapManager())
+    if (HnShadowMapManager* ShadowMapMgr = RenderDelegate->GetShadowMapManager())
     {
-        // Assign indices to shadow casting lights
+        const auto& Lights = RenderDelegate->GetLights();
+
+        // Fit directional light cascades to the camera frustum and select local light
+        // shadow map resolutions
+        HnRenderParam* pRenderParam = static_cast<HnRenderParam*>(RenderDelegate->GetRenderParam());
+        const bool     RankLights   = m_pCamera != nullptr && pRenderParam != nullptr;
+        m_ShadowLightsByImportance.clear();
+        if (RankLights)
+        {
+            const float3 CameraPos = float3::MakeVector(m_pCamera->GetWorldMatrix()[3]);
+
+            // Rank local shadow-casting lights by their importance.
+            // Reallocating a shadow map requires re-rendering it, so to avoid changing the resolution
+            // every frame when two lights have similar importance, the importance of a light is reduced
+            // by ShadowResolutionHysteresis for every level its current resolution is below the highest one.
+            // A light then has to become that much more important than another one to take its resolution.
+            constexpr float ShadowResolutionHysteresis = 1.25f;
+
+            for (HnLight* Light : Lights)
+            {
+                if (Light->IsVisible() && Light->GetNumRequestedShadowMaps() > 0 && Light->GetParams().Type != GLTF::Light::TYPE::DIRECTIONAL)
+                {
+                    const float Importance = Light->GetShadowImportance(CameraPos) /
+                        std::pow(ShadowResolutionHysteresis, static_cast<float>(Light->GetShadowResolutionLevel()));
+                    m_ShadowLightsByImportance.emplace_back(Importance, Light);
+                }
+            }
+            std::sort(m_ShadowLightsByImportance.begin(), m_ShadowLightsByImportance.end(),
+                      [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+            const bool IsGL = RenderDelegate->GetDevice()->GetDeviceInfo().NDC.MinZ == -1;
+            for (size_t Rank = 0; Rank < m_ShadowLightsByImportance.size(); ++Rank)
+            {
+                // Halve the resolution for every two lights
+                const Uint32 ResolutionLevel = static_cast<Uint32>(std::min(Rank / 2, size_t{3}));
+                m_ShadowLightsByImportance[Rank].second->UpdateShadowMaps(*m_pCamera, *pRenderParam, *ShadowMapMgr, IsGL, ResolutionLevel);
+            }
+
+            for (HnLight* Light : Lights)
+            {
+                if (Light->IsVisible() && Light->GetParams().Type == GLTF::Light::TYPE::DIRECTIONAL)
+                    Light->UpdateShadowMaps(*m_pCamera, *pRenderParam, *ShadowMapMgr, IsGL, 0);
+            }
+        }
+
+        // Assign indices to shadow casting lights. Every cascade and every cube face uses its own index.
+        // Directional lights are assigned first, followed by local lights in the order of their importance,
+        // so that when there are not enough indices, the least important local lights are left without shadows.
 
         const Uint32 NumShadowCastingLights = Renderer.GetSettings().EnableShadows ? Renderer.GetSettings().MaxShadowCastingLightCount : 0;
-        const auto&  Lights                 = RenderDelegate->GetLights();
 
         Uint32 ShadowCastingLightIdx = 0;
-        for (HnLight* Light : Lights)
-        {
-            if (Light->ShadowsEnabled() && Light->IsVisible() && ShadowCastingLightIdx < NumShadowCastingLights)
+
+        auto AssignFrameAttribsIndex = [&ShadowCastingLightIdx, NumShadowCastingLights](HnLight* Light) {
+            if (Light->ShadowsEnabled() && Light->IsVisible() && ShadowCastingLightIdx + Light->GetNumShadowMaps() <= NumShadowCastingLights)
             {
-                Light->SetFrameAttribsIndex(ShadowCastingLightIdx++);
+                Light->SetFrameAttribsIndex(ShadowCastingLightIdx);
+                ShadowCastingLightIdx += Light->GetNumShadowMaps();
             }
-            else
+        };
+
+        for (HnLight* Light : Lights)
+        {
+            Light->SetFrameAttribsIndex(-1);
+            if (Light->GetParams().Type == GLTF::Light::TYPE::DIRECTIONAL)
+                AssignFrameAttribsIndex(Light);
+        }
+
+        if (RankLights)
+        {
+            for (const auto& LightIt : m_ShadowLightsByImportance)
+                AssignFrameAttribsIndex(LightIt.second);
+        }
+        else
+        {
+            for (HnLight* Light : Lights)
             {
-                Light->SetFrameAttribsIndex(-1);
+                if (Light->GetParams().Type != GLTF::Light::TYPE::DIRECTIONAL)
+                    AssignFrameAttribsIndex(Light);
             }
         }
     }
@@ -406,37 +473,42 @@ void HnBeginFrameTask::UpdateFrameConstants(IDeviceContext* pCtx,
         const auto& Lights = RenderDelegate->GetLights();
         for (const HnLight* Light : Lights)
         {
-            const Int32 ShadowCastingLightIdx = Light->GetFrameAttribsIndex();
-            VERIFY_EXPR((ShadowCastingLightIdx < 0) == (!Light->ShadowsEnabled() || !Light->IsVisible() || ShadowCastingLightIdx >= static_cast<Int32>(NumShadowCastingLights)));
-            if (ShadowCastingLightIdx < 0)
+            const Int32 FirstShadowCastingLightIdx = Light->GetFrameAttribsIndex();
+            if (FirstShadowCastingLightIdx < 0)
                 continue;
 
-            HLSL::PBRFrameAttribs* ShadowAttribs = reinterpret_cast<HLSL::PBRFrameAttribs*>(&m_FrameAttribsData[RenderDelegate->GetShadowPassFrameAttribsOffset(ShadowCastingLightIdx)]);
-            HLSL::CameraAttribs&   CamAttribs    = ShadowAttribs->Camera;
-
-            const float4x4& ProjMatrix = Light->GetViewProjMatrix();
-            const float4x4& ViewMatrix = Light->GetViewMatrix();
-            const float4x4  ViewProj   = Light->GetViewProjMatrix();
-
-            VERIFY_EXPR(ShadowAtlasDesc.Width > 0 && ShadowAtlasDesc.Height > 0);
-            CamAttribs.f4ViewportSize = float4{
-                static_cast<float>(ShadowAtlasDesc.Width),
-                static_cast<float>(ShadowAtlasDesc.Height),
-                1.f / static_cast<float>(ShadowAtlasDesc.Width),
-                1.f / static_cast<float>(ShadowAtlasDesc.Height),
-            };
-            CamAttribs.fHandness = 1.f;
-
-            CamAttribs.mViewT        = ViewMatrix.Transpose();
-            CamAttribs.mProjT        = ProjMatrix.Transpose();
-            CamAttribs.mViewProjT    = ViewProj.Transpose();
-            CamAttribs.mViewInvT     = ViewMatrix.Inverse().Transpose();
-            CamAttribs.mProjInvT     = ProjMatrix.Inverse().Transpose();
-            CamAttribs.mViewProjInvT = ViewProj.Inverse().Transpose();
-            CamAttribs.f4Position    = float4{0, 0, 0, 1};
-            CamAttribs.f2Jitter      = float2{0, 0};
-
-            memset(&ShadowAttribs->Renderer, 0, sizeof(HLSL::PBRRendererShaderParameters));
+            VERIFY_EXPR(Light->ShadowsEnabled() && Light->IsVisible() &&
+                        FirstShadowCastingLightIdx + Light->GetNumShadowMaps() <= NumShadowCastingLights);
+            for (Uint32 i = 0; i < Light->GetNumShadowMaps(); ++i)
+            {
+                const Uint32           ShadowCastingLightIdx = FirstShadowCastingLightIdx + i;
+                HLSL::PBRFrameAttribs* ShadowAttribs         = reinterpret_cast<HLSL::PBRFrameAttribs*>(&m_FrameAttribsData[RenderDelegate->GetShadowPassFrameAttribsOffset(ShadowCastingLightIdx)]);
+                HLSL::CameraAttribs&   CamAttribs            = ShadowAttribs->Camera;
+
+                const float4x4& ProjMatrix = Light->GetProjMatrix(i);
+                const float4x4& ViewMatrix = Light->GetShadowViewMatrix(i);
+                const float4x4& ViewProj   = Light->GetViewProjMatrix(i);
+
+                VERIFY_EXPR(ShadowAtlasDesc.Width > 0 && ShadowAtlasDesc.Height > 0);
+                CamAttribs.f4ViewportSize = float4{
+                    static_cast<float>(ShadowAtlasDesc.Width),
+                    static_cast<float>(ShadowAtlasDesc.Height),
+                    1.f / static_cast<float>(ShadowAtlasDesc.Width),
+                    1.f / static_cast<float>(ShadowAtlasDesc.Height),
+                };
+                CamAttribs.fHandness = 1.f;
+
+                CamAttribs.mViewT        = ViewMatrix.Transpose();
+                CamAttribs.mProjT        = ProjMatrix.Transpose();
+                CamAttribs.mViewProjT    = ViewProj.Transpose();
+                CamAttribs.mViewInvT     = ViewMatrix.Inverse().Transpose();
+                CamAttribs.mProjInvT     = ProjMatrix.Inverse().Transpose();
+                CamAttribs.mViewProjInvT = ViewProj.Inverse().Transpose();
+                CamAttribs.f4Position    = Light->GetParams().Type == GLTF::Light::TYPE::DIRECTIONAL ? float4{0, 0, 0, 1} : float4{Light->GetPosition(), 1};
+                CamAttribs.f2Jitter      = float2{0, 0};
+
+                memset(&ShadowAttribs->Renderer, 0, sizeof(HLSL::PBRRendererShaderParameters));
+            }
         }
     }
 
@@ -524,7 +596,8 @@ void HnBeginFrameTask::UpdateFrameConstants(IDeviceContext* pCtx,
             {
                 if (const HLSL::PBRShadowMapInfo* pShadowMapInfo = Light->GetShadowMapShaderInfo())
                 {
-                    ShadowMaps[ShadowMapIndex] = *pShadowMapInfo;
+                    for (Uint32 i = 0; i < Light->GetNumShadowMaps(); ++i)
+                        ShadowMaps[ShadowMapIndex + i] = pShadowMapInfo[i];
                 }
                 else
                 {
@@ -261,9 +261,15 @@ void HnRenderShadowsTask::Prepare(pxr::HdTaskContext* TaskCtx,
 
         if (GeometryChanged)
         {
-            // Make shadow map dirty even if the light is disabled so that
-            // when it is enabled, the shadow map will be updated.
-            Light->SetShadowMapDirty(true);
+            // Only re-render the shadow maps if the casters of this light have changed.
+            // Check the casters even if the light is disabled so that when it is enabled,
+            // the shadow map will be updated.
+            const size_t ShadowCastersHash = RenderDelegate->ComputeShadowCastersHash(*Light);
+            if (ShadowCastersHash != Light->GetShadowCastersHash())
+            {
+                Light->SetShadowCastersHash(ShadowCastersHash);
+                Light->SetShadowMapDirty(true);
+            }
         }
 
         if (!Light->IsShadowMapDirty())
@@ -275,8 +281,11 @@ void HnRenderShadowsTask::Prepare(pxr::HdTaskContext* TaskCtx,
 
         VERIFY(Light->IsVisible(), "Invisible lights should not be assigned shadow casting light index");
 
-        ITextureAtlasSuballocation* pAtlasRegion = Light->GetShadowMapSuballocation();
-        m_LightsByShadowSlice.emplace(pAtlasRegion->GetSlice(), Light);
+        for (Uint32 ShadowMapIdx = 0; ShadowMapIdx < Light->GetNumShadowMaps(); ++ShadowMapIdx)
+        {
+            ITextureAtlasSuballocation* pAtlasRegion = Light->GetShadowMapSuballocation(ShadowMapIdx);
+            m_LightsByShadowSlice.emplace(pAtlasRegion->GetSlice(), ShadowMapRenderItem{Light, ShadowMapIdx});
+        }
     }
 }
 
@@ -305,18 +314,24 @@ void HnRenderShadowsTask::Execute(pxr::HdTaskContext* TaskCtx)
     IDeviceContext*         pCtx       = RenderDelegate->GetDeviceContext();
     const RenderDeviceInfo& DeviceInfo = pDevice->GetDeviceInfo();
 
+    const bool IsGL = DeviceInfo.NDC.MinZ == -1;
+
+    ViewFrustum ShadowFrustum;
+    m_RPState.SetShadowCasterCullingFrustum(&ShadowFrustum);
+
     int LastSlice = -1;
     for (const auto it : m_LightsByShadowSlice)
     {
-        Uint32   Slice = it.first;
-        HnLight* Light = it.second;
+        Uint32       Slice        = it.first;
+        HnLight*     Light        = it.second.Light;
+        const Uint32 ShadowMapIdx = it.second.ShadowMapIdx;
         VERIFY_EXPR(Light->ShadowsEnabled() && Light->IsShadowMapDirty());
 
         Int32 ShadowCatingLightId = Light->GetFrameAttribsIndex();
         VERIFY_EXPR(ShadowCatingLightId >= 0);
-        m_RPState.SetFrameAttribsSRB(RenderDelegate->GetShadowPassFrameAttribsSRB(ShadowCatingLightId));
+        m_RPState.SetFrameAttribsSRB(RenderDelegate->GetShadowPassFrameAttribsSRB(ShadowCatingLightId + ShadowMapIdx));
 
-        ITextureAtlasSuballocation* pAtlasRegion = Light->GetShadowMapSuballocation();
+        ITextureAtlasSuballocation* pAtlasRegion = Light->GetShadowMapSuballocation(ShadowMapIdx);
         VERIFY_EXPR(pAtlasRegion->GetSlice() == Slice);
         VERIFY(static_cast<int>(Slice) >= LastSlice, "Shadow map slices must be sorted in ascending order");
 
@@ -348,8 +363,17 @@ void HnRenderShadowsTask::Execute(pxr::HdTaskContext* TaskCtx)
             pCtx->Draw(DrawAttribs{3, DRAW_FLAG_VERIFY_ALL});
         }
 
+        ExtractViewFrustumPlanesFromMatrix(Light->GetViewProjMatrix(ShadowMapIdx), ShadowFrustum, IsGL);
         m_RenderPass->Execute(m_RPState, GetRenderTags());
-        Light->SetShadowMapDirty(false);
+        Light->SetNumShadowCasters(ShadowMapIdx, m_RenderPass->GetNumRenderedItems());
+    }
+
+    m_RPState.SetShadowCasterCullingFrustum(nullptr);
+
+    // Shadow maps of one light may be in different slices, so reset the dirty flags after all shadow maps are rendered
+    for (const auto it : m_LightsByShadowSlice)
+    {
+        it.second.Light->SetShadowMapDirty(false);
     }
 }
 
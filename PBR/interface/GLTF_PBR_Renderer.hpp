@@ -110,9 +110,16 @@ public:
         void Clear()
         {
             MaterialSRB.clear();
+            MaterialTable.Release();
         }
-        /// Shader resource binding for every material
+        /// Shader resource binding for every material.
+        /// If the bindings were created with ShareSRBs = true, materials that
+        /// reference the same textures point to the same SRB object.
         std::vector<RefCntAutoPtr<IShaderResourceBinding>> MaterialSRB;
+
+        /// Structured buffer that contains parameters of all materials of the model.
+        /// Only created when the material table is enabled in the renderer settings.
+        RefCntAutoPtr<IBuffer> MaterialTable;
     };
 
     /// GLTF resource cache shader resource binding information
@@ -145,8 +152,17 @@ public:
                 ResourceCacheBindings*       pCacheBindings = nullptr);
 
     /// Creates resource bindings for a given GLTF model
+    /// \param [in] GLTFModel     - GLTF model to create resource bindings for.
+    /// \param [in] pFrameAttribs - Frame attributes constant buffer to set in the SRBs.
+    /// \param [in] ShareSRBs     - Whether materials that reference the same set of texture
+    ///                             objects (e.g. the same atlas pages) should share a single SRB.
+    ///                             Since all remaining per-material data is passed through
+    ///                             primitive attributes, this lets Render() skip committing
+    ///                             shader resources at material boundaries that do not change
+    ///                             the binding set.
     ModelResourceBindings CreateResourceBindings(GLTF::Model& GLTFModel,
-                                                 IBuffer*     pFrameAttribs);
+                                                 IBuffer*     pFrameAttribs,
+                                                 bool         ShareSRBs = false);
 
 
     /// Initializes a shader resource binding for the given material.
@@ -258,12 +274,35 @@ public:
         size_t          CustomDataSize = 0;
 
         HLSL::PBRMaterialBasicAttribs** pMaterialBasicAttribsDstPtr = nullptr;
+
+        // Index of the material in the material table.
+        // Only used if PSOFlags contains PSO_FLAG_USE_MATERIAL_TABLE.
+        Uint32 MaterialTableIndex = 0;
+
+        // Whether the material may not have the extensions enabled by PSOFlags
+        // (e.g. in ubershader mode). Attributes of missing extensions are zeroed out,
+        // which disables them in the shader.
+        bool AllowMissingExtensions = false;
     };
     static void* WritePBRPrimitiveShaderAttribs(void*                                           pDstShaderAttribs,
                                                 const PBRPrimitiveShaderAttribsData&            AttribsData,
                                                 const std::array<int, TEXTURE_ATTRIB_ID_COUNT>& TextureAttribIndices,
                                                 const GLTF::Material&                           Material);
 
+    /// Writes the material table entry for the given material.
+
+    /// \param [in] pDstEntry            - Destination memory; must be at least
+    ///                                    GetMaterialTableEntrySize() bytes large.
+    /// \param [in] TextureAttribIndices - Texture attribute indices, see PBR_Renderer::CreateInfo.
+    /// \param [in] NumTextureAttribs    - The number of texture attributes in the entry,
+    ///                                    see PBR_Renderer::GetMaterialTableTextureAttribCount.
+    /// \param [in] Material             - Material to write.
+    /// \return     Pointer to the end of the written data.
+    static void* WritePBRMaterialTableEntry(void*                                           pDstEntry,
+                                            const std::array<int, TEXTURE_ATTRIB_ID_COUNT>& TextureAttribIndices,
+                                            Uint32                                          NumTextureAttribs,
+                                            const GLTF::Material&                           Material);
+
     struct PBRLightShaderAttribsData
     {
         const GLTF::Light* Light     = nullptr;
@@ -279,6 +318,21 @@ public:
 
     PSO_FLAGS GetMaterialPSOFlags(const GLTF::Material& Mat) const;
 
+    /// Rendering statistics accumulated by the Render method
+    /// since the last call to Begin.
+    struct RenderStatistics
+    {
+        /// The number of draw calls.
+        Uint32 NumDrawCalls = 0;
+
+        /// The number of pipeline state changes.
+        Uint32 NumPSOChanges = 0;
+
+        /// The number of shader resource binding changes.
+        Uint32 NumSRBChanges = 0;
+    };
+    const RenderStatistics& GetRenderStatistics() const { return m_RenderStats; }
+
 private:
     static ALPHA_MODE GltfAlphaModeToAlphaMode(GLTF::Material::ALPHA_MODE GltfAlphaMode);
 
@@ -300,6 +354,8 @@ private:
 
     PsoCacheAccessor m_PbrPSOCache;
     PsoCacheAccessor m_WireframePSOCache;
+
+    RenderStatistics m_RenderStats;
 };
 
 DEFINE_FLAG_ENUM_OPERATORS(GLTF_PBR_Renderer::RenderInfo::ALPHA_MODE_FLAGS)
@@ -0,0 +1,149 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// CPU light assignment for clustered forward shading.
+
+#include <vector>
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+#include "../../../DiligentCore/Common/interface/BasicMath.hpp"
+#include "../../../DiligentCore/Platforms/Basic/interface/DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace HLSL
+{
+struct PBRLightAttribs;
+struct PBRLightClusterGridAttribs;
+} // namespace HLSL
+
+/// Assigns lights to the clusters of a view frustum grid (froxels).
+///
+/// The grid divides the screen into GridSizeX x GridSizeY tiles and the view depth
+/// into GridSizeZ exponentially distributed slices. Directional lights and lights with
+/// infinite range affect every cluster and are placed first in the light list; every
+/// cluster references the remaining lights through a range in the light index list.
+///
+/// The class does not use the GPU, so the assignment can be tested on the CPU.
+/// PBR_Renderer::UpdateLightClusters uploads the results to the GPU.
+class LightClusterGrid
+{
+public:
+    struct CreateInfo
+    {
+        /// The number of tiles along the screen X axis.
+        Uint32 GridSizeX = 16;
+
+        /// The number of tiles along the screen Y axis.
+        Uint32 GridSizeY = 9;
+
+        /// The number of depth slices.
+        Uint32 GridSizeZ = 24;
+
+        /// View-space depth range that is divided into slices.
+        /// Depths closer than ZNear fall into the first slice,
+        /// depths further than ZFar fall into the last one.
+        float ZNear = 0.1f;
+        float ZFar  = 1000.f;
+    };
+
+    explicit LightClusterGrid(const CreateInfo& CI);
+    ~LightClusterGrid();
+
+    /// Assigns lights to clusters.
+
+    /// \param [in] View      - Camera view matrix.
+    /// \param [in] Proj      - Camera projection matrix.
+    /// \param [in] pLights   - Lights in world space.
+    /// \param [in] NumLights - The number of lights.
+    void Build(const float4x4&              View,
+               const float4x4&              Proj,
+               const HLSL::PBRLightAttribs* pLights,
+               Uint32                       NumLights);
+
+    /// Returns the lights reordered by the last Build call: global lights go first.
+    const std::vector<HLSL::PBRLightAttribs>& GetLights() const { return m_Lights; }
+
+    /// Returns the number of lights that affect every cluster.
+    Uint32 GetGlobalLightCount() const { return m_GlobalLightCount; }
+
+    /// Returns the (offset, count) ranges in the light index list for every cluster.
+    const std::vector<uint2>& GetClusters() const { return m_Clusters; }
+
+    /// Returns the light index list. Indices refer to GetLights().
+    const std::vector<Uint32>& GetLightIndices() const { return m_LightIndices; }
+
+    Uint32 GetClusterCount() const { return m_CI.GridSizeX * m_CI.GridSizeY * m_CI.GridSizeZ; }
+
+    Uint32 GetClusterIndex(Uint32 X, Uint32 Y, Uint32 Z) const
+    {
+        VERIFY_EXPR(X < m_CI.GridSizeX && Y < m_CI.GridSizeY && Z < m_CI.GridSizeZ);
+        return (Z * m_CI.GridSizeY + Y) * m_CI.GridSizeX + X;
+    }
+
+    /// Returns the depth slice that contains the given view-space depth.
+    Uint32 GetDepthSlice(float ViewZ) const;
+
+    /// Returns the index of the cluster that contains the given view-space position.
+    /// This is the CPU counterpart of GetLightClusterIndex() in the pixel shader.
+    Uint32 GetClusterIndex(const float3& ViewPos, const float4x4& Proj) const;
+
+    /// Writes the grid parameters used by the shaders.
+    void GetShaderAttribs(HLSL::PBRLightClusterGridAttribs& Attribs) const;
+
+    const CreateInfo& GetDesc() const { return m_CI; }
+
+private:
+    // View-space depth of the near boundary of the given slice.
+    float GetSliceNearZ(Uint32 Slice) const;
+
+private:
+    const CreateInfo m_CI;
+
+    // GridSizeZ / log2(ZFar / ZNear)
+    const float m_ZSliceScale;
+
+    std::vector<HLSL::PBRLightAttribs> m_Lights;
+    Uint32                             m_GlobalLightCount = 0;
+    std::vector<uint2>                 m_Clusters;
+    std::vector<Uint32>                m_LightIndices;
+
+    struct SliceSpan
+    {
+        Uint32 LightIdx;
+        Uint32 Z;
+        Uint32 X0, X1;
+        Uint32 Y0, Y1;
+    };
+    std::vector<SliceSpan> m_Spans;
+};
+
+} // namespace Diligent
@@ -29,6 +29,8 @@
 #include <unordered_map>
 #include <functional>
 #include <array>
+#include <vector>
+#include <algorithm>
 
 #include "../../../DiligentCore/Platforms/Basic/interface/DebugUtilities.hpp"
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
@@ -38,6 +40,7 @@
 #include "../../../DiligentCore/Graphics/GraphicsTools/interface/ShaderMacroHelper.hpp"
 #include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
 #include "../../../DiligentCore/Common/interface/HashUtils.hpp"
+#include "LightClusterGrid.hpp"
 
 namespace Diligent
 {
@@ -45,6 +48,7 @@ namespace Diligent
 namespace HLSL
 {
 struct PBRRendererShaderParameters;
+struct PBRLightAttribs;
 } // namespace HLSL
 
 class PBR_Renderer
@@ -160,6 +164,44 @@ public:
         /// A pipeline state can use shadows only if this flag is set to true.
         bool EnableShadows = false;
 
+        /// Whether to enable the material table.
+        ///
+        /// \remarks   When this flag is set, the resource signature contains the
+        ///             g_MaterialTable structured buffer that holds the parameters of
+        ///             all materials of a model. Pipeline states created with
+        ///             PSO_FLAG_USE_MATERIAL_TABLE read material parameters from the table,
+        ///             and the primitive attributes only contain the material index.
+        ///             GLTF_PBR_Renderer creates the table in CreateResourceBindings and
+        ///             uses it when RenderInfo::Flags contains PSO_FLAG_USE_MATERIAL_TABLE.
+        bool EnableMaterialTable = false;
+
+        /// Whether to enable the ubershader mode.
+        ///
+        /// \remarks   In ubershader mode, material features (texture maps and material
+        ///             extensions allowed by this create info) are not used as pipeline
+        ///             specialization keys. Every pipeline state is compiled with all of them,
+        ///             and the shader selects the features at run time based on the material
+        ///             parameters: texture attributes with negative UV selector, zero clear coat,
+        ///             sheen, anisotropy, iridescence and transmission factors disable the
+        ///             corresponding feature. Only structural flags (vertex attributes, alpha mode,
+        ///             cull mode, output and debug options) select the pipeline state.
+        ///             This considerably reduces the number of pipeline states and state changes
+        ///             at the cost of more expensive shaders.
+        ///             Clients should use GetUbershaderMaterialFlags() as the material PSO flags.
+        bool EnableUbershader = false;
+
+        /// Whether to enable clustered forward lighting.
+        ///
+        /// \remarks   When this flag is set, the resource signature contains the light
+        ///             cluster grid constant buffer and the g_ClusteredLights, g_LightClusters and
+        ///             g_ClusterLightIndices structured buffers. Pipeline states created with
+        ///             PSO_FLAG_USE_CLUSTERED_LIGHTING read the lights from these buffers
+        ///             instead of the frame attributes and only evaluate the lights that
+        ///             affect the cluster that contains the shaded point, which allows using
+        ///             many more lights than MaxLightCount. The client must call
+        ///             UpdateLightClusters every frame before rendering.
+        bool EnableClusteredLighting = false;
+
         /// Whether to allow hot shader reload.
         ///
         /// \remarks    When hot shader reload is enabled, the renderer will need
@@ -186,12 +228,31 @@ public:
         /// When 0, single primitive will be used.
         Uint32 PrimitiveArraySize = 0;
 
+        /// An optional path to the directory where HLSL shaders converted to GLSL are cached.
+        ///
+        /// \remarks   When PrimitiveArraySize > 0 on Vulkan, the renderer converts the vertex
+        ///             shader from HLSL to GLSL for every new pipeline state. Converted sources
+        ///             are always cached in memory and keyed by a hash of the shader source files.
+        ///             If this path is not null, they are also stored on disk and reused by
+        ///             subsequent runs.
+        const char* GLSLConversionCacheDir = nullptr;
+
         /// The maximum number of lights.
         Uint32 MaxLightCount = 16;
 
         /// The maximum number of shadow-casting lights.
         Uint32 MaxShadowCastingLightCount = 8;
 
+        /// The maximum number of lights in clustered lighting mode, see EnableClusteredLighting.
+        Uint32 MaxClusteredLightCount = 1024;
+
+        /// The capacity of the cluster light index list.
+        /// When 0, the renderer reserves 32 indices per cluster.
+        Uint32 ClusterLightIndexCapacity = 0;
+
+        /// Light cluster grid parameters used in clustered lighting mode.
+        LightClusterGrid::CreateInfo LightClusterGridCI;
+
         static const SamplerDesc DefaultSampler;
 
         /// Immutable sampler for color map texture.
@@ -257,6 +318,13 @@ public:
         ///                     float4 Color   : ATTRIB6; // If PSO_FLAG_USE_VERTEX_COLORS is set
         ///                     float3 Tangent : ATTRIB7; // If PSO_FLAG_USE_VERTEX_TANGENTS is set
         ///                 };
+        ///
+        ///             Attributes may also use compressed formats (see VertexCompression.hpp):
+        ///             - Normal and Tangent: two octahedral-encoded components, e.g. VT_INT16 normalized (RG16_SNORM).
+        ///             - UV0, UV1: VT_FLOAT16 or normalized integer components.
+        ///             - Color, Weight0: VT_FLOAT16 or normalized integer components, e.g. VT_UINT8 normalized (RGBA8_UNORM).
+        ///             - Joint0: non-normalized integer components, e.g. VT_UINT16 or VT_UINT8.
+        ///             The vertex shader input struct is generated to match the layout.
         InputLayoutDesc InputLayout;
 
         /// Conversion mode applied to diffuse, specular and emissive textures.
@@ -460,8 +528,15 @@ public:
         PSO_FLAG_UNSHADED                  = PSO_FLAG_BIT(36),
         PSO_FLAG_COMPUTE_MOTION_VECTORS    = PSO_FLAG_BIT(37),
         PSO_FLAG_ENABLE_SHADOWS            = PSO_FLAG_BIT(38),
+        PSO_FLAG_USE_MATERIAL_TABLE        = PSO_FLAG_BIT(39),
+        PSO_FLAG_USE_CLUSTERED_LIGHTING    = PSO_FLAG_BIT(40),
+
+        /// Use reduced precision (min16float) for color and material math.
+        /// Positions, directions and specular distribution terms keep full precision.
+        /// Ignored on OpenGL devices.
+        PSO_FLAG_USE_HALF_PRECISION        = PSO_FLAG_BIT(41),
 
-        PSO_FLAG_LAST = PSO_FLAG_ENABLE_SHADOWS,
+        PSO_FLAG_LAST = PSO_FLAG_USE_HALF_PRECISION,
 
         PSO_FLAG_FIRST_USER_DEFINED = PSO_FLAG_LAST << 1ull,
 
@@ -553,6 +628,7 @@ public:
         constexpr ALPHA_MODE    GetAlphaMode() const noexcept { return AlphaMode; }
         constexpr DebugViewType GetDebugView() const noexcept { return DebugView; }
         constexpr Uint64        GetUserValue() const noexcept { return UserValue; }
+        constexpr size_t        GetHash() const noexcept { return Hash; }
 
     private:
         PSO_FLAGS     Flags       = PSO_FLAG_NONE;
@@ -563,7 +639,113 @@ public:
         size_t        Hash        = 0;
     };
 
-    using PsoHashMapType = std::unordered_map<PSOKey, RefCntAutoPtr<IPipelineState>, PSOKey::Hasher>;
+    /// Open-addressing hash table that maps PSO keys to values.
+    ///
+    /// \remarks   Keys and values are stored in a flat array of slots with a power-of-two
+    ///             size that is kept at most half full. Lookups use the hash precomputed
+    ///             by PSOKey (see GetHomeSlot()) and linear probing, so in the common case
+    ///             a lookup is a single probe that compares the hashes. Values are never removed.
+    ///             A slot may hold a null value, e.g. a pipeline state that failed to be created,
+    ///             so that the failed pipeline is not recreated on every lookup.
+    template <typename ValueType>
+    class PsoHashMap
+    {
+    public:
+        /// Returns the pointer to the value with the given key, or null if the key is not in the map.
+        const ValueType* Find(const PSOKey& Key) const noexcept
+        {
+            if (m_Slots.empty())
+                return nullptr;
+
+            const size_t Mask = m_Slots.size() - 1;
+            for (size_t Idx = GetHomeSlot(Key.GetHash(), Mask);; Idx = (Idx + 1) & Mask)
+            {
+                const Slot& S = m_Slots[Idx];
+                if (!S.Occupied)
+                    return nullptr;
+                if (S.Key == Key)
+                    return &S.Value;
+            }
+        }
+
+        ValueType* Find(const PSOKey& Key) noexcept
+        {
+            return const_cast<ValueType*>(static_cast<const PsoHashMap&>(*this).Find(Key));
+        }
+
+        /// Adds the value to the map, replacing the existing one with the same key.
+        void Insert(const PSOKey& Key, ValueType Value)
+        {
+            // Keep the table at most half full so that most lookups take a single probe.
+            if ((m_Size + 1) * 2 > m_Slots.size())
+            {
+                std::vector<Slot> OldSlots{std::move(m_Slots)};
+                m_Slots.clear();
+                m_Slots.resize(std::max(OldSlots.size() * 2, size_t{16}));
+                m_Size = 0;
+                for (Slot& S : OldSlots)
+                {
+                    if (S.Occupied)
+                        Insert(S.Key, std::move(S.Value));
+                }
+            }
+
+            const size_t Mask = m_Slots.size() - 1;
+            for (size_t Idx = GetHomeSlot(Key.GetHash(), Mask);; Idx = (Idx + 1) & Mask)
+            {
+                Slot& S = m_Slots[Idx];
+                if (!S.Occupied)
+                {
+                    S.Key      = Key;
+                    S.Value    = std::move(Value);
+                    S.Occupied = true;
+                    ++m_Size;
+                    return;
+                }
+                if (S.Key == Key)
+                {
+                    S.Value = std::move(Value);
+                    return;
+                }
+            }
+        }
+
+        size_t GetSize() const noexcept { return m_Size; }
+        size_t GetCapacity() const noexcept { return m_Slots.size(); }
+
+        /// Returns the index of the first slot probed for the key with the given hash.
+        ///
+        /// \remarks   PSOKey hashes are combined from std::hash values, which are identity
+        ///             functions for integers in common standard libraries, so the low bits
+        ///             are poorly distributed and would cluster with linear probing.
+        ///             The hash is multiplied by the 64-bit golden ratio and the high bits are used.
+        static size_t GetHomeSlot(size_t Hash, size_t Mask) noexcept
+        {
+            return static_cast<size_t>((static_cast<Uint64>(Hash) * 0x9E3779B97F4A7C15ull) >> 32) & Mask;
+        }
+
+        /// Calls the handler for every non-null value in the map.
+        template <typename HandlerType>
+        void ProcessPSOs(HandlerType&& Handler) const
+        {
+            for (const Slot& S : m_Slots)
+            {
+                if (S.Occupied && S.Value)
+                    Handler(S.Key, S.Value);
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            PSOKey    Key;
+            ValueType Value{};
+            bool      Occupied = false;
+        };
+        std::vector<Slot> m_Slots;
+        size_t            m_Size = 0;
+    };
+    using PsoHashMapType = PsoHashMap<RefCntAutoPtr<IPipelineState>>;
 
     class PsoCacheAccessor
     {
@@ -590,7 +772,19 @@ public:
                 UNEXPECTED("Accessor is not initialized");
                 return nullptr;
             }
-            return m_pRenderer->GetPSO(*m_pPsoHashMap, *m_pGraphicsDesc, Key, CreateIfNull);
+
+            // Consecutive draws often use the same key. The last hit skips the key
+            // normalization in GetPSO and the hash table lookup.
+            if (m_pLastPSO && m_LastKey == Key)
+                return m_pLastPSO;
+
+            IPipelineState* pPSO = m_pRenderer->GetPSO(*m_pPsoHashMap, *m_pGraphicsDesc, Key, CreateIfNull);
+            if (pPSO != nullptr)
+            {
+                m_LastKey  = Key;
+                m_pLastPSO = pPSO;
+            }
+            return pPSO;
         }
 
     private:
@@ -607,6 +801,11 @@ public:
         PBR_Renderer*               m_pRenderer     = nullptr;
         PsoHashMapType*             m_pPsoHashMap   = nullptr;
         const GraphicsPipelineDesc* m_pGraphicsDesc = nullptr;
+
+        // Last-hit cache. Accessors are not shared between threads, so every
+        // draw-list builder thread has its own cache.
+        mutable PSOKey                        m_LastKey;
+        mutable RefCntAutoPtr<IPipelineState> m_pLastPSO;
     };
 
     PsoCacheAccessor GetPsoCacheAccessor(const GraphicsPipelineDesc& GraphicsDesc);
@@ -627,6 +826,61 @@ public:
     /// Returns the PBR primitive attributes shader data size for the given PSO flags.
     Uint32 GetPBRPrimitiveAttribsSize(PSO_FLAGS Flags) const;
 
+    /// Returns the number of texture attributes in the material table entry.
+    ///
+    /// \remarks   Texture attributes in the material table are indexed by
+    ///             CreateInfo::TextureAttribIndices, so that the same entry
+    ///             can be used by any pipeline state.
+    Uint32 GetMaterialTableTextureAttribCount() const;
+
+    /// Returns the size of a single material table entry.
+    Uint32 GetMaterialTableEntrySize() const;
+
+    /// Returns the material PSO flags that every pipeline state uses in the ubershader mode,
+    /// see CreateInfo::EnableUbershader.
+    PSO_FLAGS GetUbershaderMaterialFlags() const;
+
+    /// Returns the number of unique pipeline states created by the renderer.
+    Uint32 GetPSOCount() const;
+
+    /// Assigns the lights to the clusters of the camera view frustum and uploads
+    /// the results to the GPU, see CreateInfo::EnableClusteredLighting.
+
+    /// \param [in] pCtx      - Device context to use for buffer updates.
+    /// \param [in] View      - Camera view matrix.
+    /// \param [in] Proj      - Camera projection matrix.
+    /// \param [in] pLights   - Lights to assign.
+    /// \param [in] NumLights - The number of lights.
+    ///
+    /// \remarks   Lights that do not fit into CreateInfo::MaxClusteredLightCount are ignored.
+    void UpdateLightClusters(IDeviceContext*              pCtx,
+                             const float4x4&              View,
+                             const float4x4&              Proj,
+                             const HLSL::PBRLightAttribs* pLights,
+                             Uint32                       NumLights);
+
+    const LightClusterGrid* GetLightClusterGrid() const { return m_LightClusterGrid.get(); }
+
+    /// HLSL-to-GLSL conversion cache statistics, see CreateInfo::GLSLConversionCacheDir.
+    struct GLSLConversionCacheStatistics
+    {
+        /// The number of conversions found in the memory cache.
+        Uint32 NumMemoryHits = 0;
+
+        /// The number of conversions loaded from the disk cache.
+        Uint32 NumDiskHits = 0;
+
+        /// The number of shaders that had to be converted.
+        Uint32 NumMisses = 0;
+
+        /// Total time spent converting shaders, in seconds.
+        double ConversionTime = 0;
+
+        /// Estimated conversion time saved by cache hits, in seconds.
+        double TimeSaved = 0;
+    };
+    const GLSLConversionCacheStatistics& GetGLSLConversionCacheStats() const { return m_GLSLConversionCacheStats; }
+
     /// Returns the PBR Frame attributes shader data size for the given light count.
     static Uint32 GetPRBFrameAttribsSize(Uint32 LightCount, Uint32 ShadowCastingLightCount);
 
@@ -663,6 +917,9 @@ private:
 
     void CreatePSO(PsoHashMapType& PsoHashMap, const GraphicsPipelineDesc& GraphicsDesc, const PSOKey& Key);
 
+    // Converts the HLSL shader to GLSL using the conversion cache.
+    std::string ConvertHLSLToGLSL(const ShaderCreateInfo& ShaderCI, bool UseCombinedSamplers);
+
 protected:
     const InputLayoutDescX m_InputLayout;
 
@@ -696,6 +953,17 @@ protected:
     RefCntAutoPtr<IBuffer> m_PrecomputeEnvMapAttribsCB;
     RefCntAutoPtr<IBuffer> m_JointsBuffer;
 
+    std::unique_ptr<LightClusterGrid> m_LightClusterGrid;
+    RefCntAutoPtr<IBuffer>            m_LightClusterGridCB;
+    RefCntAutoPtr<IBuffer>            m_ClusteredLightsBuffer;
+    RefCntAutoPtr<IBuffer>            m_LightClustersBuffer;
+    RefCntAutoPtr<IBuffer>            m_ClusterLightIndicesBuffer;
+
+    // Converted GLSL sources keyed by the hash of the HLSL sources and conversion attributes
+    std::unordered_map<std::string, std::string> m_GLSLConversionCache;
+    std::string                                  m_GLSLConversionCacheDir;
+    GLSLConversionCacheStatistics                m_GLSLConversionCacheStats;
+
     std::vector<RefCntAutoPtr<IPipelineResourceSignature>> m_ResourceSignatures;
 
     std::unordered_map<GraphicsPipelineDesc, PsoHashMapType> m_PSOs;
@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+/// \file
+/// Vertex attribute compression utilities.
+///
+/// The functions in this file encode vertex attributes into the compressed formats
+/// supported by PBR_Renderer input layouts, and decode them back.
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+#include "../../../DiligentCore/Common/interface/BasicMath.hpp"
+
+namespace Diligent
+{
+
+/// Encodes a unit vector into two octahedral components packed as RG16_SNORM.
+
+/// \param [in] Normal - Vector to encode. The vector does not need to be normalized.
+/// \return     Packed components: x in the lower 16 bits, y in the upper 16 bits.
+///
+/// \remarks    The angular error of the round trip does not exceed 0.02 degrees.
+Uint32 EncodeOctahedralNormalRG16(const float3& Normal);
+
+/// Decodes a unit vector packed by EncodeOctahedralNormalRG16.
+float3 DecodeOctahedralNormalRG16(Uint32 Encoded);
+
+/// Converts a 32-bit float to a 16-bit float with round-to-nearest-even.
+Uint16 FloatToHalf(float Value);
+
+/// Converts a 16-bit float to a 32-bit float.
+float HalfToFloat(Uint16 Value);
+
+/// Encodes a two-component vector as RG16_FLOAT.
+Uint32 EncodeRG16Float(const float2& Value);
+
+/// Decodes a two-component vector packed by EncodeRG16Float.
+float2 DecodeRG16Float(Uint32 Encoded);
+
+/// Encodes a four-component vector with components in [0, 1] range as RGBA8_UNORM.
+Uint32 EncodeRGBA8Unorm(const float4& Value);
+
+/// Decodes a four-component vector packed by EncodeRGBA8Unorm.
+float4 DecodeRGBA8Unorm(Uint32 Encoded);
+
+/// Encodes skinning weights as RGBA8_UNORM so that the decoded weights sum up to one.
+Uint32 EncodeJointWeightsRGBA8(const float4& Weights);
+
+/// Converts joint indices to RGBA16_UINT.
+/// Indices must be in [0, 65535] range.
+void EncodeJointIndicesRGBA16(const float4& Joints, Uint16 Dst[4]);
+
+/// Converts joint indices to RGBA8_UINT.
+/// Indices must be in [0, 255] range.
+Uint32 EncodeJointIndicesRGBA8(const float4& Joints);
+
+} // namespace Diligent
@@ -31,6 +31,8 @@
 #include <functional>
 #include <algorithm>
 #include <cmath>
+#include <map>
+#include <vector>
 
 #include "BasicMath.hpp"
 #include "MapHelper.hpp"
@@ -304,17 +306,99 @@ GLTF_PBR_Renderer::ModelResourceBindings GLTF_PBR_Renderer::CreateResourceBindin
 {
     ModelResourceBindings ResourceBindings;
     ResourceBindings.MaterialSRB.resize(GLTFModel.Materials.size());
+
+    // Materials that reference the same texture objects for every texture attribute
+    // (e.g. the same atlas pages) can use the same SRB. The IBL and shadow maps are
+    // common to all SRBs and do not need to be part of the key.
+    std::map<std::vector<const ITexture*>, IShaderResourceBinding*> SharedSRBs;
+
+    auto GetTextureSetKey = [&](const GLTF::Material& Material) {
+        std::vector<const ITexture*> Key;
+        Key.reserve(TEXTURE_ATTRIB_ID_COUNT);
+        for (const int TexAttribId : m_Settings.TextureAttribIndices)
+        {
+            if (TexAttribId < 0)
+                continue;
+
+            const auto TexIdx = Material.GetTextureId(TexAttribId);
+            Key.push_back(TexIdx >= 0 ? GLTFModel.GetTexture(TexIdx) : nullptr);
+        }
+        return Key;
+    };
+
     for (size_t mat = 0; mat < GLTFModel.Materials.size(); ++mat)
     {
-        auto& pMatSRB = ResourceBindings.MaterialSRB[mat];
+        auto& Material = GLTFModel.Materials[mat];
+        auto& pMatSRB  = ResourceBindings.MaterialSRB[mat];
+
+        IShaderResourceBinding** ppSharedSRB = nullptr;
+        if (ShareSRBs)
+        {
+            ppSharedSRB = &SharedSRBs[GetTextureSetKey(Material)];
+            if (*ppSharedSRB != nullptr)
+            {
+                pMatSRB = *ppSharedSRB;
+                continue;
+            }
+        }
+
         CreateResourceBinding(&pMatSRB);
-        InitMaterialSRB(GLTFModel, GLTFModel.Materials[mat], pFrameAttribs, pMatSRB);
+        InitMaterialSRB(GLTFModel, Material, pFrameAttribs, pMatSRB);
+
+        if (ppSharedSRB != nullptr)
+            *ppSharedSRB = pMatSRB;
+    }
+
+    if (m_Settings.EnableMaterialTable && !GLTFModel.Materials.empty())
+    {
+        const Uint32 NumTextureAttribs = GetMaterialTableTextureAttribCount();
+        const Uint32 EntrySize         = GetMaterialTableEntrySize();
+
+        std::vector<Uint8> TableData(size_t{EntrySize} * GLTFModel.Materials.size());
+        for (size_t mat = 0; mat < GLTFModel.Materials.size(); ++mat)
+        {
+            Uint8* pEntry = &TableData[mat * EntrySize];
+
+            auto* pEndPtr = WritePBRMaterialTableEntry(pEntry, m_Settings.TextureAttribIndices, NumTextureAttribs, GLTFModel.Materials[mat]);
+            VERIFY_EXPR(pEndPtr == pEntry + EntrySize);
+            (void)pEndPtr;
+        }
+
+        BufferDesc Desc{
+            "GLTF material table",
+            TableData.size(),
+            BIND_SHADER_RESOURCE,
+            USAGE_IMMUTABLE,
+            CPU_ACCESS_NONE,
+            BUFFER_MODE_STRUCTURED,
+            EntrySize,
+        };
+        BufferData InitData{TableData.data(), TableData.size()};
+        ResourceBindings.MaterialTable = m_Device.CreateBuffer(Desc, &InitData);
+
+        if (ResourceBindings.MaterialTable)
+        {
+            IBufferView* pTableSRV = ResourceBindings.MaterialTable->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+            for (auto& pMatSRB : ResourceBindings.MaterialSRB)
+            {
+                // SRBs may be shared between materials, and setting the same object is a no-op
+                if (IShaderResourceVariable* pVar = pMatSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_MaterialTable"))
+                    pVar->Set(pTableSRV);
+            }
+        }
+        else
+        {
+            LOG_ERROR_MESSAGE("Failed to create the material table buffer");
+        }
     }
+
     return ResourceBindings;
 }
 
 void GLTF_PBR_Renderer::Begin(IDeviceContext* pCtx)
 {
+    m_RenderStats = {};
+
     if (m_JointsBuffer)
     {
         // In next-gen backends, dynamic buffers must be mapped before the first use in every frame
@@ -369,6 +453,12 @@ void GLTF_PBR_Renderer::Begin(IRenderDevice*         pDevice,
 
 GLTF_PBR_Renderer::PSO_FLAGS GLTF_PBR_Renderer::GetMaterialPSOFlags(const GLTF::Material& Mat) const
 {
+    if (m_Settings.EnableUbershader)
+    {
+        // All materials use the same set of features that are selected at run time
+        return GetUbershaderMaterialFlags();
+    }
+
     // Color, normal and physical descriptor maps are always enabled
     PSO_FLAGS PSOFlags =
         PSO_FLAG_USE_COLOR_MAP |
@@ -479,6 +569,15 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*              pCtx,
         {
             pCtx->SetIndexBuffer(pIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
         }
+
+        if (IBuffer* pMaterialTable = pModelBindings->MaterialTable)
+        {
+            if (pMaterialTable->GetState() != RESOURCE_STATE_SHADER_RESOURCE)
+            {
+                StateTransitionDesc Barrier{pMaterialTable, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE};
+                pCtx->TransitionResourceStates(1, &Barrier);
+            }
+        }
     }
 
     auto VertexAttribFlags = PSO_FLAG_NONE;
@@ -567,6 +666,10 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*              pCtx,
             {
                 PSOFlags |= PSO_FLAG_USE_IBL;
             }
+            if (pModelBindings != nullptr && pModelBindings->MaterialTable)
+            {
+                PSOFlags |= PSO_FLAG_USE_MATERIAL_TABLE;
+            }
 
             PSOFlags &= RenderParams.Flags;
 
@@ -585,6 +688,7 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*              pCtx,
                 pCurrPSO = (RenderParams.Wireframe ? m_WireframePSOCache : m_PbrPSOCache).Get(NewKey, true);
                 VERIFY_EXPR(pCurrPSO != nullptr);
                 pCtx->SetPipelineState(pCurrPSO);
+                ++m_RenderStats.NumPSOChanges;
             }
             else
             {
@@ -602,6 +706,7 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*              pCtx,
                 {
                     pCurrSRB = pSRB;
                     pCtx->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                    ++m_RenderStats.NumSRBChanges;
                 }
             }
             else
@@ -611,6 +716,7 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*              pCtx,
                 {
                     pCurrSRB = pCacheBindings->pSRB;
                     pCtx->CommitShaderResources(pCurrSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                    ++m_RenderStats.NumSRBChanges;
                 }
             }
 
@@ -659,6 +765,9 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*              pCtx,
                         &PrevNodeTransform,
                         static_cast<Uint32>(JointCount),
                     };
+                    AttribsData.MaterialTableIndex     = primitive.MaterialId;
+                    AttribsData.AllowMissingExtensions = m_Settings.EnableUbershader;
+
                     auto* pEndPtr = WritePBRPrimitiveShaderAttribs(pAttribsData, AttribsData, m_Settings.TextureAttribIndices, material);
 
                     VERIFY(reinterpret_cast<uint8_t*>(pEndPtr) <= static_cast<uint8_t*>(pAttribsData) + m_PBRPrimitiveAttribsCB->GetDesc().Size,
@@ -685,12 +794,13 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*              pCtx,
                 drawAttrs.StartVertexLocation = BaseVertex;
                 pCtx->Draw(drawAttrs);
             }
+            ++m_RenderStats.NumDrawCalls;
         }
     }
 }
 
 template <typename ShaderStructType, typename HostStructType>
-Uint8* WriteShaderAttribs(Uint8* pDstPtr, HostStructType* pSrc, const char* DebugName)
+Uint8* WriteShaderAttribs(Uint8* pDstPtr, HostStructType* pSrc, const char* DebugName, bool AllowNull = false)
 {
     static_assert(sizeof(ShaderStructType) == sizeof(HostStructType), "Size of HLSL and C++ structures must be the same");
     if (pSrc != nullptr)
@@ -699,7 +809,7 @@ Uint8* WriteShaderAttribs(Uint8* pDstPtr, HostStructType* pSrc, const char* Debu
     }
     else
     {
-        UNEXPECTED("Shader attribute ", DebugName, " is not initialized in the material");
+        VERIFY(AllowNull, "Shader attribute ", DebugName, " is not initialized in the material");
         memset(pDstPtr, 0, sizeof(ShaderStructType));
     }
     static_assert(sizeof(ShaderStructType) % 16 == 0, "Size structure must be a multiple of 16");
@@ -718,6 +828,7 @@ void* GLTF_PBR_Renderer::WritePBRPrimitiveShaderAttribs(void*
     //{
     //    GLTFNodeShaderTransforms Transforms;
     //    float4x4                 PrevNodeMatrix; // #if ENABLE_MOTION_VECTORS
+    //    int4                     MaterialIndex;  // #if USE_MATERIAL_TABLE, replaces Material
     //    struct PBRMaterialShaderInfo
     //    {
     //        PBRMaterialBasicAttribs        Basic;
@@ -762,56 +873,69 @@ void* GLTF_PBR_Renderer::WritePBRPrimitiveShaderAttribs(void*
         pDstPtr += sizeof(float4x4);
     }
 
-    if (AttribsData.pMaterialBasicAttribsDstPtr != nullptr)
-        *AttribsData.pMaterialBasicAttribsDstPtr = reinterpret_cast<HLSL::PBRMaterialBasicAttribs*>(pDstPtr);
-    pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialBasicAttribs>(pDstPtr, &Material.Attribs, "Basic Attribs");
-
-    if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_SHEEN)
+    if (AttribsData.PSOFlags & PSO_FLAG_USE_MATERIAL_TABLE)
     {
-        pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialSheenAttribs>(pDstPtr, Material.Sheen.get(), "Sheen Attribs");
-    }
+        // Material attributes are read from the material table
+        if (AttribsData.pMaterialBasicAttribsDstPtr != nullptr)
+            *AttribsData.pMaterialBasicAttribsDstPtr = nullptr;
 
-    if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_ANISOTROPY)
-    {
-        pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialAnisotropyAttribs>(pDstPtr, Material.Anisotropy.get(), "Anisotropy Attribs");
+        int4* pDstMaterialIndex = reinterpret_cast<int4*>(pDstPtr);
+        *pDstMaterialIndex      = int4{static_cast<int>(AttribsData.MaterialTableIndex), 0, 0, 0};
+        pDstPtr += sizeof(int4);
     }
-
-    if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_IRIDESCENCE)
+    else
     {
-        pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialIridescenceAttribs>(pDstPtr, Material.Iridescence.get(), "Iridescence Attribs");
-    }
+        if (AttribsData.pMaterialBasicAttribsDstPtr != nullptr)
+            *AttribsData.pMaterialBasicAttribsDstPtr = reinterpret_cast<HLSL::PBRMaterialBasicAttribs*>(pDstPtr);
+        pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialBasicAttribs>(pDstPtr, &Material.Attribs, "Basic Attribs");
 
-    if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_TRANSMISSION)
-    {
-        pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialTransmissionAttribs>(pDstPtr, Material.Transmission.get(), "Transmission Attribs");
-    }
+        if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_SHEEN)
+        {
+            pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialSheenAttribs>(pDstPtr, Material.Sheen.get(), "Sheen Attribs", AttribsData.AllowMissingExtensions);
+        }
 
-    if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_VOLUME)
-    {
-        pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialVolumeAttribs>(pDstPtr, Material.Volume.get(), "Volume Attribs");
-    }
+        if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_ANISOTROPY)
+        {
+            pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialAnisotropyAttribs>(pDstPtr, Material.Anisotropy.get(), "Anisotropy Attribs", AttribsData.AllowMissingExtensions);
+        }
 
-    {
-        HLSL::PBRMaterialTextureAttribs* pDstTextures = reinterpret_cast<HLSL::PBRMaterialTextureAttribs*>(pDstPtr);
-        static_assert(sizeof(HLSL::PBRMaterialTextureAttribs) % 16 == 0, "Size of HLSL::PBRMaterialTextureAttribs must be a multiple of 16");
+        if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_IRIDESCENCE)
+        {
+            pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialIridescenceAttribs>(pDstPtr, Material.Iridescence.get(), "Iridescence Attribs", AttribsData.AllowMissingExtensions);
+        }
 
-        Uint32 NumTextureAttribs = 0;
-        ProcessTexturAttribs(AttribsData.PSOFlags, [&](int CurrIndex, PBR_Renderer::TEXTURE_ATTRIB_ID AttribId) //
-                             {
-                                 const int SrcAttribIndex = TextureAttribIndices[AttribId];
-                                 if (SrcAttribIndex < 0)
-                                 {
-                                     UNEXPECTED("Shader attribute ", Uint32{AttribId}, " is not initialized");
-                                     return;
-                                 }
+        if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_TRANSMISSION)
+        {
+            pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialTransmissionAttribs>(pDstPtr, Material.Transmission.get(), "Transmission Attribs", AttribsData.AllowMissingExtensions);
+        }
+
+        if (AttribsData.PSOFlags & PSO_FLAG_ENABLE_VOLUME)
+        {
+            pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialVolumeAttribs>(pDstPtr, Material.Volume.get(), "Volume Attribs", AttribsData.AllowMissingExtensions);
+        }
 
-                                 static_assert(sizeof(HLSL::PBRMaterialTextureAttribs) == sizeof(GLTF::Material::TextureShaderAttribs),
-                                               "The sizeof(HLSL::PBRMaterialTextureAttribs) is inconsistent with sizeof(GLTF::Material::TextureShaderAttribs)");
-                                 memcpy(pDstTextures + CurrIndex, &Material.GetTextureAttrib(SrcAttribIndex), sizeof(HLSL::PBRMaterialTextureAttribs));
-                                 ++NumTextureAttribs;
-                             });
+        {
+            HLSL::PBRMaterialTextureAttribs* pDstTextures = reinterpret_cast<HLSL::PBRMaterialTextureAttribs*>(pDstPtr);
+            static_assert(sizeof(HLSL::PBRMaterialTextureAttribs) % 16 == 0, "Size of HLSL::PBRMaterialTextureAttribs must be a multiple of 16");
 
-        pDstPtr = reinterpret_cast<Uint8*>(pDstTextures + NumTextureAttribs);
+            Uint32 NumTextureAttribs = 0;
+            ProcessTexturAttribs(AttribsData.PSOFlags, [&](int CurrIndex, PBR_Renderer::TEXTURE_ATTRIB_ID AttribId) //
+                                 {
+                                     const int SrcAttribIndex = TextureAttribIndices[AttribId];
+                                     if (SrcAttribIndex < 0)
+                                     {
+                                         UNEXPECTED("Shader attribute ", Uint32{AttribId}, " is not initialized");
+                                         return;
+                                     }
+
+                                     static_assert(sizeof(HLSL::PBRMaterialTextureAttribs) == sizeof(GLTF::Material::TextureShaderAttribs),
+                                                   "The sizeof(HLSL::PBRMaterialTextureAttribs) is inconsistent with sizeof(GLTF::Material::TextureShaderAttribs)");
+                                     memcpy(pDstTextures + CurrIndex, &Material.GetTextureAttrib(SrcAttribIndex), sizeof(HLSL::PBRMaterialTextureAttribs));
+                                     ++NumTextureAttribs;
+                                 });
+
+            pDstPtr = reinterpret_cast<Uint8*>(pDstTextures + NumTextureAttribs);
+        }
     }
 
     {
@@ -826,6 +950,64 @@ void* GLTF_PBR_Renderer::WritePBRPrimitiveShaderAttribs(void*
     return pDstPtr;
 }
 
+void* GLTF_PBR_Renderer::WritePBRMaterialTableEntry(void*                                           pDstEntry,
+                                                    const std::array<int, TEXTURE_ATTRIB_ID_COUNT>& TextureAttribIndices,
+                                                    Uint32                                          NumTextureAttribs,
+                                                    const GLTF::Material&                           Material)
+{
+    // When adding new members, don't forget to update PBR_Renderer::GetMaterialTableEntrySize!
+
+    //struct PBRMaterialTableEntry
+    //{
+    //    PBRMaterialBasicAttribs        Basic;
+    //    PBRMaterialSheenAttribs        Sheen;
+    //    PBRMaterialAnisotropyAttribs   Anisotropy;
+    //    PBRMaterialIridescenceAttribs  Iridescence;
+    //    PBRMaterialTransmissionAttribs Transmission;
+    //    PBRMaterialVolumeAttribs       Volume;
+    //    PBRMaterialTextureAttribs      Textures[PBR_NUM_TEXTURE_ATTRIBUTES];
+    //};
+
+    Uint8* pDstPtr = reinterpret_cast<Uint8*>(pDstEntry);
+
+    // Unlike primitive attributes, the entry always contains all extensions.
+    // Missing extensions are zeroed out, which disables them in the shader
+    // when the PSO flags enable them (e.g. in ubershader mode).
+    auto WriteOptionalAttribs = [&pDstPtr](const auto* pSrc, size_t Size) {
+        if (pSrc != nullptr)
+            memcpy(pDstPtr, pSrc, Size);
+        else
+            memset(pDstPtr, 0, Size);
+        pDstPtr += Size;
+    };
+
+    pDstPtr = WriteShaderAttribs<HLSL::PBRMaterialBasicAttribs>(pDstPtr, &Material.Attribs, "Basic Attribs");
+    WriteOptionalAttribs(Material.Sheen.get(), sizeof(HLSL::PBRMaterialSheenAttribs));
+    WriteOptionalAttribs(Material.Anisotropy.get(), sizeof(HLSL::PBRMaterialAnisotropyAttribs));
+    WriteOptionalAttribs(Material.Iridescence.get(), sizeof(HLSL::PBRMaterialIridescenceAttribs));
+    WriteOptionalAttribs(Material.Transmission.get(), sizeof(HLSL::PBRMaterialTransmissionAttribs));
+    WriteOptionalAttribs(Material.Volume.get(), sizeof(HLSL::PBRMaterialVolumeAttribs));
+
+    {
+        HLSL::PBRMaterialTextureAttribs* pDstTextures = reinterpret_cast<HLSL::PBRMaterialTextureAttribs*>(pDstPtr);
+        memset(pDstTextures, 0, sizeof(HLSL::PBRMaterialTextureAttribs) * NumTextureAttribs);
+
+        // Texture attributes are indexed by the renderer-wide attribute indices
+        for (const int SrcAttribIndex : TextureAttribIndices)
+        {
+            if (SrcAttribIndex < 0)
+                continue;
+
+            VERIFY(static_cast<Uint32>(SrcAttribIndex) < NumTextureAttribs, "Texture attribute index is out of range");
+            memcpy(pDstTextures + SrcAttribIndex, &Material.GetTextureAttrib(SrcAttribIndex), sizeof(HLSL::PBRMaterialTextureAttribs));
+        }
+
+        pDstPtr = reinterpret_cast<Uint8*>(pDstTextures + NumTextureAttribs);
+    }
+
+    return pDstPtr;
+}
+
 void GLTF_PBR_Renderer::WritePBRLightShaderAttribs(const PBRLightShaderAttribsData& AttribsData,
                                                    HLSL::PBRLightAttribs*           pShaderAttribs)
 {
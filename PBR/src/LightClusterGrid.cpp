@@ -0,0 +1,238 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include "LightClusterGrid.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <cfloat>
+
+namespace Diligent
+{
+
+namespace HLSL
+{
+
+#include "Shaders/Common/public/BasicStructures.fxh"
+#include "Shaders/PBR/public/PBR_Structures.fxh"
+
+} // namespace HLSL
+
+namespace
+{
+
+// Must match the values in PBR_Shading.fxh
+constexpr int PBR_LIGHT_TYPE_DIRECTIONAL = 1;
+
+bool IsGlobalLight(const HLSL::PBRLightAttribs& Light)
+{
+    return Light.Type == PBR_LIGHT_TYPE_DIRECTIONAL || Light.Range4 <= 0;
+}
+
+} // namespace
+
+LightClusterGrid::LightClusterGrid(const CreateInfo& CI) :
+    m_CI{CI},
+    m_ZSliceScale{static_cast<float>(CI.GridSizeZ) / std::log2(CI.ZFar / CI.ZNear)}
+{
+    DEV_CHECK_ERR(CI.GridSizeX > 0 && CI.GridSizeY > 0 && CI.GridSizeZ > 0, "Grid size must not be zero");
+    DEV_CHECK_ERR(CI.ZNear > 0 && CI.ZFar > CI.ZNear, "ZNear (", CI.ZNear, ") must be positive and less than ZFar (", CI.ZFar, ")");
+    m_Clusters.resize(GetClusterCount());
+}
+
+LightClusterGrid::~LightClusterGrid()
+{
+}
+
+Uint32 LightClusterGrid::GetDepthSlice(float ViewZ) const
+{
+    if (ViewZ <= m_CI.ZNear)
+        return 0;
+
+    const float Slice = std::floor(std::log2(ViewZ / m_CI.ZNear) * m_ZSliceScale);
+    return std::min(static_cast<Uint32>(Slice), m_CI.GridSizeZ - 1);
+}
+
+float LightClusterGrid::GetSliceNearZ(Uint32 Slice) const
+{
+    // The first slice also contains all depths closer than ZNear
+    return Slice > 0 ? m_CI.ZNear * std::exp2(static_cast<float>(Slice) / m_ZSliceScale) : 0.f;
+}
+
+Uint32 LightClusterGrid::GetClusterIndex(const float3& ViewPos, const float4x4& Proj) const
+{
+    const float4 PosPS = float4{ViewPos, 1} * Proj;
+    const float  W     = PosPS.w != 0 ? PosPS.w : 1.f;
+
+    const float U = PosPS.x / W * 0.5f + 0.5f;
+    const float V = 0.5f - PosPS.y / W * 0.5f;
+
+    const Uint32 X = static_cast<Uint32>(clamp(U * static_cast<float>(m_CI.GridSizeX), 0.f, static_cast<float>(m_CI.GridSizeX - 1)));
+    const Uint32 Y = static_cast<Uint32>(clamp(V * static_cast<float>(m_CI.GridSizeY), 0.f, static_cast<float>(m_CI.GridSizeY - 1)));
+    return GetClusterIndex(X, Y, GetDepthSlice(ViewPos.z));
+}
+
+void LightClusterGrid::Build(const float4x4&              View,
+                             const float4x4&              Proj,
+                             const HLSL::PBRLightAttribs* pLights,
+                             Uint32                       NumLights)
+{
+    VERIFY_EXPR(pLights != nullptr || NumLights == 0);
+
+    // Global lights go first so that the shader can process them without indirection
+    m_Lights.clear();
+    m_Lights.reserve(NumLights);
+    for (Uint32 i = 0; i < NumLights; ++i)
+    {
+        if (IsGlobalLight(pLights[i]))
+            m_Lights.push_back(pLights[i]);
+    }
+    m_GlobalLightCount = static_cast<Uint32>(m_Lights.size());
+    for (Uint32 i = 0; i < NumLights; ++i)
+    {
+        if (!IsGlobalLight(pLights[i]))
+            m_Lights.push_back(pLights[i]);
+    }
+
+    // Pass 1: find the clusters overlapped by every local light.
+    m_Spans.clear();
+    for (Uint32 LightIdx = m_GlobalLightCount; LightIdx < m_Lights.size(); ++LightIdx)
+    {
+        const HLSL::PBRLightAttribs& Light = m_Lights[LightIdx];
+
+        const float  Range   = std::sqrt(std::sqrt(Light.Range4));
+        const float3 Center  = float3{Light.PosX, Light.PosY, Light.PosZ} * View;
+        const float  MinZ    = Center.z - Range;
+        const float  MaxZ    = Center.z + Range;
+        const float  RangeSq = Range * Range;
+        if (MaxZ <= 0)
+            continue; // Behind the camera
+
+        const Uint32 Slice0 = GetDepthSlice(MinZ);
+        const Uint32 Slice1 = GetDepthSlice(MaxZ);
+        for (Uint32 z = Slice0; z <= Slice1; ++z)
+        {
+            const float SliceZ0 = std::max(GetSliceNearZ(z), MinZ);
+            const float SliceZ1 = z + 1 < m_CI.GridSizeZ ? std::min(GetSliceNearZ(z + 1), MaxZ) : MaxZ;
+
+            // Radius of the light sphere cross-section within the slice
+            const float ClosestZ = clamp(Center.z, SliceZ0, SliceZ1);
+            const float SectionR = std::sqrt(std::max(RangeSq - (ClosestZ - Center.z) * (ClosestZ - Center.z), 0.f));
+
+            float2 MinUV{+FLT_MAX, +FLT_MAX};
+            float2 MaxUV{-FLT_MAX, -FLT_MAX};
+            if (SliceZ0 <= 0)
+            {
+                // The box crosses the camera plane: the projection is unbounded
+                MinUV = float2{0, 0};
+                MaxUV = float2{1, 1};
+            }
+            else
+            {
+                for (Uint32 Corner = 0; Corner < 8; ++Corner)
+                {
+                    const float3 Pos{
+                        Center.x + ((Corner & 0x01) ? SectionR : -SectionR),
+                        Center.y + ((Corner & 0x02) ? SectionR : -SectionR),
+                        (Corner & 0x04) ? SliceZ1 : SliceZ0,
+                    };
+
+                    const float4 PosPS = float4{Pos, 1} * Proj;
+                    const float2 UV{
+                        PosPS.x / PosPS.w * 0.5f + 0.5f,
+                        0.5f - PosPS.y / PosPS.w * 0.5f,
+                    };
+                    MinUV = std::min(MinUV, UV);
+                    MaxUV = std::max(MaxUV, UV);
+                }
+            }
+
+            if (MaxUV.x < 0 || MaxUV.y < 0 || MinUV.x > 1 || MinUV.y > 1)
+                continue; // Outside of the view frustum
+
+            const float2 GridSize{static_cast<float>(m_CI.GridSizeX), static_cast<float>(m_CI.GridSizeY)};
+
+            SliceSpan Span;
+            Span.LightIdx = LightIdx;
+            Span.Z        = z;
+            Span.X0       = static_cast<Uint32>(clamp(MinUV.x * GridSize.x, 0.f, GridSize.x - 1));
+            Span.X1       = static_cast<Uint32>(clamp(MaxUV.x * GridSize.x, 0.f, GridSize.x - 1));
+            Span.Y0       = static_cast<Uint32>(clamp(MinUV.y * GridSize.y, 0.f, GridSize.y - 1));
+            Span.Y1       = static_cast<Uint32>(clamp(MaxUV.y * GridSize.y, 0.f, GridSize.y - 1));
+            m_Spans.push_back(Span);
+        }
+    }
+
+    // Pass 2: count the lights in every cluster.
+    for (uint2& Cluster : m_Clusters)
+        Cluster = uint2{0, 0};
+    for (const SliceSpan& Span : m_Spans)
+    {
+        for (Uint32 y = Span.Y0; y <= Span.Y1; ++y)
+        {
+            for (Uint32 x = Span.X0; x <= Span.X1; ++x)
+                ++m_Clusters[GetClusterIndex(x, y, Span.Z)].y;
+        }
+    }
+
+    // Pass 3: compute the offsets of every cluster in the index list.
+    Uint32 NumIndices = 0;
+    for (uint2& Cluster : m_Clusters)
+    {
+        Cluster.x = NumIndices;
+        NumIndices += Cluster.y;
+        // Count is restored while filling the list
+        Cluster.y = 0;
+    }
+
+    // Pass 4: fill the index list. Lights in every cluster are sorted by index.
+    m_LightIndices.resize(NumIndices);
+    for (const SliceSpan& Span : m_Spans)
+    {
+        for (Uint32 y = Span.Y0; y <= Span.Y1; ++y)
+        {
+            for (Uint32 x = Span.X0; x <= Span.X1; ++x)
+            {
+                uint2& Cluster = m_Clusters[GetClusterIndex(x, y, Span.Z)];
+                m_LightIndices[Cluster.x + Cluster.y++] = Span.LightIdx;
+            }
+        }
+    }
+}
+
+void LightClusterGrid::GetShaderAttribs(HLSL::PBRLightClusterGridAttribs& Attribs) const
+{
+    Attribs.GridSizeX        = static_cast<int>(m_CI.GridSizeX);
+    Attribs.GridSizeY        = static_cast<int>(m_CI.GridSizeY);
+    Attribs.GridSizeZ        = static_cast<int>(m_CI.GridSizeZ);
+    Attribs.GlobalLightCount = static_cast<int>(m_GlobalLightCount);
+    Attribs.ZNear            = m_CI.ZNear;
+    Attribs.ZSliceScale      = m_ZSliceScale;
+    Attribs.LightIndexCount  = static_cast<int>(m_LightIndices.size());
+}
+
+} // namespace Diligent
@@ -28,6 +28,13 @@
 
 #include <array>
 #include <vector>
+#include <unordered_set>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
 
 #include "RenderStateCache.hpp"
 #include "GraphicsUtilities.h"
@@ -38,7 +45,10 @@
 #include "PlatformMisc.hpp"
 #include "TextureUtilities.h"
 #include "Utilities/interface/DiligentFXShaderSourceStreamFactory.hpp"
+#include "Utilities/interface/DiligentFXShaderArchive.hpp"
 #include "ShaderSourceFactoryUtils.hpp"
+#include "FileSystem.hpp"
+#include "Timer.hpp"
 
 #if HLSL2GLSL_CONVERTER_SUPPORTED
 #    include "../include/HLSL2GLSLConverterImpl.hpp"
@@ -182,13 +192,16 @@ std::string PBR_Renderer::GetPSOFlagsString(PSO_FLAGS Flags)
             case PSO_FLAG_UNSHADED:                  FlagsStr += "UNSHADED"; break;
             case PSO_FLAG_COMPUTE_MOTION_VECTORS:    FlagsStr += "MOTION_VECTORS"; break;
             case PSO_FLAG_ENABLE_SHADOWS:            FlagsStr += "SHADOWS"; break;
+            case PSO_FLAG_USE_MATERIAL_TABLE:        FlagsStr += "MATERIAL_TABLE"; break;
+            case PSO_FLAG_USE_CLUSTERED_LIGHTING:    FlagsStr += "CLUSTERED_LIGHTING"; break;
+            case PSO_FLAG_USE_HALF_PRECISION:        FlagsStr += "HALF_PRECISION"; break;
                 // clang-format on
 
             default:
                 FlagsStr += std::to_string(PlatformMisc::GetLSB(Flag));
         }
     }
-    static_assert(PSO_FLAG_LAST == 1ull << 38ull, "Please update the switch above to handle the new flag");
+    static_assert(PSO_FLAG_LAST == 1ull << 41ull, "Please update the switch above to handle the new flag");
 
     return FlagsStr;
 }
@@ -203,11 +216,13 @@ PBR_Renderer::PBR_Renderer(IRenderDevice*     pDevice,
         [this](CreateInfo CI) {
             CI.InputLayout               = m_InputLayout;
             CI.SheenAlbedoScalingLUTPath = nullptr;
+            CI.GLSLConversionCacheDir    = nullptr;
             return CI;
         }(CI)},
     m_Device{pDevice, pStateCache},
     m_PBRPrimitiveAttribsCB{CI.pPrimitiveAttribsCB},
-    m_JointsBuffer{CI.pJointsBuffer}
+    m_JointsBuffer{CI.pJointsBuffer},
+    m_GLSLConversionCacheDir{CI.GLSLConversionCacheDir != nullptr ? CI.GLSLConversionCacheDir : ""}
 {
     if (m_Settings.EnableIBL)
     {
@@ -343,7 +358,8 @@ PBR_Renderer::PBR_Renderer(IRenderDevice*     pDevice,
     {
         if (!m_PBRPrimitiveAttribsCB)
         {
-            CreateUniformBuffer(pDevice, GetPBRPrimitiveAttribsSize(PSO_FLAG_ALL), "PBR primitive attribs CB", &m_PBRPrimitiveAttribsCB);
+            // Material table mode replaces material attributes with the material index, so exclude it to get the maximum size.
+            CreateUniformBuffer(pDevice, GetPBRPrimitiveAttribsSize(PSO_FLAG_ALL & ~PSO_FLAG_USE_MATERIAL_TABLE), "PBR primitive attribs CB", &m_PBRPrimitiveAttribsCB);
         }
         if (m_Settings.MaxJointCount > 0)
         {
@@ -357,10 +373,44 @@ PBR_Renderer::PBR_Renderer(IRenderDevice*     pDevice,
                 DEV_CHECK_ERR(m_JointsBuffer->GetDesc().Size >= JointsBufferSize, "PBR joint transforms buffer is too small to hold ", m_Settings.MaxJointCount, " joints.");
             }
         }
+        if (m_Settings.EnableClusteredLighting)
+        {
+            m_LightClusterGrid = std::make_unique<LightClusterGrid>(m_Settings.LightClusterGridCI);
+
+            const Uint32 ClusterCount = m_LightClusterGrid->GetClusterCount();
+            if (m_Settings.ClusterLightIndexCapacity == 0)
+                m_Settings.ClusterLightIndexCapacity = ClusterCount * 32;
+
+            CreateUniformBuffer(pDevice, sizeof(HLSL::PBRLightClusterGridAttribs), "PBR light cluster grid attribs CB", &m_LightClusterGridCB);
+
+            auto CreateStructuredBuffer = [&](const char* Name, Uint32 ElementSize, Uint32 NumElements, RefCntAutoPtr<IBuffer>& pBuffer) {
+                BufferDesc Desc{
+                    Name,
+                    Uint64{ElementSize} * std::max(NumElements, 1u),
+                    BIND_SHADER_RESOURCE,
+                    USAGE_DEFAULT,
+                    CPU_ACCESS_NONE,
+                    BUFFER_MODE_STRUCTURED,
+                    ElementSize,
+                };
+                pBuffer = m_Device.CreateBuffer(Desc);
+            };
+            CreateStructuredBuffer("PBR clustered lights", sizeof(HLSL::PBRLightAttribs), m_Settings.MaxClusteredLightCount, m_ClusteredLightsBuffer);
+            CreateStructuredBuffer("PBR light clusters", sizeof(uint2), ClusterCount, m_LightClustersBuffer);
+            CreateStructuredBuffer("PBR cluster light indices", sizeof(Uint32), m_Settings.ClusterLightIndexCapacity, m_ClusterLightIndicesBuffer);
+        }
+
         std::vector<StateTransitionDesc> Barriers;
         Barriers.emplace_back(m_PBRPrimitiveAttribsCB, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
         if (m_JointsBuffer)
             Barriers.emplace_back(m_JointsBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
+        if (m_LightClusterGrid)
+        {
+            Barriers.emplace_back(m_LightClusterGridCB, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
+            Barriers.emplace_back(m_ClusteredLightsBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE);
+            Barriers.emplace_back(m_LightClustersBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE);
+            Barriers.emplace_back(m_ClusterLightIndicesBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE);
+        }
         pCtx->TransitionResourceStates(static_cast<Uint32>(Barriers.size()), Barriers.data());
     }
 
@@ -374,12 +424,14 @@ PBR_Renderer::~PBR_Renderer()
 {
 #ifdef DILIGENT_DEVELOPMENT
     {
-        size_t NumPSOs = 0;
-        for (const auto& it : m_PSOs)
+        LOG_INFO_MESSAGE("PBR Renderer: PSO count: ", GetPSOCount(), ".");
+
+        const GLSLConversionCacheStatistics& Stats = m_GLSLConversionCacheStats;
+        if (Stats.NumMemoryHits + Stats.NumDiskHits + Stats.NumMisses > 0)
         {
-            NumPSOs += it.second.size();
+            LOG_INFO_MESSAGE("PBR Renderer: HLSL-to-GLSL conversion cache: ", Stats.NumMemoryHits, " memory hits, ", Stats.NumDiskHits, " disk hits, ",
+                             Stats.NumMisses, " misses. Conversion time: ", Stats.ConversionTime * 1000.0, " ms, saved: ", Stats.TimeSaved * 1000.0, " ms.");
         }
-        LOG_INFO_MESSAGE("PBR Renderer: PSO cache size: ", NumPSOs, ".");
     }
 #endif
 }
@@ -737,6 +789,18 @@ void PBR_Renderer::InitCommonSRBVars(IShaderResourceBinding* pSRB,
         if (auto* pShadowMapVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ShadowMap"))
             pShadowMapVar->Set(pShadowMap);
     }
+
+    if (m_LightClusterGrid)
+    {
+        if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbLightClusterGrid"))
+            pVar->Set(m_LightClusterGridCB);
+        if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ClusteredLights"))
+            pVar->Set(m_ClusteredLightsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+        if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LightClusters"))
+            pVar->Set(m_LightClustersBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+        if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ClusterLightIndices"))
+            pVar->Set(m_ClusterLightIndicesBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    }
 }
 
 void PBR_Renderer::SetMaterialTexture(IShaderResourceBinding* pSRB, ITextureView* pTexSRV, TEXTURE_ATTRIB_ID TextureId) const
@@ -948,6 +1012,22 @@ void PBR_Renderer::CreateSignature()
         AddTextureAndSampler("g_ShadowMap", Sam_ComparisonLinearClamp, "g_ShadowMap_sampler");
     }
 
+    if (m_Settings.EnableMaterialTable)
+    {
+        SignatureDesc.AddResource(SHADER_TYPE_PIXEL, "g_MaterialTable", SHADER_RESOURCE_TYPE_BUFFER_SRV, SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE);
+    }
+
+    if (m_Settings.EnableClusteredLighting)
+    {
+        // clang-format off
+        SignatureDesc
+            .AddResource(SHADER_TYPE_PIXEL, "cbLightClusterGrid",    SHADER_RESOURCE_TYPE_CONSTANT_BUFFER, SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE)
+            .AddResource(SHADER_TYPE_PIXEL, "g_ClusteredLights",     SHADER_RESOURCE_TYPE_BUFFER_SRV,      SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE)
+            .AddResource(SHADER_TYPE_PIXEL, "g_LightClusters",       SHADER_RESOURCE_TYPE_BUFFER_SRV,      SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE)
+            .AddResource(SHADER_TYPE_PIXEL, "g_ClusterLightIndices", SHADER_RESOURCE_TYPE_BUFFER_SRV,      SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE);
+        // clang-format on
+    }
+
     CreateCustomSignature(std::move(SignatureDesc));
 }
 
@@ -1026,6 +1106,7 @@ ShaderMacroHelper PBR_Renderer::DefineMacros(const PSOKey& Key) const
     Macros.Add("USE_IBL_ENV_MAP_LOD", true);
     Macros.Add("USE_HDR_IBL_CUBEMAPS", true);
     Macros.Add("USE_SEPARATE_METALLIC_ROUGHNESS_TEXTURES", m_Settings.UseSeparateMetallicRoughnessTextures);
+    Macros.Add("PBR_UBERSHADER", m_Settings.EnableUbershader);
 
     if (m_Settings.EnableShadows)
     {
@@ -1077,7 +1158,7 @@ ShaderMacroHelper PBR_Renderer::DefineMacros(const PSOKey& Key) const
     Macros.Add("DEBUG_VIEW_THICKNESS",             static_cast<int>(DebugViewType::Thickness));
     // clang-format on
 
-    static_assert(PSO_FLAG_LAST == PSO_FLAG_BIT(38), "Did you add new PSO Flag? You may need to handle it here.");
+    static_assert(PSO_FLAG_LAST == PSO_FLAG_BIT(41), "Did you add new PSO Flag? You may need to handle it here.");
 #define ADD_PSO_FLAG_MACRO(Flag) Macros.Add(#Flag, (PSOFlags & PSO_FLAG_##Flag) != PSO_FLAG_NONE)
     ADD_PSO_FLAG_MACRO(USE_COLOR_MAP);
     ADD_PSO_FLAG_MACRO(USE_NORMAL_MAP);
@@ -1121,6 +1202,9 @@ ShaderMacroHelper PBR_Renderer::DefineMacros(const PSOKey& Key) const
     ADD_PSO_FLAG_MACRO(UNSHADED);
     ADD_PSO_FLAG_MACRO(COMPUTE_MOTION_VECTORS);
     ADD_PSO_FLAG_MACRO(ENABLE_SHADOWS);
+    ADD_PSO_FLAG_MACRO(USE_MATERIAL_TABLE);
+    ADD_PSO_FLAG_MACRO(USE_CLUSTERED_LIGHTING);
+    ADD_PSO_FLAG_MACRO(USE_HALF_PRECISION);
 #undef ADD_PSO_FLAG_MACRO
 
     Macros.Add("TEX_COLOR_CONVERSION_MODE_NONE", CreateInfo::TEX_COLOR_CONVERSION_MODE_NONE);
@@ -1136,14 +1220,19 @@ ShaderMacroHelper PBR_Renderer::DefineMacros(const PSOKey& Key) const
             *m_StaticShaderTextureIds;
     }
 
-    // Tightly pack these attributes that are used by the shader
+    // Tightly pack these attributes that are used by the shader.
+    // Material table entries are shared by all pipeline states, so in this mode
+    // the attributes are indexed by the renderer-wide texture attribute indices.
+    const bool UseMaterialTable = (PSOFlags & PSO_FLAG_USE_MATERIAL_TABLE) != 0;
+    DEV_CHECK_ERR(!UseMaterialTable || m_Settings.EnableMaterialTable, "Material table must be enabled in the renderer settings");
+
     int MaxIndex = -1;
     ProcessTexturAttribs(PSOFlags, [&](int CurrIndex, PBR_Renderer::TEXTURE_ATTRIB_ID AttribId) //
                          {
                              if (m_Settings.TextureAttribIndices[AttribId] >= 0)
                              {
                                  const std::string AttribIdName = GetTextureAttribIdString(AttribId);
-                                 Macros.Add(AttribIdName.c_str(), CurrIndex);
+                                 Macros.Add(AttribIdName.c_str(), UseMaterialTable ? m_Settings.TextureAttribIndices[AttribId] : CurrIndex);
                              }
                              else
                              {
@@ -1166,7 +1255,7 @@ ShaderMacroHelper PBR_Renderer::DefineMacros(const PSOKey& Key) const
                              }
                          });
     Macros
-        .Add("PBR_NUM_TEXTURE_ATTRIBUTES", MaxIndex + 1)
+        .Add("PBR_NUM_TEXTURE_ATTRIBUTES", UseMaterialTable ? static_cast<int>(GetMaterialTableTextureAttribCount()) : MaxIndex + 1)
         .Add("PBR_NUM_MATERIAL_TEXTURES", static_cast<int>(m_Settings.MaterialTexturesArraySize));
 
     Macros
@@ -1193,25 +1282,44 @@ void PBR_Renderer::GetVSInputStructAndLayout(PSO_FLAGS         PSOFlags,
     //    float4 Color   : ATTRIB6;
     //    float3 Tangent : ATTRIB7;
     //};
+    enum VS_ATTRIB_ENCODING : Uint8
+    {
+        // 32-bit float components
+        VS_ATTRIB_ENCODING_FLOAT = 1u << 0u,
+
+        // Half-precision float or normalized integer components that
+        // are converted to float by the input assembler
+        VS_ATTRIB_ENCODING_CONVERTED = 1u << 1u,
+
+        // Non-normalized integer components
+        VS_ATTRIB_ENCODING_INTEGER = 1u << 2u,
+
+        // Unit vector encoded as two octahedral components
+        VS_ATTRIB_ENCODING_OCTAHEDRAL = 1u << 3u,
+    };
     struct VSAttribInfo
     {
         const Uint32      Index;
         const char* const Name;
-        const VALUE_TYPE  Type;
         const Uint32      NumComponents;
         const PSO_FLAGS   Flag;
+        const Uint8       AllowedEncodings;
+        const char* const OctahedralMacro;
     };
+    static constexpr Uint8 FloatOrConverted = VS_ATTRIB_ENCODING_FLOAT | VS_ATTRIB_ENCODING_CONVERTED;
+    static constexpr Uint8 UnitVector       = VS_ATTRIB_ENCODING_FLOAT | VS_ATTRIB_ENCODING_OCTAHEDRAL;
+    static constexpr Uint8 JointIndices     = VS_ATTRIB_ENCODING_FLOAT | VS_ATTRIB_ENCODING_INTEGER;
     static constexpr std::array<VSAttribInfo, 8> VSAttribs = //
         {
             // clang-format off
-            VSAttribInfo{0, "Pos",     VT_FLOAT32, 3, PSO_FLAG_NONE},
-            VSAttribInfo{1, "Normal",  VT_FLOAT32, 3, PSO_FLAG_USE_VERTEX_NORMALS},
-            VSAttribInfo{2, "UV0",     VT_FLOAT32, 2, PSO_FLAG_USE_TEXCOORD0},
-            VSAttribInfo{3, "UV1",     VT_FLOAT32, 2, PSO_FLAG_USE_TEXCOORD1},
-            VSAttribInfo{4, "Joint0",  VT_FLOAT32, 4, PSO_FLAG_USE_JOINTS},
-            VSAttribInfo{5, "Weight0", VT_FLOAT32, 4, PSO_FLAG_USE_JOINTS},
-            VSAttribInfo{6, "Color",   VT_FLOAT32, 4, PSO_FLAG_USE_VERTEX_COLORS},
-            VSAttribInfo{7, "Tangent", VT_FLOAT32, 3, PSO_FLAG_USE_VERTEX_TANGENTS}
+            VSAttribInfo{0, "Pos",     3, PSO_FLAG_NONE,                VS_ATTRIB_ENCODING_FLOAT, nullptr},
+            VSAttribInfo{1, "Normal",  3, PSO_FLAG_USE_VERTEX_NORMALS,  UnitVector,               "VS_INPUT_OCTAHEDRAL_NORMAL"},
+            VSAttribInfo{2, "UV0",     2, PSO_FLAG_USE_TEXCOORD0,       FloatOrConverted,         nullptr},
+            VSAttribInfo{3, "UV1",     2, PSO_FLAG_USE_TEXCOORD1,       FloatOrConverted,         nullptr},
+            VSAttribInfo{4, "Joint0",  4, PSO_FLAG_USE_JOINTS,          JointIndices,             nullptr},
+            VSAttribInfo{5, "Weight0", 4, PSO_FLAG_USE_JOINTS,          FloatOrConverted,         nullptr},
+            VSAttribInfo{6, "Color",   4, PSO_FLAG_USE_VERTEX_COLORS,   FloatOrConverted,         nullptr},
+            VSAttribInfo{7, "Tangent", 3, PSO_FLAG_USE_VERTEX_TANGENTS, UnitVector,               "VS_INPUT_OCTAHEDRAL_TANGENT"}
             // clang-format on
         };
 
@@ -1219,6 +1327,7 @@ void PBR_Renderer::GetVSInputStructAndLayout(PSO_FLAGS         PSOFlags,
     InputLayout.ResolveAutoOffsetsAndStrides();
 
     std::stringstream ss;
+    std::stringstream Defines;
     ss << "struct VSInput" << std::endl
        << "{" << std::endl;
 
@@ -1226,25 +1335,57 @@ void PBR_Renderer::GetVSInputStructAndLayout(PSO_FLAGS         PSOFlags,
     {
         if (Attrib.Flag == PSO_FLAG_NONE || (PSOFlags & Attrib.Flag) != 0)
         {
-#ifdef DILIGENT_DEVELOPMENT
+            const LayoutElement* pElem = nullptr;
+            for (Uint32 i = 0; i < InputLayout.GetNumElements(); ++i)
             {
-                bool AttribFound = false;
-                for (Uint32 i = 0; i < InputLayout.GetNumElements(); ++i)
+                if (InputLayout[i].InputIndex == Attrib.Index)
                 {
-                    const auto& Elem = InputLayout[i];
-                    if (Elem.InputIndex == Attrib.Index)
-                    {
-                        AttribFound = true;
-                        DEV_CHECK_ERR(Elem.NumComponents == Attrib.NumComponents, "Input layout element '", Attrib.Name, "' (index ", Attrib.Index, ") has ", Elem.NumComponents, " components, but shader expects ", Attrib.NumComponents);
-                        DEV_CHECK_ERR(Elem.ValueType == Attrib.Type, "Input layout element '", Attrib.Name, "' (index ", Attrib.Index, ") has value type ", GetValueTypeString(Elem.ValueType), ", but shader expects ", GetValueTypeString(Attrib.Type));
-                        break;
-                    }
+                    pElem = &InputLayout[i];
+                    break;
                 }
-                DEV_CHECK_ERR(AttribFound, "Input layout does not contain attribute '", Attrib.Name, "' (index ", Attrib.Index, ")");
             }
-#endif
-            VERIFY_EXPR(Attrib.Type == VT_FLOAT32);
-            ss << "    " << std::setw(7) << "float" << Attrib.NumComponents << std::setw(9) << Attrib.Name << ": ATTRIB" << Attrib.Index << ";" << std::endl;
+            DEV_CHECK_ERR(pElem != nullptr, "Input layout does not contain attribute '", Attrib.Name, "' (index ", Attrib.Index, ")");
+
+            // Compressed attributes are decoded either by the input assembler or in the vertex shader.
+            VS_ATTRIB_ENCODING Encoding      = VS_ATTRIB_ENCODING_FLOAT;
+            const char*        ShaderType    = "float";
+            Uint32             NumComponents = Attrib.NumComponents;
+            if (pElem != nullptr)
+            {
+                const bool IsFloat = pElem->ValueType == VT_FLOAT32 || pElem->ValueType == VT_FLOAT16;
+                if (pElem->ValueType == VT_FLOAT32 && pElem->NumComponents == Attrib.NumComponents)
+                {
+                    Encoding = VS_ATTRIB_ENCODING_FLOAT;
+                }
+                else if (pElem->NumComponents == 2 && (Attrib.AllowedEncodings & VS_ATTRIB_ENCODING_OCTAHEDRAL) != 0 && (IsFloat || pElem->IsNormalized))
+                {
+                    Encoding      = VS_ATTRIB_ENCODING_OCTAHEDRAL;
+                    NumComponents = 2;
+                }
+                else if (IsFloat || pElem->IsNormalized)
+                {
+                    Encoding = VS_ATTRIB_ENCODING_CONVERTED;
+                }
+                else
+                {
+                    Encoding   = VS_ATTRIB_ENCODING_INTEGER;
+                    ShaderType = (pElem->ValueType == VT_INT8 || pElem->ValueType == VT_INT16 || pElem->ValueType == VT_INT32) ? "int" : "uint";
+                }
+
+                DEV_CHECK_ERR((Attrib.AllowedEncodings & Encoding) != 0,
+                              "Input layout element '", Attrib.Name, "' (index ", Attrib.Index, ") uses unsupported encoding: ",
+                              pElem->NumComponents, " components of type ", GetValueTypeString(pElem->ValueType), (pElem->IsNormalized ? " (normalized)" : ""));
+                DEV_CHECK_ERR(Encoding == VS_ATTRIB_ENCODING_OCTAHEDRAL || pElem->NumComponents == Attrib.NumComponents,
+                              "Input layout element '", Attrib.Name, "' (index ", Attrib.Index, ") has ", pElem->NumComponents, " components, but shader expects ", Attrib.NumComponents);
+            }
+
+            if (Encoding == VS_ATTRIB_ENCODING_OCTAHEDRAL)
+            {
+                VERIFY_EXPR(Attrib.OctahedralMacro != nullptr);
+                Defines << "#define " << Attrib.OctahedralMacro << " 1" << std::endl;
+            }
+
+            ss << "    " << std::setw(7) << ShaderType << NumComponents << std::setw(9) << Attrib.Name << ": ATTRIB" << Attrib.Index << ";" << std::endl;
         }
         else
         {
@@ -1263,7 +1404,7 @@ void PBR_Renderer::GetVSInputStructAndLayout(PSO_FLAGS         PSOFlags,
 
     ss << "};" << std::endl;
 
-    VSInputStruct = ss.str();
+    VSInputStruct = Defines.str() + ss.str();
 }
 
 std::string PBR_Renderer::GetVSOutputStruct(PSO_FLAGS PSOFlags, bool UseVkPointSize, bool UsePrimitiveId)
@@ -1358,6 +1499,111 @@ static constexpr char DefaultPSMainFooter[] = R"(
     return PSOut;
 )";
 
+std::string PBR_Renderer::ConvertHLSLToGLSL(const ShaderCreateInfo& ShaderCI, bool UseCombinedSamplers)
+{
+#ifdef HLSL2GLSL_CONVERTER_SUPPORTED
+    HLSL2GLSLConverterImpl::ConversionAttribs Attribs;
+    Attribs.pSourceStreamFactory       = ShaderCI.pShaderSourceStreamFactory;
+    Attribs.EntryPoint                 = ShaderCI.EntryPoint;
+    Attribs.ShaderType                 = ShaderCI.Desc.ShaderType;
+    Attribs.InputFileName              = ShaderCI.FilePath;
+    Attribs.SamplerSuffix              = UseCombinedSamplers ? ShaderCI.Desc.CombinedSamplerSuffix : ShaderDesc{}.CombinedSamplerSuffix;
+    Attribs.UseInOutLocationQualifiers = true;
+    Attribs.IncludeDefinitions         = true;
+
+    // The converter does not run the preprocessor, so the result only depends on the
+    // source files (including the generated ones) and the conversion attributes, but not on the macros.
+    // The hash is also used as the file name in the cache directory, so it must not depend on the platform.
+    XXH128State Hasher;
+    Hasher.UpdateStr(Attribs.EntryPoint);
+    Hasher.Update(static_cast<Uint32>(Attribs.ShaderType));
+    Hasher.UpdateStr(Attribs.SamplerSuffix);
+    DiligentFXShaderArchive::HashShaderSource(Attribs.pSourceStreamFactory, Attribs.InputFileName, Hasher);
+    const std::string Hash = DiligentFXShaderArchive::HashToString(Hasher.Digest());
+
+    GLSLConversionCacheStatistics& Stats = m_GLSLConversionCacheStats;
+
+    const double AvgConversionTime = Stats.NumMisses > 0 ? Stats.ConversionTime / Stats.NumMisses : 0;
+
+    auto it = m_GLSLConversionCache.find(Hash);
+    if (it != m_GLSLConversionCache.end())
+    {
+        ++Stats.NumMemoryHits;
+        Stats.TimeSaved += AvgConversionTime;
+        return it->second;
+    }
+
+    std::string CachePath;
+    if (!m_GLSLConversionCacheDir.empty())
+    {
+        std::stringstream PathSS;
+        PathSS << m_GLSLConversionCacheDir;
+        if (m_GLSLConversionCacheDir.back() != '/' && m_GLSLConversionCacheDir.back() != '\\')
+            PathSS << '/';
+        PathSS << Hash << ".glsl";
+        CachePath = PathSS.str();
+
+        std::ifstream CacheFile{CachePath, std::ios::binary};
+        if (CacheFile)
+        {
+            std::stringstream SourceSS;
+            SourceSS << CacheFile.rdbuf();
+            std::string GLSLSource = SourceSS.str();
+            if (!GLSLSource.empty())
+            {
+                ++Stats.NumDiskHits;
+                Stats.TimeSaved += AvgConversionTime;
+                return m_GLSLConversionCache.emplace(Hash, std::move(GLSLSource)).first->second;
+            }
+        }
+    }
+
+    Timer       ConversionTimer;
+    std::string GLSLSource = HLSL2GLSLConverterImpl::GetInstance().Convert(Attribs);
+    if (GLSLSource.empty())
+        return {};
+
+    ++Stats.NumMisses;
+    Stats.ConversionTime += ConversionTimer.GetElapsedTime();
+
+    if (!CachePath.empty())
+    {
+        if (!FileSystem::PathExists(m_GLSLConversionCacheDir.c_str()) && !FileSystem::CreateDirectory(m_GLSLConversionCacheDir.c_str()))
+        {
+            LOG_WARNING_MESSAGE("Failed to create GLSL conversion cache directory ", m_GLSLConversionCacheDir);
+        }
+        else
+        {
+            // Several renderers may share the cache directory. Write to a temporary file first
+            // and then rename it so that readers never see a partially written file.
+            const std::string TmpPath = CachePath + '.' + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+            bool              Written = false;
+            {
+                std::ofstream TmpFile{TmpPath, std::ios::binary | std::ios::trunc};
+                Written = static_cast<bool>(TmpFile.write(GLSLSource.data(), GLSLSource.size()));
+            }
+            if (!Written)
+            {
+                LOG_WARNING_MESSAGE("Failed to write GLSL conversion cache file ", TmpPath);
+                std::remove(TmpPath.c_str());
+            }
+            else if (std::rename(TmpPath.c_str(), CachePath.c_str()) != 0)
+            {
+                // The file may have been written by another renderer
+                std::remove(TmpPath.c_str());
+            }
+        }
+    }
+
+    return m_GLSLConversionCache.emplace(Hash, std::move(GLSLSource)).first->second;
+#else
+    (void)ShaderCI;
+    (void)UseCombinedSamplers;
+    UNSUPPORTED("HLSL2GLSL converter is not supported");
+    return {};
+#endif
+}
+
 void PBR_Renderer::CreatePSO(PsoHashMapType& PsoHashMap, const GraphicsPipelineDesc& GraphicsDesc, const PSOKey& Key)
 {
     GraphicsPipelineStateCreateInfo PSOCreateInfo;
@@ -1404,6 +1650,14 @@ void PBR_Renderer::CreatePSO(PsoHashMapType& PsoHashMap, const GraphicsPipelineD
     RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory =
         CreateCompoundShaderSourceFactory({&DiligentFXShaderSourceStreamFactory::GetInstance(), pMemorySourceFactory});
 
+    // Generated files are part of the shader archive name, see DiligentFXShaderArchive.
+    const std::vector<DiligentFXShaderArchive::GeneratedFile> GeneratedFiles{
+        {"VSInputStruct.generated", VSInputStruct},
+        {"VSOutputStruct.generated", VSOutputStruct},
+        {"PSOutputStruct.generated", PSMainSource.OutputStruct},
+        {"PSMainFooter.generated", PSMainSource.Footer},
+    };
+
     auto Macros = DefineMacros(Key);
     if (GraphicsDesc.PrimitiveTopology == PRIMITIVE_TOPOLOGY_POINT_LIST && (m_Device.GetDeviceInfo().IsGLDevice() || m_Device.GetDeviceInfo().IsVulkanDevice()))
     {
@@ -1435,16 +1689,7 @@ void PBR_Renderer::CreatePSO(PsoHashMapType& PsoHashMap, const GraphicsPipelineD
             {
 #ifdef HLSL2GLSL_CONVERTER_SUPPORTED
                 // Since we use gl_DrawID in HLSL, we need to manually convert the shader to GLSL
-                HLSL2GLSLConverterImpl::ConversionAttribs Attribs;
-                Attribs.pSourceStreamFactory       = ShaderCI.pShaderSourceStreamFactory;
-                Attribs.EntryPoint                 = ShaderCI.EntryPoint;
-                Attribs.ShaderType                 = ShaderCI.Desc.ShaderType;
-                Attribs.InputFileName              = ShaderCI.FilePath;
-                Attribs.SamplerSuffix              = UseCombinedSamplers ? ShaderCI.Desc.CombinedSamplerSuffix : ShaderDesc{}.CombinedSamplerSuffix;
-                Attribs.UseInOutLocationQualifiers = true;
-                Attribs.IncludeDefinitions         = true;
-
-                GLSLSource = HLSL2GLSLConverterImpl::GetInstance().Convert(Attribs);
+                GLSLSource = ConvertHLSLToGLSL(ShaderCI, UseCombinedSamplers);
                 if (GLSLSource.empty())
                 {
                     UNEXPECTED("Failed to convert HLSL source to GLSL");
@@ -1463,7 +1708,7 @@ void PBR_Renderer::CreatePSO(PsoHashMapType& PsoHashMap, const GraphicsPipelineD
             }
         }
 
-        pVS = m_Device.CreateShader(ShaderCI);
+        pVS = DiligentFXShaderArchive::GetInstance().CreateShader(m_Device, m_Device.GetCache(), ShaderCI, GeneratedFiles);
     }
 
     RefCntAutoPtr<IShader> pPS;
@@ -1476,7 +1721,7 @@ void PBR_Renderer::CreatePSO(PsoHashMapType& PsoHashMap, const GraphicsPipelineD
             SHADER_SOURCE_LANGUAGE_HLSL,
             {!IsUnshaded ? "PBR PS" : "Unshaded PS", SHADER_TYPE_PIXEL, UseCombinedSamplers},
         };
-        pPS = m_Device.CreateShader(ShaderCI);
+        pPS = DiligentFXShaderArchive::GetInstance().CreateShader(m_Device, m_Device.GetCache(), ShaderCI, GeneratedFiles);
     }
 
     GraphicsPipeline             = GraphicsDesc;
@@ -1523,11 +1768,11 @@ void PBR_Renderer::CreatePSO(PsoHashMapType& PsoHashMap, const GraphicsPipelineD
             const auto DoubleSided                   = CullMode == CULL_MODE_NONE;
             auto       PSO                           = m_Device.CreateGraphicsPipelineState(PSOCreateInfo);
 
-            PsoHashMap[{PSOFlags, AlphaMode, DoubleSided, Key}] = PSO;
+            PsoHashMap.Insert({PSOFlags, AlphaMode, DoubleSided, Key}, PSO);
             if (AlphaMode == ALPHA_MODE_OPAQUE)
             {
                 // Mask and opaque use the same PSO
-                PsoHashMap[{PSOFlags, ALPHA_MODE_MASK, DoubleSided, Key}] = PSO;
+                PsoHashMap.Insert({PSOFlags, ALPHA_MODE_MASK, DoubleSided, Key}, PSO);
             }
         }
     }
@@ -1594,6 +1839,15 @@ IPipelineState* PBR_Renderer::GetPSO(PsoHashMapType&             PsoHashMap,
     {
         Flags &= ~PSO_FLAG_ENABLE_SHADOWS;
     }
+    if (!m_Settings.EnableClusteredLighting || (Flags & PSO_FLAG_USE_LIGHTS) == 0)
+    {
+        Flags &= ~PSO_FLAG_USE_CLUSTERED_LIGHTING;
+    }
+    if (m_Device.GetDeviceInfo().IsGLDevice())
+    {
+        // GLSL has no min16float type, so the shaders would fall back to full precision anyway.
+        Flags &= ~PSO_FLAG_USE_HALF_PRECISION;
+    }
 
     if (m_Settings.MaxJointCount == 0)
     {
@@ -1634,18 +1888,16 @@ IPipelineState* PBR_Renderer::GetPSO(PsoHashMapType&             PsoHashMap,
 
     const PSOKey UpdatedKey{Flags, Key};
 
-    auto it = PsoHashMap.find(UpdatedKey);
-    if (it == PsoHashMap.end())
+    // Pipeline states that failed to be created are stored as null and are not recreated
+    RefCntAutoPtr<IPipelineState>* ppPSO = PsoHashMap.Find(UpdatedKey);
+    if (ppPSO == nullptr && CreateIfNull)
     {
-        if (CreateIfNull)
-        {
-            CreatePSO(PsoHashMap, GraphicsDesc, UpdatedKey);
-            it = PsoHashMap.find(UpdatedKey);
-            VERIFY_EXPR(it != PsoHashMap.end());
-        }
+        CreatePSO(PsoHashMap, GraphicsDesc, UpdatedKey);
+        ppPSO = PsoHashMap.Find(UpdatedKey);
+        VERIFY_EXPR(ppPSO != nullptr);
     }
 
-    return it != PsoHashMap.end() ? it->second.RawPtr() : nullptr;
+    return ppPSO != nullptr ? ppPSO->RawPtr() : nullptr;
 }
 
 void PBR_Renderer::SetInternalShaderParameters(HLSL::PBRRendererShaderParameters& Renderer)
@@ -1659,6 +1911,7 @@ Uint32 PBR_Renderer::GetPBRPrimitiveAttribsSize(PSO_FLAGS Flags) const
     //{
     //    GLTFNodeShaderTransforms Transforms;
     //    float4x4                 PrevNodeMatrix; // #if ENABLE_MOTION_VECTORS
+    //    int4                     MaterialIndex;  // #if USE_MATERIAL_TABLE, replaces Material
     //    struct PBRMaterialShaderInfo
     //    {
     //        PBRMaterialBasicAttribs        Basic;
@@ -1682,6 +1935,15 @@ Uint32 PBR_Renderer::GetPBRPrimitiveAttribsSize(PSO_FLAGS Flags) const
                              }
                          });
 
+    if (Flags & PSO_FLAG_USE_MATERIAL_TABLE)
+    {
+        // Material attributes are replaced with the material index in the table
+        return (sizeof(HLSL::GLTFNodeShaderTransforms) +
+                ((Flags & PSO_FLAG_COMPUTE_MOTION_VECTORS) ? sizeof(float4x4) : 0) +
+                sizeof(int4) +
+                sizeof(float4));
+    }
+
     return (sizeof(HLSL::GLTFNodeShaderTransforms) +
             ((Flags & PSO_FLAG_COMPUTE_MOTION_VECTORS) ? sizeof(float4x4) : 0) +
             sizeof(HLSL::PBRMaterialBasicAttribs) +
@@ -1694,6 +1956,110 @@ Uint32 PBR_Renderer::GetPBRPrimitiveAttribsSize(PSO_FLAGS Flags) const
             sizeof(float4));
 }
 
+Uint32 PBR_Renderer::GetMaterialTableTextureAttribCount() const
+{
+    int MaxIndex = -1;
+    for (const int AttribIndex : m_Settings.TextureAttribIndices)
+        MaxIndex = std::max(MaxIndex, AttribIndex);
+    return static_cast<Uint32>(MaxIndex + 1);
+}
+
+Uint32 PBR_Renderer::GetMaterialTableEntrySize() const
+{
+    //struct PBRMaterialTableEntry
+    //{
+    //    PBRMaterialBasicAttribs        Basic;
+    //    PBRMaterialSheenAttribs        Sheen;
+    //    PBRMaterialAnisotropyAttribs   Anisotropy;
+    //    PBRMaterialIridescenceAttribs  Iridescence;
+    //    PBRMaterialTransmissionAttribs Transmission;
+    //    PBRMaterialVolumeAttribs       Volume;
+    //    PBRMaterialTextureAttribs      Textures[PBR_NUM_TEXTURE_ATTRIBUTES];
+    //};
+    return (sizeof(HLSL::PBRMaterialBasicAttribs) +
+            sizeof(HLSL::PBRMaterialSheenAttribs) +
+            sizeof(HLSL::PBRMaterialAnisotropyAttribs) +
+            sizeof(HLSL::PBRMaterialIridescenceAttribs) +
+            sizeof(HLSL::PBRMaterialTransmissionAttribs) +
+            sizeof(HLSL::PBRMaterialVolumeAttribs) +
+            sizeof(HLSL::PBRMaterialTextureAttribs) * GetMaterialTableTextureAttribCount());
+}
+
+PBR_Renderer::PSO_FLAGS PBR_Renderer::GetUbershaderMaterialFlags() const
+{
+    PSO_FLAGS Flags =
+        PSO_FLAG_USE_COLOR_MAP |
+        PSO_FLAG_USE_NORMAL_MAP;
+
+    Flags |= m_Settings.UseSeparateMetallicRoughnessTextures ?
+        PSO_FLAG_USE_METALLIC_MAP | PSO_FLAG_USE_ROUGHNESS_MAP :
+        PSO_FLAG_USE_PHYS_DESC_MAP;
+
+    if (m_Settings.EnableAO)
+    {
+        Flags |= PSO_FLAG_USE_AO_MAP;
+    }
+    if (m_Settings.EnableEmissive)
+    {
+        Flags |= PSO_FLAG_USE_EMISSIVE_MAP;
+    }
+    if (m_Settings.EnableClearCoat)
+    {
+        Flags |=
+            PSO_FLAG_ENABLE_CLEAR_COAT |
+            PSO_FLAG_USE_CLEAR_COAT_MAP |
+            PSO_FLAG_USE_CLEAR_COAT_ROUGHNESS_MAP |
+            PSO_FLAG_USE_CLEAR_COAT_NORMAL_MAP;
+    }
+    if (m_Settings.EnableSheen)
+    {
+        Flags |=
+            PSO_FLAG_ENABLE_SHEEN |
+            PSO_FLAG_USE_SHEEN_COLOR_MAP |
+            PSO_FLAG_USE_SHEEN_ROUGHNESS_MAP;
+    }
+    if (m_Settings.EnableAnisotropy)
+    {
+        Flags |=
+            PSO_FLAG_ENABLE_ANISOTROPY |
+            PSO_FLAG_USE_ANISOTROPY_MAP;
+    }
+    if (m_Settings.EnableIridescence)
+    {
+        Flags |=
+            PSO_FLAG_ENABLE_IRIDESCENCE |
+            PSO_FLAG_USE_IRIDESCENCE_MAP |
+            PSO_FLAG_USE_IRIDESCENCE_THICKNESS_MAP;
+    }
+    if (m_Settings.EnableTransmission)
+    {
+        Flags |=
+            PSO_FLAG_ENABLE_TRANSMISSION |
+            PSO_FLAG_USE_TRANSMISSION_MAP;
+    }
+    if (m_Settings.EnableVolume)
+    {
+        Flags |=
+            PSO_FLAG_ENABLE_VOLUME |
+            PSO_FLAG_USE_THICKNESS_MAP;
+    }
+
+    return Flags;
+}
+
+Uint32 PBR_Renderer::GetPSOCount() const
+{
+    // Opaque and mask alpha modes share the same pipeline state
+    std::unordered_set<const IPipelineState*> PSOs;
+    for (const auto& it : m_PSOs)
+    {
+        it.second.ProcessPSOs([&PSOs](const PSOKey&, const RefCntAutoPtr<IPipelineState>& pPSO) {
+            PSOs.insert(pPSO.RawPtr());
+        });
+    }
+    return static_cast<Uint32>(PSOs.size());
+}
+
 Uint32 PBR_Renderer::GetPRBFrameAttribsSize(Uint32 LightCount, Uint32 ShadowCastingLightCount)
 {
     return (sizeof(HLSL::CameraAttribs) * 2 +
@@ -1707,4 +2073,54 @@ Uint32 PBR_Renderer::GetPRBFrameAttribsSize() const
     return GetPRBFrameAttribsSize(m_Settings.MaxLightCount, m_Settings.MaxShadowCastingLightCount);
 }
 
+void PBR_Renderer::UpdateLightClusters(IDeviceContext*              pCtx,
+                                       const float4x4&              View,
+                                       const float4x4&              Proj,
+                                       const HLSL::PBRLightAttribs* pLights,
+                                       Uint32                       NumLights)
+{
+    if (!m_LightClusterGrid)
+    {
+        UNEXPECTED("Clustered lighting is not enabled in the renderer settings");
+        return;
+    }
+
+    if (NumLights > m_Settings.MaxClusteredLightCount)
+    {
+        LOG_WARNING_MESSAGE_ONCE("The number of lights (", NumLights, ") exceeds the maximum clustered light count (",
+                                 m_Settings.MaxClusteredLightCount, "). Extra lights will be ignored.");
+        NumLights = m_Settings.MaxClusteredLightCount;
+    }
+
+    m_LightClusterGrid->Build(View, Proj, pLights, NumLights);
+
+    const std::vector<HLSL::PBRLightAttribs>& Lights       = m_LightClusterGrid->GetLights();
+    const std::vector<uint2>&                 Clusters     = m_LightClusterGrid->GetClusters();
+    const std::vector<Uint32>&                LightIndices = m_LightClusterGrid->GetLightIndices();
+
+    Uint32 NumIndices = static_cast<Uint32>(LightIndices.size());
+    if (NumIndices > m_Settings.ClusterLightIndexCapacity)
+    {
+        // The shader clamps cluster ranges to the uploaded indices
+        LOG_WARNING_MESSAGE_ONCE("The number of cluster light indices (", NumIndices, ") exceeds the capacity (",
+                                 m_Settings.ClusterLightIndexCapacity, "). Some lights will not be rendered. Increase ClusterLightIndexCapacity.");
+        NumIndices = m_Settings.ClusterLightIndexCapacity;
+    }
+
+    HLSL::PBRLightClusterGridAttribs GridAttribs{};
+    m_LightClusterGrid->GetShaderAttribs(GridAttribs);
+    GridAttribs.LightIndexCount = static_cast<int>(NumIndices);
+    pCtx->UpdateBuffer(m_LightClusterGridCB, 0, sizeof(GridAttribs), &GridAttribs, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    if (!Lights.empty())
+    {
+        pCtx->UpdateBuffer(m_ClusteredLightsBuffer, 0, static_cast<Uint64>(Lights.size() * sizeof(Lights[0])), Lights.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+    pCtx->UpdateBuffer(m_LightClustersBuffer, 0, static_cast<Uint64>(Clusters.size() * sizeof(Clusters[0])), Clusters.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    if (NumIndices > 0)
+    {
+        pCtx->UpdateBuffer(m_ClusterLightIndicesBuffer, 0, Uint64{NumIndices} * sizeof(LightIndices[0]), LightIndices.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+}
+
 } // namespace Diligent
@@ -177,10 +177,19 @@ struct USD_Renderer::USDRendererCreateInfoWrapper
     {
         CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_BASE_COLOR] = 0;
         CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_NORMAL]     = 1;
-        CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_METALLIC]   = 2;
-        CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_ROUGHNESS]  = 3;
-        CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_OCCLUSION]  = 4;
-        CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_EMISSIVE]   = 5;
+        if (CI.UseSeparateMetallicRoughnessTextures)
+        {
+            CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_METALLIC]  = 2;
+            CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_ROUGHNESS] = 3;
+            CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_OCCLUSION] = 4;
+            CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_EMISSIVE]  = 5;
+        }
+        else
+        {
+            CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_PHYS_DESC] = 2;
+            CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_OCCLUSION] = 3;
+            CI.TextureAttribIndices[PBR_Renderer::TEXTURE_ATTRIB_ID_EMISSIVE]  = 4;
+        }
 
         if (CI.GetPSMainSource == nullptr)
         {
@@ -0,0 +1,257 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include "VertexCompression.hpp"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+#include "../../../DiligentCore/Platforms/Basic/interface/DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+float SignNotZero(float Value)
+{
+    return Value >= 0.f ? 1.f : -1.f;
+}
+
+Uint16 FloatToSnorm16(float Value)
+{
+    const float Clamped = std::max(std::min(Value, 1.f), -1.f);
+    return static_cast<Uint16>(static_cast<Int16>(std::round(Clamped * 32767.f)));
+}
+
+float Snorm16ToFloat(Uint16 Value)
+{
+    return std::max(static_cast<float>(static_cast<Int16>(Value)) / 32767.f, -1.f);
+}
+
+Uint8 FloatToUnorm8(float Value)
+{
+    const float Clamped = std::max(std::min(Value, 1.f), 0.f);
+    return static_cast<Uint8>(std::round(Clamped * 255.f));
+}
+
+} // namespace
+
+Uint32 EncodeOctahedralNormalRG16(const float3& Normal)
+{
+    const float L1Norm = std::abs(Normal.x) + std::abs(Normal.y) + std::abs(Normal.z);
+    if (L1Norm == 0)
+    {
+        // Zero-length vector is encoded as (0, 0, 1)
+        return 0;
+    }
+
+    // Project the vector onto the octahedron
+    float2 Oct{Normal.x / L1Norm, Normal.y / L1Norm};
+    if (Normal.z < 0)
+    {
+        // Fold the lower hemisphere over the diagonals
+        Oct = float2{
+            (1.f - std::abs(Oct.y)) * SignNotZero(Oct.x),
+            (1.f - std::abs(Oct.x)) * SignNotZero(Oct.y),
+        };
+    }
+
+    return Uint32{FloatToSnorm16(Oct.x)} | (Uint32{FloatToSnorm16(Oct.y)} << 16u);
+}
+
+float3 DecodeOctahedralNormalRG16(Uint32 Encoded)
+{
+    // Must be consistent with DecodeOctahedralNormal() in VertexProcessing.fxh
+    const float2 Oct{
+        Snorm16ToFloat(static_cast<Uint16>(Encoded & 0xFFFFu)),
+        Snorm16ToFloat(static_cast<Uint16>(Encoded >> 16u)),
+    };
+
+    float3    Normal{Oct.x, Oct.y, 1.f - std::abs(Oct.x) - std::abs(Oct.y)};
+    const float t = std::max(-Normal.z, 0.f);
+    Normal.x += Normal.x >= 0 ? -t : t;
+    Normal.y += Normal.y >= 0 ? -t : t;
+    return normalize(Normal);
+}
+
+Uint16 FloatToHalf(float Value)
+{
+    Uint32 Bits = 0;
+    static_assert(sizeof(Bits) == sizeof(Value), "Unexpected float size");
+    memcpy(&Bits, &Value, sizeof(Bits));
+
+    const Uint32 Sign = (Bits >> 16u) & 0x8000u;
+    const Uint32 Abs  = Bits & 0x7FFFFFFFu;
+
+    if (Abs >= 0x7F800000u)
+    {
+        // Infinity or NaN
+        return static_cast<Uint16>(Sign | 0x7C00u | (Abs > 0x7F800000u ? 0x200u : 0u));
+    }
+
+    if (Abs >= 0x477FF000u)
+    {
+        // The value is too large and rounds to infinity (65520 and above)
+        return static_cast<Uint16>(Sign | 0x7C00u);
+    }
+
+    if (Abs < 0x38800000u)
+    {
+        // The value is below the smallest normal half (2^-14)
+        if (Abs < 0x33000000u)
+            return static_cast<Uint16>(Sign); // Rounds to zero
+
+        const Uint32 Exponent = Abs >> 23u;
+        const Uint32 Mantissa = (Abs & 0x7FFFFFu) | 0x800000u;
+        const Uint32 Shift    = 126u - Exponent;
+
+        Uint32       Half      = Mantissa >> Shift;
+        const Uint32 Remainder = Mantissa & ((1u << Shift) - 1u);
+        const Uint32 Midpoint  = 1u << (Shift - 1u);
+        if (Remainder > Midpoint || (Remainder == Midpoint && (Half & 1u) != 0))
+            ++Half;
+        return static_cast<Uint16>(Sign | Half);
+    }
+
+    // Rebias the exponent from 127 to 15 and round the mantissa to nearest even
+    Uint32       Half      = (Abs - 0x38000000u) >> 13u;
+    const Uint32 Remainder = Abs & 0x1FFFu;
+    if (Remainder > 0x1000u || (Remainder == 0x1000u && (Half & 1u) != 0))
+        ++Half;
+    return static_cast<Uint16>(Sign | Half);
+}
+
+float HalfToFloat(Uint16 Value)
+{
+    const Uint32 Sign     = (Uint32{Value} & 0x8000u) << 16u;
+    const Uint32 Exponent = (Value >> 10u) & 0x1Fu;
+    const Uint32 Mantissa = Value & 0x3FFu;
+
+    Uint32 Bits = 0;
+    if (Exponent == 0)
+    {
+        // Zero or subnormal
+        const float Abs = static_cast<float>(Mantissa) / 16777216.f; // Mantissa * 2^-24
+        return Sign != 0 ? -Abs : Abs;
+    }
+    else if (Exponent == 0x1Fu)
+    {
+        // Infinity or NaN
+        Bits = Sign | 0x7F800000u | (Mantissa << 13u);
+    }
+    else
+    {
+        Bits = Sign | ((Exponent + 112u) << 23u) | (Mantissa << 13u);
+    }
+
+    float Result = 0;
+    memcpy(&Result, &Bits, sizeof(Result));
+    return Result;
+}
+
+Uint32 EncodeRG16Float(const float2& Value)
+{
+    return Uint32{FloatToHalf(Value.x)} | (Uint32{FloatToHalf(Value.y)} << 16u);
+}
+
+float2 DecodeRG16Float(Uint32 Encoded)
+{
+    return float2{
+        HalfToFloat(static_cast<Uint16>(Encoded & 0xFFFFu)),
+        HalfToFloat(static_cast<Uint16>(Encoded >> 16u)),
+    };
+}
+
+Uint32 EncodeRGBA8Unorm(const float4& Value)
+{
+    return (Uint32{FloatToUnorm8(Value.x)} << 0u) |
+        (Uint32{FloatToUnorm8(Value.y)} << 8u) |
+        (Uint32{FloatToUnorm8(Value.z)} << 16u) |
+        (Uint32{FloatToUnorm8(Value.w)} << 24u);
+}
+
+float4 DecodeRGBA8Unorm(Uint32 Encoded)
+{
+    return float4{
+        static_cast<float>((Encoded >> 0u) & 0xFFu) / 255.f,
+        static_cast<float>((Encoded >> 8u) & 0xFFu) / 255.f,
+        static_cast<float>((Encoded >> 16u) & 0xFFu) / 255.f,
+        static_cast<float>((Encoded >> 24u) & 0xFFu) / 255.f,
+    };
+}
+
+Uint32 EncodeJointWeightsRGBA8(const float4& Weights)
+{
+    const float Sum = Weights.x + Weights.y + Weights.z + Weights.w;
+    if (Sum <= 0)
+        return 0;
+
+    const float4 Normalized = Weights / Sum;
+
+    int Quantized[4] = {
+        static_cast<int>(FloatToUnorm8(Normalized.x)),
+        static_cast<int>(FloatToUnorm8(Normalized.y)),
+        static_cast<int>(FloatToUnorm8(Normalized.z)),
+        static_cast<int>(FloatToUnorm8(Normalized.w)),
+    };
+
+    // Rounding may break the partition of unity; apply the error to the largest weight.
+    const int Error   = 255 - (Quantized[0] + Quantized[1] + Quantized[2] + Quantized[3]);
+    int*      Largest = std::max_element(std::begin(Quantized), std::end(Quantized));
+    *Largest          = std::max(std::min(*Largest + Error, 255), 0);
+
+    return (static_cast<Uint32>(Quantized[0]) << 0u) |
+        (static_cast<Uint32>(Quantized[1]) << 8u) |
+        (static_cast<Uint32>(Quantized[2]) << 16u) |
+        (static_cast<Uint32>(Quantized[3]) << 24u);
+}
+
+void EncodeJointIndicesRGBA16(const float4& Joints, Uint16 Dst[4])
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        VERIFY(Joints[i] >= 0 && Joints[i] <= 65535, "Joint index ", Joints[i], " can't be represented as a 16-bit unsigned integer");
+        Dst[i] = static_cast<Uint16>(Joints[i]);
+    }
+}
+
+Uint32 EncodeJointIndicesRGBA8(const float4& Joints)
+{
+    Uint32 Encoded = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        VERIFY(Joints[i] >= 0 && Joints[i] <= 255, "Joint index ", Joints[i], " can't be represented as an 8-bit unsigned integer");
+        Encoded |= Uint32{static_cast<Uint8>(Joints[i])} << (i * 8u);
+    }
+    return Encoded;
+}
+
+} // namespace Diligent
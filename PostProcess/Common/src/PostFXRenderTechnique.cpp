@@ -27,6 +27,7 @@
 #include "PostFXRenderTechnique.hpp"
 #include "RenderStateCache.hpp"
 #include "Utilities/interface/DiligentFXShaderSourceStreamFactory.hpp"
+#include "Utilities/interface/DiligentFXShaderArchive.hpp"
 
 namespace Diligent
 {
@@ -47,7 +48,7 @@ RefCntAutoPtr<IShader> PostFXRenderTechnique::CreateShader(IRenderDevice*
     ShaderCI.Desc.Name                       = EntryPoint;
     ShaderCI.pShaderSourceStreamFactory      = &DiligentFXShaderSourceStreamFactory::GetInstance();
     ShaderCI.Desc.UseCombinedTextureSamplers = true;
-    return RenderDeviceWithCache<false>{pDevice, pStateCache}.CreateShader(ShaderCI);
+    return DiligentFXShaderArchive::GetInstance().CreateShader(pDevice, pStateCache, ShaderCI);
 }
 
 void PostFXRenderTechnique::InitializePSO(IRenderDevice*                     pDevice,
@@ -35,6 +35,7 @@
 #include "GraphicsUtilities.h"
 #include "GraphicsAccessories.hpp"
 #include "Utilities/interface/DiligentFXShaderSourceStreamFactory.hpp"
+#include "Utilities/interface/DiligentFXShaderArchive.hpp"
 #include "MapHelper.hpp"
 #include "CommonlyUsedStates.h"
 #include "Align.hpp"
@@ -283,7 +284,7 @@ static RefCntAutoPtr<IShader> CreateShader(IRenderDevice*          pDevice,
     ShaderCI.pShaderSourceStreamFactory      = &DiligentFXShaderSourceStreamFactory::GetInstance();
     ShaderCI.Desc.UseCombinedTextureSamplers = true;
 
-    return RenderDeviceWithCache<false>{pDevice, pStateCache}.CreateShader(ShaderCI);
+    return DiligentFXShaderArchive::GetInstance().CreateShader(pDevice, pStateCache, ShaderCI);
 }
 
 EpipolarLightScattering::EpipolarLightScattering(IRenderDevice*              pDevice,
@@ -0,0 +1,249 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "VertexCompression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Offline comparison of the half-precision shading path (PSO_FLAG_USE_HALF_PRECISION) with the full-precision path.
+// The functions below mirror SmithGGX_BRDF and GetSurfaceReflectanceMR from PBR_Common.fxh and PBR_Shading.fxh.
+// Every PBR_HALF value is rounded to fp16, which is the lowest precision min16float may use.
+//
+// Note that the test only validates the precision budget of this C++ copy of the BRDF math.
+// It does not compile the shaders, so it does not detect compile errors in RenderPBR.psh with
+// USE_HALF_PRECISION=1, nor differences between the shader code and the copy below. The copy must
+// be kept in sync with the shaders, and the half-precision PSOs must be tested on a device.
+
+constexpr float PI_F = 3.14159265358979323846f;
+
+// Rounds the value to the nearest fp16 value
+float ToHalf(float Value)
+{
+    return HalfToFloat(FloatToHalf(Value));
+}
+
+struct SurfaceReflectanceInfo
+{
+    float PerceptualRoughness;
+    float Reflectance0[3];
+    float Reflectance90[3];
+    float DiffuseColor[3];
+};
+
+struct Material
+{
+    float BaseColor[3];
+    float Metallic;
+    float Roughness;
+};
+
+SurfaceReflectanceInfo GetSurfaceReflectanceMR(const Material& Mat, bool Half)
+{
+    const float f0 = 0.04f;
+
+    SurfaceReflectanceInfo SrfInfo;
+    SrfInfo.PerceptualRoughness = Mat.Roughness;
+
+    float MaxR0 = 0;
+    for (int c = 0; c < 3; ++c)
+    {
+        SrfInfo.DiffuseColor[c] = Mat.BaseColor[c] * ((1.f - f0) * (1.f - Mat.Metallic));
+        SrfInfo.Reflectance0[c] = f0 + (Mat.BaseColor[c] - f0) * Mat.Metallic;
+        MaxR0                   = std::max(MaxR0, SrfInfo.Reflectance0[c]);
+    }
+    const float R90 = std::min(MaxR0 * 50.f, 1.f);
+    for (int c = 0; c < 3; ++c)
+        SrfInfo.Reflectance90[c] = R90;
+
+    if (Half)
+    {
+        // Reflectance0, Reflectance90 and DiffuseColor are PBR_HALF3
+        for (int c = 0; c < 3; ++c)
+        {
+            SrfInfo.DiffuseColor[c]  = ToHalf(SrfInfo.DiffuseColor[c]);
+            SrfInfo.Reflectance0[c]  = ToHalf(SrfInfo.Reflectance0[c]);
+            SrfInfo.Reflectance90[c] = ToHalf(SrfInfo.Reflectance90[c]);
+        }
+    }
+
+    return SrfInfo;
+}
+
+float NormalDistribution_GGX(float NdotH, float AlphaRoughness)
+{
+    AlphaRoughness = std::max(AlphaRoughness, 1e-3f);
+
+    const float a2  = AlphaRoughness * AlphaRoughness;
+    const float nh2 = NdotH * NdotH;
+    const float f   = nh2 * a2 + (1.f - nh2);
+    return a2 / (PI_F * f * f);
+}
+
+float SmithGGXVisibilityCorrelated(float NdotL, float NdotV, float AlphaRoughness)
+{
+    const float a2   = AlphaRoughness * AlphaRoughness;
+    const float GGXV = NdotL * std::sqrt(std::max(NdotV * NdotV * (1.f - a2) + a2, 1e-7f));
+    const float GGXL = NdotV * std::sqrt(std::max(NdotL * NdotL * (1.f - a2) + a2, 1e-7f));
+    return 0.5f / (GGXV + GGXL);
+}
+
+// Returns the radiance reflected towards the viewer for a light with unit intensity
+float3 Shade(const float3& Normal, const float3& View, const float3& PointToLight, const SurfaceReflectanceInfo& SrfInfo, bool Half)
+{
+    const float3 HalfVector = normalize(PointToLight + View);
+    const float  NdotL      = std::max(dot(Normal, PointToLight), 0.f);
+    const float  NdotV      = std::max(dot(Normal, View), 0.f);
+    const float  NdotH      = std::max(dot(Normal, HalfVector), 0.f);
+    const float  VdotH      = std::max(dot(View, HalfVector), 0.f);
+    if (NdotL <= 0 && NdotV <= 0)
+        return float3{};
+
+    const float AlphaRoughness = SrfInfo.PerceptualRoughness * SrfInfo.PerceptualRoughness;
+    const float D              = NormalDistribution_GGX(NdotH, AlphaRoughness);
+    const float Vis            = SmithGGXVisibilityCorrelated(NdotL, NdotV, AlphaRoughness);
+
+    float3 Radiance;
+    for (int c = 0; c < 3; ++c)
+    {
+        float F, Diffuse;
+        if (Half)
+        {
+            // SchlickReflectionHalf and LambertianDiffuseHalf
+            const float x  = ToHalf(std::min(std::max(ToHalf(1.f - ToHalf(VdotH)), 0.f), 1.f));
+            const float x2 = ToHalf(x * x);
+            const float x5 = ToHalf(ToHalf(x2 * x2) * x);
+            F              = ToHalf(SrfInfo.Reflectance0[c] + ToHalf(ToHalf(SrfInfo.Reflectance90[c] - SrfInfo.Reflectance0[c]) * x5));
+            Diffuse        = ToHalf(ToHalf(1.f - F) * ToHalf(SrfInfo.DiffuseColor[c] * ToHalf(1.f / PI_F)));
+        }
+        else
+        {
+            const float x  = std::min(std::max(1.f - VdotH, 0.f), 1.f);
+            const float x2 = x * x;
+            F              = SrfInfo.Reflectance0[c] + (SrfInfo.Reflectance90[c] - SrfInfo.Reflectance0[c]) * (x2 * x2 * x);
+            Diffuse        = (1.f - F) * (SrfInfo.DiffuseColor[c] / PI_F);
+        }
+        // The specular term is always evaluated in full precision
+        const float Specular = F * (Vis * D);
+
+        Radiance[c] = (Diffuse + Specular) * NdotL;
+    }
+    return Radiance;
+}
+
+// Renders a lit sphere and returns the tone-mapped 8-bit image
+std::vector<int> RenderSphere(const Material& Mat, bool Half)
+{
+    constexpr int Size = 64;
+
+    const SurfaceReflectanceInfo SrfInfo = GetSurfaceReflectanceMR(Mat, Half);
+
+    const float3 View{0, 0, 1};
+    const float3 PointToLight   = normalize(float3{0.5f, 0.7f, 1.f});
+    const float  LightIntensity = 3.f;
+
+    std::vector<int> Image(Size * Size * 3, 0);
+    for (int y = 0; y < Size; ++y)
+    {
+        for (int x = 0; x < Size; ++x)
+        {
+            const float u  = (x + 0.5f) / Size * 2.f - 1.f;
+            const float v  = 1.f - (y + 0.5f) / Size * 2.f;
+            const float r2 = u * u + v * v;
+            if (r2 >= 1.f)
+                continue;
+
+            const float3 Normal{u, v, std::sqrt(1.f - r2)};
+            const float3 Radiance = Shade(Normal, View, PointToLight, SrfInfo, Half);
+            for (int c = 0; c < 3; ++c)
+            {
+                // Reinhard tone mapping
+                const float Color = Radiance[c] * LightIntensity;
+                const float LDR   = Color / (1.f + Color);
+
+                Image[(y * Size + x) * 3 + c] = static_cast<int>(LDR * 255.f + 0.5f);
+            }
+        }
+    }
+    return Image;
+}
+
+TEST(PBR_HalfPrecisionShading, ImageDiff)
+{
+    const Material Materials[] = {
+        {{0.8f, 0.2f, 0.1f}, 0.0f, 0.5f},
+        {{0.8f, 0.2f, 0.1f}, 0.0f, 0.04f},
+        {{0.9f, 0.9f, 0.9f}, 0.0f, 1.0f},
+        {{1.0f, 0.8f, 0.3f}, 1.0f, 0.3f},
+        {{1.0f, 0.8f, 0.3f}, 1.0f, 0.04f},
+        {{0.5f, 0.5f, 0.5f}, 0.5f, 0.7f},
+        {{0.02f, 0.02f, 0.02f}, 0.0f, 0.2f},
+    };
+
+    bool AnyDifference = false;
+    for (const Material& Mat : Materials)
+    {
+        const std::vector<int> FloatImage = RenderSphere(Mat, false);
+        const std::vector<int> HalfImage  = RenderSphere(Mat, true);
+
+        int    MaxDiff = 0;
+        double SqrErr  = 0;
+        for (size_t i = 0; i < FloatImage.size(); ++i)
+        {
+            const int Diff = std::abs(FloatImage[i] - HalfImage[i]);
+            MaxDiff        = std::max(MaxDiff, Diff);
+            SqrErr += Diff * Diff;
+        }
+        AnyDifference = AnyDifference || MaxDiff > 0;
+
+        const double MSE  = SqrErr / FloatImage.size();
+        const double PSNR = MSE > 0 ? 10.0 * std::log10(255.0 * 255.0 / MSE) : 100.0;
+        EXPECT_LE(MaxDiff, 1) << "Metallic: " << Mat.Metallic << ", Roughness: " << Mat.Roughness;
+        EXPECT_GT(PSNR, 50.0) << "Metallic: " << Mat.Metallic << ", Roughness: " << Mat.Roughness;
+    }
+    // Make sure that the reduced precision is actually emulated
+    EXPECT_TRUE(AnyDifference);
+}
+
+TEST(PBR_HalfPrecisionShading, SpecularDistributionRange)
+{
+    // The GGX distribution of smooth surfaces exceeds the largest fp16 value (65504),
+    // which is why the specular term must be evaluated in full precision.
+    const float Roughness = 0.04f;
+    const float D         = NormalDistribution_GGX(1.f, Roughness * Roughness);
+    EXPECT_GT(D, 65504.f);
+    EXPECT_TRUE(std::isinf(ToHalf(D)));
+}
+
+} // namespace
@@ -0,0 +1,249 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "LightClusterGrid.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace Diligent
+{
+
+namespace HLSL
+{
+
+#include "Shaders/Common/public/BasicStructures.fxh"
+#include "Shaders/PBR/public/PBR_Structures.fxh"
+
+} // namespace HLSL
+
+} // namespace Diligent
+
+using namespace Diligent;
+
+namespace
+{
+
+// Must match the values in PBR_Shading.fxh
+constexpr int PBR_LIGHT_TYPE_DIRECTIONAL = 1;
+constexpr int PBR_LIGHT_TYPE_POINT       = 2;
+
+HLSL::PBRLightAttribs CreatePointLight(const float3& Pos, float Range)
+{
+    HLSL::PBRLightAttribs Light{};
+    Light.Type   = PBR_LIGHT_TYPE_POINT;
+    Light.PosX   = Pos.x;
+    Light.PosY   = Pos.y;
+    Light.PosZ   = Pos.z;
+    Light.Range4 = Range * Range * Range * Range;
+    return Light;
+}
+
+HLSL::PBRLightAttribs CreateDirectionalLight()
+{
+    HLSL::PBRLightAttribs Light{};
+    Light.Type       = PBR_LIGHT_TYPE_DIRECTIONAL;
+    Light.DirectionZ = 1;
+    return Light;
+}
+
+bool ClusterContainsLight(const LightClusterGrid& Grid, Uint32 ClusterIdx, Uint32 LightIdx)
+{
+    const uint2                Cluster = Grid.GetClusters()[ClusterIdx];
+    const std::vector<Uint32>& Indices = Grid.GetLightIndices();
+    return std::find(Indices.begin() + Cluster.x, Indices.begin() + Cluster.x + Cluster.y, LightIdx) != Indices.begin() + Cluster.x + Cluster.y;
+}
+
+void CheckClusterRanges(const LightClusterGrid& Grid)
+{
+    const std::vector<uint2>&  Clusters = Grid.GetClusters();
+    const std::vector<Uint32>& Indices  = Grid.GetLightIndices();
+    ASSERT_EQ(Clusters.size(), Grid.GetClusterCount());
+
+    // Clusters are stored contiguously in the index list
+    Uint32 Offset = 0;
+    for (const uint2& Cluster : Clusters)
+    {
+        EXPECT_EQ(Cluster.x, Offset);
+        Offset += Cluster.y;
+
+        for (Uint32 i = Cluster.x; i < Cluster.x + Cluster.y; ++i)
+        {
+            // Only local lights are referenced by the clusters
+            EXPECT_GE(Indices[i], Grid.GetGlobalLightCount());
+            EXPECT_LT(Indices[i], Grid.GetLights().size());
+            if (i > Cluster.x)
+            {
+                EXPECT_LT(Indices[i - 1], Indices[i]) << "Lights in the cluster must be sorted and unique";
+            }
+        }
+    }
+    EXPECT_EQ(Offset, Indices.size());
+}
+
+TEST(PBR_LightClusterGrid, DepthSlices)
+{
+    LightClusterGrid::CreateInfo CI;
+    CI.GridSizeZ = 16;
+    CI.ZNear     = 0.5f;
+    CI.ZFar      = 500.f;
+    LightClusterGrid Grid{CI};
+
+    EXPECT_EQ(Grid.GetDepthSlice(-1.f), 0u);
+    EXPECT_EQ(Grid.GetDepthSlice(0.1f), 0u);
+    EXPECT_EQ(Grid.GetDepthSlice(CI.ZFar * 2.f), CI.GridSizeZ - 1);
+
+    // Slices are distributed exponentially between ZNear and ZFar
+    for (Uint32 Slice = 0; Slice < CI.GridSizeZ; ++Slice)
+    {
+        const float SliceNearZ = CI.ZNear * std::pow(CI.ZFar / CI.ZNear, static_cast<float>(Slice) / static_cast<float>(CI.GridSizeZ));
+        const float SliceFarZ  = CI.ZNear * std::pow(CI.ZFar / CI.ZNear, static_cast<float>(Slice + 1) / static_cast<float>(CI.GridSizeZ));
+        EXPECT_EQ(Grid.GetDepthSlice(SliceNearZ * 1.001f), Slice);
+        EXPECT_EQ(Grid.GetDepthSlice(SliceFarZ * 0.999f), Slice);
+    }
+}
+
+TEST(PBR_LightClusterGrid, GlobalLightsFirst)
+{
+    LightClusterGrid Grid{LightClusterGrid::CreateInfo{}};
+
+    const std::vector<HLSL::PBRLightAttribs> Lights = {
+        CreatePointLight(float3{0, 0, 10}, 1),
+        CreateDirectionalLight(),
+        CreatePointLight(float3{0, 0, 20}, 0), // Infinite range
+        CreatePointLight(float3{0, 0, 30}, 1),
+    };
+
+    const float4x4 Proj = float4x4::Projection(PI_F / 3.f, 16.f / 9.f, 0.1f, 1000.f, false);
+    Grid.Build(float4x4::Identity(), Proj, Lights.data(), static_cast<Uint32>(Lights.size()));
+
+    const std::vector<HLSL::PBRLightAttribs>& Sorted = Grid.GetLights();
+    ASSERT_EQ(Sorted.size(), 4u);
+    EXPECT_EQ(Grid.GetGlobalLightCount(), 2u);
+
+    // The relative order of global and local lights is preserved
+    EXPECT_EQ(Sorted[0].Type, PBR_LIGHT_TYPE_DIRECTIONAL);
+    EXPECT_EQ(Sorted[1].PosZ, 20.f);
+    EXPECT_EQ(Sorted[2].PosZ, 10.f);
+    EXPECT_EQ(Sorted[3].PosZ, 30.f);
+
+    CheckClusterRanges(Grid);
+
+    // The light in front of the camera is assigned to the cluster that contains its center
+    const Uint32 ClusterIdx = Grid.GetClusterIndex(float3{0, 0, 10}, Proj);
+    EXPECT_TRUE(ClusterContainsLight(Grid, ClusterIdx, 2));
+    EXPECT_FALSE(ClusterContainsLight(Grid, ClusterIdx, 3));
+
+    HLSL::PBRLightClusterGridAttribs Attribs{};
+    Grid.GetShaderAttribs(Attribs);
+    EXPECT_EQ(Attribs.GlobalLightCount, 2);
+    EXPECT_EQ(Attribs.LightIndexCount, static_cast<int>(Grid.GetLightIndices().size()));
+}
+
+TEST(PBR_LightClusterGrid, CulledLights)
+{
+    LightClusterGrid Grid{LightClusterGrid::CreateInfo{}};
+
+    const std::vector<HLSL::PBRLightAttribs> Lights = {
+        // Behind the camera
+        CreatePointLight(float3{0, 0, -10}, 5),
+        // Outside of the view frustum
+        CreatePointLight(float3{100, 0, 10}, 5),
+        CreatePointLight(float3{0, -100, 10}, 5),
+    };
+
+    const float4x4 Proj = float4x4::Projection(PI_F / 3.f, 1.f, 0.1f, 1000.f, false);
+    Grid.Build(float4x4::Identity(), Proj, Lights.data(), static_cast<Uint32>(Lights.size()));
+
+    EXPECT_EQ(Grid.GetGlobalLightCount(), 0u);
+    EXPECT_TRUE(Grid.GetLightIndices().empty());
+    CheckClusterRanges(Grid);
+}
+
+// Every light must be assigned to every cluster that contains a point within its range
+TEST(PBR_LightClusterGrid, ConservativeAssignment)
+{
+    LightClusterGrid::CreateInfo CI;
+    CI.ZNear = 0.1f;
+    CI.ZFar  = 100.f;
+    LightClusterGrid Grid{CI};
+
+    const float4x4 Proj = float4x4::Projection(PI_F / 3.f, 16.f / 9.f, CI.ZNear, CI.ZFar, false);
+    // The camera is at (0, 0, -5) in world space
+    const float4x4 View = float4x4::Translation(0, 0, 5);
+
+    std::mt19937                          Gen{0};
+    std::uniform_real_distribution<float> Unorm{0.f, 1.f};
+
+    std::vector<HLSL::PBRLightAttribs> Lights;
+    for (int i = 0; i < 64; ++i)
+    {
+        const float3 Pos{
+            (Unorm(Gen) * 2.f - 1.f) * 30.f,
+            (Unorm(Gen) * 2.f - 1.f) * 20.f,
+            Unorm(Gen) * 60.f - 10.f,
+        };
+        Lights.push_back(CreatePointLight(Pos, 0.5f + Unorm(Gen) * 5.f));
+    }
+    Grid.Build(View, Proj, Lights.data(), static_cast<Uint32>(Lights.size()));
+    CheckClusterRanges(Grid);
+
+    const std::vector<HLSL::PBRLightAttribs>& Sorted = Grid.GetLights();
+    ASSERT_EQ(Sorted.size(), Lights.size());
+    EXPECT_EQ(Grid.GetGlobalLightCount(), 0u);
+
+    Uint32 NumTestedPoints = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+        // Random point within the view frustum in view space, denser close to the camera
+        const float Z = CI.ZNear + Unorm(Gen) * (CI.ZFar - CI.ZNear) * Unorm(Gen);
+        const float X = (Unorm(Gen) * 2.f - 1.f) * Z / Proj[0][0];
+        const float Y = (Unorm(Gen) * 2.f - 1.f) * Z / Proj[1][1];
+
+        const float3 ViewPos{X, Y, Z};
+        const float3 WorldPos = ViewPos - float3{0, 0, 5};
+        const Uint32 Cluster  = Grid.GetClusterIndex(ViewPos, Proj);
+        for (Uint32 LightIdx = 0; LightIdx < Sorted.size(); ++LightIdx)
+        {
+            const HLSL::PBRLightAttribs& Light = Sorted[LightIdx];
+
+            const float3 ToLight = float3{Light.PosX, Light.PosY, Light.PosZ} - WorldPos;
+            if (dot(ToLight, ToLight) * dot(ToLight, ToLight) >= Light.Range4)
+                continue;
+
+            ++NumTestedPoints;
+            EXPECT_TRUE(ClusterContainsLight(Grid, Cluster, LightIdx))
+                << "Light " << LightIdx << " is not assigned to cluster " << Cluster
+                << " that contains point (" << X << ", " << Y << ", " << Z << ") within its range";
+        }
+    }
+    EXPECT_GT(NumTestedPoints, 100u);
+}
+
+} // namespace
@@ -0,0 +1,260 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "PBR_Renderer.hpp"
+
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+using PSOKey      = PBR_Renderer::PSOKey;
+using TestHashMap = PBR_Renderer::PsoHashMap<int>;
+
+constexpr auto Opaque = PBR_Renderer::ALPHA_MODE_OPAQUE;
+
+PSOKey MakeKey(Uint64 UserValue)
+{
+    return PSOKey{PBR_Renderer::PSO_FLAG_DEFAULT, Opaque, false, PBR_Renderer::DebugViewType::None, UserValue};
+}
+
+TEST(PBR_PsoHashMap, InsertAndReplace)
+{
+    TestHashMap Map;
+    EXPECT_EQ(Map.Find(MakeKey(0)), nullptr);
+    EXPECT_EQ(Map.GetSize(), size_t{0});
+
+    Map.Insert(MakeKey(0), 10);
+    Map.Insert(MakeKey(1), 11);
+    Map.Insert({PBR_Renderer::PSO_FLAG_DEFAULT, Opaque, true}, 12);
+    EXPECT_EQ(Map.GetSize(), size_t{3});
+
+    ASSERT_NE(Map.Find(MakeKey(0)), nullptr);
+    EXPECT_EQ(*Map.Find(MakeKey(0)), 10);
+    ASSERT_NE(Map.Find(MakeKey(1)), nullptr);
+    EXPECT_EQ(*Map.Find(MakeKey(1)), 11);
+    ASSERT_NE(Map.Find({PBR_Renderer::PSO_FLAG_DEFAULT, Opaque, true}), nullptr);
+    EXPECT_EQ(*Map.Find({PBR_Renderer::PSO_FLAG_DEFAULT, Opaque, true}), 12);
+    EXPECT_EQ(Map.Find(MakeKey(2)), nullptr);
+
+    // Inserting the same key replaces the value
+    Map.Insert(MakeKey(1), 21);
+    EXPECT_EQ(Map.GetSize(), size_t{3});
+    ASSERT_NE(Map.Find(MakeKey(1)), nullptr);
+    EXPECT_EQ(*Map.Find(MakeKey(1)), 21);
+
+    int Sum = 0;
+    Map.ProcessPSOs([&Sum](const PSOKey&, int Value) { Sum += Value; });
+    EXPECT_EQ(Sum, 10 + 21 + 12);
+}
+
+TEST(PBR_PsoHashMap, NullPSO)
+{
+    // Pipeline states that failed to be created are stored as null
+    PBR_Renderer::PsoHashMapType Map;
+    Map.Insert(MakeKey(0), {});
+    EXPECT_EQ(Map.GetSize(), size_t{1});
+
+    const RefCntAutoPtr<IPipelineState>* ppPSO = Map.Find(MakeKey(0));
+    ASSERT_NE(ppPSO, nullptr);
+    EXPECT_FALSE(*ppPSO);
+    EXPECT_EQ(Map.Find(MakeKey(1)), nullptr);
+
+    size_t NumPSOs = 0;
+    Map.ProcessPSOs([&NumPSOs](const PSOKey&, const RefCntAutoPtr<IPipelineState>&) { ++NumPSOs; });
+    EXPECT_EQ(NumPSOs, size_t{0});
+}
+
+TEST(PBR_PsoHashMap, GrowthAndRehash)
+{
+    constexpr int NumKeys = 1000;
+
+    TestHashMap Map;
+    size_t      NumGrowths   = 0;
+    size_t      LastCapacity = 0;
+    for (int i = 0; i < NumKeys; ++i)
+    {
+        Map.Insert(MakeKey(i), i + 1);
+
+        const size_t Capacity = Map.GetCapacity();
+        EXPECT_EQ(Capacity & (Capacity - 1), size_t{0}) << "Capacity must be a power of two";
+        EXPECT_LE(Map.GetSize() * 2, Capacity) << "The table must be at most half full";
+        if (Capacity != LastCapacity)
+        {
+            ++NumGrowths;
+            LastCapacity = Capacity;
+
+            // All keys must be found after the rehash
+            for (int j = 0; j <= i; ++j)
+            {
+                const int* pValue = Map.Find(MakeKey(j));
+                ASSERT_NE(pValue, nullptr);
+                EXPECT_EQ(*pValue, j + 1);
+            }
+        }
+    }
+    EXPECT_EQ(Map.GetSize(), size_t{NumKeys});
+    EXPECT_GT(NumGrowths, size_t{1});
+
+    for (int i = 0; i < NumKeys; ++i)
+    {
+        const int* pValue = Map.Find(MakeKey(i));
+        ASSERT_NE(pValue, nullptr);
+        EXPECT_EQ(*pValue, i + 1);
+    }
+    for (int i = NumKeys; i < NumKeys * 2; ++i)
+        EXPECT_EQ(Map.Find(MakeKey(i)), nullptr);
+}
+
+TEST(PBR_PsoHashMap, ProbeWraparound)
+{
+    // The initial table has 16 slots and holds up to 8 keys
+    constexpr size_t InitialCapacity = 16;
+    constexpr size_t LastSlot        = InitialCapacity - 1;
+
+    // Find keys that hash to the last slot so that their probe chain wraps around to the first one
+    std::vector<PSOKey> LastSlotKeys;
+    std::vector<PSOKey> FirstSlotKeys;
+    for (Uint64 i = 0; LastSlotKeys.size() < 4 || FirstSlotKeys.size() < 2; ++i)
+    {
+        const PSOKey Key  = MakeKey(i);
+        const size_t Slot = TestHashMap::GetHomeSlot(Key.GetHash(), LastSlot);
+        if (Slot == LastSlot && LastSlotKeys.size() < 4)
+            LastSlotKeys.push_back(Key);
+        else if (Slot == 0 && FirstSlotKeys.size() < 2)
+            FirstSlotKeys.push_back(Key);
+    }
+
+    TestHashMap Map;
+    // The first key takes the last slot, the next two wrap around to slots 0 and 1.
+    for (int i = 0; i < 3; ++i)
+        Map.Insert(LastSlotKeys[i], 100 + i);
+    // This key hashes to slot 0 and has to probe past the wrapped-around keys.
+    Map.Insert(FirstSlotKeys[0], 200);
+    ASSERT_EQ(Map.GetCapacity(), InitialCapacity);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const int* pValue = Map.Find(LastSlotKeys[i]);
+        ASSERT_NE(pValue, nullptr);
+        EXPECT_EQ(*pValue, 100 + i);
+    }
+    ASSERT_NE(Map.Find(FirstSlotKeys[0]), nullptr);
+    EXPECT_EQ(*Map.Find(FirstSlotKeys[0]), 200);
+
+    // Lookups of missing keys must wrap around and stop at the first empty slot
+    EXPECT_EQ(Map.Find(LastSlotKeys[3]), nullptr);
+    EXPECT_EQ(Map.Find(FirstSlotKeys[1]), nullptr);
+
+    // Replacing a wrapped-around key must not add a new one
+    Map.Insert(LastSlotKeys[2], 300);
+    EXPECT_EQ(Map.GetSize(), size_t{4});
+    ASSERT_NE(Map.Find(LastSlotKeys[2]), nullptr);
+    EXPECT_EQ(*Map.Find(LastSlotKeys[2]), 300);
+}
+
+// Compares the lookup throughput of PsoHashMap with std::unordered_map that was used before.
+TEST(PBR_PsoHashMap, LookupPerformance)
+{
+    // A typical renderer uses a few dozen PSO permutations per graphics pipeline description.
+    constexpr int NumKeys       = 64;
+    constexpr int NumLookups    = 1 << 20;
+    constexpr int NumIterations = 5;
+
+    std::vector<PSOKey> Keys;
+    for (int i = 0; i < NumKeys; ++i)
+    {
+        Keys.emplace_back(static_cast<PBR_Renderer::PSO_FLAGS>(PBR_Renderer::PSO_FLAG_DEFAULT | (Uint64{1} << (i % 32))),
+                          (i & 1) ? PBR_Renderer::ALPHA_MODE_MASK : Opaque,
+                          (i & 2) != 0,
+                          PBR_Renderer::DebugViewType::None,
+                          static_cast<Uint64>(i / 32));
+    }
+
+    TestHashMap                                     Map;
+    std::unordered_map<PSOKey, int, PSOKey::Hasher> StdMap;
+    for (int i = 0; i < NumKeys; ++i)
+    {
+        Map.Insert(Keys[i], i + 1);
+        StdMap.emplace(Keys[i], i + 1);
+    }
+
+    // Look the keys up in a pseudo-random order so that the branch predictor can't learn it.
+    std::vector<PSOKey> LookupKeys;
+    LookupKeys.reserve(NumLookups);
+    Uint32 Rand = 12345;
+    for (int i = 0; i < NumLookups; ++i)
+    {
+        Rand = Rand * 1664525u + 1013904223u;
+        LookupKeys.push_back(Keys[(Rand >> 16) % NumKeys]);
+    }
+
+    // Returns the best time of several runs to reduce the noise.
+    auto Measure = [&](auto&& Lookup) {
+        double BestTime = 1e+10;
+        for (int it = 0; it < NumIterations; ++it)
+        {
+            Int64 Sum = 0;
+
+            const auto StartTime = std::chrono::high_resolution_clock::now();
+            for (const PSOKey& Key : LookupKeys)
+                Sum += Lookup(Key);
+            const auto EndTime = std::chrono::high_resolution_clock::now();
+
+            EXPECT_GT(Sum, 0);
+            BestTime = std::min(BestTime, std::chrono::duration<double>(EndTime - StartTime).count());
+        }
+        return BestTime;
+    };
+
+    const double HashMapTime = Measure([&Map](const PSOKey& Key) {
+        const int* pValue = Map.Find(Key);
+        return pValue != nullptr ? *pValue : 0;
+    });
+    const double StdMapTime = Measure([&StdMap](const PSOKey& Key) {
+        auto it = StdMap.find(Key);
+        return it != StdMap.end() ? it->second : 0;
+    });
+
+    std::cout << "PsoHashMap:         " << HashMapTime * 1e+9 / NumLookups << " ns per lookup\n"
+              << "std::unordered_map: " << StdMapTime * 1e+9 / NumLookups << " ns per lookup\n";
+
+#ifndef DILIGENT_DEBUG
+    // Timings in debug builds are not representative.
+    // Leave some headroom for the noise on loaded CI machines.
+    EXPECT_LE(HashMapTime, StdMapTime * 1.25);
+#endif
+}
+
+} // namespace
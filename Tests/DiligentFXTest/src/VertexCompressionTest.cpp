@@ -0,0 +1,237 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "VertexCompression.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Computes the angle between two vectors in degrees with double precision
+double GetAngleDeg(const float3& v0, const float3& v1)
+{
+    const double x0 = v0.x, y0 = v0.y, z0 = v0.z;
+    const double x1 = v1.x, y1 = v1.y, z1 = v1.z;
+
+    const double CrossX = y0 * z1 - z0 * y1;
+    const double CrossY = z0 * x1 - x0 * z1;
+    const double CrossZ = x0 * y1 - y0 * x1;
+    const double Dot    = x0 * x1 + y0 * y1 + z0 * z1;
+    return std::atan2(std::sqrt(CrossX * CrossX + CrossY * CrossY + CrossZ * CrossZ), Dot) * 180.0 / 3.14159265358979323846;
+}
+
+// The bound documented by EncodeOctahedralNormalRG16
+constexpr double MaxAngleDeg = 0.02;
+
+TEST(PBR_VertexCompression, OctahedralNormal)
+{
+    const auto TestNormal = [](const float3& Normal) {
+        const float3 Decoded = DecodeOctahedralNormalRG16(EncodeOctahedralNormalRG16(Normal));
+        EXPECT_NEAR(length(Decoded), 1.f, 1e-6f);
+
+        const double Angle = GetAngleDeg(Normal, Decoded);
+        EXPECT_LE(Angle, MaxAngleDeg) << "Normal: (" << Normal.x << ", " << Normal.y << ", " << Normal.z << ")";
+        return Angle;
+    };
+
+    // Axes and the directions that lie on the folds of the octahedron
+    for (float x = -1; x <= 1; x += 1)
+    {
+        for (float y = -1; y <= 1; y += 1)
+        {
+            for (float z = -1; z <= 1; z += 1)
+            {
+                if (x != 0 || y != 0 || z != 0)
+                    TestNormal(float3{x, y, z});
+            }
+        }
+    }
+
+    // Fibonacci sphere
+    constexpr int    NumPoints   = 100000;
+    const double     GoldenAngle = 3.14159265358979323846 * (3.0 - std::sqrt(5.0));
+    double           MaxAngle    = 0;
+    for (int i = 0; i < NumPoints; ++i)
+    {
+        const double z   = 1.0 - 2.0 * (i + 0.5) / NumPoints;
+        const double r   = std::sqrt(1.0 - z * z);
+        const double Phi = GoldenAngle * i;
+
+        const float3 Normal{
+            static_cast<float>(r * std::cos(Phi)),
+            static_cast<float>(r * std::sin(Phi)),
+            static_cast<float>(z),
+        };
+        MaxAngle = std::max(MaxAngle, TestNormal(Normal));
+    }
+    EXPECT_GT(MaxAngle, 0.0) << "16-bit quantization can't be lossless";
+
+    // The encoded vector does not need to be normalized
+    EXPECT_LE(GetAngleDeg(DecodeOctahedralNormalRG16(EncodeOctahedralNormalRG16(float3{0, 0, -5})), float3{0, 0, -1}), MaxAngleDeg);
+    EXPECT_LE(GetAngleDeg(DecodeOctahedralNormalRG16(EncodeOctahedralNormalRG16(float3{0.01f, 0.02f, 0.03f})), float3{1, 2, 3}), MaxAngleDeg);
+
+    // Zero-length vector is encoded as (0, 0, 1)
+    const float3 Zero = DecodeOctahedralNormalRG16(EncodeOctahedralNormalRG16(float3{0, 0, 0}));
+    EXPECT_EQ(Zero.x, 0.f);
+    EXPECT_EQ(Zero.y, 0.f);
+    EXPECT_EQ(Zero.z, 1.f);
+}
+
+TEST(PBR_VertexCompression, HalfFloat)
+{
+    // Exactly representable values
+    EXPECT_EQ(FloatToHalf(0.f), 0x0000);
+    EXPECT_EQ(FloatToHalf(-0.f), 0x8000);
+    EXPECT_EQ(FloatToHalf(1.f), 0x3C00);
+    EXPECT_EQ(FloatToHalf(-2.f), 0xC000);
+    EXPECT_EQ(FloatToHalf(0.5f), 0x3800);
+    EXPECT_EQ(FloatToHalf(65504.f), 0x7BFF);
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.f, -14)), 0x0400); // Smallest normal
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.f, -24)), 0x0001); // Smallest subnormal
+
+    // Round to nearest even
+    EXPECT_EQ(FloatToHalf(1.f + std::ldexp(1.f, -11)), 0x3C00);
+    EXPECT_EQ(FloatToHalf(1.f + 3.f * std::ldexp(1.f, -11)), 0x3C02);
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.f, -25)), 0x0000);
+    EXPECT_EQ(FloatToHalf(3.f * std::ldexp(1.f, -25)), 0x0002);
+
+    // Overflow and special values
+    EXPECT_EQ(FloatToHalf(65520.f), 0x7C00);
+    EXPECT_EQ(FloatToHalf(-1e10f), 0xFC00);
+    EXPECT_EQ(FloatToHalf(std::numeric_limits<float>::infinity()), 0x7C00);
+    EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+    EXPECT_EQ(FloatToHalf(1e-10f), 0x0000);
+
+    // Every half value survives the round trip through float
+    for (Uint32 i = 0; i <= 0xFFFF; ++i)
+    {
+        const Uint16 Half  = static_cast<Uint16>(i);
+        const float  Value = HalfToFloat(Half);
+        if (std::isnan(Value))
+        {
+            EXPECT_EQ(Half & 0x7C00, 0x7C00);
+            continue;
+        }
+        EXPECT_EQ(FloatToHalf(Value), Half) << "Half: 0x" << std::hex << i;
+    }
+
+    // Relative error of normal values does not exceed half of the 10-bit mantissa step
+    std::mt19937                          Gen{0};
+    std::uniform_real_distribution<float> Dist{-65504.f, 65504.f};
+    for (int i = 0; i < 10000; ++i)
+    {
+        const float Value = Dist(Gen);
+        if (std::abs(Value) < std::ldexp(1.f, -14))
+            continue;
+
+        const float RoundTrip = HalfToFloat(FloatToHalf(Value));
+        EXPECT_LE(std::abs(RoundTrip - Value), std::abs(Value) * std::ldexp(1.f, -11)) << Value;
+    }
+
+    const float2 UV{0.25f, -12.5f};
+    const float2 DecodedUV = DecodeRG16Float(EncodeRG16Float(UV));
+    EXPECT_EQ(DecodedUV.x, 0.25f);
+    EXPECT_EQ(DecodedUV.y, -12.5f);
+}
+
+TEST(PBR_VertexCompression, RGBA8Unorm)
+{
+    for (int i = 0; i <= 255; ++i)
+    {
+        const float  Value = static_cast<float>(i) / 255.f;
+        const float4 Color{Value, 1.f - Value, Value * 0.5f, 1.f};
+        const float4 Decoded = DecodeRGBA8Unorm(EncodeRGBA8Unorm(Color));
+        for (size_t c = 0; c < 4; ++c)
+            EXPECT_NEAR(Decoded[c], Color[c], 0.5f / 255.f + 1e-6f);
+    }
+
+    // Values are clamped to [0, 1]
+    const float4 Clamped = DecodeRGBA8Unorm(EncodeRGBA8Unorm(float4{-1.f, 2.f, 0.f, 1.f}));
+    EXPECT_EQ(Clamped.x, 0.f);
+    EXPECT_EQ(Clamped.y, 1.f);
+}
+
+TEST(PBR_VertexCompression, JointWeights)
+{
+    const auto GetWeightSum = [](Uint32 Encoded) {
+        return ((Encoded >> 0u) & 0xFFu) + ((Encoded >> 8u) & 0xFFu) + ((Encoded >> 16u) & 0xFFu) + ((Encoded >> 24u) & 0xFFu);
+    };
+
+    std::mt19937                          Gen{0};
+    std::uniform_real_distribution<float> Dist{0.f, 1.f};
+    for (int i = 0; i < 10000; ++i)
+    {
+        float4 Weights{Dist(Gen), Dist(Gen), Dist(Gen), Dist(Gen)};
+        // Most vertices are affected by fewer than four joints
+        for (size_t c = 1; c < 4; ++c)
+        {
+            if (Dist(Gen) < 0.3f)
+                Weights[c] = 0;
+        }
+
+        const Uint32 Encoded = EncodeJointWeightsRGBA8(Weights);
+
+        // Decoded weights sum up to one
+        EXPECT_EQ(GetWeightSum(Encoded), 255u);
+
+        const float  Sum     = Weights.x + Weights.y + Weights.z + Weights.w;
+        const float4 Decoded = DecodeRGBA8Unorm(Encoded);
+        for (size_t c = 0; c < 4; ++c)
+        {
+            // Zero weights stay zero, so that the joints that do not affect the vertex are skipped
+            if (Weights[c] == 0)
+            {
+                EXPECT_EQ(Decoded[c], 0.f);
+            }
+            // The rounding error of up to four weights is applied to the largest one
+            EXPECT_NEAR(Decoded[c], Weights[c] / Sum, 2.f / 255.f);
+        }
+    }
+
+    EXPECT_EQ(EncodeJointWeightsRGBA8(float4{0, 0, 0, 0}), 0u);
+    EXPECT_EQ(EncodeJointWeightsRGBA8(float4{2, 0, 0, 0}), 255u);
+}
+
+TEST(PBR_VertexCompression, JointIndices)
+{
+    EXPECT_EQ(EncodeJointIndicesRGBA8(float4{1, 2, 3, 255}), 0xFF030201u);
+
+    Uint16 Joints[4] = {};
+    EncodeJointIndicesRGBA16(float4{0, 256, 1000, 65535}, Joints);
+    EXPECT_EQ(Joints[0], 0);
+    EXPECT_EQ(Joints[1], 256);
+    EXPECT_EQ(Joints[2], 1000);
+    EXPECT_EQ(Joints[3], 65535);
+}
+
+} // namespace
@@ -0,0 +1,135 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "HnGeometryResidency.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+using namespace Diligent::USD;
+
+namespace
+{
+
+TEST(Hydrogent_GeometryResidency, WithinBudget)
+{
+    const std::vector<HnGeometryResidencyItem> Items = {
+        {100, 1},
+        {200, 2},
+    };
+    EXPECT_TRUE(SelectGeometryToEvict(Items, 300, 10, 300).empty());
+    EXPECT_TRUE(SelectGeometryToEvict(Items, 300, 10, 1000).empty());
+}
+
+TEST(Hydrogent_GeometryResidency, EvictLeastRecentlyVisible)
+{
+    const std::vector<HnGeometryResidencyItem> Items = {
+        {100, 5},
+        {100, 2},
+        {100, 9},
+        {100, 7},
+    };
+
+    // 400 bytes resident, 250 byte budget: two meshes must go, the oldest first
+    const std::vector<size_t> Evicted = SelectGeometryToEvict(Items, 400, 10, 250);
+    ASSERT_EQ(Evicted.size(), 2u);
+    EXPECT_EQ(Evicted[0], 1u);
+    EXPECT_EQ(Evicted[1], 0u);
+}
+
+TEST(Hydrogent_GeometryResidency, StopWhenBudgetIsMet)
+{
+    const std::vector<HnGeometryResidencyItem> Items = {
+        {500, 1},
+        {100, 2},
+        {100, 3},
+    };
+
+    // Evicting the first, largest, mesh is enough
+    const std::vector<size_t> Evicted = SelectGeometryToEvict(Items, 700, 10, 300);
+    ASSERT_EQ(Evicted.size(), 1u);
+    EXPECT_EQ(Evicted[0], 0u);
+}
+
+TEST(Hydrogent_GeometryResidency, KeepLastFrameMeshes)
+{
+    const std::vector<HnGeometryResidencyItem> Items = {
+        {100, 10},
+        {100, 9},
+        {100, 10},
+    };
+
+    // Meshes visible in the last frame are never evicted, even if the budget is exceeded
+    const std::vector<size_t> Evicted = SelectGeometryToEvict(Items, 300, 10, 0);
+    ASSERT_EQ(Evicted.size(), 1u);
+    EXPECT_EQ(Evicted[0], 1u);
+}
+
+TEST(Hydrogent_GeometryResidency, KeepCurrentFrameMeshes)
+{
+    const std::vector<HnGeometryResidencyItem> Items = {
+        {100, 11},
+        {100, 9},
+        {100, 11},
+    };
+
+    // Meshes uploaded or restored in the current frame 11 have not been rendered yet
+    // and must not be evicted
+    const std::vector<size_t> Evicted = SelectGeometryToEvict(Items, 300, 10, 0);
+    ASSERT_EQ(Evicted.size(), 1u);
+    EXPECT_EQ(Evicted[0], 1u);
+}
+
+TEST(Hydrogent_GeometryResidency, NonEvictableGeometry)
+{
+    const std::vector<HnGeometryResidencyItem> Items = {
+        {100, 1},
+        {0, 2},
+        {100, 3},
+    };
+
+    // 1000 bytes are resident, but only 200 bytes can be evicted
+    const std::vector<size_t> Evicted = SelectGeometryToEvict(Items, 1000, 10, 500);
+    ASSERT_EQ(Evicted.size(), 2u);
+    EXPECT_EQ(Evicted[0], 0u);
+    EXPECT_EQ(Evicted[1], 2u);
+}
+
+TEST(Hydrogent_GeometryResidency, EqualFramesKeepOrder)
+{
+    const std::vector<HnGeometryResidencyItem> Items = {
+        {100, 3},
+        {100, 3},
+        {100, 3},
+    };
+
+    const std::vector<size_t> Evicted = SelectGeometryToEvict(Items, 300, 10, 100);
+    ASSERT_EQ(Evicted.size(), 2u);
+    EXPECT_EQ(Evicted[0], 0u);
+    EXPECT_EQ(Evicted[1], 1u);
+}
+
+} // namespace
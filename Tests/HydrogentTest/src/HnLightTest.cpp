@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "HnLight.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+using namespace Diligent::USD;
+
+namespace
+{
+
+// Perspective camera at the origin looking along +Z with 90-degree FOV, near plane at 1 and far plane at 100
+ViewFrustum GetPerspectiveFrustum()
+{
+    const float4x4 Proj = float4x4::Projection(PI_F / 2.f, 1.f, 1.f, 100.f, false);
+
+    ViewFrustum Frustum;
+    ExtractViewFrustumPlanesFromMatrix(Proj, Frustum, false);
+    return Frustum;
+}
+
+// Light-space frustum of a directional light shining along +Z: 10x10 units wide, from z = 0 to z = 100
+ViewFrustum GetOrthoFrustum()
+{
+    const float4x4 Proj = float4x4::Ortho(10.f, 10.f, 0.f, 100.f, false);
+
+    ViewFrustum Frustum;
+    ExtractViewFrustumPlanesFromMatrix(Proj, Frustum, false);
+    return Frustum;
+}
+
+TEST(Hydrogent_HnLight, IsShadowCasterInFrustum_Inside)
+{
+    const ViewFrustum Frustum = GetPerspectiveFrustum();
+
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(Frustum, float4{0, 0, 10, 1}, float4x4::Identity()));
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(Frustum, float4{0, 0, 0, 1}, float4x4::Translation(5, -5, 50)));
+    // The sphere intersects the right plane
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(Frustum, float4{10.5f, 0, 10, 1}, float4x4::Identity()));
+
+    const ViewFrustum OrthoFrustum = GetOrthoFrustum();
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0, 0, 50, 1}, float4x4::Identity()));
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{5.5f, 0, 50, 1}, float4x4::Identity()));
+}
+
+TEST(Hydrogent_HnLight, IsShadowCasterInFrustum_Outside)
+{
+    const ViewFrustum Frustum = GetPerspectiveFrustum();
+
+    // Outside of the side planes
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(Frustum, float4{12, 0, 10, 1}, float4x4::Identity()));
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(Frustum, float4{-12, 0, 10, 1}, float4x4::Identity()));
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(Frustum, float4{0, 12, 10, 1}, float4x4::Identity()));
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(Frustum, float4{0, 0, 0, 1}, float4x4::Translation(0, -12, 10)));
+    // Beyond the far plane
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(Frustum, float4{0, 0, 102, 1}, float4x4::Identity()));
+
+    const ViewFrustum OrthoFrustum = GetOrthoFrustum();
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{6.5f, 0, 50, 1}, float4x4::Identity()));
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0, 0, 102, 1}, float4x4::Identity()));
+}
+
+TEST(Hydrogent_HnLight, IsShadowCasterInFrustum_BehindNearPlane)
+{
+    // Casters between the light and the frustum are not culled because the near plane is ignored
+    const ViewFrustum OrthoFrustum = GetOrthoFrustum();
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0, 0, -50, 1}, float4x4::Identity()));
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0, 0, -1000, 1}, float4x4::Identity()));
+    // The side planes are still checked
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0, 7, -50, 1}, float4x4::Identity()));
+
+    const ViewFrustum Frustum = GetPerspectiveFrustum();
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(Frustum, float4{0, 0, 0.5f, 0.1f}, float4x4::Identity()));
+}
+
+TEST(Hydrogent_HnLight, IsShadowCasterInFrustum_ScaledTransform)
+{
+    const ViewFrustum OrthoFrustum = GetOrthoFrustum();
+
+    // The sphere center is at x = 14. Without scaling, the sphere is outside of the right plane at x = 5.
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0, 0, 0, 1}, float4x4::Translation(14, 0, 50)));
+
+    // Scaling by 10 along X moves the center from x = 0.5 to x = 5 and scales the radius to 10
+    const float4x4 Transform = float4x4::Scale(10, 1, 1) * float4x4::Translation(9, 0, 50);
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0.5f, 0, 0, 1}, Transform));
+
+    // The largest axis scale is used for the radius, so the scale along Z also affects the culling along X
+    EXPECT_TRUE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0, 0, 0, 1}, float4x4::Scale(1, 1, 10) * float4x4::Translation(14, 0, 50)));
+    EXPECT_FALSE(HnLight::IsShadowCasterInFrustum(OrthoFrustum, float4{0, 0, 0, 1}, float4x4::Scale(1, 1, 5) * float4x4::Translation(14, 0, 50)));
+}
+
+} // namespace
@@ -0,0 +1,248 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "HnMeshBVH.hpp"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+using namespace Diligent::USD;
+
+namespace
+{
+
+// Reference implementation that tests every triangle of the mesh
+bool BruteForceRayCast(const std::vector<float3>& Positions,
+                       const std::vector<Uint32>& Indices,
+                       const float3&              Origin,
+                       const float3&              Direction,
+                       float                      MaxT,
+                       HnMeshBVH::Hit&            Result)
+{
+    bool IntersectionFound = false;
+    for (Uint32 t = 0; t < Indices.size() / 3; ++t)
+    {
+        const float3& p0 = Positions[Indices[t * 3 + 0]];
+        const float3& p1 = Positions[Indices[t * 3 + 1]];
+        const float3& p2 = Positions[Indices[t * 3 + 2]];
+
+        const float3 E1  = p1 - p0;
+        const float3 E2  = p2 - p0;
+        const float3 P   = cross(Direction, E2);
+        const float  Det = dot(E1, P);
+        if (Det == 0)
+            continue;
+
+        const float  InvDet = 1.f / Det;
+        const float3 T      = Origin - p0;
+        const float  u      = dot(T, P) * InvDet;
+        if (u < 0 || u > 1)
+            continue;
+
+        const float3 Q = cross(T, E1);
+        const float  v = dot(Direction, Q) * InvDet;
+        if (v < 0 || u + v > 1)
+            continue;
+
+        const float HitT = dot(E2, Q) * InvDet;
+        if (HitT < 0 || HitT > MaxT)
+            continue;
+
+        MaxT              = HitT;
+        Result.T          = HitT;
+        Result.Triangle   = t;
+        IntersectionFound = true;
+    }
+    return IntersectionFound;
+}
+
+float3 RandomPoint(std::mt19937& Gen, float Range)
+{
+    std::uniform_real_distribution<float> Dist{-Range, Range};
+    return float3{Dist(Gen), Dist(Gen), Dist(Gen)};
+}
+
+void TestRandomMesh(Uint32 Seed, Uint32 NumVertices, Uint32 NumTriangles)
+{
+    std::mt19937 Gen{Seed};
+
+    std::vector<float3> Positions(NumVertices);
+    for (float3& Pos : Positions)
+        Pos = RandomPoint(Gen, 10);
+
+    std::uniform_int_distribution<Uint32> IndexDist{0, NumVertices - 1};
+
+    // Use distinct vertices so that no triangle is degenerate
+    std::vector<Uint32> Indices(size_t{NumTriangles} * 3);
+    for (Uint32 t = 0; t < NumTriangles; ++t)
+    {
+        Uint32* Idx = &Indices[size_t{t} * 3];
+        Idx[0]      = IndexDist(Gen);
+        do
+            Idx[1] = IndexDist(Gen);
+        while (Idx[1] == Idx[0]);
+        do
+            Idx[2] = IndexDist(Gen);
+        while (Idx[2] == Idx[0] || Idx[2] == Idx[1]);
+    }
+
+    HnMeshBVH BVH;
+    BVH.Build(Positions.data(), NumVertices, Indices.data(), NumTriangles);
+    ASSERT_FALSE(BVH.IsEmpty());
+
+    std::uniform_int_distribution<Uint32>  TriangleDist{0, NumTriangles - 1};
+    std::uniform_real_distribution<float> BarycentricDist{0, 0.5f};
+
+    Uint32 NumHits = 0;
+    for (Uint32 r = 0; r < 1000; ++r)
+    {
+        const float3 Origin = RandomPoint(Gen, 20);
+
+        // Aim half of the rays at a random point of a random triangle
+        float3 Direction = RandomPoint(Gen, 1);
+        if (r % 2 == 0)
+        {
+            const Uint32* Idx = &Indices[size_t{TriangleDist(Gen)} * 3];
+            const float   u   = BarycentricDist(Gen);
+            const float   v   = BarycentricDist(Gen);
+            const float3  Target =
+                Positions[Idx[0]] * (1 - u - v) + Positions[Idx[1]] * u + Positions[Idx[2]] * v;
+            Direction = Target - Origin;
+        }
+        const float MaxT = r % 4 < 2 ? 1000.f : 0.9f;
+
+        HnMeshBVH::Hit RefHit;
+        HnMeshBVH::Hit BVHHit;
+
+        const bool RefFound = BruteForceRayCast(Positions, Indices, Origin, Direction, MaxT, RefHit);
+        const bool BVHFound = BVH.RayCast(Origin, Direction, MaxT, BVHHit);
+        ASSERT_EQ(RefFound, BVHFound) << "Ray " << r;
+        if (!RefFound)
+            continue;
+
+        ++NumHits;
+        // Triangles may be tested in a different order, so only
+        // the triangle index of unambiguous hits must match.
+        EXPECT_FLOAT_EQ(RefHit.T, BVHHit.T) << "Ray " << r;
+        if (RefHit.T != BVHHit.T)
+            continue;
+
+        const Uint32* RefIdx = &Indices[RefHit.Triangle * 3];
+        const Uint32* BVHIdx = &Indices[BVHHit.Triangle * 3];
+        const float3  RefN   = cross(Positions[RefIdx[1]] - Positions[RefIdx[0]], Positions[RefIdx[2]] - Positions[RefIdx[0]]);
+        const float3  BVHN   = cross(Positions[BVHIdx[1]] - Positions[BVHIdx[0]], Positions[BVHIdx[2]] - Positions[BVHIdx[0]]);
+        EXPECT_NEAR(length(cross(RefN, BVHN)), 0.f, 1e-3f * length(RefN) * length(BVHN)) << "Ray " << r;
+    }
+    EXPECT_GT(NumHits, 0u);
+}
+
+TEST(Hydrogent_MeshBVH, RandomMeshes)
+{
+    TestRandomMesh(0, 3, 1);
+    TestRandomMesh(1, 16, 8);
+    TestRandomMesh(2, 100, 200);
+    TestRandomMesh(3, 1000, 5000);
+}
+
+TEST(Hydrogent_MeshBVH, Grid)
+{
+    // Regular grid of quads in the XY plane with many coplanar triangles
+    constexpr Uint32 GridSize = 32;
+
+    std::vector<float3> Positions;
+    for (Uint32 y = 0; y <= GridSize; ++y)
+    {
+        for (Uint32 x = 0; x <= GridSize; ++x)
+            Positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.f);
+    }
+
+    std::vector<Uint32> Indices;
+    for (Uint32 y = 0; y < GridSize; ++y)
+    {
+        for (Uint32 x = 0; x < GridSize; ++x)
+        {
+            const Uint32 v0 = y * (GridSize + 1) + x;
+            const Uint32 v1 = v0 + 1;
+            const Uint32 v2 = v0 + GridSize + 1;
+            const Uint32 v3 = v2 + 1;
+            Indices.insert(Indices.end(), {v0, v1, v2, v2, v1, v3});
+        }
+    }
+    const Uint32 NumTriangles = static_cast<Uint32>(Indices.size() / 3);
+
+    HnMeshBVH BVH;
+    BVH.Build(Positions.data(), static_cast<Uint32>(Positions.size()), Indices.data(), NumTriangles);
+
+    for (Uint32 y = 0; y < GridSize; ++y)
+    {
+        for (Uint32 x = 0; x < GridSize; ++x)
+        {
+            // Cast a ray at the center of the lower-left triangle of every quad
+            const float3 Origin{x + 0.25f, y + 0.25f, 5.f};
+
+            HnMeshBVH::Hit Hit;
+            ASSERT_TRUE(BVH.RayCast(Origin, float3{0, 0, -1}, 100.f, Hit));
+            EXPECT_FLOAT_EQ(Hit.T, 5.f);
+            EXPECT_EQ(Hit.Triangle, (y * GridSize + x) * 2);
+        }
+    }
+
+    // Rays that miss the grid or are too short
+    HnMeshBVH::Hit Hit;
+    EXPECT_FALSE(BVH.RayCast(float3{-1, -1, 5}, float3{0, 0, -1}, 100.f, Hit));
+    EXPECT_FALSE(BVH.RayCast(float3{1.25f, 1.25f, 5}, float3{0, 0, -1}, 4.f, Hit));
+    EXPECT_FALSE(BVH.RayCast(float3{1.25f, 1.25f, 5}, float3{0, 0, 1}, 100.f, Hit));
+}
+
+TEST(Hydrogent_MeshBVH, InvalidTriangles)
+{
+    const float3 Positions[] = {
+        {0, 0, 0},
+        {1, 0, 0},
+        {0, 1, 0},
+    };
+    // The first triangle references a vertex out of range and is skipped
+    const Uint32 Indices[] = {
+        0, 1, 5,
+        0, 1, 2,
+    };
+
+    HnMeshBVH BVH;
+    BVH.Build(Positions, 3, Indices, 2);
+
+    HnMeshBVH::Hit Hit;
+    ASSERT_TRUE(BVH.RayCast(float3{0.2f, 0.2f, 1}, float3{0, 0, -1}, 10.f, Hit));
+    EXPECT_EQ(Hit.Triangle, 1u);
+
+    BVH.Build(Positions, 3, Indices, 1);
+    EXPECT_TRUE(BVH.IsEmpty());
+    EXPECT_FALSE(BVH.RayCast(float3{0.2f, 0.2f, 1}, float3{0, 0, -1}, 10.f, Hit));
+}
+
+} // namespace
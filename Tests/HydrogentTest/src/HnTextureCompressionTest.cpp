@@ -0,0 +1,240 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "HnTextureCompression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+using namespace Diligent::USD;
+
+namespace
+{
+
+struct TestTexture
+{
+    TextureDesc                     Desc;
+    std::vector<std::vector<Uint8>> Mips;
+    std::vector<TextureSubResData>  SubResources;
+
+    TestTexture(Uint32 Width, Uint32 Height, Uint32 MipLevels, TEXTURE_FORMAT Format, Uint8 Alpha = 255)
+    {
+        Desc.Type      = RESOURCE_DIM_TEX_2D;
+        Desc.Width     = Width;
+        Desc.Height    = Height;
+        Desc.Format    = Format;
+        Desc.MipLevels = MipLevels;
+
+        const Uint32 NumComponents = Format == TEX_FORMAT_R8_UNORM ? 1 : 4;
+        for (Uint32 mip = 0; mip < MipLevels; ++mip)
+        {
+            const Uint32 MipWidth  = std::max(Width >> mip, 1u);
+            const Uint32 MipHeight = std::max(Height >> mip, 1u);
+
+            // Smooth gradients that block compression reproduces with low error
+            std::vector<Uint8> Texels(size_t{MipWidth} * MipHeight * NumComponents);
+            for (Uint32 y = 0; y < MipHeight; ++y)
+            {
+                for (Uint32 x = 0; x < MipWidth; ++x)
+                {
+                    Uint8* pTexel = &Texels[(size_t{y} * MipWidth + x) * NumComponents];
+
+                    pTexel[0] = static_cast<Uint8>(x * 255 / MipWidth);
+                    if (NumComponents == 4)
+                    {
+                        pTexel[1] = static_cast<Uint8>(y * 255 / MipHeight);
+                        pTexel[2] = 128;
+                        pTexel[3] = Alpha;
+                    }
+                }
+            }
+            Mips.emplace_back(std::move(Texels));
+
+            TextureSubResData SubRes;
+            SubRes.pData  = Mips.back().data();
+            SubRes.Stride = size_t{MipWidth} * NumComponents;
+            SubResources.push_back(SubRes);
+        }
+    }
+
+    TextureData GetData()
+    {
+        TextureData Data;
+        Data.pSubResources   = SubResources.data();
+        Data.NumSubresources = static_cast<Uint32>(SubResources.size());
+        return Data;
+    }
+};
+
+size_t GetCompressedMipSize(Uint32 Width, Uint32 Height, Uint32 Mip, Uint32 BytesPerBlock)
+{
+    const Uint32 BlocksX = (std::max(Width >> Mip, 1u) + 3) / 4;
+    const Uint32 BlocksY = (std::max(Height >> Mip, 1u) + 3) / 4;
+    return size_t{BlocksX} * BlocksY * BytesPerBlock;
+}
+
+void CheckMipLayout(const HnCompressedTextureData& Compressed, Uint32 BytesPerBlock)
+{
+    const TextureDesc& Desc = Compressed.Desc;
+    ASSERT_EQ(Compressed.MipOffsets.size(), Desc.MipLevels);
+
+    size_t Offset = 0;
+    for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+    {
+        EXPECT_EQ(Compressed.MipOffsets[mip], Offset) << "mip " << mip;
+        Offset += GetCompressedMipSize(Desc.Width, Desc.Height, mip, BytesPerBlock);
+    }
+    EXPECT_EQ(Compressed.Data.size(), Offset);
+}
+
+TEST(Hydrogent_TextureCompression, BC1)
+{
+    TestTexture Src{64, 32, 7, TEX_FORMAT_RGBA8_UNORM};
+
+    HnCompressedTextureData Compressed;
+    ASSERT_TRUE(CompressTextureBC(Src.Desc, Src.GetData(), TEX_FORMAT_BC1_UNORM, Compressed));
+    EXPECT_EQ(Compressed.Desc.Format, TEX_FORMAT_BC1_UNORM);
+    EXPECT_EQ(Compressed.Desc.Width, 64u);
+    EXPECT_EQ(Compressed.Desc.Height, 32u);
+    EXPECT_EQ(Compressed.Desc.MipLevels, 7u);
+    EXPECT_GT(Compressed.PSNR, 30.0);
+    CheckMipLayout(Compressed, 8);
+}
+
+TEST(Hydrogent_TextureCompression, OpaqueBC3FallsBackToBC1)
+{
+    TestTexture Src{16, 16, 1, TEX_FORMAT_RGBA8_UNORM_SRGB};
+
+    HnCompressedTextureData Compressed;
+    ASSERT_TRUE(CompressTextureBC(Src.Desc, Src.GetData(), TEX_FORMAT_BC3_UNORM, Compressed));
+    EXPECT_EQ(Compressed.Desc.Format, TEX_FORMAT_BC1_UNORM_SRGB);
+    CheckMipLayout(Compressed, 8);
+}
+
+TEST(Hydrogent_TextureCompression, BC3)
+{
+    TestTexture Src{32, 32, 6, TEX_FORMAT_RGBA8_UNORM_SRGB, 100};
+
+    HnCompressedTextureData Compressed;
+    ASSERT_TRUE(CompressTextureBC(Src.Desc, Src.GetData(), TEX_FORMAT_BC3_UNORM, Compressed));
+    EXPECT_EQ(Compressed.Desc.Format, TEX_FORMAT_BC3_UNORM_SRGB);
+    EXPECT_GT(Compressed.PSNR, 30.0);
+    CheckMipLayout(Compressed, 16);
+}
+
+TEST(Hydrogent_TextureCompression, BC4)
+{
+    TestTexture Src{32, 16, 6, TEX_FORMAT_R8_UNORM};
+
+    HnCompressedTextureData Compressed;
+    ASSERT_TRUE(CompressTextureBC(Src.Desc, Src.GetData(), TEX_FORMAT_BC4_UNORM, Compressed));
+    EXPECT_EQ(Compressed.Desc.Format, TEX_FORMAT_BC4_UNORM);
+    EXPECT_GT(Compressed.PSNR, 40.0);
+    CheckMipLayout(Compressed, 8);
+}
+
+TEST(Hydrogent_TextureCompression, UnsupportedInput)
+{
+    HnCompressedTextureData Compressed;
+    {
+        // Dimensions are not multiples of the block size
+        TestTexture Src{18, 16, 1, TEX_FORMAT_RGBA8_UNORM};
+        EXPECT_FALSE(CompressTextureBC(Src.Desc, Src.GetData(), TEX_FORMAT_BC1_UNORM, Compressed));
+    }
+    {
+        // BC4 requires single-channel data
+        TestTexture Src{16, 16, 1, TEX_FORMAT_RGBA8_UNORM};
+        EXPECT_FALSE(CompressTextureBC(Src.Desc, Src.GetData(), TEX_FORMAT_BC4_UNORM, Compressed));
+    }
+    {
+        // BC1 requires four-channel data
+        TestTexture Src{16, 16, 1, TEX_FORMAT_R8_UNORM};
+        EXPECT_FALSE(CompressTextureBC(Src.Desc, Src.GetData(), TEX_FORMAT_BC1_UNORM, Compressed));
+    }
+}
+
+TEST(Hydrogent_TextureCompression, DDSHeader)
+{
+    TestTexture Src{64, 32, 7, TEX_FORMAT_RGBA8_UNORM_SRGB, 0};
+
+    HnCompressedTextureData Compressed;
+    ASSERT_TRUE(CompressTextureBC(Src.Desc, Src.GetData(), TEX_FORMAT_BC3_UNORM, Compressed));
+    ASSERT_EQ(Compressed.Desc.Format, TEX_FORMAT_BC3_UNORM_SRGB);
+
+    const std::vector<Uint8> DDSData = WriteCompressedTextureDDS(Compressed);
+
+    // Magic number, DDS_HEADER, and DDS_HEADER_DXT10
+    Uint32 Header[1 + 31 + 5] = {};
+    ASSERT_EQ(DDSData.size(), sizeof(Header) + Compressed.Data.size());
+    std::memcpy(Header, DDSData.data(), sizeof(Header));
+
+    EXPECT_EQ(Header[0], 0x20534444u);    // "DDS "
+    EXPECT_EQ(Header[1], 124u);           // dwSize
+    EXPECT_EQ(Header[3], 32u);            // dwHeight
+    EXPECT_EQ(Header[4], 64u);            // dwWidth
+    EXPECT_EQ(Header[5], GetCompressedMipSize(64, 32, 0, 16));
+    EXPECT_EQ(Header[7], 7u);             // dwMipMapCount
+    EXPECT_EQ(Header[19], 32u);           // ddspf.dwSize
+    EXPECT_EQ(Header[20], 0x4u);          // DDPF_FOURCC
+    EXPECT_EQ(Header[21], 0x30315844u);   // "DX10"
+    EXPECT_EQ(Header[32], 78u);           // DXGI_FORMAT_BC3_UNORM_SRGB
+    EXPECT_EQ(Header[33], 3u);            // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+    EXPECT_EQ(Header[35], 1u);            // arraySize
+
+    EXPECT_EQ(std::memcmp(DDSData.data() + sizeof(Header), Compressed.Data.data(), Compressed.Data.size()), 0);
+}
+
+TEST(Hydrogent_TextureCompression, DDSFormats)
+{
+    const auto GetDXGIFormat = [](TEXTURE_FORMAT Format) {
+        HnCompressedTextureData Compressed;
+        Compressed.Desc.Type      = RESOURCE_DIM_TEX_2D;
+        Compressed.Desc.Width     = 4;
+        Compressed.Desc.Height    = 4;
+        Compressed.Desc.MipLevels = 1;
+        Compressed.Desc.Format    = Format;
+        Compressed.Data.resize(16);
+        Compressed.MipOffsets = {0};
+
+        const std::vector<Uint8> DDSData = WriteCompressedTextureDDS(Compressed);
+
+        Uint32 DXGIFormat = 0;
+        std::memcpy(&DXGIFormat, DDSData.data() + 32 * sizeof(Uint32), sizeof(DXGIFormat));
+        return DXGIFormat;
+    };
+
+    EXPECT_EQ(GetDXGIFormat(TEX_FORMAT_BC1_UNORM), 71u);
+    EXPECT_EQ(GetDXGIFormat(TEX_FORMAT_BC1_UNORM_SRGB), 72u);
+    EXPECT_EQ(GetDXGIFormat(TEX_FORMAT_BC3_UNORM), 77u);
+    EXPECT_EQ(GetDXGIFormat(TEX_FORMAT_BC3_UNORM_SRGB), 78u);
+    EXPECT_EQ(GetDXGIFormat(TEX_FORMAT_BC4_UNORM), 80u);
+}
+
+} // namespace
@@ -0,0 +1,175 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "HnTextureUtils.hpp"
+
+#include <array>
+#include <functional>
+
+#include "Image.h"
+#include "DataBlobImpl.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+using namespace Diligent::USD;
+
+namespace
+{
+
+RefCntAutoPtr<ITextureLoader> CreateR8Loader(Uint32 Width, Uint32 Height, const std::function<Uint8(Uint32, Uint32)>& GetValue)
+{
+    ImageDesc ImgDesc;
+    ImgDesc.Width         = Width;
+    ImgDesc.Height        = Height;
+    ImgDesc.ComponentType = VT_UINT8;
+    ImgDesc.NumComponents = 1;
+    ImgDesc.RowStride     = Width;
+
+    RefCntAutoPtr<IDataBlob> pData = DataBlobImpl::Create(size_t{Width} * size_t{Height});
+
+    Uint8* const pTexels = reinterpret_cast<Uint8*>(pData->GetDataPtr());
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        for (Uint32 x = 0; x < Width; ++x)
+            pTexels[y * Width + x] = GetValue(x, y);
+    }
+
+    RefCntAutoPtr<Image> pImage;
+    Image::CreateFromMemory(ImgDesc, pData, &pImage);
+    if (!pImage)
+        return {};
+
+    TextureLoadInfo LoadInfo;
+    LoadInfo.Name = "Test texture";
+
+    RefCntAutoPtr<ITextureLoader> pLoader;
+    CreateTextureLoaderFromImage(pImage, LoadInfo, &pLoader);
+    return pLoader;
+}
+
+// Returns the texel of the most detailed mip level of the RGBA8 texture
+const Uint8* GetTexel(ITextureLoader* pLoader, Uint32 x, Uint32 y)
+{
+    const TextureSubResData& Level = pLoader->GetTextureData().pSubResources[0];
+    return static_cast<const Uint8*>(Level.pData) + y * Level.Stride + x * 4;
+}
+
+TEST(Hydrogent_TexturePacking, PackChannels)
+{
+    constexpr Uint32 Width  = 16;
+    constexpr Uint32 Height = 8;
+
+    const auto GetOcclusion = [](Uint32 x, Uint32 y) { return static_cast<Uint8>(x * 16 + y); };
+    const auto GetRoughness = [](Uint32 x, Uint32 y) { return static_cast<Uint8>(255 - x * 8 - y); };
+    const auto GetMetallic  = [](Uint32 x, Uint32 y) { return static_cast<Uint8>((x + y) % 2 == 0 ? 0 : 255); };
+
+    const std::array<RefCntAutoPtr<ITextureLoader>, 4> ChannelLoaders = {
+        CreateR8Loader(Width, Height, GetOcclusion),
+        CreateR8Loader(Width, Height, GetRoughness),
+        CreateR8Loader(Width, Height, GetMetallic),
+        RefCntAutoPtr<ITextureLoader>{},
+    };
+    ASSERT_TRUE(ChannelLoaders[0] && ChannelLoaders[1] && ChannelLoaders[2]);
+
+    RefCntAutoPtr<ITextureLoader> pPacked = CreatePackedTextureLoader("ORM", ChannelLoaders);
+    ASSERT_TRUE(pPacked);
+
+    const TextureDesc& Desc = pPacked->GetTextureDesc();
+    EXPECT_EQ(Desc.Width, Width);
+    EXPECT_EQ(Desc.Height, Height);
+    EXPECT_EQ(Desc.Format, TEX_FORMAT_RGBA8_UNORM);
+
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        for (Uint32 x = 0; x < Width; ++x)
+        {
+            const Uint8* pTexel = GetTexel(pPacked, x, y);
+            EXPECT_EQ(pTexel[0], GetOcclusion(x, y)) << "(" << x << ", " << y << ")";
+            EXPECT_EQ(pTexel[1], GetRoughness(x, y)) << "(" << x << ", " << y << ")";
+            EXPECT_EQ(pTexel[2], GetMetallic(x, y)) << "(" << x << ", " << y << ")";
+            // Channels without a source texture are white
+            EXPECT_EQ(pTexel[3], 255) << "(" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST(Hydrogent_TexturePacking, ResampleSmallerTextures)
+{
+    const std::array<RefCntAutoPtr<ITextureLoader>, 4> ChannelLoaders = {
+        // Constant texture must stay constant after resampling
+        CreateR8Loader(2, 2, [](Uint32, Uint32) { return Uint8{77}; }),
+        // Horizontal ramp: 0 in the left column, 200 in the right column
+        CreateR8Loader(2, 2, [](Uint32 x, Uint32) { return static_cast<Uint8>(x * 200); }),
+        CreateR8Loader(8, 4, [](Uint32, Uint32) { return Uint8{10}; }),
+        CreateR8Loader(8, 4, [](Uint32, Uint32) { return Uint8{20}; }),
+    };
+
+    RefCntAutoPtr<ITextureLoader> pPacked = CreatePackedTextureLoader("ORM", ChannelLoaders);
+    ASSERT_TRUE(pPacked);
+
+    // The packed texture has the resolution of the largest source texture
+    const TextureDesc& Desc = pPacked->GetTextureDesc();
+    ASSERT_EQ(Desc.Width, 8u);
+    ASSERT_EQ(Desc.Height, 4u);
+
+    for (Uint32 y = 0; y < Desc.Height; ++y)
+    {
+        Uint8 PrevG = 0;
+        for (Uint32 x = 0; x < Desc.Width; ++x)
+        {
+            const Uint8* pTexel = GetTexel(pPacked, x, y);
+            EXPECT_EQ(pTexel[0], 77);
+            EXPECT_GE(pTexel[1], PrevG) << "The resampled ramp must not decrease";
+            EXPECT_EQ(pTexel[2], 10);
+            EXPECT_EQ(pTexel[3], 20);
+            PrevG = pTexel[1];
+        }
+        // Texels outside of the source texel centers are clamped to the edge values
+        EXPECT_EQ(GetTexel(pPacked, 0, y)[1], 0);
+        EXPECT_EQ(GetTexel(pPacked, Desc.Width - 1, y)[1], 200);
+    }
+}
+
+TEST(Hydrogent_TexturePacking, Compression)
+{
+    const std::array<RefCntAutoPtr<ITextureLoader>, 4> ChannelLoaders = {
+        CreateR8Loader(16, 16, [](Uint32 x, Uint32) { return static_cast<Uint8>(x * 16); }),
+        CreateR8Loader(16, 16, [](Uint32, Uint32 y) { return static_cast<Uint8>(y * 16); }),
+        CreateR8Loader(16, 16, [](Uint32, Uint32) { return Uint8{0}; }),
+        RefCntAutoPtr<ITextureLoader>{},
+    };
+
+    RefCntAutoPtr<ITextureLoader> pPacked = CreatePackedTextureLoader("ORM", ChannelLoaders, TEX_FORMAT_BC1_UNORM);
+    ASSERT_TRUE(pPacked);
+
+    const TextureDesc& Desc = pPacked->GetTextureDesc();
+    EXPECT_EQ(Desc.Width, 16u);
+    EXPECT_EQ(Desc.Height, 16u);
+    EXPECT_EQ(Desc.Format, TEX_FORMAT_BC1_UNORM);
+}
+
+} // namespace
@@ -0,0 +1,219 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+// DiligentFX-ShaderArchiver compiles the shaders listed in a DiligentFX shader manifest
+// (see DiligentFXShaderArchive) into a device object archive. Compilation only requires
+// the shader compilers and does not need a GPU.
+//
+// Usage:
+//     DiligentFX-ShaderArchiver --manifest <manifest> --output <archive> [--devices d3d11,d3d12,gl,gles,vulkan,metal_macos,metal_ios]
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ArchiverFactoryLoader.h"
+#include "ShaderSourceFactoryUtils.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "Utilities/interface/DiligentFXShaderArchive.hpp"
+#include "Utilities/interface/DiligentFXShaderSourceStreamFactory.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+bool ParseDeviceFlags(const std::string& Devices, ARCHIVE_DEVICE_DATA_FLAGS& Flags)
+{
+    Flags = ARCHIVE_DEVICE_DATA_FLAG_NONE;
+
+    std::stringstream DevicesSS{Devices};
+    std::string       Device;
+    while (std::getline(DevicesSS, Device, ','))
+    {
+        // clang-format off
+        if      (Device == "d3d11")       Flags |= ARCHIVE_DEVICE_DATA_FLAG_D3D11;
+        else if (Device == "d3d12")       Flags |= ARCHIVE_DEVICE_DATA_FLAG_D3D12;
+        else if (Device == "gl")          Flags |= ARCHIVE_DEVICE_DATA_FLAG_GL;
+        else if (Device == "gles")        Flags |= ARCHIVE_DEVICE_DATA_FLAG_GLES;
+        else if (Device == "vulkan")      Flags |= ARCHIVE_DEVICE_DATA_FLAG_VULKAN;
+        else if (Device == "metal_macos") Flags |= ARCHIVE_DEVICE_DATA_FLAG_METAL_MACOS;
+        else if (Device == "metal_ios")   Flags |= ARCHIVE_DEVICE_DATA_FLAG_METAL_IOS;
+        // clang-format on
+        else
+        {
+            std::cerr << "Unknown device type: " << Device << '\n';
+            return false;
+        }
+    }
+
+    return Flags != ARCHIVE_DEVICE_DATA_FLAG_NONE;
+}
+
+RefCntAutoPtr<IShader> CreateShader(ISerializationDevice*                         pDevice,
+                                    const DiligentFXShaderArchive::ManifestEntry& Entry,
+                                    ARCHIVE_DEVICE_DATA_FLAGS                     DeviceFlags)
+{
+    std::vector<MemoryShaderSourceFileInfo> GeneratedFiles;
+    for (const DiligentFXShaderArchive::GeneratedFile& File : Entry.GeneratedFiles)
+        GeneratedFiles.emplace_back(File.Name.c_str(), File.Content);
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pMemorySourceFactory;
+    if (!GeneratedFiles.empty())
+    {
+        MemoryShaderSourceFactoryCreateInfo FactoryCI{GeneratedFiles.data(), static_cast<Uint32>(GeneratedFiles.size()), false};
+        CreateMemoryShaderSourceFactory(FactoryCI, &pMemorySourceFactory);
+    }
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory =
+        pMemorySourceFactory ?
+        CreateCompoundShaderSourceFactory({&DiligentFXShaderSourceStreamFactory::GetInstance(), pMemorySourceFactory}) :
+        RefCntAutoPtr<IShaderSourceInputStreamFactory>{&DiligentFXShaderSourceStreamFactory::GetInstance()};
+
+    std::vector<ShaderMacro> Macros;
+    for (const auto& Macro : Entry.Macros)
+        Macros.emplace_back(Macro.first.c_str(), Macro.second.c_str());
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.FilePath                        = !Entry.FilePath.empty() ? Entry.FilePath.c_str() : nullptr;
+    ShaderCI.Source                          = !Entry.Source.empty() ? Entry.Source.c_str() : nullptr;
+    ShaderCI.SourceLength                    = Entry.Source.length();
+    ShaderCI.EntryPoint                      = Entry.EntryPoint.c_str();
+    ShaderCI.SourceLanguage                  = Entry.SourceLanguage;
+    ShaderCI.GLSLExtensions                  = !Entry.GLSLExtensions.empty() ? Entry.GLSLExtensions.c_str() : nullptr;
+    ShaderCI.Macros                          = {Macros.data(), static_cast<Uint32>(Macros.size())};
+    ShaderCI.pShaderSourceStreamFactory      = pShaderSourceFactory;
+    ShaderCI.Desc.ShaderType                 = Entry.ShaderType;
+    ShaderCI.Desc.UseCombinedTextureSamplers = Entry.UseCombinedTextureSamplers;
+    if (!Entry.CombinedSamplerSuffix.empty())
+        ShaderCI.Desc.CombinedSamplerSuffix = Entry.CombinedSamplerSuffix.c_str();
+
+    // The archive name contains the hash of the shader sources, so it is computed from the sources
+    // being compiled rather than taken from the manifest that may have been recorded with other sources.
+    const std::string ArchiveName = DiligentFXShaderArchive::GetArchiveName(ShaderCI, Entry.GeneratedFiles);
+    if (ArchiveName != Entry.ArchiveName)
+        std::cout << "Shader sources of " << Entry.ArchiveName << " have changed since the manifest was recorded\n";
+    ShaderCI.Desc.Name = ArchiveName.c_str();
+
+    RefCntAutoPtr<IShader> pShader;
+    pDevice->CreateShader(ShaderCI, ShaderArchiveInfo{DeviceFlags}, &pShader);
+    return pShader;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const char* ManifestPath = nullptr;
+    const char* OutputPath   = nullptr;
+    std::string Devices      = "d3d12,vulkan";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        // clang-format off
+        if      (strcmp(argv[i], "--manifest") == 0) ManifestPath = argv[i + 1];
+        else if (strcmp(argv[i], "--output")   == 0) OutputPath   = argv[i + 1];
+        else if (strcmp(argv[i], "--devices")  == 0) Devices      = argv[i + 1];
+        // clang-format on
+        else
+        {
+            std::cerr << "Unknown argument: " << argv[i] << '\n';
+            return -1;
+        }
+    }
+
+    if (ManifestPath == nullptr || OutputPath == nullptr)
+    {
+        std::cerr << "Usage: DiligentFX-ShaderArchiver --manifest <manifest> --output <archive> [--devices d3d11,d3d12,gl,gles,vulkan,metal_macos,metal_ios]\n";
+        return -1;
+    }
+
+    ARCHIVE_DEVICE_DATA_FLAGS DeviceFlags = ARCHIVE_DEVICE_DATA_FLAG_NONE;
+    if (!ParseDeviceFlags(Devices, DeviceFlags))
+        return -1;
+
+    std::vector<DiligentFXShaderArchive::ManifestEntry> Entries;
+    if (!DiligentFXShaderArchive::ReadManifest(ManifestPath, Entries))
+        return -1;
+
+#if EXPLICITLY_LOAD_ARCHIVER_FACTORY_DLL
+    auto GetArchiverFactory = LoadArchiverFactory();
+    if (GetArchiverFactory == nullptr)
+    {
+        std::cerr << "Failed to load the archiver factory\n";
+        return -1;
+    }
+#endif
+    IArchiverFactory* pArchiverFactory = GetArchiverFactory();
+
+    RefCntAutoPtr<ISerializationDevice> pDevice;
+    pArchiverFactory->CreateSerializationDevice(SerializationDeviceCreateInfo{}, &pDevice);
+    if (!pDevice)
+    {
+        std::cerr << "Failed to create the serialization device\n";
+        return -1;
+    }
+
+    RefCntAutoPtr<IArchiver> pArchiver;
+    pArchiverFactory->CreateArchiver(pDevice, &pArchiver);
+    if (!pArchiver)
+    {
+        std::cerr << "Failed to create the archiver\n";
+        return -1;
+    }
+
+    int NumErrors = 0;
+    for (const DiligentFXShaderArchive::ManifestEntry& Entry : Entries)
+    {
+        RefCntAutoPtr<IShader> pShader = CreateShader(pDevice, Entry, DeviceFlags);
+        if (!pShader || !pArchiver->AddShader(pShader))
+        {
+            std::cerr << "Failed to archive shader " << Entry.ArchiveName << '\n';
+            ++NumErrors;
+        }
+    }
+
+    RefCntAutoPtr<IDataBlob> pArchive;
+    if (!pArchiver->SerializeToBlob(0, &pArchive) || !pArchive)
+    {
+        std::cerr << "Failed to serialize the archive\n";
+        return -1;
+    }
+
+    std::ofstream ArchiveFile{OutputPath, std::ios::binary | std::ios::trunc};
+    if (!ArchiveFile.write(static_cast<const char*>(pArchive->GetConstDataPtr()), pArchive->GetSize()))
+    {
+        std::cerr << "Failed to write " << OutputPath << '\n';
+        return -1;
+    }
+
+    std::cout << "Archived " << Entries.size() - NumErrors << " of " << Entries.size() << " shaders to " << OutputPath << '\n';
+
+    return NumErrors == 0 ? 0 : -1;
+}
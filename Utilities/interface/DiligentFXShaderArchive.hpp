@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+#include "Dearchiver.h"
+#include "RenderStateCache.h"
+#include "RefCntAutoPtr.hpp"
+#include "XXH128Hasher.hpp"
+
+namespace Diligent
+{
+
+/// Precompiled DiligentFX shader archive.
+///
+/// DiligentFX components create shaders through this class. If a dearchiver is set, the shader
+/// is unpacked from the archive by its archive name (see GetArchiveName()); otherwise it is
+/// compiled at run time using the render state cache, if one is provided.
+///
+/// The archive is generated offline by the DiligentFX-ShaderArchiver tool from a shader manifest
+/// (see the DILIGENT_BUILD_FX_SHADER_ARCHIVE CMake option). The manifest lists the shader permutations
+/// used by the application and is recorded at run time by enabling recording and calling WriteManifest().
+class DiligentFXShaderArchive final
+{
+public:
+    /// A generated shader source file that is not part of the DiligentFX shader sources.
+    struct GeneratedFile
+    {
+        std::string Name;
+        std::string Content;
+    };
+
+    /// Shader manifest entry that contains everything needed to compile the shader offline.
+    struct ManifestEntry
+    {
+        std::string ArchiveName;
+        std::string FilePath;
+        std::string Source;
+        std::string EntryPoint;
+        std::string CombinedSamplerSuffix;
+        std::string GLSLExtensions;
+
+        SHADER_TYPE            ShaderType                 = SHADER_TYPE_UNKNOWN;
+        SHADER_SOURCE_LANGUAGE SourceLanguage             = SHADER_SOURCE_LANGUAGE_DEFAULT;
+        bool                   UseCombinedTextureSamplers = false;
+
+        std::vector<std::pair<std::string, std::string>> Macros;
+        std::vector<GeneratedFile>                       GeneratedFiles;
+    };
+
+    static DiligentFXShaderArchive& GetInstance();
+
+    /// Sets the dearchiver that contains precompiled shaders. Pass null to disable the archive.
+    void SetDearchiver(IDearchiver* pDearchiver);
+
+    /// Enables or disables recording of the shaders that were not found in the archive.
+    void SetRecordingEnabled(bool Enable);
+
+    /// Creates the shader.
+
+    /// \param [in] pDevice        - Render device.
+    /// \param [in] pStateCache    - Optional render state cache used when the shader is not found in the archive.
+    /// \param [in] ShaderCI       - Shader create info. Files are loaded from ShaderCI.pShaderSourceStreamFactory.
+    /// \param [in] GeneratedFiles - Files that the shader includes in addition to DiligentFX shader sources.
+    ///                              ShaderCI.pShaderSourceStreamFactory must provide them.
+    RefCntAutoPtr<IShader> CreateShader(IRenderDevice*                    pDevice,
+                                        IRenderStateCache*                pStateCache,
+                                        const ShaderCreateInfo&           ShaderCI,
+                                        const std::vector<GeneratedFile>& GeneratedFiles = {});
+
+    /// Writes the manifest of the recorded shaders to the file.
+    bool WriteManifest(const char* FilePath) const;
+
+    /// Reads the shader manifest from the file.
+    static bool ReadManifest(const char* FilePath, std::vector<ManifestEntry>& Entries);
+
+    /// Returns the name of the shader in the archive.
+    ///
+    /// \remarks    The name contains the 128-bit XXH3 hash of all shader create info members that affect
+    ///             the compiled shader as well as the contents of the source file and the files
+    ///             it includes, so every permutation of every shader version has a unique name.
+    ///             The hash does not depend on the platform or compiler, so an archive built
+    ///             offline on one system can be used on any other.
+    static std::string GetArchiveName(const ShaderCreateInfo& ShaderCI, const std::vector<GeneratedFile>& GeneratedFiles);
+
+    /// Updates the hasher with the contents of the shader source file and all files it includes.
+    static void HashShaderSource(IShaderSourceInputStreamFactory* pFactory, const char* FilePath, XXH128State& Hasher);
+
+    /// Formats the hash as a 32-character hexadecimal string.
+    static std::string HashToString(const XXH128Hash& Hash);
+
+    /// Returns the number of shaders that were unpacked from the archive.
+    Uint32 GetNumArchiveHits() const { return m_NumArchiveHits; }
+
+    /// Returns the number of shaders that were compiled at run time.
+    Uint32 GetNumArchiveMisses() const { return m_NumArchiveMisses; }
+
+private:
+    DiligentFXShaderArchive() = default;
+
+    static ManifestEntry MakeManifestEntry(const ShaderCreateInfo& ShaderCI, const std::vector<GeneratedFile>& GeneratedFiles);
+
+private:
+    mutable std::mutex m_Mtx;
+
+    RefCntAutoPtr<IDearchiver> m_pDearchiver;
+
+    bool                       m_RecordingEnabled = false;
+    std::vector<ManifestEntry> m_Manifest;
+
+    Uint32 m_NumArchiveHits   = 0;
+    Uint32 m_NumArchiveMisses = 0;
+};
+
+} // namespace Diligent
@@ -0,0 +1,446 @@
+/*
+ *  Copyright 2024 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include "../interface/DiligentFXShaderArchive.hpp"
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <unordered_set>
+
+#include "RenderStateCache.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr char ManifestHeader[] = "DiligentFX shader manifest 1";
+
+// Every manifest field is written as "<Key> <Length>\n<Value>\n" so that values may contain any characters.
+void WriteField(std::ostream& Stream, const char* Key, const std::string& Value)
+{
+    Stream << Key << ' ' << Value.size() << '\n';
+    Stream.write(Value.data(), Value.size());
+    Stream << '\n';
+}
+
+bool ReadField(std::istream& Stream, std::string& Key, std::string& Value)
+{
+    size_t Length = 0;
+    if (!(Stream >> Key >> Length))
+        return false;
+    if (Stream.get() != '\n')
+        return false;
+
+    Value.resize(Length);
+    if (Length > 0 && !Stream.read(&Value[0], Length))
+        return false;
+
+    return Stream.get() == '\n';
+}
+
+// Parses an unsigned integer field value without throwing exceptions.
+bool ParseUint(const std::string& Value, Uint32& Result)
+{
+    if (Value.empty() || Value[0] < '0' || Value[0] > '9')
+        return false;
+
+    errno = 0;
+
+    char*               pEnd   = nullptr;
+    const unsigned long Parsed = std::strtoul(Value.c_str(), &pEnd, 10);
+    if (errno != 0 || pEnd != Value.c_str() + Value.size() || Parsed > UINT32_MAX)
+        return false;
+
+    Result = static_cast<Uint32>(Parsed);
+    return true;
+}
+
+// Hashes the string length followed by its characters so that adjacent strings
+// can't produce the same byte sequence.
+void HashString(XXH128State& Hasher, const std::string& Str)
+{
+    Hasher.Update(static_cast<Uint64>(Str.size()));
+    Hasher.UpdateRaw(Str.data(), Str.size());
+}
+
+void HashShaderFile(IShaderSourceInputStreamFactory* pFactory, const std::string& FileName, std::unordered_set<std::string>& VisitedFiles, XXH128State& Hasher);
+
+// Hashes the contents of all files included by the shader source.
+void HashShaderIncludes(IShaderSourceInputStreamFactory* pFactory, const std::string& Source, std::unordered_set<std::string>& VisitedFiles, XXH128State& Hasher)
+{
+    // Shaders may include files conditionally, so all #include directives are
+    // processed regardless of the macros. This can only add unnecessary files to the hash.
+    for (size_t Pos = Source.find("include"); Pos != std::string::npos; Pos = Source.find("include", Pos))
+    {
+        size_t DirectivePos = Pos;
+        while (DirectivePos > 0 && (Source[DirectivePos - 1] == ' ' || Source[DirectivePos - 1] == '\t'))
+            --DirectivePos;
+
+        Pos += 7;
+        if (DirectivePos == 0 || Source[DirectivePos - 1] != '#')
+            continue;
+
+        const size_t NameStart = Source.find_first_of("\"<\n", Pos);
+        if (NameStart == std::string::npos || Source[NameStart] == '\n')
+            continue;
+
+        const size_t NameEnd = Source.find_first_of("\">\n", NameStart + 1);
+        if (NameEnd == std::string::npos || Source[NameEnd] == '\n')
+            continue;
+
+        HashShaderFile(pFactory, Source.substr(NameStart + 1, NameEnd - NameStart - 1), VisitedFiles, Hasher);
+        Pos = NameEnd;
+    }
+}
+
+// Hashes the contents of the shader source file and all files it includes.
+void HashShaderFile(IShaderSourceInputStreamFactory* pFactory, const std::string& FileName, std::unordered_set<std::string>& VisitedFiles, XXH128State& Hasher)
+{
+    if (!VisitedFiles.insert(FileName).second)
+        return;
+
+    HashString(Hasher, FileName);
+
+    RefCntAutoPtr<IFileStream> pStream;
+    pFactory->CreateInputStream2(FileName.c_str(), CREATE_SHADER_SOURCE_INPUT_STREAM_FLAG_SILENT, &pStream);
+    if (!pStream)
+        return;
+
+    std::string Source(pStream->GetSize(), '\0');
+    if (!Source.empty() && !pStream->Read(&Source[0], Source.size()))
+        return;
+
+    HashString(Hasher, Source);
+    HashShaderIncludes(pFactory, Source, VisitedFiles, Hasher);
+}
+
+} // namespace
+
+DiligentFXShaderArchive& DiligentFXShaderArchive::GetInstance()
+{
+    static DiligentFXShaderArchive TheArchive;
+    return TheArchive;
+}
+
+void DiligentFXShaderArchive::SetDearchiver(IDearchiver* pDearchiver)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    m_pDearchiver = pDearchiver;
+}
+
+void DiligentFXShaderArchive::SetRecordingEnabled(bool Enable)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    m_RecordingEnabled = Enable;
+}
+
+void DiligentFXShaderArchive::HashShaderSource(IShaderSourceInputStreamFactory* pFactory, const char* FilePath, XXH128State& Hasher)
+{
+    if (pFactory == nullptr || FilePath == nullptr)
+        return;
+
+    std::unordered_set<std::string> VisitedFiles;
+    HashShaderFile(pFactory, FilePath, VisitedFiles, Hasher);
+}
+
+std::string DiligentFXShaderArchive::HashToString(const XXH128Hash& Hash)
+{
+    std::stringstream HashSS;
+    HashSS << std::hex << std::setfill('0')
+           << std::setw(16) << Hash.HighPart
+           << std::setw(16) << Hash.LowPart;
+    return HashSS.str();
+}
+
+std::string DiligentFXShaderArchive::GetArchiveName(const ShaderCreateInfo& ShaderCI, const std::vector<GeneratedFile>& GeneratedFiles)
+{
+    const ManifestEntry Entry = MakeManifestEntry(ShaderCI, GeneratedFiles);
+
+    // std::hash is implementation-defined, so the name is built from a hash that is the same
+    // on all platforms and compilers. Otherwise an archive built offline would never match.
+    XXH128State Hasher;
+    HashString(Hasher, Entry.FilePath);
+    HashString(Hasher, Entry.Source);
+    HashString(Hasher, Entry.EntryPoint);
+    HashString(Hasher, Entry.CombinedSamplerSuffix);
+    HashString(Hasher, Entry.GLSLExtensions);
+    Hasher.Update(static_cast<Uint32>(Entry.ShaderType));
+    Hasher.Update(static_cast<Uint32>(Entry.SourceLanguage));
+    Hasher.Update(static_cast<Uint32>(Entry.UseCombinedTextureSamplers ? 1 : 0));
+    Hasher.Update(static_cast<Uint64>(Entry.Macros.size()));
+    for (const auto& Macro : Entry.Macros)
+    {
+        HashString(Hasher, Macro.first);
+        HashString(Hasher, Macro.second);
+    }
+    Hasher.Update(static_cast<Uint64>(Entry.GeneratedFiles.size()));
+    for (const GeneratedFile& File : Entry.GeneratedFiles)
+    {
+        HashString(Hasher, File.Name);
+        HashString(Hasher, File.Content);
+    }
+
+    // Hash the contents of the source file and the files it includes so that
+    // an archive built from older shader sources is never used with newer ones.
+    if (ShaderCI.pShaderSourceStreamFactory != nullptr)
+    {
+        std::unordered_set<std::string> VisitedFiles;
+        if (!Entry.FilePath.empty())
+            HashShaderFile(ShaderCI.pShaderSourceStreamFactory, Entry.FilePath, VisitedFiles, Hasher);
+        else
+            HashShaderIncludes(ShaderCI.pShaderSourceStreamFactory, Entry.Source, VisitedFiles, Hasher);
+    }
+
+    std::stringstream NameSS;
+    NameSS << (!Entry.FilePath.empty() ? Entry.FilePath : "<inline>") << ':' << Entry.EntryPoint << ':'
+           << HashToString(Hasher.Digest());
+    return NameSS.str();
+}
+
+DiligentFXShaderArchive::ManifestEntry DiligentFXShaderArchive::MakeManifestEntry(const ShaderCreateInfo& ShaderCI, const std::vector<GeneratedFile>& GeneratedFiles)
+{
+    ManifestEntry Entry;
+    if (ShaderCI.FilePath != nullptr)
+        Entry.FilePath = ShaderCI.FilePath;
+    if (ShaderCI.Source != nullptr)
+        Entry.Source.assign(ShaderCI.Source, ShaderCI.SourceLength != 0 ? ShaderCI.SourceLength : strlen(ShaderCI.Source));
+    if (ShaderCI.EntryPoint != nullptr)
+        Entry.EntryPoint = ShaderCI.EntryPoint;
+    if (ShaderCI.Desc.CombinedSamplerSuffix != nullptr)
+        Entry.CombinedSamplerSuffix = ShaderCI.Desc.CombinedSamplerSuffix;
+    if (ShaderCI.GLSLExtensions != nullptr)
+        Entry.GLSLExtensions = ShaderCI.GLSLExtensions;
+
+    Entry.ShaderType                 = ShaderCI.Desc.ShaderType;
+    Entry.SourceLanguage             = ShaderCI.SourceLanguage;
+    Entry.UseCombinedTextureSamplers = ShaderCI.Desc.UseCombinedTextureSamplers;
+
+    for (Uint32 i = 0; i < ShaderCI.Macros.Count; ++i)
+    {
+        const ShaderMacro& Macro = ShaderCI.Macros.Elements[i];
+        Entry.Macros.emplace_back(Macro.Name != nullptr ? Macro.Name : "", Macro.Definition != nullptr ? Macro.Definition : "");
+    }
+
+    Entry.GeneratedFiles = GeneratedFiles;
+
+    return Entry;
+}
+
+RefCntAutoPtr<IShader> DiligentFXShaderArchive::CreateShader(IRenderDevice*                    pDevice,
+                                                             IRenderStateCache*                pStateCache,
+                                                             const ShaderCreateInfo&           ShaderCI,
+                                                             const std::vector<GeneratedFile>& GeneratedFiles)
+{
+    RefCntAutoPtr<IDearchiver> pDearchiver;
+    bool                       RecordingEnabled = false;
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        pDearchiver      = m_pDearchiver;
+        RecordingEnabled = m_RecordingEnabled;
+    }
+
+    if (pDearchiver || RecordingEnabled)
+    {
+        const std::string ArchiveName = GetArchiveName(ShaderCI, GeneratedFiles);
+        if (pDearchiver)
+        {
+            ShaderUnpackInfo UnpackInfo;
+            UnpackInfo.pDevice = pDevice;
+            UnpackInfo.Name    = ArchiveName.c_str();
+
+            RefCntAutoPtr<IShader> pShader;
+            pDearchiver->UnpackShader(UnpackInfo, &pShader);
+            if (pShader)
+            {
+                std::lock_guard<std::mutex> Lock{m_Mtx};
+                ++m_NumArchiveHits;
+                return pShader;
+            }
+            LOG_INFO_MESSAGE("Shader '", ArchiveName, "' is not found in the DiligentFX shader archive and will be compiled at run time.");
+        }
+
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        ++m_NumArchiveMisses;
+        if (RecordingEnabled)
+        {
+            ManifestEntry Entry = MakeManifestEntry(ShaderCI, GeneratedFiles);
+            Entry.ArchiveName   = ArchiveName;
+            m_Manifest.emplace_back(std::move(Entry));
+        }
+    }
+
+    return RenderDeviceWithCache<false>{pDevice, pStateCache}.CreateShader(ShaderCI);
+}
+
+bool DiligentFXShaderArchive::WriteManifest(const char* FilePath) const
+{
+    // Write to a temporary file first and then rename it so that an interrupted
+    // write never leaves a truncated manifest behind.
+    const std::string TmpPath = std::string{FilePath} + ".tmp";
+
+    std::ofstream Stream{TmpPath, std::ios::binary | std::ios::trunc};
+    if (!Stream)
+    {
+        LOG_ERROR_MESSAGE("Failed to open shader manifest file ", TmpPath, " for writing");
+        return false;
+    }
+
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+
+    Stream << ManifestHeader << '\n';
+    for (const ManifestEntry& Entry : m_Manifest)
+    {
+        WriteField(Stream, "shader", Entry.ArchiveName);
+        WriteField(Stream, "file", Entry.FilePath);
+        WriteField(Stream, "source", Entry.Source);
+        WriteField(Stream, "entry", Entry.EntryPoint);
+        WriteField(Stream, "sampler_suffix", Entry.CombinedSamplerSuffix);
+        WriteField(Stream, "glsl_extensions", Entry.GLSLExtensions);
+        WriteField(Stream, "type", std::to_string(static_cast<Uint32>(Entry.ShaderType)));
+        WriteField(Stream, "language", std::to_string(static_cast<Uint32>(Entry.SourceLanguage)));
+        WriteField(Stream, "combined_samplers", Entry.UseCombinedTextureSamplers ? "1" : "0");
+        for (const auto& Macro : Entry.Macros)
+        {
+            WriteField(Stream, "macro", Macro.first);
+            WriteField(Stream, "definition", Macro.second);
+        }
+        for (const GeneratedFile& File : Entry.GeneratedFiles)
+        {
+            WriteField(Stream, "generated", File.Name);
+            WriteField(Stream, "content", File.Content);
+        }
+        WriteField(Stream, "end", "");
+    }
+    Lock.unlock();
+
+    Stream.close();
+    if (!Stream)
+    {
+        LOG_ERROR_MESSAGE("Failed to write shader manifest file ", TmpPath);
+        std::remove(TmpPath.c_str());
+        return false;
+    }
+
+    if (std::rename(TmpPath.c_str(), FilePath) != 0)
+    {
+        // rename does not replace an existing file on some platforms
+        std::remove(FilePath);
+        if (std::rename(TmpPath.c_str(), FilePath) != 0)
+        {
+            LOG_ERROR_MESSAGE("Failed to rename ", TmpPath, " to ", FilePath);
+            std::remove(TmpPath.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DiligentFXShaderArchive::ReadManifest(const char* FilePath, std::vector<ManifestEntry>& Entries)
+{
+    std::ifstream Stream{FilePath, std::ios::binary};
+    if (!Stream)
+    {
+        LOG_ERROR_MESSAGE("Failed to open shader manifest file ", FilePath);
+        return false;
+    }
+
+    std::string Header;
+    if (!std::getline(Stream, Header) || Header != ManifestHeader)
+    {
+        LOG_ERROR_MESSAGE(FilePath, " is not a valid DiligentFX shader manifest");
+        return false;
+    }
+
+    ManifestEntry Entry;
+    std::string   Key;
+    std::string   Value;
+    while (ReadField(Stream, Key, Value))
+    {
+        // clang-format off
+        if      (Key == "shader")            Entry.ArchiveName                = std::move(Value);
+        else if (Key == "file")              Entry.FilePath                   = std::move(Value);
+        else if (Key == "source")            Entry.Source                     = std::move(Value);
+        else if (Key == "entry")             Entry.EntryPoint                 = std::move(Value);
+        else if (Key == "sampler_suffix")    Entry.CombinedSamplerSuffix      = std::move(Value);
+        else if (Key == "glsl_extensions")   Entry.GLSLExtensions             = std::move(Value);
+        else if (Key == "combined_samplers") Entry.UseCombinedTextureSamplers = (Value == "1");
+        else if (Key == "macro")             Entry.Macros.emplace_back(std::move(Value), "");
+        else if (Key == "generated")         Entry.GeneratedFiles.push_back({std::move(Value), ""});
+        // clang-format on
+        else if (Key == "type" || Key == "language")
+        {
+            Uint32 IntValue = 0;
+            if (!ParseUint(Value, IntValue))
+            {
+                LOG_ERROR_MESSAGE("Invalid value '", Value, "' of field '", Key, "' in shader manifest ", FilePath);
+                return false;
+            }
+            if (Key == "type")
+                Entry.ShaderType = static_cast<SHADER_TYPE>(IntValue);
+            else
+                Entry.SourceLanguage = static_cast<SHADER_SOURCE_LANGUAGE>(IntValue);
+        }
+        else if (Key == "definition" && !Entry.Macros.empty())
+        {
+            Entry.Macros.back().second = std::move(Value);
+        }
+        else if (Key == "content" && !Entry.GeneratedFiles.empty())
+        {
+            Entry.GeneratedFiles.back().Content = std::move(Value);
+        }
+        else if (Key == "end")
+        {
+            Entries.emplace_back(std::move(Entry));
+            Entry = {};
+        }
+        else
+        {
+            LOG_ERROR_MESSAGE("Unexpected field '", Key, "' in shader manifest ", FilePath);
+            return false;
+        }
+    }
+
+    if (!Stream.eof())
+    {
+        LOG_ERROR_MESSAGE("Failed to parse shader manifest ", FilePath);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Diligent